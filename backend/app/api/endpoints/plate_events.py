@@ -1,11 +1,14 @@
-from fastapi import APIRouter, Depends, HTTPException
+import json
+from fastapi import APIRouter, Depends, HTTPException, Request
+from fastapi.responses import JSONResponse
 from sqlalchemy.orm import Session
-from sqlalchemy import desc
+from sqlalchemy import desc, insert
 from typing import List, Optional
 from datetime import datetime
 from ...core.database import get_db
 from ...models import PlateEvent, Camera
 from ...schemas import PlateEvent as PlateEventSchema, PlateEventCreate
+from ...services.event_wire import CONTENT_TYPE as WIRE_CONTENT_TYPE, WireFormatError, decode_batch, plate_event_row
 
 router = APIRouter()
 
@@ -65,6 +68,64 @@ async def ingest_plate_event(event: PlateEventCreate, db: Session = Depends(get_
     return db_event
 
 
+@router.post("/ingest/bulk", status_code=202)
+async def ingest_plate_events_bulk(request: Request, db: Session = Depends(get_db)):
+    """
+    Ingest a batch of edge events with a single bulk insert.
+
+    The body is either the binary wire format (Content-Type
+    application/x-anpr-events, see app.services.event_wire) or JSON
+    {"events": [...]} in the edge DetectionEvent layout. Valid events are
+    stored; if any event has no backend camera id, names an unknown camera
+    or has no usable timestamp, the response is 207 Multi-Status listing
+    them in rejected_events, so the edge keeps those events for retry.
+    """
+    body = await request.body()
+    content_type = request.headers.get("content-type", "").split(";")[0].strip()
+    try:
+        if content_type == WIRE_CONTENT_TYPE:
+            events = decode_batch(body)
+        else:
+            events = json.loads(body).get("events", [])
+    except (WireFormatError, ValueError, AttributeError) as e:
+        raise HTTPException(status_code=400, detail=f"Invalid event batch: {e}")
+
+    rows = []
+    rejected = []
+    for index, event in enumerate(events):
+        if not isinstance(event, dict):
+            rejected.append({"index": index, "event_id": None, "reason": "not an event object"})
+            continue
+        try:
+            rows.append((index, plate_event_row(event)))
+        except ValueError as e:
+            rejected.append({"index": index, "event_id": event.get("event_id"), "reason": str(e)})
+
+    # Verify cameras exist, one query for the whole batch
+    camera_ids = {row["camera_id"] for _, row in rows}
+    known = set()
+    if camera_ids:
+        known = {camera_id for (camera_id,) in db.query(Camera.id).filter(Camera.id.in_(camera_ids))}
+    for index, row in rows:
+        if row["camera_id"] not in known:
+            rejected.append({
+                "index": index,
+                "event_id": events[index].get("event_id"),
+                "reason": f"unknown camera {row['camera_id']}",
+            })
+    rows = [row for _, row in rows if row["camera_id"] in known]
+
+    if rows:
+        db.execute(insert(PlateEvent.__table__), rows)
+        db.commit()
+
+    result = {"received": len(events), "inserted": len(rows), "rejected": len(rejected)}
+    if rejected:
+        result["rejected_events"] = sorted(rejected, key=lambda rejection: rejection["index"])
+        return JSONResponse(status_code=207, content=result)
+    return result
+
+
 @router.delete("/{event_id}")
 def delete_plate_event(event_id: int, db: Session = Depends(get_db)):
     """Delete a plate event"""
@@ -0,0 +1,206 @@
+"""
+Event Wire Format
+Decoder for the edge worker's binary plate-event batches.
+
+Mirrors edge/exporters/wire.py, which documents the layout; keep the two in
+step. Batches are posted to POST /api/plate-events/ingest/bulk with
+Content-Type application/x-anpr-events.
+"""
+
+import json
+import struct
+import zlib
+from datetime import datetime, timezone
+from typing import Any, Dict, List, Optional, Tuple
+
+CONTENT_TYPE = "application/x-anpr-events"
+
+MAGIC = b"ANPE"
+VERSION = 1
+FLAG_ZLIB = 0x01
+
+BOX_PLATE = 0x01
+BOX_VEHICLE = 0x02
+
+_HEADER = struct.Struct("<4sBBI")
+_LENGTH = struct.Struct("<I")
+_FIXED = struct.Struct("<dfB")
+_BOX = struct.Struct("<4f")
+_STRING = struct.Struct("<H")
+
+_STRING_FIELDS = ("event_id", "worker_id", "camera_id", "camera_name", "plate_text", "image_path")
+
+# Bound on the inflated record section, against compression bombs
+MAX_DECOMPRESSED_BYTES = 64 * 1024 * 1024
+
+
+class WireFormatError(ValueError):
+    """Raised for a batch that is truncated or not in this format"""
+
+
+def _unpack_string(body: bytes, offset: int) -> Tuple[Optional[str], int]:
+    (length,) = _STRING.unpack_from(body, offset)
+    offset += _STRING.size
+    if offset + length > len(body):
+        raise WireFormatError("Truncated string field")
+    value = body[offset:offset + length].decode("utf-8")
+    return value or None, offset + length
+
+
+def decode_record(body: bytes) -> Dict[str, Any]:
+    """
+    Decode one record body.
+
+    Returns:
+        Edge event dictionary (DetectionEvent layout), timestamp as datetime
+    """
+    try:
+        timestamp, confidence, boxes = _FIXED.unpack_from(body, 0)
+        offset = _FIXED.size
+        event: Dict[str, Any] = {"plate_bbox": None, "vehicle_bbox": None}
+        if boxes & BOX_PLATE:
+            event["plate_bbox"] = _BOX.unpack_from(body, offset)
+            offset += _BOX.size
+        if boxes & BOX_VEHICLE:
+            event["vehicle_bbox"] = _BOX.unpack_from(body, offset)
+            offset += _BOX.size
+        for field in _STRING_FIELDS:
+            event[field], offset = _unpack_string(body, offset)
+
+        (metadata_length,) = _LENGTH.unpack_from(body, offset)
+        offset += _LENGTH.size
+        if offset + metadata_length > len(body):
+            raise WireFormatError("Truncated metadata")
+        metadata = body[offset:offset + metadata_length]
+    except (struct.error, UnicodeDecodeError) as e:
+        raise WireFormatError(f"Malformed record: {e}") from e
+
+    event["timestamp"] = datetime.fromtimestamp(timestamp, tz=timezone.utc)
+    event["confidence"] = round(confidence, 6)  # f32 on the wire
+    event["plate_text"] = event["plate_text"] or ""
+    try:
+        event["metadata"] = json.loads(metadata) if metadata else None
+    except ValueError as e:
+        raise WireFormatError(f"Malformed metadata: {e}") from e
+    return event
+
+
+def decode_batch(data: bytes) -> List[Dict[str, Any]]:
+    """
+    Decode a binary event batch.
+
+    Raises:
+        WireFormatError: Bad magic, unknown version or truncated data
+    """
+    if len(data) < _HEADER.size:
+        raise WireFormatError("Truncated batch header")
+    magic, version, flags, count = _HEADER.unpack_from(data, 0)
+    if magic != MAGIC:
+        raise WireFormatError("Not an event batch")
+    if version != VERSION:
+        raise WireFormatError(f"Unsupported batch version {version}")
+
+    records = data[_HEADER.size:]
+    if flags & FLAG_ZLIB:
+        inflater = zlib.decompressobj()
+        try:
+            records = inflater.decompress(records, MAX_DECOMPRESSED_BYTES)
+        except zlib.error as e:
+            raise WireFormatError(f"Corrupt compressed batch: {e}") from e
+        if inflater.unconsumed_tail:
+            raise WireFormatError("Batch exceeds the decompressed size limit")
+        if not inflater.eof:
+            raise WireFormatError("Truncated compressed batch")
+
+    events = []
+    offset = 0
+    for _ in range(count):
+        if offset + _LENGTH.size > len(records):
+            raise WireFormatError("Truncated batch")
+        (length,) = _LENGTH.unpack_from(records, offset)
+        offset += _LENGTH.size
+        if offset + length > len(records):
+            raise WireFormatError("Truncated record")
+        events.append(decode_record(records[offset:offset + length]))
+        offset += length
+    return events
+
+
+def _camera_id(event: Dict[str, Any]) -> Optional[int]:
+    """
+    Backend camera id of an edge event.
+
+    Edge camera ids are free-form strings, so the edge maps each camera
+    explicitly (backend_id in its camera config, sent as metadata
+    backend_camera_id). An integer camera_id, as JSON clients may send, is
+    taken as is; string ids are never parsed.
+    """
+    metadata = event.get("metadata")
+    value = metadata.get("backend_camera_id") if isinstance(metadata, dict) else None
+    if value is None:
+        value = event.get("camera_id")
+    if isinstance(value, int) and not isinstance(value, bool):
+        return value
+    return None
+
+
+def plate_event_row(event: Dict[str, Any]) -> Dict[str, Any]:
+    """
+    Map an edge event to a plate_events row.
+
+    The plate box (x1, y1, x2, y2) becomes the x/y/width/height bbox, the
+    detection confidence is the edge's plate_confidence, the OCR confidence
+    is the event confidence (the edge's recognition confidence) unless the
+    metadata carries ocr_confidence, and the edge identifiers are kept in
+    metadata.
+
+    Args:
+        event: Decoded batch record or JSON batch entry
+
+    Returns:
+        Column values
+
+    Raises:
+        ValueError: The event has no backend camera id or no usable timestamp
+    """
+    camera_id = _camera_id(event)
+    if camera_id is None:
+        raise ValueError(f"camera {event.get('camera_id')!r} has no backend camera id")
+
+    timestamp = event.get("timestamp")
+    if isinstance(timestamp, str):
+        try:
+            timestamp = datetime.fromisoformat(timestamp.replace("Z", "+00:00"))
+        except ValueError:
+            raise ValueError(f"invalid timestamp {timestamp!r}") from None
+    if not isinstance(timestamp, datetime):
+        raise ValueError("missing timestamp")
+    if timestamp.tzinfo is None:
+        timestamp = timestamp.replace(tzinfo=timezone.utc)
+
+    bbox = None
+    plate_bbox = event.get("plate_bbox")
+    if plate_bbox and len(plate_bbox) == 4:
+        x1, y1, x2, y2 = (int(round(v)) for v in plate_bbox)
+        bbox = {"x": x1, "y": y1, "width": x2 - x1, "height": y2 - y1}
+
+    metadata = dict(event.get("metadata") or {})
+    for field in ("event_id", "worker_id", "camera_id", "camera_name", "vehicle_bbox"):
+        if event.get(field) is not None:
+            metadata[field] = list(event[field]) if field == "vehicle_bbox" else event[field]
+
+    confidence = float(event.get("confidence") or 0.0)
+    detection_confidence = metadata.get("detection_confidence", metadata.get("plate_confidence"))
+    ocr_confidence = metadata.get("ocr_confidence", confidence)
+
+    return {
+        "camera_id": camera_id,
+        "plate_text": event.get("plate_text") or "",
+        "confidence": confidence,
+        "detection_confidence": detection_confidence,
+        "ocr_confidence": ocr_confidence,
+        "bbox": bbox,
+        "timestamp": timestamp,
+        "image_path": event.get("image_path"),
+        "metadata": metadata or None,
+    }
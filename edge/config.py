@@ -14,6 +14,7 @@ class CameraConfig(BaseModel):
     """Configuration for a single camera"""
 
     id: str = Field(..., description="Unique camera identifier")
+    backend_id: Optional[int] = Field(None, description="Backend camera id of this camera's events (REST bulk ingest)")
     name: str = Field(..., description="Human-readable camera name")
     rtsp_url: str = Field(..., description="RTSP stream URL")
     location: Optional[str] = Field(None, description="Physical location")
@@ -88,7 +89,13 @@ class ExporterConfig(BaseModel):
     retry_backoff: float = Field(2.0, ge=1.0, description="Retry backoff multiplier")
     timeout: int = Field(30, ge=1, description="Request timeout in seconds")
     batch_size: int = Field(10, ge=1, description="Event batch size")
+    batch_max_delay: float = Field(0.5, ge=0.0, description="Maximum seconds an event waits for its batch to fill")
+    wire_format: Literal["json", "binary"] = Field("binary", description="REST batch encoding")
+    compress: bool = Field(True, description="zlib-compress binary batches")
+    batch_endpoint: Optional[str] = Field(None, description="REST bulk ingest URL (default: endpoint + '/bulk')")
     queue_path: Optional[str] = Field("/var/lib/anpr/queue", description="Disk queue path")
+    queue_segment_mb: int = Field(64, ge=1, description="Retry log segment size in MiB")
+    queue_max_mb: int = Field(4096, ge=1, description="Retry log disk budget in MiB (oldest events dropped beyond)")
 
 
 class PipelineConfig(BaseModel):
@@ -5,7 +5,6 @@ Exports detection events to backend using REST, WebSocket, or MQTT
 
 from typing import Dict, List, Optional, Any
 from dataclasses import dataclass, asdict
-from datetime import datetime
 from abc import ABC, abstractmethod
 import json
 import time
@@ -15,9 +14,23 @@ from queue import Queue, Empty
 from loguru import logger
 import requests
 import websocket
-from diskcache import Cache
 
 from edge.config import ExporterConfig
+from edge.exporters import wire
+from edge.exporters.retry_log import RetryLog
+
+# While exports fail, live batches go straight to the retry log and a replay
+# batch probes the backend this often
+OUTAGE_PROBE_INTERVAL = 5.0
+
+# Live queue poll while a backlog replays between live batches
+BACKLOG_POLL_INTERVAL = 0.05
+
+# Batches replayed per pass when no live batch is waiting
+REPLAY_BURST = 8
+
+# Bulk ingest answers 207 when it rejected some of the batch's events
+MULTI_STATUS = 207
 
 
 @dataclass
@@ -101,6 +114,16 @@ class BaseExporter(ABC):
         """
         pass
 
+    def take_rejected(self) -> List[DetectionEvent]:
+        """
+        Events the receiver refused since the last call, although their batch
+        was delivered (for example a camera the backend does not know)
+
+        Returns:
+            Rejected events, oldest first
+        """
+        return []
+
     @abstractmethod
     def close(self):
         """Close exporter and cleanup resources"""
@@ -120,22 +143,31 @@ class RESTExporter(BaseExporter):
             "Content-Type": "application/json",
             "User-Agent": "ANPR-Edge-Worker/1.0",
         })
+        self.batch_endpoint = config.batch_endpoint or f"{config.endpoint.rstrip('/')}/bulk"
+        self.rejected: List[DetectionEvent] = []
 
     def export(self, event: DetectionEvent) -> bool:
         """
         Export single event via REST API
 
+        Sent as a batch of one: the backend takes edge events only on its bulk
+        ingest endpoint (POST /api/plate-events/ingest expects backend rows).
+
         Args:
             event: Detection event
 
         Returns:
             True if successful
         """
-        return self._send_with_retry(event.to_dict())
+        return self.export_batch([event])
 
     def export_batch(self, events: List[DetectionEvent]) -> bool:
         """
-        Export batch of events via REST API
+        Export batch of events in one request to the bulk ingest endpoint,
+        encoded with edge.exporters.wire unless wire_format is "json"
+
+        Events the backend rejects (207 Multi-Status) are kept for
+        take_rejected(); the rest of the batch counts as delivered.
 
         Args:
             events: List of events
@@ -143,24 +175,66 @@ class RESTExporter(BaseExporter):
         Returns:
             True if successful
         """
-        payload = {
-            "events": [event.to_dict() for event in events],
-            "batch_size": len(events),
-        }
-        return self._send_with_retry(payload)
+        event_dicts = [event.to_dict() for event in events]
+        if self.config.wire_format == "binary":
+            body = wire.encode_batch(event_dicts, compress=self.config.compress)
+            response = self._send_with_retry(
+                self.batch_endpoint,
+                data=body,
+                headers={"Content-Type": wire.CONTENT_TYPE},
+            )
+        else:
+            payload = {
+                "events": event_dicts,
+                "batch_size": len(events),
+            }
+            response = self._send_with_retry(self.batch_endpoint, json=payload)
+
+        if response is None:
+            return False
+        if response.status_code == MULTI_STATUS:
+            self.rejected.extend(self._rejected_events(response, events))
+        return True
+
+    def _rejected_events(self, response: requests.Response, events: List[DetectionEvent]) -> List[DetectionEvent]:
+        """
+        Events of a batch listed in a 207 response
+
+        Args:
+            response: Bulk ingest response
+            events: The batch, in the order sent
 
-    def _send_with_retry(self, payload: Dict) -> bool:
+        Returns:
+            Rejected events; the whole batch if the response cannot be read
+        """
+        try:
+            rejections = response.json()["rejected_events"]
+            indices = sorted({int(rejection["index"]) for rejection in rejections})
+            for rejection in rejections:
+                logger.warning(f"Backend rejected event {rejection.get('event_id')}: {rejection.get('reason')}")
+            return [events[index] for index in indices if 0 <= index < len(events)]
+        except (ValueError, KeyError, TypeError) as e:
+            logger.error(f"Unreadable bulk ingest rejections, keeping the whole batch: {e}")
+            return list(events)
+
+    def take_rejected(self) -> List[DetectionEvent]:
+        """Events rejected by the backend since the last call"""
+        rejected, self.rejected = self.rejected, []
+        return rejected
+
+    def _send_with_retry(self, url: str, **request) -> Optional[requests.Response]:
         """
         Send payload with retry logic
 
         Args:
-            payload: Data to send
+            url: Target URL
+            **request: Body arguments for requests (json= or data= and headers=)
 
         Returns:
-            True if successful
+            Response if successful, None otherwise
         """
         if not self.config.retry_enabled:
-            return self._send_request(payload)
+            return self._send_request(url, **request)
 
         # Retry with exponential backoff
         max_attempts = self.config.retry_max_attempts
@@ -168,8 +242,9 @@ class RESTExporter(BaseExporter):
 
         for attempt in range(max_attempts):
             try:
-                if self._send_request(payload):
-                    return True
+                response = self._send_request(url, **request)
+                if response is not None:
+                    return response
 
                 if attempt < max_attempts - 1:
                     sleep_time = backoff * self.config.retry_backoff
@@ -184,41 +259,42 @@ class RESTExporter(BaseExporter):
                     backoff *= self.config.retry_backoff
 
         logger.error(f"Failed to export after {max_attempts} attempts")
-        return False
+        return None
 
-    def _send_request(self, payload: Dict) -> bool:
+    def _send_request(self, url: str, **request) -> Optional[requests.Response]:
         """
         Send HTTP POST request
 
         Args:
-            payload: Data to send
+            url: Target URL
+            **request: Body arguments for requests
 
         Returns:
-            True if successful
+            Response if successful (2xx, 207 included), None otherwise
         """
         try:
             response = self.session.post(
-                self.config.endpoint,
-                json=payload,
+                url,
                 timeout=self.config.timeout,
+                **request,
             )
 
-            if response.status_code in [200, 201, 202]:
+            if response.status_code in [200, 201, 202, MULTI_STATUS]:
                 logger.debug(f"Event exported successfully: {response.status_code}")
-                return True
+                return response
             else:
                 logger.warning(f"Export failed with status {response.status_code}: {response.text}")
-                return False
+                return None
 
         except requests.exceptions.Timeout:
             logger.warning(f"Request timeout after {self.config.timeout}s")
-            return False
+            return None
         except requests.exceptions.ConnectionError as e:
             logger.warning(f"Connection error: {e}")
-            return False
+            return None
         except Exception as e:
             logger.error(f"Request failed: {e}")
-            return False
+            return None
 
     def close(self):
         """Close session"""
@@ -429,19 +505,42 @@ class MQTTExporter(BaseExporter):
 class EventDispatcher:
     """
     Event dispatcher with retry queue and multiple exporters
+
+    Events are exported in batches: the worker takes events until it holds the
+    largest exporter batch_size or the first of them has waited the smallest
+    batch_max_delay, then hands each exporter the batch in chunks of its own
+    batch_size (a chunk of one goes through export()).
+
+    Batches that fail go to a memory-mapped retry log (edge.exporters.retry_log)
+    and are replayed in batches between live batches once the backend answers
+    again. During an outage live batches are written to the log without an
+    export attempt, so the in-memory queue stays short however long it lasts.
+    Events an exporter delivered but the receiver rejected (take_rejected())
+    go to the log too, and replay pauses for OUTAGE_PROBE_INTERVAL after a
+    rejection so events that stay rejected are not resent in a tight loop.
     """
 
-    def __init__(self, configs: List[ExporterConfig], queue_path: Optional[str] = None):
+    def __init__(
+        self,
+        configs: List[ExporterConfig],
+        queue_path: Optional[str] = None,
+        queue_segment_bytes: int = 64 * 1024 * 1024,
+        queue_max_bytes: int = 4 * 1024 * 1024 * 1024,
+    ):
         """
         Initialize event dispatcher
 
         Args:
             configs: List of exporter configurations
-            queue_path: Path for disk-backed retry queue
+            queue_path: Directory of the retry log
+            queue_segment_bytes: Retry log segment size
+            queue_max_bytes: Retry log disk budget, the oldest events are dropped beyond it
         """
         self.exporters: List[BaseExporter] = []
         self.queue_path = queue_path or "/tmp/anpr-queue"
-        self.retry_queue: Optional[Cache] = None
+        self.retry_log: Optional[RetryLog] = None
+        self._outage_until = 0.0
+        self._replay_after = 0.0
         self.event_queue: Queue = Queue()
         self.worker_thread: Optional[threading.Thread] = None
         self.running = False
@@ -472,13 +571,22 @@ class EventDispatcher:
         if not self.exporters:
             logger.warning("No exporters initialized")
 
-        # Initialize retry queue (disk-backed cache)
+        self.batch_size = max((exporter.config.batch_size for exporter in self.exporters), default=1)
+        self.batch_max_delay = min((exporter.config.batch_max_delay for exporter in self.exporters), default=0.0)
+        self.batches = 0
+        self.batched_events = 0
+        self.rejected_events = 0
+
+        # Initialize retry log (memory-mapped segments)
         try:
-            Path(self.queue_path).mkdir(parents=True, exist_ok=True)
-            self.retry_queue = Cache(self.queue_path)
-            logger.info(f"Retry queue initialized at {self.queue_path}")
+            self.retry_log = RetryLog(
+                self.queue_path,
+                segment_bytes=queue_segment_bytes,
+                max_bytes=queue_max_bytes,
+            )
+            self._migrate_disk_cache()
         except Exception as e:
-            logger.error(f"Failed to initialize retry queue: {e}")
+            logger.error(f"Failed to initialize retry log: {e}")
 
         # Start worker thread
         self.start()
@@ -500,72 +608,178 @@ class EventDispatcher:
 
         while self.running:
             try:
-                # Get event from queue (blocking with timeout)
-                event = self.event_queue.get(timeout=1.0)
+                outage = time.monotonic() < self._outage_until
+                backlog = self.retry_log is not None and self.retry_log.pending() > 0
 
-                # Try to export
-                success = self._export_event(event)
+                # Poll briefly while catching up so replay runs between live batches
+                batch = self._next_batch(BACKLOG_POLL_INTERVAL if backlog and not outage else 1.0)
+                if batch and (outage or not self._export_batch(batch)):
+                    self._add_to_retry_log(batch)
 
-                if not success and self.retry_queue:
-                    # Add to retry queue
-                    key = f"{event.event_id}_{datetime.utcnow().timestamp()}"
-                    self.retry_queue.set(key, event.to_dict())
-                    logger.debug(f"Added event to retry queue: {event.event_id}")
+                # One replay batch per live batch, a burst when idle, a probe during an outage
+                if backlog and time.monotonic() >= max(self._outage_until, self._replay_after):
+                    self._process_retry_queue(1 if batch or outage else REPLAY_BURST)
 
-            except Empty:
-                # Queue timeout, check retry queue
-                self._process_retry_queue()
             except Exception as e:
                 logger.error(f"Error in worker loop: {e}")
 
         logger.info("Event dispatcher worker stopped")
 
-    def _export_event(self, event: DetectionEvent) -> bool:
+    def _next_batch(self, timeout: float = 1.0) -> List[DetectionEvent]:
         """
-        Export event to all exporters
+        Collect the next batch of events
+
+        Blocks up to timeout for the first event, then takes more until the
+        batch holds batch_size events or batch_max_delay has passed; events
+        already queued by then still join the batch.
 
         Args:
-            event: Detection event
+            timeout: Seconds to wait for the first event
+
+        Returns:
+            Events in dispatch order, empty on timeout
+        """
+        try:
+            batch = [self.event_queue.get(timeout=timeout)]
+        except Empty:
+            return []
+
+        deadline = time.monotonic() + self.batch_max_delay
+        while len(batch) < self.batch_size:
+            remaining = deadline - time.monotonic()
+            try:
+                if remaining > 0:
+                    batch.append(self.event_queue.get(timeout=remaining))
+                else:
+                    batch.append(self.event_queue.get_nowait())
+            except Empty:
+                break
+
+        return batch
+
+    def _export_batch(self, events: List[DetectionEvent]) -> bool:
+        """
+        Export events to all exporters, each in chunks of its batch_size
+
+        Args:
+            events: Detection events
 
         Returns:
-            True if at least one exporter succeeded
+            True if at least one exporter took every chunk
         """
         success = False
 
         for exporter in self.exporters:
+            size = exporter.config.batch_size
             try:
-                if exporter.export(event):
+                exported = True
+                for start in range(0, len(events), size):
+                    chunk = events[start:start + size]
+                    sent = exporter.export(chunk[0]) if len(chunk) == 1 else exporter.export_batch(chunk)
+                    exported = exported and sent
+                if exported:
                     success = True
             except Exception as e:
                 logger.error(f"Exporter {exporter.config.type} failed: {e}")
 
+        if success:
+            self.batches += 1
+            self.batched_events += len(events)
+            self._outage_until = 0.0
+        else:
+            self._outage_until = time.monotonic() + OUTAGE_PROBE_INTERVAL
+
+        # Rejected events are kept for replay once the receiver is fixed; a
+        # failed batch goes to the retry log whole, rejected events included
+        rejected = [event for exporter in self.exporters for event in exporter.take_rejected()]
+        if success and rejected:
+            self.rejected_events += len(rejected)
+            self._replay_after = time.monotonic() + OUTAGE_PROBE_INTERVAL
+            self._add_to_retry_log(rejected)
         return success
 
-    def _process_retry_queue(self):
+    def _add_to_retry_log(self, events: List[DetectionEvent]):
         """
-        Process events from retry queue
+        Append events to the retry log
+
+        Args:
+            events: Events that could not be exported
         """
-        if not self.retry_queue:
+        if self.retry_log is None:
             return
 
-        # Process a few events from retry queue
-        for key in list(self.retry_queue.iterkeys())[:10]:
+        payloads = []
+        for event in events:
             try:
-                event_dict = self.retry_queue.get(key)
-                if not event_dict:
-                    continue
+                payloads.append(wire.encode_record(event.to_dict()))
+            except (wire.WireFormatError, ValueError, TypeError, KeyError) as e:
+                logger.error(f"Cannot queue event {event.event_id} for retry: {e}")
 
-                # Recreate event
-                event = DetectionEvent(**event_dict)
+        self.retry_log.append(payloads)
+        logger.debug(f"Added {len(payloads)} events to retry log")
+
+    def _migrate_disk_cache(self):
+        """
+        Move events left in a diskcache retry queue (older releases) into the retry log
+        """
+        if not (Path(self.queue_path) / "cache.db").exists():
+            return
+
+        try:
+            from diskcache import Cache
+        except ImportError:
+            logger.warning(f"Old retry queue in {self.queue_path} needs diskcache to migrate")
+            return
 
-                # Try to export
-                if self._export_event(event):
-                    # Remove from retry queue on success
-                    del self.retry_queue[key]
-                    logger.debug(f"Retry successful for event: {event.event_id}")
+        cache = Cache(self.queue_path)
+        try:
+            events = [DetectionEvent(**cache[key]) for key in cache.iterkeys()]
+            self._add_to_retry_log(events)
+            cache.clear()
+            logger.info(f"Migrated {len(events)} events from the old retry queue")
+        finally:
+            cache.close()
+
+    def _process_retry_queue(self, batches: int = 1):
+        """
+        Process events from retry queue
+
+        Args:
+            batches: Dispatcher batches to replay, stops at the first failure or rejection
+        """
+        if self.retry_log is None:
+            return
+
+        for _ in range(batches):
+            if not self._replay_batch() or time.monotonic() < self._replay_after:
+                break
+
+    def _replay_batch(self) -> bool:
+        """
+        Export the oldest batch of the retry log
 
+        Returns:
+            True if a batch was exported and consumed
+        """
+        payloads, position = self.retry_log.read_batch(self.batch_size)
+        if not payloads:
+            return False
+
+        events = []
+        for payload in payloads:
+            try:
+                # Recreate event
+                events.append(DetectionEvent(**wire.decode_record(payload)))
             except Exception as e:
-                logger.error(f"Error processing retry queue: {e}")
+                logger.error(f"Dropping unreadable retry log record: {e}")
+
+        # Try to export, consume from retry log on success
+        if events and not self._export_batch(events):
+            return False
+
+        self.retry_log.commit(position)
+        logger.debug(f"Retry successful for {len(events)} events")
+        return True
 
     def start(self):
         """Start dispatcher worker thread"""
@@ -592,6 +806,9 @@ class EventDispatcher:
             except Exception as e:
                 logger.error(f"Error closing exporter: {e}")
 
+        if self.retry_log is not None:
+            self.retry_log.close()
+
         logger.info("Event dispatcher stopped")
 
     def get_stats(self) -> Dict[str, Any]:
@@ -601,11 +818,17 @@ class EventDispatcher:
         Returns:
             Dictionary of statistics
         """
-        retry_queue_size = len(self.retry_queue) if self.retry_queue else 0
+        retry_log = self.retry_log.stats() if self.retry_log is not None else {}
 
         return {
             "running": self.running,
             "num_exporters": len(self.exporters),
             "event_queue_size": self.event_queue.qsize(),
-            "retry_queue_size": retry_queue_size,
+            "retry_queue_size": retry_log.get("pending", 0),
+            "retry_log": retry_log,
+            "outage": time.monotonic() < self._outage_until,
+            "batch_size": self.batch_size,
+            "batches": self.batches,
+            "mean_batch_size": self.batched_events / self.batches if self.batches else 0.0,
+            "rejected_events": self.rejected_events,
         }
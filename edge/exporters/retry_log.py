@@ -0,0 +1,461 @@
+"""
+Retry Log
+Segmented, append-only, memory-mapped store for events awaiting re-export
+
+The log is a directory of fixed-size segment files. Records are appended to
+the active segment through a writable mmap; a segment that cannot take the
+next record is sealed and the next one is created. Every record has a fixed
+header and a CRC over its payload, so after a crash the active segment is
+recovered by scanning up to the first record that does not check out:
+
+    segment header (64 bytes)
+        "ANPRSEG1" | sequence u64 | flags u32 | count u32 | end u64 | crc u32
+
+    record (8-byte aligned)
+        magic u32 | length u32 | crc32 u32 | reserved u32 | payload
+
+The replay position lives in a separate cursor file that is replaced
+atomically (write, fsync, rename), so a crash re-delivers at most the batch
+that was in flight and never skips one. Sealed segments wholly behind the
+cursor are deleted in the background, which is all the compaction a FIFO log
+needs; replay and appends never wait for it.
+
+RAM use does not depend on the backlog: nothing is indexed in memory beyond
+a record count per segment, and replay reads one batch at a time through the
+page cache.
+"""
+
+import mmap
+import os
+import struct
+import threading
+import zlib
+from pathlib import Path
+from typing import Any, Dict, List, Optional, Sequence, Tuple
+
+from loguru import logger
+
+SEGMENT_MAGIC = b"ANPRSEG1"
+RECORD_MAGIC = 0x414E5052  # "ANPR"
+FLAG_SEALED = 0x01
+
+_SEGMENT_HEADER = struct.Struct("<8sQIIQI")
+SEGMENT_HEADER_BYTES = 64
+_RECORD_HEADER = struct.Struct("<IIII")
+_CURSOR = struct.Struct("<QQQI")
+
+RECORD_ALIGN = 8
+
+# (segment sequence, byte offset, record index within the segment)
+Position = Tuple[int, int, int]
+
+
+def _aligned(size: int) -> int:
+    return (size + RECORD_ALIGN - 1) & ~(RECORD_ALIGN - 1)
+
+
+class _Segment:
+    """One segment file; mapped while it is being written or replayed"""
+
+    def __init__(self, path: Path, sequence: int, size: int):
+        self.path = path
+        self.sequence = sequence
+        self.size = size
+        self.count = 0
+        self.end = SEGMENT_HEADER_BYTES
+        self.sealed = False
+        self.map: Optional[mmap.mmap] = None
+
+    def open(self, writable: bool):
+        if self.map is not None:
+            return
+        flags = os.O_RDWR if writable else os.O_RDONLY
+        fd = os.open(self.path, flags)
+        try:
+            access = mmap.ACCESS_WRITE if writable else mmap.ACCESS_READ
+            self.map = mmap.mmap(fd, self.size, access=access)
+        finally:
+            os.close(fd)
+
+    def close(self):
+        if self.map is not None:
+            self.map.close()
+            self.map = None
+
+    def write_header(self):
+        fields = (SEGMENT_MAGIC, self.sequence, FLAG_SEALED if self.sealed else 0, self.count, self.end)
+        crc = zlib.crc32(_SEGMENT_HEADER.pack(*fields, 0)[:-4])
+        _SEGMENT_HEADER.pack_into(self.map, 0, *fields, crc)
+
+    def read_header(self) -> bool:
+        """Load count/end of a sealed segment; False if it has to be scanned"""
+        magic, sequence, flags, count, end, crc = _SEGMENT_HEADER.unpack_from(self.map, 0)
+        if magic != SEGMENT_MAGIC or sequence != self.sequence:
+            return False
+        if crc != zlib.crc32(_SEGMENT_HEADER.pack(magic, sequence, flags, count, end, 0)[:-4]):
+            return False
+        if not flags & FLAG_SEALED or end > self.size:
+            return False
+        self.count, self.end, self.sealed = count, end, True
+        return True
+
+    def record_at(self, offset: int) -> Optional[Tuple[bytes, int]]:
+        """Payload and next offset of the record at offset, None past the last valid one"""
+        if offset + _RECORD_HEADER.size > self.size:
+            return None
+        magic, length, crc, _ = _RECORD_HEADER.unpack_from(self.map, offset)
+        start = offset + _RECORD_HEADER.size
+        if magic != RECORD_MAGIC or start + length > self.size:
+            return None
+        payload = self.map[start:start + length]
+        if zlib.crc32(payload) != crc:
+            return None
+        return payload, _aligned(start + length)
+
+    def scan(self):
+        """Recover count/end of an unsealed segment after a restart or crash"""
+        self.count = 0
+        self.end = SEGMENT_HEADER_BYTES
+        while True:
+            record = self.record_at(self.end)
+            if record is None:
+                break
+            self.count += 1
+            self.end = record[1]
+
+
+class RetryLog:
+    """
+    Persistent FIFO of event payloads (edge.exporters.wire records)
+
+    Thread-safe; appends and replay are meant to come from the dispatcher's
+    worker thread, compaction runs on its own thread.
+    """
+
+    def __init__(
+        self,
+        path: str,
+        segment_bytes: int = 64 * 1024 * 1024,
+        max_bytes: int = 4 * 1024 * 1024 * 1024,
+        compact_interval: float = 10.0,
+    ):
+        """
+        Open (or create) the log
+
+        Args:
+            path: Log directory
+            segment_bytes: Size of each segment file
+            max_bytes: Disk budget; the oldest segments are dropped beyond it
+            compact_interval: Seconds between background flush/compaction passes
+        """
+        if segment_bytes < 4096:
+            raise ValueError("segment_bytes must be at least 4096")
+        self.path = Path(path)
+        self.path.mkdir(parents=True, exist_ok=True)
+        self.segment_bytes = segment_bytes
+        self.max_bytes = max(max_bytes, 2 * segment_bytes)
+        self.compact_interval = compact_interval
+
+        self._lock = threading.Lock()
+        self._segments: List[_Segment] = []  # oldest first, the last one is being written
+        self._cursor: Position = (0, SEGMENT_HEADER_BYTES, 0)
+        self._appended = 0
+        self._replayed = 0
+        self._dropped = 0
+        self._compactions = 0
+
+        self._load()
+
+        self._stop = threading.Event()
+        self._compactor = threading.Thread(target=self._compact_loop, name="anpr-retry-log", daemon=True)
+        self._compactor.start()
+
+    # ------------------------------------------------------------------ setup
+
+    def _segment_path(self, sequence: int) -> Path:
+        return self.path / f"segment-{sequence:012d}.log"
+
+    def _load(self):
+        sequences = sorted(
+            int(p.stem.split("-")[1]) for p in self.path.glob("segment-*.log") if p.stem.split("-")[1].isdigit()
+        )
+        for sequence in sequences:
+            path = self._segment_path(sequence)
+            size = path.stat().st_size
+            if size < SEGMENT_HEADER_BYTES:
+                path.unlink()
+                continue
+            segment = _Segment(path, sequence, size)
+            segment.open(writable=True)
+            if not segment.read_header():
+                segment.scan()
+            self._segments.append(segment)
+
+        # Only the newest segment is written to; seal any older ones a crash left open
+        for segment in self._segments[:-1]:
+            if not segment.sealed:
+                segment.sealed = True
+                segment.write_header()
+                segment.map.flush()
+            segment.close()
+
+        self._load_cursor()
+
+        if not self._segments or self._segments[-1].sealed:
+            self._roll()
+        elif self._segments[-1].size != self.segment_bytes:
+            # Written with another segment size; keep it, but start a new one for appends
+            self._roll()
+
+        logger.info(
+            f"Retry log at {self.path}: {len(self._segments)} segments, {self.pending()} events pending"
+        )
+
+    def _load_cursor(self):
+        first = self._segments[0].sequence if self._segments else 0
+        self._cursor = (first, SEGMENT_HEADER_BYTES, 0)
+        try:
+            data = (self.path / "cursor").read_bytes()
+            sequence, offset, index, crc = _CURSOR.unpack(data)
+            if crc == zlib.crc32(data[:-4]) and sequence >= first:
+                self._cursor = (sequence, offset, index)
+        except (OSError, struct.error):
+            pass
+        self._normalize_cursor()
+
+    def _write_cursor(self):
+        payload = _CURSOR.pack(*self._cursor, 0)[:-4]
+        data = payload + struct.pack("<I", zlib.crc32(payload))
+        temp = self.path / "cursor.tmp"
+        fd = os.open(temp, os.O_WRONLY | os.O_CREAT | os.O_TRUNC, 0o644)
+        try:
+            os.write(fd, data)
+            os.fsync(fd)
+        finally:
+            os.close(fd)
+        os.replace(temp, self.path / "cursor")
+
+    def _segment(self, sequence: int) -> Optional[_Segment]:
+        for segment in self._segments:
+            if segment.sequence == sequence:
+                return segment
+        return None
+
+    def _normalize_cursor(self):
+        """Move the cursor off the end of sealed segments (and off deleted ones)"""
+        sequence, offset, index = self._cursor
+        for segment in self._segments:
+            if segment.sequence < sequence:
+                continue
+            if segment.sequence > sequence:
+                sequence, offset, index = segment.sequence, SEGMENT_HEADER_BYTES, 0
+            if segment.sealed and (offset >= segment.end or index >= segment.count):
+                continue
+            break
+        else:
+            if self._segments:
+                last = self._segments[-1]
+                sequence, offset, index = last.sequence, last.end, last.count
+        self._cursor = (sequence, offset, index)
+
+    def _roll(self):
+        """Seal the active segment and start the next one"""
+        sequence = 0
+        if self._segments:
+            active = self._segments[-1]
+            sequence = active.sequence + 1
+            if not active.sealed:
+                active.sealed = True
+                active.write_header()
+                active.map.flush()
+            if self._cursor[0] != active.sequence:
+                active.close()
+
+        path = self._segment_path(sequence)
+        fd = os.open(path, os.O_RDWR | os.O_CREAT | os.O_TRUNC, 0o644)
+        try:
+            os.ftruncate(fd, self.segment_bytes)
+        finally:
+            os.close(fd)
+        segment = _Segment(path, sequence, self.segment_bytes)
+        segment.open(writable=True)
+        segment.write_header()
+        self._segments.append(segment)
+
+        self._enforce_budget()
+        self._normalize_cursor()
+
+    def _enforce_budget(self):
+        """Drop the oldest segments while the log is over max_bytes"""
+        while len(self._segments) > 1 and sum(s.size for s in self._segments) > self.max_bytes:
+            oldest = self._segments.pop(0)
+            sequence, _, index = self._cursor
+            if oldest.sequence > sequence:
+                lost = oldest.count
+            elif oldest.sequence == sequence:
+                lost = oldest.count - index
+            else:
+                lost = 0
+            self._dropped += lost
+            oldest.close()
+            oldest.path.unlink(missing_ok=True)
+            if lost:
+                logger.warning(f"Retry log over {self.max_bytes} bytes, dropped {lost} oldest events")
+
+    # ------------------------------------------------------------------ API
+
+    def append(self, payloads: Sequence[bytes]) -> int:
+        """
+        Append records
+
+        Args:
+            payloads: Encoded events
+
+        Returns:
+            Number of records appended (oversized payloads are skipped)
+        """
+        appended = 0
+        limit = self.segment_bytes - SEGMENT_HEADER_BYTES - _RECORD_HEADER.size
+        with self._lock:
+            for payload in payloads:
+                if len(payload) > limit:
+                    logger.error(f"Dropping {len(payload)}-byte event, larger than a retry log segment")
+                    continue
+
+                active = self._segments[-1]
+                end = _aligned(active.end + _RECORD_HEADER.size + len(payload))
+                if end > active.size:
+                    self._roll()
+                    active = self._segments[-1]
+                    end = _aligned(active.end + _RECORD_HEADER.size + len(payload))
+
+                # Payload first, header last: a torn write fails the magic or CRC check
+                start = active.end + _RECORD_HEADER.size
+                active.map[start:start + len(payload)] = payload
+                _RECORD_HEADER.pack_into(active.map, active.end, RECORD_MAGIC, len(payload), zlib.crc32(payload), 0)
+                active.end = end
+                active.count += 1
+                appended += 1
+            self._appended += appended
+        return appended
+
+    def read_batch(self, max_records: int) -> Tuple[List[bytes], Position]:
+        """
+        Read the oldest records without consuming them
+
+        Args:
+            max_records: Batch size
+
+        Returns:
+            (payloads, position after them); pass the position to commit()
+            once the batch is exported
+        """
+        payloads: List[bytes] = []
+        with self._lock:
+            sequence, offset, index = self._cursor
+            for segment in self._segments:
+                if segment.sequence < sequence:
+                    continue
+                if segment.sequence > sequence:
+                    sequence, offset, index = segment.sequence, SEGMENT_HEADER_BYTES, 0
+                segment.open(writable=not segment.sealed)
+                while index < segment.count and len(payloads) < max_records:
+                    record = segment.record_at(offset)
+                    if record is None:
+                        # Unreadable (e.g. disk corruption): skip the rest of the segment
+                        logger.error(f"Corrupt retry log record in {segment.path.name} at {offset}")
+                        self._dropped += segment.count - index
+                        index, offset = segment.count, segment.end
+                        break
+                    payloads.append(record[0])
+                    offset = record[1]
+                    index += 1
+                if len(payloads) >= max_records or not segment.sealed:
+                    break
+            return payloads, (sequence, offset, index)
+
+    def commit(self, position: Position):
+        """
+        Consume everything before position (from read_batch)
+
+        The cursor file is replaced atomically before returning.
+        """
+        with self._lock:
+            replayed = self._count_between(self._cursor, position)
+            self._cursor = position
+            self._normalize_cursor()
+            self._write_cursor()
+            self._replayed += replayed
+
+    def _count_between(self, start: Position, end: Position) -> int:
+        count = 0
+        for segment in self._segments:
+            if segment.sequence < start[0] or segment.sequence > end[0]:
+                continue
+            first = start[2] if segment.sequence == start[0] else 0
+            last = end[2] if segment.sequence == end[0] else segment.count
+            count += max(0, last - first)
+        return count
+
+    def pending(self) -> int:
+        """Records not yet committed"""
+        with self._lock:
+            sequence, _, index = self._cursor
+            return sum(
+                segment.count - (index if segment.sequence == sequence else 0)
+                for segment in self._segments
+                if segment.sequence >= sequence
+            )
+
+    # ------------------------------------------------------------------ compaction
+
+    def _compact_loop(self):
+        while not self._stop.wait(self.compact_interval):
+            try:
+                self.compact()
+            except Exception as e:
+                logger.error(f"Retry log compaction failed: {e}")
+
+    def compact(self):
+        """Flush the active segment and delete segments wholly behind the cursor"""
+        with self._lock:
+            self._segments[-1].map.flush()
+            sequence = self._cursor[0]
+            consumed = [s for s in self._segments if s.sequence < sequence]
+            self._segments = [s for s in self._segments if s.sequence >= sequence]
+            for segment in consumed:
+                segment.close()
+            # Segments behind a replayed one are no longer read
+            for segment in self._segments[:-1]:
+                if segment.sequence != sequence:
+                    segment.close()
+            if consumed:
+                self._compactions += 1
+
+        # Unlink outside the lock; nothing references these files any more
+        for segment in consumed:
+            segment.path.unlink(missing_ok=True)
+
+    def stats(self) -> Dict[str, Any]:
+        """Log statistics"""
+        pending = self.pending()
+        with self._lock:
+            return {
+                "pending": pending,
+                "segments": len(self._segments),
+                "disk_bytes": sum(s.size for s in self._segments),
+                "appended": self._appended,
+                "replayed": self._replayed,
+                "dropped": self._dropped,
+                "compactions": self._compactions,
+            }
+
+    def close(self):
+        """Stop compaction, flush and unmap"""
+        self._stop.set()
+        self._compactor.join(timeout=5.0)
+        with self._lock:
+            for segment in self._segments:
+                if segment.map is not None and not segment.sealed:
+                    segment.map.flush()
+                segment.close()
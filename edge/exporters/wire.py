@@ -0,0 +1,200 @@
+"""
+Event Wire Format
+Compact binary encoding of DetectionEvent batches for the REST bulk ingest
+
+A batch is a fixed frame header followed by the record section, which is
+zlib-compressed when FLAG_ZLIB is set:
+
+    header   "ANPE" | version u8 | flags u8 | count u32       (little endian)
+    record   length u32 | body
+
+    body     timestamp f64 (UNIX seconds) | confidence f32 | boxes u8
+             [plate_bbox 4 x f32 if boxes & 1] [vehicle_bbox 4 x f32 if boxes & 2]
+             event_id, worker_id, camera_id, camera_name, plate_text,
+             image_path (u16 length + UTF-8, empty for None)
+             metadata (u32 length + JSON, empty for None)
+
+Records are length-prefixed so a reader can skip fields a later version
+appends. The backend decoder (backend/app/services/event_wire.py) mirrors
+this module; keep the two in step.
+"""
+
+import json
+import struct
+import zlib
+from datetime import datetime, timezone
+from typing import Any, Dict, List, Optional, Sequence, Tuple
+
+CONTENT_TYPE = "application/x-anpr-events"
+
+MAGIC = b"ANPE"
+VERSION = 1
+FLAG_ZLIB = 0x01
+
+BOX_PLATE = 0x01
+BOX_VEHICLE = 0x02
+
+_HEADER = struct.Struct("<4sBBI")
+_LENGTH = struct.Struct("<I")
+_FIXED = struct.Struct("<dfB")
+_BOX = struct.Struct("<4f")
+_STRING = struct.Struct("<H")
+
+_STRING_FIELDS = ("event_id", "worker_id", "camera_id", "camera_name", "plate_text", "image_path")
+
+# Below this the zlib stream costs more than it saves
+COMPRESS_MIN_BYTES = 256
+
+
+class WireFormatError(ValueError):
+    """Raised for a batch that is truncated or not in this format"""
+
+
+def _timestamp_seconds(timestamp: str) -> float:
+    """ISO 8601 to UNIX seconds, naive timestamps taken as UTC"""
+    value = datetime.fromisoformat(timestamp.replace("Z", "+00:00"))
+    if value.tzinfo is None:
+        value = value.replace(tzinfo=timezone.utc)
+    return value.timestamp()
+
+
+def _pack_string(value: Optional[str], parts: List[bytes]):
+    data = (value or "").encode("utf-8")
+    if len(data) > 0xFFFF:
+        raise WireFormatError(f"String field of {len(data)} bytes does not fit the wire format")
+    parts.append(_STRING.pack(len(data)))
+    parts.append(data)
+
+
+def encode_record(event: Dict[str, Any]) -> bytes:
+    """
+    Encode one event
+
+    Args:
+        event: DetectionEvent.to_dict() output
+
+    Returns:
+        Record body, without its length prefix
+    """
+    plate_bbox = event.get("plate_bbox")
+    vehicle_bbox = event.get("vehicle_bbox")
+    boxes = (BOX_PLATE if plate_bbox else 0) | (BOX_VEHICLE if vehicle_bbox else 0)
+
+    parts = [_FIXED.pack(_timestamp_seconds(event["timestamp"]), float(event["confidence"]), boxes)]
+    if plate_bbox:
+        parts.append(_BOX.pack(*plate_bbox))
+    if vehicle_bbox:
+        parts.append(_BOX.pack(*vehicle_bbox))
+    for field in _STRING_FIELDS:
+        _pack_string(event.get(field), parts)
+
+    metadata = event.get("metadata")
+    metadata_json = json.dumps(metadata, separators=(",", ":")).encode("utf-8") if metadata is not None else b""
+    parts.append(_LENGTH.pack(len(metadata_json)))
+    parts.append(metadata_json)
+    return b"".join(parts)
+
+
+def encode_batch(events: Sequence[Dict[str, Any]], compress: bool = True) -> bytes:
+    """
+    Encode a batch of events
+
+    Args:
+        events: DetectionEvent.to_dict() outputs
+        compress: zlib-compress the records (skipped for tiny batches)
+
+    Returns:
+        Request body for the bulk ingest endpoint
+    """
+    parts = []
+    for event in events:
+        record = encode_record(event)
+        parts.append(_LENGTH.pack(len(record)))
+        parts.append(record)
+    records = b"".join(parts)
+
+    flags = 0
+    if compress and len(records) >= COMPRESS_MIN_BYTES:
+        records = zlib.compress(records, 6)
+        flags |= FLAG_ZLIB
+    return _HEADER.pack(MAGIC, VERSION, flags, len(events)) + records
+
+
+def _unpack_string(body: bytes, offset: int) -> Tuple[Optional[str], int]:
+    (length,) = _STRING.unpack_from(body, offset)
+    offset += _STRING.size
+    if offset + length > len(body):
+        raise WireFormatError("Truncated string field")
+    value = body[offset:offset + length].decode("utf-8")
+    return value or None, offset + length
+
+
+def decode_record(body: bytes) -> Dict[str, Any]:
+    """
+    Decode one record body
+
+    Returns:
+        Event dictionary in DetectionEvent.to_dict() layout
+    """
+    try:
+        timestamp, confidence, boxes = _FIXED.unpack_from(body, 0)
+        offset = _FIXED.size
+        event: Dict[str, Any] = {"plate_bbox": None, "vehicle_bbox": None}
+        if boxes & BOX_PLATE:
+            event["plate_bbox"] = _BOX.unpack_from(body, offset)
+            offset += _BOX.size
+        if boxes & BOX_VEHICLE:
+            event["vehicle_bbox"] = _BOX.unpack_from(body, offset)
+            offset += _BOX.size
+        for field in _STRING_FIELDS:
+            event[field], offset = _unpack_string(body, offset)
+
+        (metadata_length,) = _LENGTH.unpack_from(body, offset)
+        offset += _LENGTH.size
+        if offset + metadata_length > len(body):
+            raise WireFormatError("Truncated metadata")
+        metadata = body[offset:offset + metadata_length]
+    except struct.error as e:
+        raise WireFormatError(f"Truncated record: {e}") from e
+
+    event["timestamp"] = datetime.fromtimestamp(timestamp, tz=timezone.utc).isoformat()
+    event["confidence"] = round(confidence, 6)  # f32 on the wire
+    event["plate_text"] = event["plate_text"] or ""
+    event["metadata"] = json.loads(metadata) if metadata else None
+    return event
+
+
+def decode_batch(data: bytes) -> List[Dict[str, Any]]:
+    """
+    Decode a batch produced by encode_batch
+
+    Raises:
+        WireFormatError: Bad magic, unknown version or truncated data
+    """
+    if len(data) < _HEADER.size:
+        raise WireFormatError("Truncated batch header")
+    magic, version, flags, count = _HEADER.unpack_from(data, 0)
+    if magic != MAGIC:
+        raise WireFormatError("Not an event batch")
+    if version != VERSION:
+        raise WireFormatError(f"Unsupported batch version {version}")
+
+    records = data[_HEADER.size:]
+    if flags & FLAG_ZLIB:
+        try:
+            records = zlib.decompress(records)
+        except zlib.error as e:
+            raise WireFormatError(f"Corrupt compressed batch: {e}") from e
+
+    events = []
+    offset = 0
+    for _ in range(count):
+        if offset + _LENGTH.size > len(records):
+            raise WireFormatError("Truncated batch")
+        (length,) = _LENGTH.unpack_from(records, offset)
+        offset += _LENGTH.size
+        if offset + length > len(records):
+            raise WireFormatError("Truncated record")
+        events.append(decode_record(records[offset:offset + length]))
+        offset += length
+    return events
@@ -0,0 +1,83 @@
+"""
+Occupancy stats of the crop buffer pools in libplate_crop.so.
+
+Each running pipeline owns one pool, labelled with the name of the streaming
+thread that runs the cropper (the queue in front of it), e.g. "cam3_det:src".
+"""
+
+import ctypes
+import logging
+from typing import Dict, List, Optional
+
+logger = logging.getLogger(__name__)
+
+CROP_LIBRARY = "./libplate_crop.so"
+
+
+class CropPoolStats(ctypes.Structure):
+    """Mirror of anpr::CropPoolStats (crop_pool.hpp)"""
+    _fields_ = [
+        ("name", ctypes.c_char * 32),
+        ("slots", ctypes.c_uint32),
+        ("in_use", ctypes.c_uint32),
+        ("peak_in_use", ctypes.c_uint32),
+        ("slot_bytes", ctypes.c_uint32),
+        ("acquired", ctypes.c_uint64),
+        ("waited", ctypes.c_uint64),
+        ("dropped", ctypes.c_uint64),
+    ]
+
+    def to_dict(self) -> Dict:
+        return {
+            "name": self.name.decode(errors="replace"),
+            "slots": self.slots,
+            "in_use": self.in_use,
+            "peak_in_use": self.peak_in_use,
+            "slot_bytes": self.slot_bytes,
+            "acquired": self.acquired,
+            "waited": self.waited,
+            "dropped": self.dropped,
+        }
+
+
+_library: Optional[ctypes.CDLL] = None
+
+
+def _load_library(path: str) -> Optional[ctypes.CDLL]:
+    global _library
+    if _library is None:
+        try:
+            # Same handle as the one hailocropper dlopen()s, so the pools are shared
+            _library = ctypes.CDLL(path)
+            _library.crop_pool_count.restype = ctypes.c_size_t
+            _library.crop_pool_stats.restype = ctypes.c_size_t
+            _library.crop_pool_stats.argtypes = [ctypes.POINTER(CropPoolStats), ctypes.c_size_t]
+        except (OSError, AttributeError) as e:
+            logger.debug(f"Crop pool stats unavailable: {e}")
+            return None
+    return _library
+
+
+def read_crop_pool_stats(prefix: str = "", library_path: str = CROP_LIBRARY) -> List[Dict]:
+    """
+    Read stats of all live crop pools.
+
+    Args:
+        prefix: Only return pools whose name starts with this prefix
+        library_path: Path of libplate_crop.so
+
+    Returns:
+        List of per-pool stat dicts (empty if the library is not loaded)
+    """
+    library = _load_library(library_path)
+    if library is None:
+        return []
+
+    count = library.crop_pool_count()
+    if count == 0:
+        return []
+
+    buffer = (CropPoolStats * count)()
+    written = library.crop_pool_stats(buffer, count)
+    pools = [buffer[i].to_dict() for i in range(written)]
+    return [p for p in pools if p["name"].startswith(prefix)]
@@ -0,0 +1,192 @@
+"""
+Plate events from the native postprocess, drained from libanpr_core.so.
+
+The OCR filter and the tracker (track events, zone crossings) publish
+fixed-size event records into lock-free rings (event_ring.hpp), one per
+streaming thread, named after the thread ("cam3_ocr:src"). EventDrain empties a pipeline's rings in batches
+from its own thread, so result callbacks never run on (or block) the
+GStreamer streaming threads; records the rings could not hold are counted
+as dropped in the ring stats.
+"""
+
+import ctypes
+import logging
+import threading
+from typing import Callable, Dict, List, Optional
+
+logger = logging.getLogger(__name__)
+
+CORE_LIBRARY = "./libanpr_core.so"
+
+MAX_PLATE_CHARS = 16  # anpr::kMaxPlateChars (plate_text.hpp)
+
+# anpr::PlateEventKind
+EVENT_KINDS = {0: "read", 1: "plate_decided", 2: "track_ended", 3: "zone_entered", 4: "zone_exited"}
+
+# Zone crossings; their records carry the zone's index in the stream's zone list
+ZONE_EVENTS = ("zone_entered", "zone_exited")
+
+
+class PlateEventRecord(ctypes.Structure):
+    """Mirror of anpr::PlateEventRecord (event_ring.hpp)"""
+    _fields_ = [
+        ("timestamp_ns", ctypes.c_uint64),
+        ("track_id", ctypes.c_uint64),
+        ("trace_frame", ctypes.c_uint64),
+        ("published_ns", ctypes.c_uint64),
+        ("stream_index", ctypes.c_int32),
+        ("kind", ctypes.c_uint32),
+        ("bbox", ctypes.c_float * 4),
+        ("detection_confidence", ctypes.c_float),
+        ("ocr_confidence", ctypes.c_float),
+        ("votes", ctypes.c_uint32),
+        ("total_reads", ctypes.c_uint32),
+        ("zone", ctypes.c_int32),
+        ("text", ctypes.c_char * (MAX_PLATE_CHARS + 1)),
+    ]
+
+    def to_dict(self) -> Dict:
+        return {
+            "event": EVENT_KINDS.get(self.kind, "unknown"),
+            "timestamp": self.timestamp_ns / 1e9,
+            "track_id": self.track_id,
+            # Latency tracing (frame_trace.py): frame id and monotonic publish time
+            "trace_frame": self.trace_frame,
+            "published_ns": self.published_ns,
+            "stream_index": self.stream_index,
+            "bbox": list(self.bbox),  # normalized x, y, width, height
+            "plate_text": self.text.decode(errors="replace"),
+            "detection_confidence": self.detection_confidence,
+            "ocr_confidence": self.ocr_confidence,
+            "votes": self.votes,
+            "total_reads": self.total_reads,
+            "zone_index": self.zone,  # -1 except for zone events
+        }
+
+
+class EventRingStats(ctypes.Structure):
+    """Mirror of anpr::EventRingStats (event_ring.hpp)"""
+    _fields_ = [
+        ("name", ctypes.c_char * 32),
+        ("capacity", ctypes.c_uint32),
+        ("size", ctypes.c_uint32),
+        ("published", ctypes.c_uint64),
+        ("dropped", ctypes.c_uint64),
+        ("drained", ctypes.c_uint64),
+    ]
+
+    def to_dict(self) -> Dict:
+        return {
+            "name": self.name.decode(errors="replace"),
+            "capacity": self.capacity,
+            "size": self.size,
+            "published": self.published,
+            "dropped": self.dropped,
+            "drained": self.drained,
+        }
+
+
+_library: Optional[ctypes.CDLL] = None
+
+
+def _load_library(path: str) -> Optional[ctypes.CDLL]:
+    global _library
+    if _library is None:
+        try:
+            # Same library the plugins load through their rpath, so the rings are shared
+            _library = ctypes.CDLL(path)
+            _library.event_ring_drain.restype = ctypes.c_size_t
+            _library.event_ring_drain.argtypes = [
+                ctypes.c_char_p, ctypes.POINTER(PlateEventRecord), ctypes.c_size_t
+            ]
+            _library.event_ring_count.restype = ctypes.c_size_t
+            _library.event_ring_stats.restype = ctypes.c_size_t
+            _library.event_ring_stats.argtypes = [ctypes.POINTER(EventRingStats), ctypes.c_size_t]
+        except (OSError, AttributeError) as e:
+            logger.warning(f"Plate event rings unavailable: {e}")
+            return None
+    return _library
+
+
+class EventDrain:
+    """Drains one pipeline's event rings on a background thread"""
+
+    def __init__(self, prefix: str, handler: Callable[[List[Dict]], None],
+                 batch_size: int = 64, idle_interval: float = 0.01,
+                 library_path: str = CORE_LIBRARY):
+        """
+        Args:
+            prefix: Ring name prefix of the pipeline (its element prefix
+                followed by "_", e.g. "cam3_")
+            handler: Called with each non-empty batch of event dicts
+            batch_size: Records taken per drain call
+            idle_interval: Seconds to sleep when the rings are empty
+        """
+        self._library = _load_library(library_path)
+        self._prefix = prefix.encode()
+        self._handler = handler
+        self._batch_size = batch_size
+        self._idle_interval = idle_interval
+        self._buffer = (PlateEventRecord * batch_size)()
+        self._stop = threading.Event()
+        self._thread: Optional[threading.Thread] = None
+
+    def start(self) -> bool:
+        if self._library is None or self._thread is not None:
+            return False
+        self._stop.clear()
+        self._thread = threading.Thread(target=self._run, name=f"events-{self._prefix.decode()}", daemon=True)
+        self._thread.start()
+        return True
+
+    def stop(self, timeout: float = 2.0):
+        """Stop the thread after a final drain (call after the pipeline stopped)"""
+        if self._thread is None:
+            return
+        self._stop.set()
+        if self._thread is not threading.current_thread():
+            self._thread.join(timeout=timeout)
+        self._thread = None
+
+    def drain_once(self) -> int:
+        """Hand one batch to the handler; returns the number of records"""
+        count = self._library.event_ring_drain(self._prefix, self._buffer, self._batch_size)
+        if count:
+            batch = [self._buffer[i].to_dict() for i in range(count)]
+            try:
+                self._handler(batch)
+            except Exception as e:
+                logger.error(f"Plate event handler failed: {e}")
+        return count
+
+    def _run(self):
+        while not self._stop.is_set():
+            if self.drain_once() < self._batch_size:
+                self._stop.wait(self._idle_interval)
+        while self.drain_once():
+            pass
+
+
+def read_event_ring_stats(prefix: str = "", library_path: str = CORE_LIBRARY) -> List[Dict]:
+    """
+    Read counters of all plate event rings.
+
+    Args:
+        prefix: Only return rings whose name starts with this prefix
+        library_path: Path of libanpr_core.so
+
+    Returns:
+        List of per-ring stat dicts (empty if the library is not loaded)
+    """
+    library = _load_library(library_path)
+    if library is None:
+        return []
+
+    count = library.event_ring_count()
+    if count == 0:
+        return []
+
+    buffer = (EventRingStats * count)()
+    written = library.event_ring_stats(buffer, count)
+    rings = [buffer[i].to_dict() for i in range(written)]
+    return [r for r in rings if r["name"].startswith(prefix)]
@@ -0,0 +1,174 @@
+"""
+Evidence snapshots of decided tracks, popped from libanpr_core.so.
+
+When the native tracker decides a plate, crop_plates copies the plate (with
+some context) and a downscaled frame out of that frame and a background
+thread of the library JPEG-encodes them (evidence.hpp); no image work
+happens in Python. EvidenceDrain pops a pipeline's finished snapshots from
+its own thread and hands them, as JPEG bytes, to a handler that attaches
+them to the track's event. The encoder holds a fixed number of snapshots;
+when it is full new ones are dropped and counted, never waited for.
+
+Snapshots are taken only with the "evidence" postprocess section enabled
+(postprocess_params.py).
+"""
+
+import ctypes
+import logging
+import threading
+from typing import Callable, Dict, Optional
+
+from .event_ring import CORE_LIBRARY
+
+logger = logging.getLogger(__name__)
+
+INITIAL_BUFFER_BYTES = 256 * 1024  # grown when a snapshot does not fit
+
+
+class EvidenceInfo(ctypes.Structure):
+    """Mirror of anpr::EvidenceInfo (evidence.hpp)"""
+    _fields_ = [
+        ("source", ctypes.c_char * 32),
+        ("timestamp_ns", ctypes.c_uint64),
+        ("track_id", ctypes.c_uint64),
+        ("stream_index", ctypes.c_int32),
+        ("plate_width", ctypes.c_uint32),
+        ("plate_height", ctypes.c_uint32),
+        ("frame_width", ctypes.c_uint32),
+        ("frame_height", ctypes.c_uint32),
+        ("plate_bytes", ctypes.c_uint32),
+        ("frame_bytes", ctypes.c_uint32),
+    ]
+
+
+class EvidenceStats(ctypes.Structure):
+    """Mirror of anpr::EvidenceStats (evidence.hpp)"""
+    _fields_ = [
+        ("available", ctypes.c_uint32),
+        ("jobs", ctypes.c_uint32),
+        ("queued", ctypes.c_uint32),
+        ("ready", ctypes.c_uint32),
+        ("submitted", ctypes.c_uint64),
+        ("encoded", ctypes.c_uint64),
+        ("dropped", ctypes.c_uint64),
+        ("failed", ctypes.c_uint64),
+        ("popped", ctypes.c_uint64),
+        ("encode_ns", ctypes.c_uint64),
+    ]
+
+    def to_dict(self) -> Dict:
+        return {
+            "available": bool(self.available),
+            "jobs": self.jobs,
+            "queued": self.queued,
+            "ready": self.ready,
+            "submitted": self.submitted,
+            "encoded": self.encoded,
+            "dropped": self.dropped,
+            "failed": self.failed,
+            "popped": self.popped,
+            "mean_encode_ms": self.encode_ns / self.encoded / 1e6 if self.encoded else 0.0,
+        }
+
+
+_library: Optional[ctypes.CDLL] = None
+
+
+def _load_library(path: str) -> Optional[ctypes.CDLL]:
+    global _library
+    if _library is None:
+        try:
+            _library = ctypes.CDLL(path)
+            _library.evidence_pop.restype = ctypes.c_int
+            _library.evidence_pop.argtypes = [
+                ctypes.c_char_p, ctypes.POINTER(EvidenceInfo), ctypes.c_void_p, ctypes.c_size_t
+            ]
+            _library.evidence_stats.restype = None
+            _library.evidence_stats.argtypes = [ctypes.POINTER(EvidenceStats)]
+        except (OSError, AttributeError) as e:
+            logger.warning(f"Evidence snapshots unavailable: {e}")
+            return None
+    return _library
+
+
+class EvidenceDrain:
+    """Pops one pipeline's evidence snapshots on a background thread"""
+
+    def __init__(self, prefix: str, handler: Callable[[Dict], None],
+                 idle_interval: float = 0.02, library_path: str = CORE_LIBRARY):
+        """
+        Args:
+            prefix: Source prefix of the pipeline (its element prefix
+                followed by "_", e.g. "cam3_")
+            handler: Called with each snapshot: track_id, stream_index,
+                timestamp, sizes, and the plate_jpeg / frame_jpeg bytes
+            idle_interval: Seconds to sleep when no snapshot is ready
+        """
+        self._library = _load_library(library_path)
+        self._prefix = prefix.encode()
+        self._handler = handler
+        self._idle_interval = idle_interval
+        self._info = EvidenceInfo()
+        self._buffer = ctypes.create_string_buffer(INITIAL_BUFFER_BYTES)
+        self._stop = threading.Event()
+        self._thread: Optional[threading.Thread] = None
+
+    def start(self) -> bool:
+        if self._library is None or self._thread is not None:
+            return False
+        self._stop.clear()
+        self._thread = threading.Thread(target=self._run, name=f"evidence-{self._prefix.decode()}", daemon=True)
+        self._thread.start()
+        return True
+
+    def stop(self, timeout: float = 2.0):
+        """Stop the thread after popping what is ready (call after the pipeline stopped)"""
+        if self._thread is None:
+            return
+        self._stop.set()
+        if self._thread is not threading.current_thread():
+            self._thread.join(timeout=timeout)
+        self._thread = None
+
+    def pop_once(self) -> bool:
+        """Hand one snapshot to the handler; returns False if none was ready"""
+        info = self._info
+        result = self._library.evidence_pop(self._prefix, ctypes.byref(info), self._buffer, len(self._buffer))
+        if result < 0:
+            self._buffer = ctypes.create_string_buffer(2 * (info.plate_bytes + info.frame_bytes))
+            result = self._library.evidence_pop(self._prefix, ctypes.byref(info), self._buffer, len(self._buffer))
+        if result <= 0:
+            return False
+
+        data = self._buffer.raw[:info.plate_bytes + info.frame_bytes]
+        evidence = {
+            "track_id": info.track_id,
+            "stream_index": info.stream_index,
+            "timestamp": info.timestamp_ns / 1e9,
+            "plate_size": (info.plate_width, info.plate_height),
+            "frame_size": (info.frame_width, info.frame_height),
+            "plate_jpeg": data[:info.plate_bytes],
+            "frame_jpeg": data[info.plate_bytes:],
+        }
+        try:
+            self._handler(evidence)
+        except Exception as e:
+            logger.error(f"Evidence handler failed: {e}")
+        return True
+
+    def _run(self):
+        while not self._stop.is_set():
+            if not self.pop_once():
+                self._stop.wait(self._idle_interval)
+        while self.pop_once():
+            pass
+
+
+def read_evidence_stats(library_path: str = CORE_LIBRARY) -> Dict:
+    """Counters of the evidence encoder (process-wide), empty if the library is not loaded"""
+    library = _load_library(library_path)
+    if library is None:
+        return {}
+    stats = EvidenceStats()
+    library.evidence_stats(ctypes.byref(stats))
+    return stats.to_dict()
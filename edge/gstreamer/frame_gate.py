@@ -0,0 +1,172 @@
+"""
+Activity-gated inference rate through libframe_gate.so.
+
+A pad probe in front of the detection hailonet hands every decoded frame to
+the native gate, which lets frames through at the full camera rate while
+there is motion or plates were detected recently, and at the idle rate
+otherwise. Frames it rejects are dropped before inference.
+"""
+
+import ctypes
+import logging
+from typing import Dict, List, Optional
+
+import gi
+gi.require_version('Gst', '1.0')
+gi.require_version('GstVideo', '1.0')
+from gi.repository import Gst, GstVideo
+import numpy as np
+
+logger = logging.getLogger(__name__)
+
+GATE_LIBRARY = "./libframe_gate.so"
+
+# Bytes per pixel of the first plane; packed RGB variants use the R+2G+B luma
+# approximation, which does not depend on the channel order
+_PIXEL_STRIDES = {
+    "RGB": 3, "BGR": 3,
+    "RGBA": 4, "BGRA": 4, "RGBx": 4, "BGRx": 4,
+    "NV12": 1, "NV21": 1, "I420": 1, "GRAY8": 1,
+}
+
+
+class FrameGateStats(ctypes.Structure):
+    """Mirror of FrameGateStats (frame_gate.cpp)"""
+    _fields_ = [
+        ("name", ctypes.c_char * 32),
+        ("active", ctypes.c_uint32),
+        ("input_fps", ctypes.c_float),
+        ("inference_fps", ctypes.c_float),
+        ("frames_in", ctypes.c_uint64),
+        ("frames_passed", ctypes.c_uint64),
+    ]
+
+    def to_dict(self) -> Dict:
+        return {
+            "name": self.name.decode(errors="replace"),
+            "active": bool(self.active),
+            "input_fps": round(self.input_fps, 2),
+            "inference_fps": round(self.inference_fps, 2),
+            "frames_in": self.frames_in,
+            "frames_passed": self.frames_passed,
+        }
+
+
+_library: Optional[ctypes.CDLL] = None
+
+
+def _load_library(path: str) -> Optional[ctypes.CDLL]:
+    global _library
+    if _library is None:
+        try:
+            _library = ctypes.CDLL(path)
+            _library.frame_gate_open.restype = ctypes.c_void_p
+            _library.frame_gate_open.argtypes = [
+                ctypes.c_char_p, ctypes.c_char_p, ctypes.c_float, ctypes.c_uint32
+            ]
+            _library.frame_gate_close.argtypes = [ctypes.c_void_p]
+            _library.frame_gate_admit.restype = ctypes.c_int
+            _library.frame_gate_admit.argtypes = [
+                ctypes.c_void_p, ctypes.c_void_p, ctypes.c_int, ctypes.c_int,
+                ctypes.c_size_t, ctypes.c_int
+            ]
+            _library.frame_gate_count.restype = ctypes.c_size_t
+            _library.frame_gate_stats.restype = ctypes.c_size_t
+            _library.frame_gate_stats.argtypes = [ctypes.POINTER(FrameGateStats), ctypes.c_size_t]
+        except (OSError, AttributeError) as e:
+            logger.warning(f"Frame gate unavailable: {e}")
+            return None
+    return _library
+
+
+class FrameGate:
+    """One camera's activity gate, installed as a pad probe"""
+
+    def __init__(self, name: str, activity_key: str, idle_fps: float = 2.0,
+                 idle_after_frames: int = 30, library_path: str = GATE_LIBRARY):
+        """
+        Args:
+            name: Label reported in stats (the pipeline's element prefix)
+            activity_key: Key plate_detection reports the stream's detections
+                under: the stream id in multi-stream pipelines, otherwise the
+                element prefix
+            idle_fps: Inference rate without activity
+            idle_after_frames: Inferred frames without detections before
+                going idle
+        """
+        self._library = _load_library(library_path)
+        self._handle = None
+        if self._library is not None:
+            self._handle = self._library.frame_gate_open(
+                name.encode(), activity_key.encode(), idle_fps, idle_after_frames
+            )
+        self._caps = None
+        self._layout = None
+
+    def attach(self, element: Gst.Element) -> bool:
+        """Install the gate on the element's sink pad"""
+        if self._handle is None:
+            return False
+        element.get_static_pad("sink").add_probe(Gst.PadProbeType.BUFFER, self._probe)
+        return True
+
+    def close(self):
+        if self._handle is not None:
+            self._library.frame_gate_close(self._handle)
+            self._handle = None
+
+    def _frame_layout(self, pad: Gst.Pad):
+        """(width, height, stride, pixel_stride) of the negotiated caps"""
+        caps = pad.get_current_caps()
+        if caps is not None and (self._caps is None or not caps.is_equal(self._caps)):
+            self._caps = caps
+            self._layout = None
+            info = GstVideo.VideoInfo.new_from_caps(caps)
+            pixel_stride = _PIXEL_STRIDES.get(info.finfo.name) if info else None
+            if pixel_stride:
+                self._layout = (info.width, info.height, info.stride[0], pixel_stride)
+            else:
+                logger.warning(f"Frame gate: unsupported caps {caps}, passing all frames")
+        return self._layout
+
+    def _probe(self, pad: Gst.Pad, info: Gst.PadProbeInfo) -> Gst.PadProbeReturn:
+        layout = self._frame_layout(pad)
+        buf = info.get_buffer()
+        if self._handle is None or layout is None or buf is None:
+            return Gst.PadProbeReturn.OK
+
+        ok, map_info = buf.map(Gst.MapFlags.READ)
+        if not ok:
+            return Gst.PadProbeReturn.OK
+        try:
+            data = np.frombuffer(map_info.data, dtype=np.uint8)
+            admitted = self._library.frame_gate_admit(self._handle, data.ctypes.data, *layout)
+        finally:
+            buf.unmap(map_info)
+
+        return Gst.PadProbeReturn.OK if admitted else Gst.PadProbeReturn.DROP
+
+
+def read_frame_gate_stats(prefix: str = "", library_path: str = GATE_LIBRARY) -> List[Dict]:
+    """
+    Read the state and rates of all open frame gates.
+
+    Args:
+        prefix: Only return gates whose name starts with this prefix
+        library_path: Path of libframe_gate.so
+
+    Returns:
+        List of per-gate stat dicts (empty if the library is not loaded)
+    """
+    library = _load_library(library_path)
+    if library is None:
+        return []
+
+    count = library.frame_gate_count()
+    if count == 0:
+        return []
+
+    buffer = (FrameGateStats * count)()
+    written = library.frame_gate_stats(buffer, count)
+    gates = [buffer[i].to_dict() for i in range(written)]
+    return [g for g in gates if g["name"].startswith(prefix)]
@@ -0,0 +1,273 @@
+"""
+End-to-end latency tracing of frames, from the RTSP capture timestamp to the
+exported plate event (libanpr_core.so).
+
+With latency_tracing on, a pipeline installs two pad probes per camera path:
+- behind the frame gate, opening the frame's native trace with its PTS and
+  capture time (pipeline base time + PTS: when rtspsrc timestamped it)
+- on the output of the detection queue, handing the buffer PTS to the
+  streaming thread, where plate_detection picks the trace up
+The native stages stamp the trace as the frame passes (frame_trace.hpp) and
+its published plate events carry the frame id. frame_latency() turns that
+into the event's capture timestamp and per-stage latencies.
+
+ChromeTraceWriter writes sampled event traces as Chrome trace events, to be
+opened in chrome://tracing or Perfetto, with one track per camera and one
+span per hop ("detection→tracker", ...).
+
+All native times are CLOCK_MONOTONIC, the clock of time.monotonic_ns() and
+of GStreamer's default system clock.
+"""
+
+import ctypes
+import json
+import logging
+import threading
+import time
+from typing import Dict, List, Optional, Tuple
+
+import gi
+gi.require_version('Gst', '1.0')
+from gi.repository import Gst
+
+from .event_ring import CORE_LIBRARY
+
+logger = logging.getLogger(__name__)
+
+# anpr::TraceStage, in pipeline order
+STAGES = ("capture", "source", "detection", "tracker", "crop", "ocr")
+
+
+class FrameTraceRecord(ctypes.Structure):
+    """Mirror of anpr::FrameTraceRecord (frame_trace.hpp)"""
+    _fields_ = [
+        ("key", ctypes.c_char * 32),
+        ("frame_id", ctypes.c_uint64),
+        ("pts_ns", ctypes.c_uint64),
+        ("stage_ns", ctypes.c_uint64 * len(STAGES)),
+    ]
+
+
+class FrameTraceStats(ctypes.Structure):
+    """Mirror of anpr::FrameTraceStats (frame_trace.hpp)"""
+    _fields_ = [
+        ("enabled", ctypes.c_uint32),
+        ("slots", ctypes.c_uint32),
+        ("opened", ctypes.c_uint64),
+        ("matched", ctypes.c_uint64),
+        ("missed", ctypes.c_uint64),
+    ]
+
+    def to_dict(self) -> Dict:
+        return {
+            "enabled": bool(self.enabled),
+            "slots": self.slots,
+            "opened": self.opened,
+            "matched": self.matched,
+            "missed": self.missed,
+        }
+
+
+_library: Optional[ctypes.CDLL] = None
+
+
+def _load_library(path: str) -> Optional[ctypes.CDLL]:
+    global _library
+    if _library is None:
+        try:
+            _library = ctypes.CDLL(path)
+            _library.frame_trace_enable.restype = None
+            _library.frame_trace_enable.argtypes = [ctypes.c_int]
+            _library.frame_trace_open.restype = ctypes.c_uint64
+            _library.frame_trace_open.argtypes = [ctypes.c_char_p, ctypes.c_uint64, ctypes.c_uint64]
+            _library.frame_trace_enter.restype = None
+            _library.frame_trace_enter.argtypes = [ctypes.c_uint64]
+            _library.frame_trace_get.restype = ctypes.c_int
+            _library.frame_trace_get.argtypes = [ctypes.c_uint64, ctypes.POINTER(FrameTraceRecord)]
+            _library.frame_trace_stats.restype = None
+            _library.frame_trace_stats.argtypes = [ctypes.POINTER(FrameTraceStats)]
+        except (OSError, AttributeError) as e:
+            logger.warning(f"Frame latency tracing unavailable: {e}")
+            return None
+    return _library
+
+
+class FrameTraceProbes:
+    """One pipeline's tracing pad probes"""
+
+    def __init__(self, library_path: str = CORE_LIBRARY):
+        self._library = _load_library(library_path)
+        self._probes: List[Tuple[Gst.Pad, int]] = []
+
+    def attach(self, pipeline: Gst.Pipeline, sources: List[Tuple[str, str]], detection_queue: str) -> bool:
+        """
+        Install the probes and turn tracing on (process-wide).
+
+        Args:
+            pipeline: The parsed pipeline
+            sources: (trace element name, SceneActivity key) of every camera
+            detection_queue: Name of the queue in front of plate_detection
+
+        Returns:
+            True if every probe was installed
+        """
+        if self._library is None:
+            return False
+        self._library.frame_trace_enable(1)
+
+        installed = True
+        for name, key in sources:
+            element = pipeline.get_by_name(name)
+            if element is None:
+                installed = False
+                continue
+            self._add_probe(element.get_static_pad("src"), self._source_probe, element, key.encode())
+
+        queue = pipeline.get_by_name(detection_queue)
+        if queue is None:
+            return False
+        self._add_probe(queue.get_static_pad("src"), self._detection_probe)
+        return installed
+
+    def close(self):
+        """Remove the probes (tracing stays on for the other pipelines)"""
+        for pad, probe_id in self._probes:
+            pad.remove_probe(probe_id)
+        self._probes = []
+
+    def _add_probe(self, pad: Gst.Pad, callback, *args):
+        probe_id = pad.add_probe(Gst.PadProbeType.BUFFER, callback, *args)
+        if probe_id:
+            self._probes.append((pad, probe_id))
+
+    def _source_probe(self, pad: Gst.Pad, info: Gst.PadProbeInfo, element: Gst.Element,
+                      key: bytes) -> Gst.PadProbeReturn:
+        buf = info.get_buffer()
+        if buf is not None and buf.pts != Gst.CLOCK_TIME_NONE:
+            base_time = element.get_base_time()
+            capture_ns = base_time + buf.pts if base_time else 0
+            self._library.frame_trace_open(key, buf.pts, capture_ns)
+        return Gst.PadProbeReturn.OK
+
+    def _detection_probe(self, pad: Gst.Pad, info: Gst.PadProbeInfo) -> Gst.PadProbeReturn:
+        buf = info.get_buffer()
+        if buf is not None and buf.pts != Gst.CLOCK_TIME_NONE:
+            self._library.frame_trace_enter(buf.pts)
+        return Gst.PadProbeReturn.OK
+
+
+def frame_latency(trace_frame: int, published_ns: int, drained_ns: Optional[int] = None,
+                  library_path: str = CORE_LIBRARY) -> Optional[Dict]:
+    """
+    Capture time and per-stage latency of a plate event's frame.
+
+    Args:
+        trace_frame: The event's trace frame id (0 if not traced)
+        published_ns: Monotonic time the event was published
+        drained_ns: Monotonic time the event left its ring (now if None)
+
+    Returns:
+        {"capture_timestamp": wall clock seconds, "latency_ms": {stage: ms
+        since capture}} for the stages the frame reached, plus "published"
+        and "drained"; None if the frame is not traced (or too old)
+    """
+    library = _load_library(library_path)
+    if library is None or not trace_frame:
+        return None
+    record = FrameTraceRecord()
+    if not library.frame_trace_get(trace_frame, ctypes.byref(record)):
+        return None
+
+    # Frames without a capture time start at the source probe
+    stages = {name: record.stage_ns[i] for i, name in enumerate(STAGES) if record.stage_ns[i]}
+    stages["published"] = published_ns
+    stages["drained"] = drained_ns if drained_ns is not None else time.monotonic_ns()
+    origin = stages.get("capture") or stages.get("source")
+    if not origin:
+        return None
+
+    capture_timestamp = time.time() - (time.monotonic_ns() - origin) / 1e9
+    return {
+        "capture_timestamp": capture_timestamp,
+        "latency_ms": {name: round((ns - origin) / 1e6, 3) for name, ns in stages.items()},
+    }
+
+
+class ChromeTraceWriter:
+    """
+    Writes sampled event traces to a Chrome trace file (JSON array format).
+
+    The array is left open so the file is valid at any point (the format
+    allows a missing closing bracket); each event adds one complete ("X")
+    span per hop between the stages its frame reached.
+    """
+
+    def __init__(self, path: str, sample_every: int = 1):
+        """
+        Args:
+            path: Trace file, overwritten
+            sample_every: Write every n-th event
+        """
+        self.path = path
+        self.sample_every = max(1, sample_every)
+        self._lock = threading.Lock()
+        self._file = open(path, "w", encoding="utf-8")
+        self._file.write("[\n")
+        self._seen = 0
+        self._cameras = set()
+        self.written = 0
+
+    def write(self, camera_id: int, name: str, capture_timestamp: float, latency_ms: Dict[str, float]) -> bool:
+        """
+        Add an event's trace if it is sampled.
+
+        Args:
+            camera_id: Track of the trace
+            name: Event label, e.g. the plate text
+            capture_timestamp: Wall clock seconds of the frame's capture
+            latency_ms: Milliseconds since capture per stage (frame_latency()),
+                in pipeline order
+
+        Returns:
+            True if written
+        """
+        with self._lock:
+            self._seen += 1
+            if self._file is None or (self._seen - 1) % self.sample_every:
+                return False
+
+            events = []
+            if camera_id not in self._cameras:
+                self._cameras.add(camera_id)
+                events.append({"name": "thread_name", "ph": "M", "pid": 1, "tid": camera_id,
+                               "args": {"name": f"camera {camera_id}"}})
+
+            start_us = capture_timestamp * 1e6
+            hops = sorted(latency_ms.items(), key=lambda item: item[1])
+            for (previous, begin_ms), (stage, end_ms) in zip(hops, hops[1:]):
+                events.append({
+                    "name": f"{previous}→{stage}", "cat": "anpr", "ph": "X", "pid": 1, "tid": camera_id,
+                    "ts": round(start_us + begin_ms * 1e3, 1), "dur": round((end_ms - begin_ms) * 1e3, 1),
+                    "args": {"event": name},
+                })
+            for event in events:
+                self._file.write(json.dumps(event, ensure_ascii=False) + ",\n")
+            self._file.flush()
+            self.written += 1
+            return True
+
+    def close(self):
+        with self._lock:
+            if self._file is not None:
+                self._file.close()
+                self._file = None
+
+
+def read_frame_trace_stats(library_path: str = CORE_LIBRARY) -> Dict:
+    """Counters of the frame tracer (process-wide), empty if the library is not loaded"""
+    library = _load_library(library_path)
+    if library is None:
+        return {}
+    stats = FrameTraceStats()
+    library.frame_trace_stats(ctypes.byref(stats))
+    return stats.to_dict()
@@ -0,0 +1,667 @@
+/**
+ * Offline benchmark of the postprocess stages on recorded tensors
+ *
+ * Replays a tensor dump (tensor_dump.hpp) through the same decoding code the
+ * plugins run, without a Hailo device or camera:
+ *   plate_detection  threshold scan, box decoding and NMS (detection_decode.hpp)
+ *   crop_plates      crop dedup and the fused crop/resize from a synthetic
+ *                    frame of the recorded frame size (crop_dedup.hpp,
+ *                    plate_resize.hpp) into a crop buffer pool
+ *   plate_ocr        CTC decoding and plate validation (ocr_decode.hpp)
+ *
+ * and reports per-call latency quantiles, calls/sec and heap allocations per
+ * call for each stage. --write-golden stores the decoded boxes and reads of
+ * every record; --check compares a run against such a file and fails on the
+ * first difference, so NMS/CTC changes can be validated on a laptop.
+ *
+ * Thresholds, decoding options and the crop size are the plugins' defaults,
+ * or with --params those a postprocess config (postprocess_params.hpp) sets
+ * for the camera the dump was captured from, so a site's tuning can be tried
+ * offline before it is pushed to the edge box.
+ *
+ * --compare-fast additionally decodes every detection record in full mode and
+ * in fast mode (top-K and plate geometry prefilter, detection_decode.hpp,
+ * with the config's top_k, geometry and max_plates) and reports both
+ * latencies and how many frames' boxes the fast mode changed.
+ *
+ * --ocr-workers N decodes the crops of each OCR record on the shared worker
+ * pool (worker_pool.hpp) like plate_ocr's frame entry points do, to size
+ * the pool for a site's plate counts.
+ *
+ * --synthesize writes a dump of generated tensors for when no recording is
+ * at hand.
+ */
+
+#include "crop_dedup.hpp"
+#include "crop_pool.hpp"
+#include "detection_decode.hpp"
+#include "ocr_decode.hpp"
+#include "plate_region.hpp"
+#include "plate_resize.hpp"
+#include "postprocess_params.hpp"
+#include "stage_stats.hpp"
+#include "tensor_dump.hpp"
+#include "worker_pool.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+// Heap allocations of the process; each stage reports the ones made inside its calls
+static std::atomic<uint64_t> g_allocations{0};
+
+void* operator new(size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+// Same values as the plugins (plate_crop.cpp)
+const int OCR_CHANNELS = 3;
+const size_t CROP_POOL_SLOTS = 32;
+const int DEFAULT_FRAME_WIDTH = 1920;
+const int DEFAULT_FRAME_HEIGHT = 1080;
+
+enum BenchCounter { ALLOCATIONS };
+
+struct Options {
+    std::string dump;
+    int iterations = 10;
+    std::string region = "eu";
+    int frame_width = 0;  // 0: frame size of each record
+    int frame_height = 0;
+    anpr::PixelFormat format = anpr::PixelFormat::NV12;
+    std::string write_golden;
+    std::string check;
+    std::string params;  // postprocess config
+    int ocr_workers = 0;  // shared pool threads, 0: decode on the replay thread
+    bool compare_fast = false;
+
+    // --synthesize
+    bool synthesize = false;
+    int frames = 200;
+    unsigned seed = 1;
+};
+
+static void usage() {
+    std::fprintf(stderr,
+                 "usage: bench_postprocess DUMP [--iterations N] [--region eu|lt|us] [--frame WxH]\n"
+                 "                              [--format nv12|rgb] [--write-golden FILE] [--check FILE]\n"
+                 "                              [--params CONFIG] [--ocr-workers N] [--compare-fast]\n"
+                 "       bench_postprocess --synthesize DUMP [--frames N] [--seed S]\n");
+}
+
+static bool parse_args(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        const bool has_value = i + 1 < argc;
+        if (arg == "--iterations" && has_value) {
+            options.iterations = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--region" && has_value) {
+            options.region = argv[++i];
+        } else if (arg == "--frame" && has_value) {
+            if (std::sscanf(argv[++i], "%dx%d", &options.frame_width, &options.frame_height) != 2) return false;
+        } else if (arg == "--format" && has_value) {
+            const std::string format = argv[++i];
+            if (format != "nv12" && format != "rgb") return false;
+            options.format = format == "rgb" ? anpr::PixelFormat::RGB : anpr::PixelFormat::NV12;
+        } else if (arg == "--write-golden" && has_value) {
+            options.write_golden = argv[++i];
+        } else if (arg == "--check" && has_value) {
+            options.check = argv[++i];
+        } else if (arg == "--params" && has_value) {
+            options.params = argv[++i];
+        } else if (arg == "--ocr-workers" && has_value) {
+            options.ocr_workers = std::atoi(argv[++i]);
+        } else if (arg == "--compare-fast") {
+            options.compare_fast = true;
+        } else if (arg == "--synthesize") {
+            options.synthesize = true;
+        } else if (arg == "--frames" && has_value) {
+            options.frames = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--seed" && has_value) {
+            options.seed = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (!arg.empty() && arg[0] != '-' && options.dump.empty()) {
+            options.dump = arg;
+        } else {
+            return false;
+        }
+    }
+    return !options.dump.empty();
+}
+
+/**
+ * Latency and allocations of one stage across the run.
+ */
+class BenchStage {
+public:
+    explicit BenchStage(const char* name) : stats_("bench", name, {"allocations"}) {}
+
+    void begin() {
+        allocations_ = g_allocations.load(std::memory_order_relaxed);
+        start_ = anpr::monotonic_ns();
+    }
+
+    void end(bool record) {
+        const uint64_t elapsed = anpr::monotonic_ns() - start_;
+        if (!record) return;
+        stats_.record(elapsed);
+        stats_.add(ALLOCATIONS, g_allocations.load(std::memory_order_relaxed) - allocations_);
+    }
+
+    void report() const {
+        const anpr::StageStatsSnapshot s = stats_.snapshot();
+        if (s.calls == 0) return;
+        std::printf("%-16s %8llu %10.0f %9.1f %9.1f %9.1f %9.1f %11.2f\n", s.stage,
+                    static_cast<unsigned long long>(s.calls), s.calls / (s.total_ns / 1e9), s.p50_ns / 1e3,
+                    s.p90_ns / 1e3, s.p99_ns / 1e3, s.max_ns / 1e3,
+                    static_cast<double>(s.counters[ALLOCATIONS]) / s.calls);
+    }
+
+private:
+    anpr::StageStats stats_;
+    uint64_t allocations_ = 0;
+    uint64_t start_ = 0;
+};
+
+/**
+ * Detection options of a camera's parameters, in the camera's mode or forced
+ * to full (fast = false) or fast mode, as plate_detection sets them.
+ */
+static anpr::DetectionOptions detection_options(const anpr::PostprocessParams& params, bool fast) {
+    anpr::DetectionOptions options;
+    options.confidence_threshold = params.confidence_threshold;
+    options.nms_threshold = params.nms_threshold;
+    options.max_plates = static_cast<size_t>(params.max_plates);
+    if (fast) {
+        options.top_k = static_cast<size_t>(params.top_k);
+        options.min_width = params.min_plate_width;
+        options.min_height = params.min_plate_height;
+        options.min_aspect = params.min_plate_aspect;
+        options.max_aspect = params.max_plate_aspect;
+    }
+    return options;
+}
+
+static bool same_boxes(const std::vector<Detection>& a, const std::vector<Detection>& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); i++) {
+        if (a[i].x != b[i].x || a[i].y != b[i].y || a[i].width != b[i].width || a[i].height != b[i].height ||
+            a[i].confidence != b[i].confidence) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Synthetic frame to crop from, one per frame size and format.
+ */
+struct SyntheticFrame {
+    std::vector<uint8_t> pixels;
+    anpr::ImageView view;
+
+    SyntheticFrame(int width, int height, anpr::PixelFormat format) {
+        view.format = format;
+        view.width = width;
+        view.height = height;
+        if (format == anpr::PixelFormat::NV12) {
+            const size_t luma = static_cast<size_t>(width) * height;
+            pixels.resize(luma + luma / 2);
+            view.planes[0] = pixels.data();
+            view.planes[1] = pixels.data() + luma;
+            view.strides[0] = view.strides[1] = static_cast<size_t>(width);
+        } else {
+            pixels.resize(static_cast<size_t>(width) * height * 3);
+            view.planes[0] = pixels.data();
+            view.strides[0] = static_cast<size_t>(width) * 3;
+        }
+        for (size_t i = 0; i < pixels.size(); i++) pixels[i] = static_cast<uint8_t>((i * 7) ^ (i >> 9));
+    }
+};
+
+/**
+ * Replays a dump; one instance per run (all state of a single streaming thread).
+ */
+template <typename Region>
+class Replay {
+public:
+    Replay(const Options& options, const anpr::PostprocessParams& params)
+        : options_(options),
+          params_(params),
+          pool_(anpr::CropBufferPool::create("bench", CROP_POOL_SLOTS,
+                                             static_cast<size_t>(params.ocr_width) * params.ocr_height *
+                                                 OCR_CHANNELS)) {
+        detection_options_ = detection_options(params, params.fast_detection);
+        full_options_ = detection_options(params, false);
+        full_options_.max_plates = 0;
+        fast_options_ = detection_options(params, true);
+        ocr_options_.beam_search = params.beam_search;
+        ocr_options_.beam_width = params.beam_width;
+        ocr_options_.min_confidence = params.min_confidence;
+        ocr_options_.min_length = params.min_plate_length;
+        ocr_options_.max_length = params.max_plate_length;
+    }
+
+    /**
+     * One pass over the records.
+     *
+     * @param record: Record latencies (false for the warmup pass)
+     * @param golden: Receives one line per decoded box / read, if not null
+     */
+    void run(const std::vector<anpr::TensorDumpReader::Record>& records, bool record,
+             std::vector<std::string>* golden) {
+        for (size_t index = 0; index < records.size(); index++) {
+            const anpr::TensorDumpReader::Record& r = records[index];
+            if (r.kind() == anpr::TensorKind::Detection) {
+                detect(r, record, index, golden);
+            } else {
+                read(r, record, index, golden);
+            }
+        }
+    }
+
+    void report() const {
+        std::printf("%-16s %8s %10s %9s %9s %9s %9s %11s\n", "stage", "calls", "calls/s", "p50_us", "p90_us",
+                    "p99_us", "max_us", "allocs/call");
+        detection_.report();
+        crop_.report();
+        ocr_.report();
+        if (!options_.compare_fast) return;
+
+        full_.report();
+        fast_.report();
+        std::printf("fast mode (top_k %zu, max_plates %zu): %llu of %llu frames with other boxes, "
+                    "%llu of %llu boxes dropped\n",
+                    fast_options_.top_k, fast_options_.max_plates, static_cast<unsigned long long>(frames_changed_),
+                    static_cast<unsigned long long>(frames_compared_), static_cast<unsigned long long>(boxes_dropped_),
+                    static_cast<unsigned long long>(boxes_full_));
+    }
+
+private:
+    void detect(const anpr::TensorDumpReader::Record& r, bool record, size_t index, std::vector<std::string>* golden) {
+        const anpr::TensorRecordHeader& h = *r.header;
+
+        detection_.begin();
+        const anpr::AnchorGrid grid = anpr::anchor_grid(h.height, h.width);
+        anpr::decode_detections(r.payload, r.dtype(), grid, r.quant(), nullptr, detection_options_, raw_,
+                                detections_);
+        detection_.end(record);
+        if (options_.compare_fast) compare_fast(r, grid, record);
+
+        if (golden) {
+            char line[160];
+            std::snprintf(line, sizeof(line), "%zu det %zu", index, detections_.size());
+            golden->push_back(line);
+            for (const Detection& det : detections_) {
+                std::snprintf(line, sizeof(line), "%zu box %.4f %.4f %.4f %.4f %.4f", index, det.x, det.y,
+                              det.width, det.height, det.confidence);
+                golden->push_back(line);
+            }
+        }
+
+        crop(h, record);
+    }
+
+    /**
+     * Decode a detection record in full and in fast mode; boxes are compared
+     * on the warmup pass.
+     */
+    void compare_fast(const anpr::TensorDumpReader::Record& r, const anpr::AnchorGrid& grid, bool record) {
+        full_.begin();
+        anpr::decode_detections(r.payload, r.dtype(), grid, r.quant(), nullptr, full_options_, raw_, full_boxes_);
+        full_.end(record);
+
+        fast_.begin();
+        anpr::decode_detections(r.payload, r.dtype(), grid, r.quant(), nullptr, fast_options_, raw_, fast_boxes_);
+        fast_.end(record);
+
+        if (record) return;
+        frames_compared_++;
+        boxes_full_ += full_boxes_.size();
+        boxes_dropped_ += full_boxes_.size() > fast_boxes_.size() ? full_boxes_.size() - fast_boxes_.size() : 0;
+        if (!same_boxes(full_boxes_, fast_boxes_)) frames_changed_++;
+    }
+
+    void crop(const anpr::TensorRecordHeader& h, bool record) {
+        const int frame_width = options_.frame_width ? options_.frame_width
+                                                     : h.frame_width ? h.frame_width : DEFAULT_FRAME_WIDTH;
+        const int frame_height = options_.frame_height ? options_.frame_height
+                                                       : h.frame_height ? h.frame_height : DEFAULT_FRAME_HEIGHT;
+        const SyntheticFrame& frame = synthetic_frame(frame_width, frame_height);
+        anpr::CropDedup& dedup = dedup_[h.stream_index];
+
+        crop_.begin();
+        boxes_.clear();
+        for (const Detection& det : detections_) {
+            boxes_.push_back(anpr::DedupBox{det.x, det.y, det.width, det.height});
+        }
+        decisions_.assign(boxes_.size(), anpr::DedupDecision());
+        dedup.update(boxes_.data(), boxes_.size(), anpr::DedupOptions(), decisions_.data());
+
+        for (size_t i = 0; i < boxes_.size(); i++) {
+            if (!decisions_[i].run_ocr) continue;
+
+            const anpr::DedupBox& box = boxes_[i];
+            const float x0 = std::max(0.0f, box.x) * frame_width;
+            const float y0 = std::max(0.0f, box.y) * frame_height;
+            const float x1 = std::min(1.0f, box.x + box.width) * frame_width;
+            const float y1 = std::min(1.0f, box.y + box.height) * frame_height;
+            if (x1 - x0 < 1.0f || y1 - y0 < 1.0f) continue;
+
+            // Released right away, as if OCR consumed the crop immediately
+            std::shared_ptr<uint8_t> out = pool_->acquire(std::chrono::milliseconds(0));
+            if (!out) continue;
+            resizer_.run(frame.view, anpr::CropRect{x0, y0, x1 - x0, y1 - y0}, out.get(), params_.ocr_width,
+                         params_.ocr_height, static_cast<size_t>(params_.ocr_width) * OCR_CHANNELS);
+        }
+        crop_.end(record);
+    }
+
+    void read(const anpr::TensorDumpReader::Record& r, bool record, size_t index, std::vector<std::string>* golden) {
+        const anpr::TensorRecordHeader& h = *r.header;
+        if (results_.size() < h.count) {
+            results_.resize(h.count);
+            cleaned_.resize(h.count);
+            verdicts_.resize(h.count);
+        }
+
+        const anpr::OCRDecodeOptions& options = ocr_options_;
+
+        ocr_.begin();
+        anpr::WorkerPool& pool = anpr::WorkerPool::instance();
+        if (pool.threads() > 0 && h.count > 1) {
+            // As plate_ocr_frame: one crop per pool item
+            const size_t block_bytes = static_cast<size_t>(h.height) * h.width * anpr::dtype_size(r.dtype());
+            const uint8_t* payload = static_cast<const uint8_t*>(r.payload);
+            pool.parallel_for(h.count, [&](size_t i) {
+                anpr::decode_crops<Region>(payload + i * block_bytes, r.dtype(), 1, h.height, h.width, r.quant(),
+                                           options, &results_[i]);
+                verdicts_[i] = anpr::check_read<Region>(results_[i], options, cleaned_[i]);
+            });
+        } else {
+            anpr::decode_crops<Region>(r.payload, r.dtype(), h.count, h.height, h.width, r.quant(), options,
+                                       results_.data());
+            for (uint32_t i = 0; i < h.count; i++) {
+                verdicts_[i] = anpr::check_read<Region>(results_[i], options, cleaned_[i]);
+            }
+        }
+        ocr_.end(record);
+
+        if (golden) {
+            for (uint32_t i = 0; i < h.count; i++) {
+                const bool accepted = verdicts_[i] == anpr::OCRVerdict::Accepted;
+                const anpr::PlateText& text = accepted ? cleaned_[i] : results_[i].text;
+                char line[160];
+                std::snprintf(line, sizeof(line), "%zu ocr %u %s '%.*s' %.4f", index, i, verdict_name(verdicts_[i]),
+                              text.length, text.chars, results_[i].confidence);
+                golden->push_back(line);
+            }
+        }
+    }
+
+    static const char* verdict_name(anpr::OCRVerdict verdict) {
+        switch (verdict) {
+            case anpr::OCRVerdict::Accepted: return "accepted";
+            case anpr::OCRVerdict::Invalid: return "invalid";
+            default: return "low_confidence";
+        }
+    }
+
+    const SyntheticFrame& synthetic_frame(int width, int height) {
+        const uint64_t key = static_cast<uint64_t>(width) << 32 | static_cast<uint32_t>(height);
+        auto it = frames_.find(key);
+        if (it == frames_.end()) it = frames_.emplace(key, SyntheticFrame(width, height, options_.format)).first;
+        return it->second;
+    }
+
+    const Options& options_;
+    const anpr::PostprocessParams params_;
+    anpr::DetectionOptions detection_options_;
+    anpr::DetectionOptions full_options_;  // --compare-fast
+    anpr::DetectionOptions fast_options_;
+    anpr::OCRDecodeOptions ocr_options_;
+    std::shared_ptr<anpr::CropBufferPool> pool_;
+    anpr::CropResizer resizer_;
+    std::map<int32_t, anpr::CropDedup> dedup_;  // per stream index
+    std::map<uint64_t, SyntheticFrame> frames_;
+
+    std::vector<Detection> raw_;
+    std::vector<Detection> detections_;
+    std::vector<Detection> full_boxes_;
+    std::vector<Detection> fast_boxes_;
+    std::vector<anpr::DedupBox> boxes_;
+    std::vector<anpr::DedupDecision> decisions_;
+    std::vector<anpr::OCRResult> results_;
+    std::vector<anpr::PlateText> cleaned_;
+    std::vector<anpr::OCRVerdict> verdicts_;
+
+    BenchStage detection_{"plate_detection"};
+    BenchStage crop_{"crop_plates"};
+    BenchStage ocr_{"plate_ocr"};
+    BenchStage full_{"detection_full"};
+    BenchStage fast_{"detection_fast"};
+
+    uint64_t frames_compared_ = 0;
+    uint64_t frames_changed_ = 0;
+    uint64_t boxes_full_ = 0;
+    uint64_t boxes_dropped_ = 0;
+};
+
+static bool write_lines(const std::string& path, const std::vector<std::string>& lines) {
+    std::FILE* file = std::fopen(path.c_str(), "w");
+    if (!file) return false;
+    for (const std::string& line : lines) std::fprintf(file, "%s\n", line.c_str());
+    return std::fclose(file) == 0;
+}
+
+static bool read_lines(const std::string& path, std::vector<std::string>& lines) {
+    std::FILE* file = std::fopen(path.c_str(), "r");
+    if (!file) return false;
+    char buffer[512];
+    while (std::fgets(buffer, sizeof(buffer), file)) {
+        std::string line(buffer);
+        while (!line.empty() && (line.back() == '\n' || line.back() == '\r')) line.pop_back();
+        lines.push_back(line);
+    }
+    std::fclose(file);
+    return true;
+}
+
+/**
+ * Compare a run's golden lines with a stored file.
+ *
+ * @return: true if identical; otherwise the first difference is printed
+ */
+static bool check_golden(const std::string& path, const std::vector<std::string>& actual) {
+    std::vector<std::string> expected;
+    if (!read_lines(path, expected)) {
+        std::fprintf(stderr, "cannot read %s\n", path.c_str());
+        return false;
+    }
+    const size_t n = std::min(expected.size(), actual.size());
+    for (size_t i = 0; i < n; i++) {
+        if (expected[i] != actual[i]) {
+            std::fprintf(stderr, "mismatch at line %zu:\n  expected: %s\n  actual:   %s\n", i + 1,
+                         expected[i].c_str(), actual[i].c_str());
+            return false;
+        }
+    }
+    if (expected.size() != actual.size()) {
+        std::fprintf(stderr, "line count differs: expected %zu, actual %zu\n", expected.size(), actual.size());
+        return false;
+    }
+    return true;
+}
+
+template <typename Region>
+static int run_bench(const Options& options, const anpr::TensorDumpReader& reader) {
+    anpr::PostprocessParamStore& store = anpr::PostprocessParamStore::instance();
+    std::string error;
+    if (!options.params.empty() && !store.load_file(options.params, &error)) {
+        std::fprintf(stderr, "cannot load %s: %s\n", options.params.c_str(), error.c_str());
+        return 1;
+    }
+    if (!anpr::WorkerPool::instance().configure(options.ocr_workers)) {
+        std::fprintf(stderr, "--ocr-workers must be within [0, %d]\n", anpr::WorkerPool::kMaxThreads);
+        return 2;
+    }
+    Replay<Region> replay(options, store.snapshot()->find(reader.file_header().source));
+
+    // Warmup pass: sizes the scratch buffers and produces the reference output
+    std::vector<std::string> golden;
+    replay.run(reader.records(), false, &golden);
+    for (int i = 0; i < options.iterations; i++) replay.run(reader.records(), true, nullptr);
+
+    std::printf("%s: %zu records, %d iterations, region %s, %d OCR workers\n", options.dump.c_str(),
+                reader.records().size(), options.iterations, options.region.c_str(), options.ocr_workers);
+    replay.report();
+
+    if (!options.write_golden.empty()) {
+        if (!write_lines(options.write_golden, golden)) {
+            std::fprintf(stderr, "cannot write %s\n", options.write_golden.c_str());
+            return 1;
+        }
+        std::printf("wrote %zu golden lines to %s\n", golden.size(), options.write_golden.c_str());
+    }
+    if (!options.check.empty()) {
+        if (!check_golden(options.check, golden)) return 1;
+        std::printf("outputs match %s\n", options.check.c_str());
+    }
+    return 0;
+}
+
+/**
+ * Generated dump: per frame a uint8 detection output [5, 8400] with a few
+ * plates (three overlapping anchors each, so NMS has work; every tenth frame
+ * a rush-hour frame with 30) followed by the batched OCR output of those
+ * plates, [24, 37] per crop, mostly valid reads and some weak or too short.
+ */
+static int synthesize(const Options& options) {
+    const int num_anchors = 8400;
+    const int channels = 5;
+    const int timesteps = 24;
+    const int num_classes = anpr::region::EU::num_classes;
+    const int blank = anpr::region::EU::blank;
+    const float scale = 1.0f / 255.0f;
+
+    std::mt19937 rng(options.seed);
+    auto uniform = [&rng](int lo, int hi) { return std::uniform_int_distribution<int>(lo, hi)(rng); };
+
+    std::remove(options.dump.c_str());
+    anpr::TensorDumpWriter writer;
+    if (!writer.open(options.dump, "synthetic", 0)) {
+        std::fprintf(stderr, "cannot create %s\n", options.dump.c_str());
+        return 1;
+    }
+
+    std::vector<uint8_t> detection(static_cast<size_t>(channels) * num_anchors);
+    std::vector<uint8_t> ocr;
+
+    for (int frame = 0; frame < options.frames; frame++) {
+        const int plates = frame % 10 == 9 ? 30 : uniform(0, 4);
+
+        // Background confidences stay under the 0.5 threshold
+        for (int c = 0; c < 4; c++) {
+            for (int i = 0; i < num_anchors; i++) {
+                detection[c * num_anchors + i] = static_cast<uint8_t>(uniform(0, 255));
+            }
+        }
+        for (int i = 0; i < num_anchors; i++) detection[4 * num_anchors + i] = static_cast<uint8_t>(uniform(0, 100));
+
+        for (int p = 0; p < plates; p++) {
+            const int cx = uniform(20, 235), cy = uniform(20, 235);
+            const int anchor = uniform(0, num_anchors - 3);
+            for (int k = 0; k < 3; k++) {
+                const int i = anchor + k;
+                detection[0 * num_anchors + i] = static_cast<uint8_t>(cx + k);
+                detection[1 * num_anchors + i] = static_cast<uint8_t>(cy);
+                detection[2 * num_anchors + i] = static_cast<uint8_t>(uniform(18, 22));
+                detection[3 * num_anchors + i] = static_cast<uint8_t>(uniform(6, 8));
+                detection[4 * num_anchors + i] = static_cast<uint8_t>(uniform(170, 250));
+            }
+        }
+
+        anpr::TensorRecordHeader header{};
+        header.kind = static_cast<uint32_t>(anpr::TensorKind::Detection);
+        header.dtype = static_cast<uint32_t>(anpr::TensorDType::UInt8);
+        header.height = channels;
+        header.width = num_anchors;
+        header.count = 1;
+        header.payload_bytes = static_cast<uint32_t>(detection.size());
+        header.quant_scale = scale;
+        header.quant_zero_point = 0.0f;
+        header.timestamp_ns = static_cast<uint64_t>(frame) * 40000000ull;  // 25 fps
+        header.frame_id = static_cast<uint64_t>(frame);
+        header.stream_index = -1;
+        header.frame_width = DEFAULT_FRAME_WIDTH;
+        header.frame_height = DEFAULT_FRAME_HEIGHT;
+        if (!writer.append(header, detection.data())) return 1;
+
+        if (plates == 0) continue;
+
+        const size_t block = static_cast<size_t>(timesteps) * num_classes;
+        ocr.assign(block * plates, 0);
+        for (int p = 0; p < plates; p++) {
+            uint8_t* crop = ocr.data() + p * block;
+            const int kind = uniform(0, 9);  // 0: weak read, 1: too short, otherwise LT-style ABC123
+            const int length = kind == 1 ? 1 : 6;
+            const int peak = kind == 0 ? 110 : 235;
+
+            for (int t = 0; t < timesteps; t++) {
+                for (int c = 0; c < num_classes; c++) crop[t * num_classes + c] = static_cast<uint8_t>(uniform(0, 12));
+                crop[t * num_classes + blank] = 200;
+            }
+            for (int ch = 0; ch < length; ch++) {
+                const int cls = ch < 3 ? 10 + uniform(0, 25) : uniform(0, 9);
+                for (int t = 2 + ch * 3; t < 4 + ch * 3; t++) {
+                    crop[t * num_classes + cls] = static_cast<uint8_t>(peak + uniform(0, 15));
+                    crop[t * num_classes + blank] = static_cast<uint8_t>(uniform(0, 20));
+                }
+            }
+        }
+
+        header.kind = static_cast<uint32_t>(anpr::TensorKind::OCR);
+        header.height = timesteps;
+        header.width = num_classes;
+        header.count = static_cast<uint32_t>(plates);
+        header.payload_bytes = static_cast<uint32_t>(ocr.size());
+        if (!writer.append(header, ocr.data())) return 1;
+    }
+
+    std::printf("wrote %d frames to %s\n", options.frames, options.dump.c_str());
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parse_args(argc, argv, options)) {
+        usage();
+        return 2;
+    }
+
+    if (options.synthesize) return synthesize(options);
+
+    anpr::TensorDumpReader reader;
+    if (!reader.open(options.dump)) {
+        std::fprintf(stderr, "cannot read tensor dump %s\n", options.dump.c_str());
+        return 1;
+    }
+
+    if (options.region == "eu") return run_bench<anpr::region::EU>(options, reader);
+    if (options.region == "lt") return run_bench<anpr::region::LT>(options, reader);
+    if (options.region == "us") return run_bench<anpr::region::US>(options, reader);
+    usage();
+    return 2;
+}
@@ -0,0 +1,308 @@
+/**
+ * Candidate selection kernels for the detection post-processing.
+ *
+ * The YOLO head produces thousands of anchors per frame but usually fewer
+ * than 1% of them clear the confidence threshold. These kernels scan the
+ * confidence channel and compact the indices of passing anchors, so that
+ * Detection objects are only built for real candidates.
+ *
+ * Kernels exist for float32 and for native uint8/uint16 quantized tensors
+ * (with the threshold already converted into the quantized domain).
+ * The vectorized kernel (AVX2 on x86-64, NEON on AArch64) is picked once at
+ * runtime; the scalar kernel is used everywhere else. Setting the
+ * ANPR_SIMD=scalar environment variable forces the scalar path.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <immintrin.h>
+#define ANPR_HAVE_AVX2_KERNEL 1
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#define ANPR_HAVE_NEON_KERNEL 1
+#endif
+
+namespace anpr {
+
+/**
+ * Memory layout of the detection output tensor.
+ *
+ * ChannelMajor: [channels, anchors] - every channel is one contiguous row,
+ *               which is what YOLOv8 exports ([84, 8400]).
+ * AnchorMajor:  [anchors, channels] - all values of one anchor are adjacent.
+ */
+enum class TensorLayout {
+    ChannelMajor,
+    AnchorMajor,
+};
+
+/**
+ * Guess the layout from the tensor shape.
+ * A detection head always has far fewer channels than anchors, so the
+ * shorter dimension is the channel dimension.
+ */
+inline TensorLayout infer_layout(int rows, int cols) {
+    return rows <= cols ? TensorLayout::ChannelMajor : TensorLayout::AnchorMajor;
+}
+
+/**
+ * Scalar scan over a strided confidence column.
+ * Used for anchor-major tensors, where the confidences are not contiguous.
+ */
+template <typename T>
+inline size_t select_candidates_strided(const T* conf, size_t count, size_t stride,
+                                        T threshold, uint32_t* out) {
+    size_t n = 0;
+    for (size_t i = 0; i < count; i++) {
+        // Branch-free compaction: always store, only advance on a hit
+        out[n] = static_cast<uint32_t>(i);
+        n += conf[i * stride] >= threshold;
+    }
+    return n;
+}
+
+/**
+ * Scalar scan over a contiguous confidence row.
+ */
+template <typename T>
+inline size_t select_candidates_scalar(const T* conf, size_t count, T threshold, uint32_t* out) {
+    return select_candidates_strided(conf, count, 1, threshold, out);
+}
+
+#ifdef ANPR_HAVE_AVX2_KERNEL
+// Append the set bits of `bits` (one bit per lane) as indices starting at `base`
+inline size_t emit_hits(uint32_t bits, size_t base, uint32_t* out, size_t n) {
+    while (bits) {
+        out[n++] = static_cast<uint32_t>(base + __builtin_ctz(bits));
+        bits &= bits - 1;
+    }
+    return n;
+}
+
+/**
+ * AVX2 float scan: 32 anchors per iteration, one movemask per 8 lanes.
+ * Hits are rare, so the common case is a single test of the OR'ed masks.
+ */
+__attribute__((target("avx2")))
+inline size_t select_candidates_avx2(const float* conf, size_t count,
+                                     float threshold, uint32_t* out) {
+    const __m256 thr = _mm256_set1_ps(threshold);
+    size_t n = 0;
+    size_t i = 0;
+
+    for (; i + 32 <= count; i += 32) {
+        __m256 m0 = _mm256_cmp_ps(_mm256_loadu_ps(conf + i), thr, _CMP_GE_OQ);
+        __m256 m1 = _mm256_cmp_ps(_mm256_loadu_ps(conf + i + 8), thr, _CMP_GE_OQ);
+        __m256 m2 = _mm256_cmp_ps(_mm256_loadu_ps(conf + i + 16), thr, _CMP_GE_OQ);
+        __m256 m3 = _mm256_cmp_ps(_mm256_loadu_ps(conf + i + 24), thr, _CMP_GE_OQ);
+
+        __m256 any = _mm256_or_ps(_mm256_or_ps(m0, m1), _mm256_or_ps(m2, m3));
+        if (_mm256_testz_ps(any, any)) continue;
+
+        uint32_t bits = static_cast<uint32_t>(_mm256_movemask_ps(m0))
+                      | static_cast<uint32_t>(_mm256_movemask_ps(m1)) << 8
+                      | static_cast<uint32_t>(_mm256_movemask_ps(m2)) << 16
+                      | static_cast<uint32_t>(_mm256_movemask_ps(m3)) << 24;
+        n = emit_hits(bits, i, out, n);
+    }
+
+    for (; i + 8 <= count; i += 8) {
+        uint32_t bits = static_cast<uint32_t>(_mm256_movemask_ps(
+            _mm256_cmp_ps(_mm256_loadu_ps(conf + i), thr, _CMP_GE_OQ)));
+        n = emit_hits(bits, i, out, n);
+    }
+
+    for (; i < count; i++) {
+        out[n] = static_cast<uint32_t>(i);
+        n += conf[i] >= threshold;
+    }
+    return n;
+}
+
+/**
+ * AVX2 uint8 scan: 32 anchors per vector. Unsigned a >= t is max(a, t) == a.
+ */
+__attribute__((target("avx2")))
+inline size_t select_candidates_avx2(const uint8_t* conf, size_t count,
+                                     uint8_t threshold, uint32_t* out) {
+    const __m256i thr = _mm256_set1_epi8(static_cast<char>(threshold));
+    size_t n = 0;
+    size_t i = 0;
+
+    for (; i + 32 <= count; i += 32) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(conf + i));
+        __m256i ge = _mm256_cmpeq_epi8(_mm256_max_epu8(v, thr), v);
+        uint32_t bits = static_cast<uint32_t>(_mm256_movemask_epi8(ge));
+        if (bits) n = emit_hits(bits, i, out, n);
+    }
+
+    for (; i < count; i++) {
+        out[n] = static_cast<uint32_t>(i);
+        n += conf[i] >= threshold;
+    }
+    return n;
+}
+
+/**
+ * AVX2 uint16 scan: 16 anchors per vector. movemask_epi8 yields two bits per
+ * lane, so only the even bits are kept and halved into lane indices.
+ */
+__attribute__((target("avx2")))
+inline size_t select_candidates_avx2(const uint16_t* conf, size_t count,
+                                     uint16_t threshold, uint32_t* out) {
+    const __m256i thr = _mm256_set1_epi16(static_cast<short>(threshold));
+    size_t n = 0;
+    size_t i = 0;
+
+    for (; i + 16 <= count; i += 16) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(conf + i));
+        __m256i ge = _mm256_cmpeq_epi16(_mm256_max_epu16(v, thr), v);
+        uint32_t bits = static_cast<uint32_t>(_mm256_movemask_epi8(ge)) & 0x55555555u;
+        while (bits) {
+            out[n++] = static_cast<uint32_t>(i + (__builtin_ctz(bits) >> 1));
+            bits &= bits - 1;
+        }
+    }
+
+    for (; i < count; i++) {
+        out[n] = static_cast<uint32_t>(i);
+        n += conf[i] >= threshold;
+    }
+    return n;
+}
+#endif
+
+#ifdef ANPR_HAVE_NEON_KERNEL
+/**
+ * NEON float scan: 16 anchors per iteration, early-out via a horizontal max.
+ */
+inline size_t select_candidates_neon(const float* conf, size_t count,
+                                     float threshold, uint32_t* out) {
+    const float32x4_t thr = vdupq_n_f32(threshold);
+    size_t n = 0;
+    size_t i = 0;
+
+    for (; i + 16 <= count; i += 16) {
+        uint32x4_t m0 = vcgeq_f32(vld1q_f32(conf + i), thr);
+        uint32x4_t m1 = vcgeq_f32(vld1q_f32(conf + i + 4), thr);
+        uint32x4_t m2 = vcgeq_f32(vld1q_f32(conf + i + 8), thr);
+        uint32x4_t m3 = vcgeq_f32(vld1q_f32(conf + i + 12), thr);
+
+        uint32x4_t any = vorrq_u32(vorrq_u32(m0, m1), vorrq_u32(m2, m3));
+        if (vmaxvq_u32(any) == 0) continue;
+
+        for (size_t j = 0; j < 16; j++) {
+            out[n] = static_cast<uint32_t>(i + j);
+            n += conf[i + j] >= threshold;
+        }
+    }
+
+    for (; i < count; i++) {
+        out[n] = static_cast<uint32_t>(i);
+        n += conf[i] >= threshold;
+    }
+    return n;
+}
+
+/**
+ * NEON uint8 scan: 32 anchors per iteration.
+ */
+inline size_t select_candidates_neon(const uint8_t* conf, size_t count,
+                                     uint8_t threshold, uint32_t* out) {
+    const uint8x16_t thr = vdupq_n_u8(threshold);
+    size_t n = 0;
+    size_t i = 0;
+
+    for (; i + 32 <= count; i += 32) {
+        uint8x16_t any = vorrq_u8(vcgeq_u8(vld1q_u8(conf + i), thr),
+                                  vcgeq_u8(vld1q_u8(conf + i + 16), thr));
+        if (vmaxvq_u8(any) == 0) continue;
+
+        for (size_t j = 0; j < 32; j++) {
+            out[n] = static_cast<uint32_t>(i + j);
+            n += conf[i + j] >= threshold;
+        }
+    }
+
+    for (; i < count; i++) {
+        out[n] = static_cast<uint32_t>(i);
+        n += conf[i] >= threshold;
+    }
+    return n;
+}
+
+/**
+ * NEON uint16 scan: 16 anchors per iteration.
+ */
+inline size_t select_candidates_neon(const uint16_t* conf, size_t count,
+                                     uint16_t threshold, uint32_t* out) {
+    const uint16x8_t thr = vdupq_n_u16(threshold);
+    size_t n = 0;
+    size_t i = 0;
+
+    for (; i + 16 <= count; i += 16) {
+        uint16x8_t any = vorrq_u16(vcgeq_u16(vld1q_u16(conf + i), thr),
+                                   vcgeq_u16(vld1q_u16(conf + i + 8), thr));
+        if (vmaxvq_u16(any) == 0) continue;
+
+        for (size_t j = 0; j < 16; j++) {
+            out[n] = static_cast<uint32_t>(i + j);
+            n += conf[i + j] >= threshold;
+        }
+    }
+
+    for (; i < count; i++) {
+        out[n] = static_cast<uint32_t>(i);
+        n += conf[i] >= threshold;
+    }
+    return n;
+}
+#endif
+
+template <typename T>
+using SelectCandidatesFn = size_t (*)(const T*, size_t, T, uint32_t*);
+
+/**
+ * Resolve the best kernel for this CPU and element type. Called once per
+ * process and type.
+ */
+template <typename T>
+inline SelectCandidatesFn<T> resolve_select_candidates() {
+    const char* forced = std::getenv("ANPR_SIMD");
+    if (forced && std::strcmp(forced, "scalar") == 0) {
+        return select_candidates_scalar<T>;
+    }
+
+#ifdef ANPR_HAVE_AVX2_KERNEL
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return static_cast<SelectCandidatesFn<T>>(select_candidates_avx2);
+    }
+#endif
+#ifdef ANPR_HAVE_NEON_KERNEL
+    // Advanced SIMD is mandatory on AArch64
+    return static_cast<SelectCandidatesFn<T>>(select_candidates_neon);
+#endif
+    return select_candidates_scalar<T>;
+}
+
+/**
+ * Compact the indices of all entries in a contiguous confidence row that are
+ * >= threshold into `out` (which must hold `count` entries).
+ * T is float, uint8_t or uint16_t.
+ *
+ * @return: Number of indices written, in ascending order
+ */
+template <typename T>
+inline size_t select_candidates(const T* conf, size_t count, T threshold, uint32_t* out) {
+    static const SelectCandidatesFn<T> kernel = resolve_select_candidates<T>();
+    return kernel(conf, count, threshold, out);
+}
+
+}  // namespace anpr
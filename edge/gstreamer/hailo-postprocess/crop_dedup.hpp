@@ -0,0 +1,255 @@
+/**
+ * Crop-level OCR deduplication.
+ *
+ * Associates plate detections across frames by IoU (greedy, highest overlap
+ * first) and decides per detection whether its crop goes to OCR. Tracks whose
+ * read in the TrackRegistry is stable - the same text several times in a row
+ * at high confidence - are only re-verified every Nth frame, so a car waiting
+ * at a barrier is not re-read at full frame rate. Tracks whose plate
+ * plate_tracker already decided from the read consensus are not OCR'd again.
+ *
+ * When the native tracker (plate_tracker) runs upstream, detections already
+ * carry its track ids and update_tracked() uses those instead of its own
+ * association.
+ *
+ * One instance per pipeline streaming thread; the track table is fixed-size.
+ */
+
+#pragma once
+
+#include "track_registry.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace anpr {
+
+struct DedupOptions {
+    float match_iou = 0.3f;            // min IoU to continue a track
+    float stable_confidence = 0.85f;   // read confidence needed to skip OCR
+    uint32_t stable_reads = 2;         // consecutive agreeing reads needed to skip OCR
+    uint32_t reverify_interval = 10;   // stable tracks are OCR'd every Nth frame
+    uint32_t max_missed_frames = 10;   // frames without a match before a track ends
+};
+
+// Normalized corner box
+struct DedupBox {
+    float x, y, width, height;
+};
+
+struct DedupDecision {
+    uint64_t track_id = 0;  // 0 if the track table was full
+    bool run_ocr = true;
+};
+
+class CropDedup {
+public:
+    static constexpr int kMaxTracks = 64;
+
+    explicit CropDedup(TrackRegistry& registry = TrackRegistry::instance()) : registry_(registry) {}
+
+    /**
+     * Associate one frame's detections and decide which crops need OCR.
+     *
+     * @param decisions: Receives one decision per box
+     */
+    void update(const DedupBox* boxes, size_t count, const DedupOptions& options, DedupDecision* decisions) {
+        match(boxes, count, options.match_iou);
+
+        for (int t = 0; t < num_tracks_; t++) tracks_[t].matched = false;
+        for (size_t i = 0; i < count; i++) {
+            if (assignment_[i] >= 0) tracks_[assignment_[i]].matched = true;
+        }
+
+        for (size_t i = 0; i < count; i++) {
+            DedupDecision& decision = decisions[i];
+            int t = assignment_[i];
+            if (t < 0) t = start_track(boxes[i], 0, true);
+
+            if (t < 0) {
+                decision = DedupDecision();
+                sent_++;
+                continue;
+            }
+
+            Track& track = tracks_[t];
+            track.box = boxes[i];
+            track.missed = 0;
+            track.matched = true;
+
+            decision.track_id = track.id;
+            decision.run_ocr = needs_ocr(track, options);
+            if (decision.run_ocr) {
+                sent_++;
+            } else {
+                skipped_++;
+            }
+        }
+
+        expire(options.max_missed_frames, true);
+    }
+
+    /**
+     * Decide which crops need OCR for detections with upstream track ids.
+     * Detections without an id (0) always go to OCR. The ids stay owned by
+     * the upstream tracker.
+     */
+    void update_tracked(const uint64_t* track_ids, size_t count, const DedupOptions& options,
+                        DedupDecision* decisions) {
+        for (int t = 0; t < num_tracks_; t++) tracks_[t].matched = false;
+
+        for (size_t i = 0; i < count; i++) {
+            DedupDecision& decision = decisions[i];
+            decision = DedupDecision();
+            if (track_ids[i] == 0) {
+                sent_++;
+                continue;
+            }
+
+            int t = find_track(track_ids[i]);
+            if (t < 0) t = start_track(DedupBox{}, track_ids[i], false);
+            if (t < 0) {
+                sent_++;
+                continue;
+            }
+
+            Track& track = tracks_[t];
+            track.missed = 0;
+            track.matched = true;
+
+            decision.track_id = track.id;
+            decision.run_ocr = needs_ocr(track, options);
+            if (decision.run_ocr) {
+                sent_++;
+            } else {
+                skipped_++;
+            }
+        }
+
+        expire(options.max_missed_frames, false);
+    }
+
+    uint64_t crops_sent() const { return sent_; }
+    uint64_t crops_skipped() const { return skipped_; }
+    int num_tracks() const { return num_tracks_; }
+
+private:
+    struct Track {
+        DedupBox box;
+        uint64_t id;
+        uint32_t missed;
+        uint32_t since_ocr;
+        bool matched;
+    };
+
+    struct Pair {
+        float iou;
+        int track;
+        int box;
+    };
+
+    static float iou(const DedupBox& a, const DedupBox& b) {
+        const float x1 = std::max(a.x, b.x);
+        const float y1 = std::max(a.y, b.y);
+        const float x2 = std::min(a.x + a.width, b.x + b.width);
+        const float y2 = std::min(a.y + a.height, b.y + b.height);
+        if (x2 <= x1 || y2 <= y1) return 0.0f;
+
+        const float intersection = (x2 - x1) * (y2 - y1);
+        return intersection / (a.width * a.height + b.width * b.height - intersection);
+    }
+
+    // Greedy assignment, highest IoU first; assignment_[i] = track or -1
+    void match(const DedupBox* boxes, size_t count, float min_iou) {
+        assignment_.assign(count, -1);
+        pairs_.clear();
+        for (int t = 0; t < num_tracks_; t++) {
+            for (size_t i = 0; i < count; i++) {
+                const float overlap = iou(tracks_[t].box, boxes[i]);
+                if (overlap >= min_iou) pairs_.push_back(Pair{overlap, t, static_cast<int>(i)});
+            }
+        }
+        std::sort(pairs_.begin(), pairs_.end(), [](const Pair& a, const Pair& b) {
+            return a.iou > b.iou || (a.iou == b.iou && (a.track < b.track || (a.track == b.track && a.box < b.box)));
+        });
+
+        uint64_t track_taken = 0;  // kMaxTracks <= 64
+        for (const Pair& p : pairs_) {
+            if ((track_taken >> p.track) & 1u || assignment_[p.box] >= 0) continue;
+            track_taken |= uint64_t(1) << p.track;
+            assignment_[p.box] = p.track;
+        }
+    }
+
+    int find_track(uint64_t id) const {
+        for (int t = 0; t < num_tracks_; t++) {
+            if (tracks_[t].id == id) return t;
+        }
+        return -1;
+    }
+
+    // New track with a registry id (owned) or an upstream one
+    int start_track(const DedupBox& box, uint64_t id, bool owned) {
+        int t = num_tracks_;
+        if (num_tracks_ == kMaxTracks) {
+            // Table full: replace the longest-missing track not seen this frame
+            t = -1;
+            for (int c = 0; c < num_tracks_; c++) {
+                if (tracks_[c].matched) continue;
+                if (t < 0 || tracks_[c].missed > tracks_[t].missed) t = c;
+            }
+            if (t < 0) return -1;
+            if (owned) registry_.forget(tracks_[t].id);
+        } else {
+            num_tracks_++;
+        }
+
+        Track& track = tracks_[t];
+        track.box = box;
+        track.id = owned ? registry_.new_track() : id;
+        track.missed = 0;
+        track.since_ocr = 0;
+        track.matched = true;
+        return t;
+    }
+
+    bool needs_ocr(Track& track, const DedupOptions& options) {
+        TrackRead read;
+        const bool has_read = registry_.read(track.id, read);
+        if (has_read && read.decided) return false;  // Plate emitted, further reads are wasted
+
+        const bool stable =
+            has_read && read.agreeing_reads >= options.stable_reads && read.confidence >= options.stable_confidence;
+
+        if (stable && ++track.since_ocr < options.reverify_interval) {
+            return false;
+        }
+        track.since_ocr = 0;
+        return true;
+    }
+
+    void expire(uint32_t max_missed, bool owned) {
+        for (int t = 0; t < num_tracks_;) {
+            Track& track = tracks_[t];
+            if (!track.matched && ++track.missed > max_missed) {
+                if (owned) registry_.forget(track.id);
+                track = tracks_[--num_tracks_];
+                continue;
+            }
+            t++;
+        }
+    }
+
+    TrackRegistry& registry_;
+    Track tracks_[kMaxTracks];
+    int num_tracks_ = 0;
+
+    std::vector<int> assignment_;
+    std::vector<Pair> pairs_;
+    uint64_t sent_ = 0;
+    uint64_t skipped_ = 0;
+};
+
+}  // namespace anpr
@@ -0,0 +1,164 @@
+/**
+ * Fixed-size buffer pool for OCR input crops.
+ *
+ * Every crop handed to the OCR hailonet lives in one slot of a preallocated
+ * arena. A slot goes back to the pool when the last reference to its buffer
+ * is dropped (hailonet releasing the frame), so the memory behind crops is
+ * bounded by slots * slot_bytes per pool. When all slots are in use, acquire()
+ * blocks the streaming thread for a bounded time (backpressure towards the
+ * source) and then gives up, and the crop is dropped.
+ *
+ * Pools register themselves under a name so occupancy can be read through
+ * the crop_pool_* C API of libplate_crop.so.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace anpr {
+
+/**
+ * Occupancy snapshot, laid out for ctypes.
+ */
+struct CropPoolStats {
+    char name[32];
+    uint32_t slots;
+    uint32_t in_use;
+    uint32_t peak_in_use;
+    uint32_t slot_bytes;
+    uint64_t acquired;  // successful acquisitions
+    uint64_t waited;    // acquisitions that had to wait for a free slot
+    uint64_t dropped;   // acquisitions that timed out
+};
+
+class CropBufferPool : public std::enable_shared_from_this<CropBufferPool> {
+public:
+    /**
+     * Create and register a pool.
+     *
+     * @param name: Label reported in stats (e.g. the streaming thread name)
+     */
+    static std::shared_ptr<CropBufferPool> create(const std::string& name, size_t slots, size_t slot_bytes) {
+        std::shared_ptr<CropBufferPool> pool(new CropBufferPool(name, slots, slot_bytes));
+        Registry& registry = registry_instance();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        registry.pools.erase(std::remove_if(registry.pools.begin(), registry.pools.end(),
+                                            [](const std::weak_ptr<CropBufferPool>& p) { return p.expired(); }),
+                             registry.pools.end());
+        registry.pools.push_back(pool);
+        return pool;
+    }
+
+    /**
+     * Take a free slot, waiting up to `wait` for one to be released.
+     *
+     * @return: The slot's buffer (returned to the pool when the last copy is
+     *          destroyed), or nullptr if the pool stayed exhausted
+     */
+    std::shared_ptr<uint8_t> acquire(std::chrono::milliseconds wait) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (free_.empty()) {
+            waited_++;
+            if (!available_.wait_for(lock, wait, [this] { return !free_.empty(); })) {
+                dropped_++;
+                return nullptr;
+            }
+        }
+
+        const uint32_t slot = free_.back();
+        free_.pop_back();
+        acquired_++;
+        const uint32_t in_use = static_cast<uint32_t>(num_slots_ - free_.size());
+        peak_in_use_ = std::max(peak_in_use_, in_use);
+        lock.unlock();
+
+        std::shared_ptr<CropBufferPool> self = shared_from_this();
+        return std::shared_ptr<uint8_t>(storage_.data() + slot * slot_bytes_,
+                                        [self, slot](uint8_t*) { self->release(slot); });
+    }
+
+    CropPoolStats stats() const {
+        CropPoolStats s{};
+        std::strncpy(s.name, name_.c_str(), sizeof(s.name) - 1);
+        std::lock_guard<std::mutex> lock(mutex_);
+        s.slots = static_cast<uint32_t>(num_slots_);
+        s.in_use = static_cast<uint32_t>(num_slots_ - free_.size());
+        s.peak_in_use = peak_in_use_;
+        s.slot_bytes = static_cast<uint32_t>(slot_bytes_);
+        s.acquired = acquired_;
+        s.waited = waited_;
+        s.dropped = dropped_;
+        return s;
+    }
+
+    size_t slot_bytes() const { return slot_bytes_; }
+
+    /**
+     * Stats of all live pools, in creation order.
+     */
+    static std::vector<CropPoolStats> all_stats() {
+        std::vector<std::shared_ptr<CropBufferPool>> pools;
+        {
+            Registry& registry = registry_instance();
+            std::lock_guard<std::mutex> lock(registry.mutex);
+            for (const auto& weak : registry.pools) {
+                if (auto pool = weak.lock()) pools.push_back(std::move(pool));
+            }
+        }
+
+        std::vector<CropPoolStats> stats;
+        stats.reserve(pools.size());
+        for (const auto& pool : pools) stats.push_back(pool->stats());
+        return stats;
+    }
+
+private:
+    CropBufferPool(const std::string& name, size_t slots, size_t slot_bytes)
+        : name_(name), num_slots_(slots), slot_bytes_(slot_bytes), storage_(slots * slot_bytes) {
+        free_.reserve(slots);
+        for (size_t i = slots; i-- > 0;) free_.push_back(static_cast<uint32_t>(i));
+    }
+
+    void release(uint32_t slot) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            free_.push_back(slot);
+        }
+        available_.notify_one();
+    }
+
+    struct Registry {
+        std::mutex mutex;
+        std::vector<std::weak_ptr<CropBufferPool>> pools;
+    };
+
+    static Registry& registry_instance() {
+        static Registry registry;
+        return registry;
+    }
+
+    const std::string name_;
+    const size_t num_slots_;
+    const size_t slot_bytes_;
+    std::vector<uint8_t> storage_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable available_;
+    std::vector<uint32_t> free_;
+    uint32_t peak_in_use_ = 0;
+    uint64_t acquired_ = 0;
+    uint64_t waited_ = 0;
+    uint64_t dropped_ = 0;
+};
+
+}  // namespace anpr
@@ -0,0 +1,239 @@
+/**
+ * Row-wise argmax kernels for CTC decoding.
+ *
+ * The OCR head emits one score row of num_classes entries per timestep.
+ * argmax_rows() reduces every row of a [rows, cols] block to the index and
+ * raw value of its maximum in a single pass, so a whole batch of plates
+ * ([N, timesteps, num_classes]) is handled by one call.
+ *
+ * Ties resolve to the lowest index, matching a strict '>' scalar scan.
+ * AVX2 (x86-64) and NEON (AArch64) kernels exist for float and uint8 rows,
+ * chosen at runtime like the candidate scan (ANPR_SIMD=scalar forces the
+ * scalar kernel). uint16 rows use the scalar kernel.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <type_traits>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <immintrin.h>
+#define ANPR_HAVE_AVX2_KERNEL 1
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#define ANPR_HAVE_NEON_KERNEL 1
+#endif
+
+namespace anpr {
+
+template <typename T, int FixedCols = 0>
+inline void argmax_rows_scalar(const T* data, size_t rows, int runtime_cols, uint8_t* idx, T* val) {
+    const int cols = FixedCols ? FixedCols : runtime_cols;
+    for (size_t r = 0; r < rows; r++) {
+        const T* row = data + r * cols;
+        int max_idx = 0;
+        T max_val = row[0];
+        for (int c = 1; c < cols; c++) {
+            if (row[c] > max_val) {
+                max_val = row[c];
+                max_idx = c;
+            }
+        }
+        idx[r] = static_cast<uint8_t>(max_idx);
+        val[r] = max_val;
+    }
+}
+
+// First index in row[0..cols) equal to `target`
+template <typename T>
+inline int first_index_of(const T* row, int cols, T target) {
+    for (int c = 0; c < cols; c++) {
+        if (row[c] == target) return c;
+    }
+    return 0;
+}
+
+#ifdef ANPR_HAVE_AVX2_KERNEL
+template <int FixedCols = 0>
+__attribute__((target("avx2")))
+inline void argmax_rows_avx2(const float* data, size_t rows, int runtime_cols, uint8_t* idx, float* val) {
+    const int cols = FixedCols ? FixedCols : runtime_cols;
+    if (cols < 8) {
+        argmax_rows_scalar<float, FixedCols>(data, rows, cols, idx, val);
+        return;
+    }
+
+    for (size_t r = 0; r < rows; r++) {
+        const float* row = data + r * cols;
+
+        // Vertical max over full vectors, the tail is covered by an overlapping load
+        __m256 vmax = _mm256_loadu_ps(row);
+        int c = 8;
+        for (; c + 8 <= cols; c += 8) {
+            vmax = _mm256_max_ps(vmax, _mm256_loadu_ps(row + c));
+        }
+        if (c < cols) {
+            vmax = _mm256_max_ps(vmax, _mm256_loadu_ps(row + cols - 8));
+        }
+
+        // Horizontal reduction
+        __m128 m = _mm_max_ps(_mm256_castps256_ps128(vmax), _mm256_extractf128_ps(vmax, 1));
+        m = _mm_max_ps(m, _mm_movehl_ps(m, m));
+        m = _mm_max_ss(m, _mm_shuffle_ps(m, m, 1));
+        const float best = _mm_cvtss_f32(m);
+
+        // Lowest index holding the maximum
+        const __m256 target = _mm256_set1_ps(best);
+        int found = -1;
+        for (c = 0; c + 8 <= cols && found < 0; c += 8) {
+            int bits = _mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(row + c), target, _CMP_EQ_OQ));
+            if (bits) found = c + __builtin_ctz(bits);
+        }
+        if (found < 0) found = c + first_index_of(row + c, cols - c, best);
+
+        idx[r] = static_cast<uint8_t>(found);
+        val[r] = best;
+    }
+}
+
+template <int FixedCols = 0>
+__attribute__((target("avx2")))
+inline void argmax_rows_avx2(const uint8_t* data, size_t rows, int runtime_cols, uint8_t* idx, uint8_t* val) {
+    const int cols = FixedCols ? FixedCols : runtime_cols;
+    if (cols < 32) {
+        argmax_rows_scalar<uint8_t, FixedCols>(data, rows, cols, idx, val);
+        return;
+    }
+
+    for (size_t r = 0; r < rows; r++) {
+        const uint8_t* row = data + r * cols;
+
+        __m256i vmax = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row));
+        int c = 32;
+        for (; c + 32 <= cols; c += 32) {
+            vmax = _mm256_max_epu8(vmax, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + c)));
+        }
+        if (c < cols) {
+            vmax = _mm256_max_epu8(vmax, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + cols - 32)));
+        }
+
+        __m128i m = _mm_max_epu8(_mm256_castsi256_si128(vmax), _mm256_extracti128_si256(vmax, 1));
+        m = _mm_max_epu8(m, _mm_srli_si128(m, 8));
+        m = _mm_max_epu8(m, _mm_srli_si128(m, 4));
+        m = _mm_max_epu8(m, _mm_srli_si128(m, 2));
+        m = _mm_max_epu8(m, _mm_srli_si128(m, 1));
+        const uint8_t best = static_cast<uint8_t>(_mm_cvtsi128_si32(m) & 0xff);
+
+        const __m256i target = _mm256_set1_epi8(static_cast<char>(best));
+        int found = -1;
+        for (c = 0; c + 32 <= cols && found < 0; c += 32) {
+            uint32_t bits = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(
+                _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + c)), target)));
+            if (bits) found = c + __builtin_ctz(bits);
+        }
+        if (found < 0) found = c + first_index_of(row + c, cols - c, best);
+
+        idx[r] = static_cast<uint8_t>(found);
+        val[r] = best;
+    }
+}
+#endif
+
+#ifdef ANPR_HAVE_NEON_KERNEL
+template <int FixedCols = 0>
+inline void argmax_rows_neon(const float* data, size_t rows, int runtime_cols, uint8_t* idx, float* val) {
+    const int cols = FixedCols ? FixedCols : runtime_cols;
+    if (cols < 4) {
+        argmax_rows_scalar<float, FixedCols>(data, rows, cols, idx, val);
+        return;
+    }
+
+    for (size_t r = 0; r < rows; r++) {
+        const float* row = data + r * cols;
+
+        float32x4_t vmax = vld1q_f32(row);
+        int c = 4;
+        for (; c + 4 <= cols; c += 4) {
+            vmax = vmaxq_f32(vmax, vld1q_f32(row + c));
+        }
+        if (c < cols) {
+            vmax = vmaxq_f32(vmax, vld1q_f32(row + cols - 4));
+        }
+        const float best = vmaxvq_f32(vmax);
+
+        idx[r] = static_cast<uint8_t>(first_index_of(row, cols, best));
+        val[r] = best;
+    }
+}
+
+template <int FixedCols = 0>
+inline void argmax_rows_neon(const uint8_t* data, size_t rows, int runtime_cols, uint8_t* idx, uint8_t* val) {
+    const int cols = FixedCols ? FixedCols : runtime_cols;
+    if (cols < 16) {
+        argmax_rows_scalar<uint8_t, FixedCols>(data, rows, cols, idx, val);
+        return;
+    }
+
+    for (size_t r = 0; r < rows; r++) {
+        const uint8_t* row = data + r * cols;
+
+        uint8x16_t vmax = vld1q_u8(row);
+        int c = 16;
+        for (; c + 16 <= cols; c += 16) {
+            vmax = vmaxq_u8(vmax, vld1q_u8(row + c));
+        }
+        if (c < cols) {
+            vmax = vmaxq_u8(vmax, vld1q_u8(row + cols - 16));
+        }
+        const uint8_t best = vmaxvq_u8(vmax);
+
+        idx[r] = static_cast<uint8_t>(first_index_of(row, cols, best));
+        val[r] = best;
+    }
+}
+#endif
+
+template <typename T>
+using ArgmaxRowsFn = void (*)(const T*, size_t, int, uint8_t*, T*);
+
+template <typename T, int FixedCols>
+inline ArgmaxRowsFn<T> resolve_argmax_rows() {
+    const char* forced = std::getenv("ANPR_SIMD");
+    if (forced && std::strcmp(forced, "scalar") == 0) {
+        return argmax_rows_scalar<T, FixedCols>;
+    }
+
+    if constexpr (std::is_same<T, float>::value || std::is_same<T, uint8_t>::value) {
+#ifdef ANPR_HAVE_AVX2_KERNEL
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) {
+            return static_cast<ArgmaxRowsFn<T>>(argmax_rows_avx2<FixedCols>);
+        }
+#endif
+#ifdef ANPR_HAVE_NEON_KERNEL
+        return static_cast<ArgmaxRowsFn<T>>(argmax_rows_neon<FixedCols>);
+#endif
+    }
+    return argmax_rows_scalar<T, FixedCols>;
+}
+
+/**
+ * Argmax of every row of a row-major [rows, cols] block (cols <= 256).
+ *
+ * With FixedCols != 0 the row width is a compile-time constant (and `cols`
+ * is ignored), so the kernels' inner loops unroll completely.
+ *
+ * @param idx: Receives the column index of each row's maximum
+ * @param val: Receives the raw maximum of each row
+ */
+template <typename T, int FixedCols = 0>
+inline void argmax_rows(const T* data, size_t rows, int cols, uint8_t* idx, T* val) {
+    static const ArgmaxRowsFn<T> kernel = resolve_argmax_rows<T, FixedCols>();
+    kernel(data, rows, cols, idx, val);
+}
+
+}  // namespace anpr
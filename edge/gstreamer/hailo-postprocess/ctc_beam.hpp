@@ -0,0 +1,294 @@
+/**
+ * CTC prefix beam search for plate OCR.
+ *
+ * Standard prefix beam search (blank / non-blank path probabilities per
+ * prefix) tuned for live streams:
+ *  - all beam storage is fixed-capacity and lives inside the decoder object
+ *    (keep one per thread), there is no heap allocation per timestep or call
+ *  - only the top few classes of each timestep are expanded
+ *  - timesteps where blank dominates skip expansion entirely
+ *  - an optional PlateGrammar drops prefixes that cannot become a valid plate
+ *
+ * Scores are expected to be per-timestep probabilities (softmax output);
+ * quantized rows are dequantized only for the expanded classes.
+ */
+
+#pragma once
+
+#include "plate_grammar.hpp"
+#include "plate_text.hpp"
+#include "quant.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace anpr {
+
+struct BeamSearchOptions {
+    int beam_width = 8;            // capped at kMaxBeamWidth
+    int classes_per_step = 6;      // non-blank classes expanded per timestep, capped at kMaxClassesPerStep
+    float min_char_prob = 1e-3f;   // classes below this are never expanded
+    float blank_skip_prob = 0.999f;  // timesteps with p(blank) >= this only extend with blank
+    const PlateGrammar* grammar = nullptr;
+};
+
+struct BeamSearchResult {
+    uint8_t symbols[kMaxPlateChars];
+    float char_confidences[kMaxPlateChars];
+    int length = 0;
+    float confidence = 0.0f;   // mean of char_confidences
+    bool found = false;        // false if no prefix satisfied the grammar
+};
+
+class CtcBeamSearch {
+public:
+    static constexpr int kMaxBeamWidth = 16;
+    static constexpr int kMaxClassesPerStep = 8;
+
+    /**
+     * Decode one [timesteps, num_classes] score block.
+     *
+     * @param blank: Index of the CTC blank class
+     */
+    template <typename T>
+    void decode(const T* data, int timesteps, int num_classes, int blank, const QuantInfo& quant,
+                const BeamSearchOptions& options, BeamSearchResult& result) {
+        const int beam_width = std::max(1, std::min(options.beam_width, kMaxBeamWidth));
+        const int classes_per_step = std::max(1, std::min(options.classes_per_step, kMaxClassesPerStep));
+        const PlateGrammar* grammar = options.grammar && options.grammar->enabled() ? options.grammar : nullptr;
+
+        num_beams_ = 1;
+        beams_[0] = Beam();
+        beams_[0].state = grammar ? grammar->start() : 0;
+        beams_[0].p_blank = 1.0f;
+
+        for (int t = 0; t < timesteps; t++) {
+            const T* row = data + t * num_classes;
+            const float p_blank = dequantize(row[blank], quant);
+
+            if (p_blank >= options.blank_skip_prob) {
+                step_blank_only(row, p_blank, quant);
+                continue;
+            }
+
+            int cls[kMaxClassesPerStep];
+            float prob[kMaxClassesPerStep];
+            const int n = top_classes(row, num_classes, blank, classes_per_step, options.min_char_prob,
+                                      quant, cls, prob);
+
+            step(p_blank, cls, prob, n, grammar, row, quant);
+            prune(beam_width);
+        }
+
+        finish(grammar, result);
+    }
+
+private:
+    struct Beam {
+        uint8_t symbols[kMaxPlateChars];
+        float char_conf[kMaxPlateChars];
+        uint64_t hash = kHashSeed;
+        float p_blank = 0.0f;
+        float p_non_blank = 0.0f;
+        int length = 0;
+        uint8_t state = 0;
+
+        float total() const { return p_blank + p_non_blank; }
+        int last() const { return length ? symbols[length - 1] : -1; }
+    };
+
+    static constexpr uint64_t kHashSeed = 1469598103934665603ull;
+    static constexpr int kMaxNext = kMaxBeamWidth * (kMaxClassesPerStep + 1);
+    static constexpr int kHashSlots = 512;  // power of two, > 2 * kMaxNext
+
+    static uint64_t extend_hash(uint64_t hash, int symbol) {
+        return (hash ^ static_cast<uint64_t>(symbol + 1)) * 1099511628211ull;
+    }
+
+    // Highest non-blank classes of a row above min_prob, compared on raw values
+    template <typename T>
+    static int top_classes(const T* row, int num_classes, int blank, int k, float min_prob,
+                           const QuantInfo& quant, int* cls, float* prob) {
+        T raw[kMaxClassesPerStep];
+        int n = 0;
+        for (int c = 0; c < num_classes; c++) {
+            if (c == blank) continue;
+            const T v = row[c];
+            if (n == k && !(v > raw[n - 1])) continue;
+
+            int pos = n < k ? n++ : k - 1;
+            while (pos > 0 && v > raw[pos - 1]) {
+                raw[pos] = raw[pos - 1];
+                cls[pos] = cls[pos - 1];
+                pos--;
+            }
+            raw[pos] = v;
+            cls[pos] = c;
+        }
+
+        int kept = 0;
+        for (int i = 0; i < n; i++) {
+            const float p = dequantize(raw[i], quant);
+            if (p < min_prob) break;
+            cls[kept] = cls[i];
+            prob[kept] = p;
+            kept++;
+        }
+        return kept;
+    }
+
+    // Blank-dominated timestep: prefixes stay, only blank and repeat-collapse paths
+    template <typename T>
+    void step_blank_only(const T* row, float p_blank, const QuantInfo& quant) {
+        float best = 0.0f;
+        for (int b = 0; b < num_beams_; b++) {
+            Beam& beam = beams_[b];
+            const float repeat = beam.length ? dequantize(row[beam.last()], quant) : 0.0f;
+            const float total = beam.total();
+            beam.p_non_blank = beam.p_non_blank * repeat;
+            beam.p_blank = total * p_blank;
+            best = std::max(best, beam.total());
+        }
+        normalize(beams_, num_beams_, best);
+    }
+
+    // Find or insert the prefix `parent + symbol` (symbol < 0: parent itself) in next_
+    Beam* next_entry(const Beam& parent, int symbol, uint8_t state) {
+        const uint64_t hash = symbol < 0 ? parent.hash : extend_hash(parent.hash, symbol);
+        const int length = parent.length + (symbol >= 0);
+
+        int slot = static_cast<int>(hash & (kHashSlots - 1));
+        while (slots_[slot] >= 0) {
+            Beam& cand = next_[slots_[slot]];
+            if (cand.hash == hash && cand.length == length &&
+                std::memcmp(cand.symbols, parent.symbols, parent.length) == 0 &&
+                (symbol < 0 || cand.symbols[length - 1] == symbol)) {
+                return &cand;
+            }
+            slot = (slot + 1) & (kHashSlots - 1);
+        }
+
+        if (num_next_ >= kMaxNext) return nullptr;
+
+        Beam& entry = next_[num_next_];
+        std::memcpy(entry.symbols, parent.symbols, parent.length);
+        std::memcpy(entry.char_conf, parent.char_conf, parent.length * sizeof(float));
+        if (symbol >= 0) {
+            entry.symbols[parent.length] = static_cast<uint8_t>(symbol);
+            entry.char_conf[parent.length] = 0.0f;
+        }
+        entry.length = length;
+        entry.hash = hash;
+        entry.state = state;
+        entry.p_blank = 0.0f;
+        entry.p_non_blank = 0.0f;
+        slots_[slot] = static_cast<int16_t>(num_next_++);
+        return &entry;
+    }
+
+    template <typename T>
+    void step(float p_blank, const int* cls, const float* prob, int n, const PlateGrammar* grammar,
+              const T* row, const QuantInfo& quant) {
+        num_next_ = 0;
+        std::fill(slots_, slots_ + kHashSlots, static_cast<int16_t>(-1));
+
+        for (int b = 0; b < num_beams_; b++) {
+            const Beam& beam = beams_[b];
+            const float total = beam.total();
+            const int last = beam.last();
+
+            // Same prefix: blank, or a repeat of the last symbol collapsing into it
+            Beam* same = next_entry(beam, -1, beam.state);
+            if (!same) continue;
+            same->p_blank += total * p_blank;
+            if (last >= 0) {
+                const float p_last = dequantize(row[last], quant);
+                same->p_non_blank += beam.p_non_blank * p_last;
+                same->char_conf[beam.length - 1] = std::max(same->char_conf[beam.length - 1], p_last);
+            }
+
+            if (beam.length >= kMaxPlateChars) continue;
+
+            for (int i = 0; i < n; i++) {
+                const int c = cls[i];
+                uint8_t state = 0;
+                if (grammar) {
+                    state = grammar->step(beam.state, c);
+                    if (state == PlateGrammar::kDead) continue;
+                }
+
+                // A repeated symbol only starts a new character after a blank
+                const float p_ext = c == last ? beam.p_blank * prob[i] : total * prob[i];
+                if (p_ext <= 0.0f) continue;
+
+                Beam* ext = next_entry(beam, c, state);
+                if (!ext) continue;
+                ext->p_non_blank += p_ext;
+                ext->char_conf[beam.length] = std::max(ext->char_conf[beam.length], prob[i]);
+            }
+        }
+    }
+
+    void prune(int beam_width) {
+        int order[kMaxNext];
+        for (int i = 0; i < num_next_; i++) order[i] = i;
+
+        const int keep = std::min(beam_width, num_next_);
+        std::partial_sort(order, order + keep, order + num_next_, [this](int a, int b) {
+            return next_[a].total() > next_[b].total();
+        });
+
+        for (int i = 0; i < keep; i++) {
+            beams_[i] = next_[order[i]];
+        }
+        num_beams_ = keep;
+
+        normalize(beams_, num_beams_, keep ? beams_[0].total() : 0.0f);
+    }
+
+    // Rescale so the best beam has total 1; keeps long sequences out of float underflow
+    static void normalize(Beam* beams, int count, float best) {
+        if (!(best > 0.0f)) return;
+        const float inv = 1.0f / best;
+        for (int i = 0; i < count; i++) {
+            beams[i].p_blank *= inv;
+            beams[i].p_non_blank *= inv;
+        }
+    }
+
+    void finish(const PlateGrammar* grammar, BeamSearchResult& result) const {
+        result.found = false;
+        result.length = 0;
+        result.confidence = 0.0f;
+
+        int best = -1;
+        for (int b = 0; b < num_beams_; b++) {
+            if (grammar && !grammar->accepting(beams_[b].state)) continue;
+            if (best < 0 || beams_[b].total() > beams_[best].total()) best = b;
+        }
+        if (best < 0) return;
+
+        const Beam& beam = beams_[best];
+        float sum = 0.0f;
+        for (int i = 0; i < beam.length; i++) {
+            result.symbols[i] = beam.symbols[i];
+            result.char_confidences[i] = beam.char_conf[i];
+            sum += beam.char_conf[i];
+        }
+        result.length = beam.length;
+        result.confidence = beam.length ? sum / beam.length : 0.0f;
+        result.found = true;
+    }
+
+    Beam beams_[kMaxBeamWidth];
+    int num_beams_ = 0;
+
+    Beam next_[kMaxNext];
+    int num_next_ = 0;
+    int16_t slots_[kHashSlots];
+};
+
+}  // namespace anpr
@@ -0,0 +1,260 @@
+/**
+ * Detection output decoding, independent of the Hailo types.
+ *
+ * Threshold scan, box decoding, lane mosaic remapping and NMS of one
+ * detection output tensor, shared by the plate_detection filter and the
+ * offline benchmark (bench/bench_postprocess.cpp), so both run exactly the
+ * same code on a tensor.
+ *
+ * Fast mode, for cameras that only ever need the few strongest plates (e.g.
+ * barrier lanes), trims the work between the scan and NMS: candidates of
+ * implausible plate geometry are dropped, and a bounded heap keeps only the
+ * top_k by confidence, so only those get their boxes decoded and enter NMS.
+ * max_plates caps the boxes per frame in either mode.
+ */
+
+#pragma once
+
+#include "candidate_scan.hpp"
+#include "lane_tiles.hpp"
+#include "nms.hpp"
+#include "quant.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace anpr {
+
+/**
+ * Shape of the detection output tensor.
+ */
+struct AnchorGrid {
+    int num_anchors;   // e.g., 8400
+    int stride;        // channels per anchor, e.g., 84 or 5
+    bool channel_major;
+};
+
+/**
+ * Grid of a [height, width] output tensor; the layout follows the longer axis.
+ */
+inline AnchorGrid anchor_grid(int height, int width) {
+    AnchorGrid grid;
+    grid.channel_major = infer_layout(height, width) == TensorLayout::ChannelMajor;
+    grid.num_anchors = grid.channel_major ? width : height;
+    grid.stride = grid.channel_major ? height : width;
+    return grid;
+}
+
+struct DetectionOptions {
+    float confidence_threshold = 0.5f;
+    float nms_threshold = 0.45f;
+
+    // Fast mode: only the top_k candidates by confidence get decoded (0 = all)
+    size_t top_k = 0;
+    // Plausible plate geometry in normalized network input coordinates, 0 = no limit
+    float min_width = 0.0f;
+    float min_height = 0.0f;
+    float min_aspect = 0.0f;  // width / height
+    float max_aspect = 0.0f;
+    // At most this many boxes per frame, the strongest after NMS (0 = no cap)
+    size_t max_plates = 0;
+
+    bool filters_geometry() const {
+        return min_width > 0.0f || min_height > 0.0f || min_aspect > 0.0f || max_aspect > 0.0f;
+    }
+
+    bool plausible(float width, float height) const {
+        return width >= min_width && height >= min_height && width >= min_aspect * height &&
+               (max_aspect <= 0.0f || width <= max_aspect * height);
+    }
+};
+
+/**
+ * Candidate ranked by the top-K heap.
+ */
+struct ScoredAnchor {
+    float confidence;
+    uint32_t anchor;
+};
+
+// Higher confidence first, ties to the earlier anchor (as NMS breaks them)
+inline bool stronger(const ScoredAnchor& a, const ScoredAnchor& b) {
+    return a.confidence > b.confidence || (a.confidence == b.confidence && a.anchor < b.anchor);
+}
+
+/**
+ * Fast mode prefilter of the scanned candidate indices, in place.
+ *
+ * Drops candidates of implausible geometry, then keeps the top_k strongest
+ * in a bounded heap whose top is the weakest kept candidate: a candidate
+ * that does not beat it is skipped after reading its confidence alone.
+ *
+ * @param candidates: Anchor indices over the threshold, ascending
+ * @return: Number of indices kept, still ascending, so the boxes reach NMS
+ *          in scan order and its tie-breaking matches full mode
+ */
+template <typename T>
+inline size_t prefilter_candidates(const T* data, const AnchorGrid& grid, const QuantInfo& quant,
+                                   const DetectionOptions& options, uint32_t* candidates, size_t count) {
+    const int n = grid.num_anchors;
+    const int stride = grid.stride;
+    const bool geometry = options.filters_geometry();
+    auto channel = [&](int c, uint32_t i) { return grid.channel_major ? data[c * n + i] : data[i * stride + c]; };
+
+    // Heap reused across frames on this streaming thread
+    static thread_local std::vector<ScoredAnchor> heap;
+    heap.clear();
+
+    size_t kept = 0;
+    for (size_t k = 0; k < count; k++) {
+        const uint32_t i = candidates[k];
+
+        ScoredAnchor scored{0.0f, i};
+        if (options.top_k) {
+            scored.confidence = dequantize(channel(4, i), quant);
+            if (heap.size() == options.top_k && !stronger(scored, heap.front())) continue;
+        }
+        if (geometry && !options.plausible(dequantize(channel(2, i), quant), dequantize(channel(3, i), quant))) {
+            continue;
+        }
+
+        if (!options.top_k) {
+            candidates[kept++] = i;
+            continue;
+        }
+        if (heap.size() == options.top_k) {
+            std::pop_heap(heap.begin(), heap.end(), stronger);
+            heap.back() = scored;
+        } else {
+            heap.push_back(scored);
+        }
+        std::push_heap(heap.begin(), heap.end(), stronger);
+    }
+
+    if (!options.top_k) return kept;
+    for (const ScoredAnchor& scored : heap) candidates[kept++] = scored.anchor;
+    std::sort(candidates, candidates + kept);
+    return kept;
+}
+
+/**
+ * Threshold scan and box decoding for one element type.
+ *
+ * For quantized tensors the threshold is converted into the quantized domain,
+ * the scan compares raw integers and only the surviving anchors are
+ * dequantized.
+ */
+template <typename T>
+inline void decode_candidates(const T* data, const AnchorGrid& grid, const QuantInfo& quant,
+                              const DetectionOptions& options, std::vector<Detection>& out) {
+    T threshold;
+    if (!quantize_threshold<T>(options.confidence_threshold, quant, threshold)) {
+        return;  // No representable confidence reaches the threshold
+    }
+
+    const int n = grid.num_anchors;
+    const int stride = grid.stride;
+
+    // Candidate index buffer, reused across frames on this streaming thread
+    static thread_local std::vector<uint32_t> candidates;
+    if (candidates.size() < static_cast<size_t>(n)) {
+        candidates.resize(n);
+    }
+
+    // Threshold scan: contiguous row read for channel-major tensors
+    size_t num_candidates;
+    if (grid.channel_major) {
+        num_candidates = select_candidates<T>(data + 4 * n, n, threshold, candidates.data());
+    } else {
+        num_candidates = select_candidates_strided<T>(data + 4, n, stride, threshold, candidates.data());
+    }
+
+    if (options.top_k || options.filters_geometry()) {
+        num_candidates = prefilter_candidates<T>(data, grid, quant, options, candidates.data(), num_candidates);
+    }
+
+    out.reserve(num_candidates);
+
+    for (size_t k = 0; k < num_candidates; k++) {
+        const int i = static_cast<int>(candidates[k]);
+
+        // Extract bbox coordinates (center x, center y, width, height)
+        T raw[5];
+        for (int c = 0; c < 5; c++) {
+            raw[c] = grid.channel_major ? data[c * n + i] : data[i * stride + c];
+        }
+
+        float cx = dequantize(raw[0], quant);
+        float cy = dequantize(raw[1], quant);
+        float w = dequantize(raw[2], quant);
+        float h = dequantize(raw[3], quant);
+        float conf = dequantize(raw[4], quant);  // objectness * class score
+
+        Detection det;
+        det.x = cx - w / 2.0f;
+        det.y = cy - h / 2.0f;
+        det.width = w;
+        det.height = h;
+        det.confidence = conf;
+        det.class_id = 0;  // license_plate
+
+        out.push_back(det);
+    }
+}
+
+/**
+ * Decode one detection output tensor into NMS-filtered boxes.
+ *
+ * @param lanes: Tile layout when the input was a lane mosaic (boxes are
+ *               mapped back to the frame, boxes on the padding dropped),
+ *               nullptr otherwise
+ * @param raw: Scratch for the candidates, holds them on return
+ * @param out: Receives the boxes surviving NMS
+ * @return: Number of candidates decoded: over the confidence threshold, and
+ *          in fast mode also past the prefilter
+ */
+inline size_t decode_detections(const void* data, TensorDType dtype, const AnchorGrid& grid, const QuantInfo& quant,
+                                const LaneLayout* lanes, const DetectionOptions& options,
+                                std::vector<Detection>& raw, std::vector<Detection>& out) {
+    raw.clear();
+    switch (dtype) {
+        case TensorDType::UInt8:
+            decode_candidates(static_cast<const uint8_t*>(data), grid, quant, options, raw);
+            break;
+        case TensorDType::UInt16:
+            decode_candidates(static_cast<const uint16_t*>(data), grid, quant, options, raw);
+            break;
+        default:
+            decode_candidates(static_cast<const float*>(data), grid, QuantInfo{}, options, raw);
+            break;
+    }
+
+    const size_t num_candidates = raw.size();
+
+    // Lane mosaic: back to frame coordinates
+    if (lanes) {
+        size_t kept = 0;
+        for (size_t i = 0; i < raw.size(); i++) {
+            const Detection det = raw[i];
+            NormRect frame_box;
+            if (!lanes->to_frame(NormRect{det.x, det.y, det.width, det.height}, frame_box)) continue;
+            Detection& mapped = raw[kept++];
+            mapped = det;
+            mapped.x = frame_box.x;
+            mapped.y = frame_box.y;
+            mapped.width = frame_box.width;
+            mapped.height = frame_box.height;
+        }
+        raw.resize(kept);
+    }
+
+    NmsOptions nms_options;
+    nms_options.iou_threshold = options.nms_threshold;
+    nms_options.max_output = options.max_plates;
+    thread_nms_engine().run(raw.data(), raw.size(), nms_options, out);
+    return num_candidates;
+}
+
+}  // namespace anpr
@@ -0,0 +1,83 @@
+/**
+ * Shared plate event rings (libanpr_core.so), see event_ring.hpp.
+ */
+
+#include "event_ring.hpp"
+
+namespace anpr {
+
+EventRings& EventRings::instance() {
+    static EventRings rings;
+    return rings;
+}
+
+PlateEventRing* EventRings::ring(const std::string& name) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (int i = 0; i < num_entries_; i++) {
+        if (name.compare(0, kMaxNameLength, entries_[i].name) == 0) return entries_[i].ring.get();
+    }
+    if (num_entries_ == kMaxRings) return nullptr;
+
+    Entry& entry = entries_[num_entries_++];
+    std::strncpy(entry.name, name.c_str(), kMaxNameLength);
+    entry.ring.reset(new PlateEventRing(kCapacity));
+    return entry.ring.get();
+}
+
+size_t EventRings::drain(const std::string& prefix, PlateEventRecord* out, size_t max_records) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t count = 0;
+    for (int i = 0; i < num_entries_ && count < max_records; i++) {
+        if (std::strncmp(entries_[i].name, prefix.c_str(), prefix.size()) != 0) continue;
+        count += entries_[i].ring->pop(out + count, max_records - count);
+    }
+    return count;
+}
+
+std::vector<EventRingStats> EventRings::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<EventRingStats> stats(num_entries_);
+    for (int i = 0; i < num_entries_; i++) {
+        const PlateEventRing& ring = *entries_[i].ring;
+        EventRingStats& s = stats[i];
+        std::memset(&s, 0, sizeof(s));
+        std::memcpy(s.name, entries_[i].name, sizeof(entries_[i].name));
+        s.capacity = static_cast<uint32_t>(ring.capacity());
+        s.size = static_cast<uint32_t>(ring.size());
+        s.published = ring.published();
+        s.dropped = ring.dropped();
+        s.drained = ring.drained();
+    }
+    return stats;
+}
+
+}  // namespace anpr
+
+/**
+ * Take up to `max_records` plate events of the rings under `prefix`
+ * (e.g. "cam3_"), oldest first per ring.
+ *
+ * @return: Number of records written to `out`
+ */
+extern "C" size_t event_ring_drain(const char* prefix, anpr::PlateEventRecord* out, size_t max_records) {
+    return anpr::EventRings::instance().drain(prefix ? prefix : "", out, max_records);
+}
+
+/**
+ * Number of event rings (one per producing streaming thread).
+ */
+extern "C" size_t event_ring_count() {
+    return anpr::EventRings::instance().stats().size();
+}
+
+/**
+ * Copy the counters of up to `max_rings` rings into `out`.
+ *
+ * @return: Number of entries written
+ */
+extern "C" size_t event_ring_stats(anpr::EventRingStats* out, size_t max_rings) {
+    const std::vector<anpr::EventRingStats> stats = anpr::EventRings::instance().stats();
+    const size_t count = std::min(max_rings, stats.size());
+    std::copy(stats.begin(), stats.begin() + count, out);
+    return count;
+}
@@ -0,0 +1,242 @@
+/**
+ * Plate event records handed from the streaming threads to Python.
+ *
+ * The OCR filter (plate reads) and the tracker (track events, zone crossings)
+ * publish fixed size PlateEventRecords into a lock-free single-producer/single-consumer
+ * ring; the Python pipeline drains them in batches from its own thread
+ * through the event_ring_* C API of libanpr_core.so. Publishing is a copy
+ * and two atomic stores, so the streaming thread never waits on Python: when
+ * the consumer falls behind, new records are dropped and counted.
+ *
+ * There is one ring per producer thread, named after the thread
+ * ("cam3_ocr:src"), so every ring has exactly one producer; the consumer of a
+ * pipeline drains all rings under its element prefix ("cam3_"). Rings live
+ * for the whole process, so a restarted pipeline picks up its rings again;
+ * a producer looks its ring up again when its thread is renamed
+ * (thread_name.hpp), so a pooled thread reused by another camera's
+ * pipeline publishes into that camera's ring.
+ */
+
+#pragma once
+
+#include "plate_text.hpp"
+#include "thread_name.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace anpr {
+
+enum class PlateEventKind : uint32_t {
+    Read = 0,          // accepted OCR read of one crop
+    PlateDecided = 1,  // a track's plate vote became decisive
+    TrackEnded = 2,    // a confirmed track disappeared, with its final vote
+    ZoneEntered = 3,   // a track's center moved into a zone
+    ZoneExited = 4,    // a track's center left a zone
+};
+
+/**
+ * One plate event, laid out for ctypes.
+ */
+struct PlateEventRecord {
+    uint64_t timestamp_ns;       // wall clock (CLOCK_REALTIME) at publish time
+    uint64_t track_id;           // 0 if the detection has no track
+    uint64_t trace_frame;        // frame_trace.hpp id of the event's frame, 0 if not traced
+    uint64_t published_ns;       // monotonic (CLOCK_MONOTONIC) at publish time, for latency tracing
+    int32_t stream_index;        // i of stream id "sink_<i>", -1 in single-stream pipelines
+    uint32_t kind;               // PlateEventKind
+    float bbox[4];               // normalized x, y, width, height
+    float detection_confidence;
+    float ocr_confidence;        // read confidence, or the consensus text's mean
+    uint32_t votes;              // reads agreeing with the consensus at every position (track events)
+    uint32_t total_reads;
+    int32_t zone;                // index in the stream's zone list (zone events), -1 otherwise
+    char text[kMaxPlateChars + 1];
+};
+
+/**
+ * Ring occupancy and counters, laid out for ctypes.
+ */
+struct EventRingStats {
+    char name[32];
+    uint32_t capacity;
+    uint32_t size;
+    uint64_t published;  // records accepted
+    uint64_t dropped;    // records rejected because the ring was full
+    uint64_t drained;    // records taken by the consumer
+};
+
+/**
+ * Bounded lock-free SPSC queue of trivially copyable items.
+ *
+ * push() must only be called from one thread and pop() from one (other)
+ * thread. Head and tail are free-running counters; the producer caches the
+ * consumer's head and the consumer the producer's tail, so the shared cache
+ * lines are only read when the cached value says the ring looks full/empty.
+ */
+template <typename T>
+class SpscRing {
+public:
+    /**
+     * @param capacity: Rounded up to a power of two
+     */
+    explicit SpscRing(size_t capacity) {
+        size_t rounded = 1;
+        while (rounded < capacity) rounded <<= 1;
+        mask_ = rounded - 1;
+        slots_.reset(new T[rounded]);
+    }
+
+    /**
+     * Producer: append an item.
+     *
+     * @return: false (and counted as dropped) if the ring is full
+     */
+    bool push(const T& item) {
+        const uint64_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - cached_head_ > mask_) {
+            cached_head_ = head_.load(std::memory_order_acquire);
+            if (tail - cached_head_ > mask_) {
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+        }
+        slots_[tail & mask_] = item;
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Consumer: take up to `max_items` items, oldest first.
+     *
+     * @return: Number of items written to `out`
+     */
+    size_t pop(T* out, size_t max_items) {
+        const uint64_t head = head_.load(std::memory_order_relaxed);
+        if (cached_tail_ - head < max_items) cached_tail_ = tail_.load(std::memory_order_acquire);
+
+        const size_t count = static_cast<size_t>(std::min<uint64_t>(cached_tail_ - head, max_items));
+        for (size_t i = 0; i < count; i++) out[i] = slots_[(head + i) & mask_];
+        head_.store(head + count, std::memory_order_release);
+        return count;
+    }
+
+    size_t capacity() const { return mask_ + 1; }
+
+    // Approximate when read by a third thread
+    size_t size() const {
+        const uint64_t head = head_.load(std::memory_order_acquire);
+        return static_cast<size_t>(tail_.load(std::memory_order_acquire) - head);
+    }
+    uint64_t published() const { return tail_.load(std::memory_order_acquire); }
+    uint64_t drained() const { return head_.load(std::memory_order_acquire); }
+    uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+private:
+    std::unique_ptr<T[]> slots_;
+    size_t mask_ = 0;
+
+    // Consumer side
+    alignas(64) std::atomic<uint64_t> head_{0};
+    uint64_t cached_tail_ = 0;
+
+    // Producer side
+    alignas(64) std::atomic<uint64_t> tail_{0};
+    uint64_t cached_head_ = 0;
+    std::atomic<uint64_t> dropped_{0};
+};
+
+using PlateEventRing = SpscRing<PlateEventRecord>;
+
+/**
+ * Process-wide rings by name (libanpr_core.so, so all plugins share them).
+ */
+class EventRings {
+public:
+    static constexpr int kMaxRings = 64;
+    static constexpr size_t kMaxNameLength = 31;
+    static constexpr size_t kCapacity = 1024;  // records per ring
+
+    static EventRings& instance();
+
+    /**
+     * Ring registered under `name`, created on first use.
+     *
+     * @return: nullptr if the ring table is full
+     */
+    PlateEventRing* ring(const std::string& name);
+
+    /**
+     * Take up to `max_records` records from the rings whose name starts
+     * with `prefix`. Consumers are serialized on the table lock (producers
+     * never take it), so any thread may drain.
+     *
+     * @return: Number of records written to `out`
+     */
+    size_t drain(const std::string& prefix, PlateEventRecord* out, size_t max_records);
+
+    std::vector<EventRingStats> stats() const;
+
+private:
+    struct Entry {
+        char name[kMaxNameLength + 1] = {};
+        std::unique_ptr<PlateEventRing> ring;
+    };
+
+    EventRings() = default;
+
+    mutable std::mutex mutex_;
+    Entry entries_[kMaxRings];
+    int num_entries_ = 0;
+};
+
+/**
+ * Ring of the calling streaming thread under its current name, or nullptr
+ * if none is available.
+ */
+inline PlateEventRing* thread_event_ring() {
+    static thread_local ThreadNameCache<PlateEventRing*> ring;
+    return ring.get("events", [](const char* name) { return EventRings::instance().ring(name); });
+}
+
+/**
+ * Stream index of a hailoroundrobin stream id ("sink_2" -> 2), -1 otherwise.
+ */
+inline int32_t stream_index(const std::string& stream_id) {
+    const size_t underscore = stream_id.rfind('_');
+    if (underscore == std::string::npos || underscore + 1 == stream_id.size()) return -1;
+    char* end = nullptr;
+    const long index = std::strtol(stream_id.c_str() + underscore + 1, &end, 10);
+    return *end == '\0' && index >= 0 ? static_cast<int32_t>(index) : -1;
+}
+
+/**
+ * Record with the common fields filled in and the text copied (truncated).
+ */
+inline PlateEventRecord make_event_record(PlateEventKind kind, const std::string& stream_id, uint64_t track_id,
+                                          const char* text, size_t length) {
+    PlateEventRecord record;
+    std::memset(&record, 0, sizeof(record));
+    timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    record.timestamp_ns = static_cast<uint64_t>(now.tv_sec) * 1000000000ull + static_cast<uint64_t>(now.tv_nsec);
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    record.published_ns = static_cast<uint64_t>(now.tv_sec) * 1000000000ull + static_cast<uint64_t>(now.tv_nsec);
+    record.track_id = track_id;
+    record.stream_index = stream_index(stream_id);
+    record.kind = static_cast<uint32_t>(kind);
+    record.zone = -1;
+    std::memcpy(record.text, text, std::min<size_t>(length, kMaxPlateChars));
+    return record;
+}
+
+}  // namespace anpr
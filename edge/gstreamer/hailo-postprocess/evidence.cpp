@@ -0,0 +1,225 @@
+/**
+ * Shared evidence encoder (libanpr_core.so), see evidence.hpp.
+ */
+
+#include "evidence.hpp"
+
+#include <pthread.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#ifdef ANPR_HAVE_JPEG
+#include <csetjmp>
+#include <jpeglib.h>
+#endif
+
+namespace anpr {
+
+#ifdef ANPR_HAVE_JPEG
+
+namespace {
+
+// libjpeg reports errors through error_exit, which must not return
+struct JpegError {
+    jpeg_error_mgr mgr;
+    jmp_buf jump;
+    unsigned char* buffer = nullptr;  // kept out of registers across longjmp
+    unsigned long size = 0;
+};
+
+void on_jpeg_error(j_common_ptr cinfo) {
+    std::longjmp(reinterpret_cast<JpegError*>(cinfo->err)->jump, 1);
+}
+
+}  // namespace
+
+bool encode_jpeg(const uint8_t* rgb, int width, int height, size_t stride, int quality, std::vector<uint8_t>& out) {
+    if (!rgb || width <= 0 || height <= 0) return false;
+
+    jpeg_compress_struct cinfo;
+    JpegError error;
+    cinfo.err = jpeg_std_error(&error.mgr);
+    error.mgr.error_exit = on_jpeg_error;
+    if (setjmp(error.jump)) {
+        jpeg_destroy_compress(&cinfo);
+        std::free(error.buffer);
+        return false;
+    }
+
+    jpeg_create_compress(&cinfo);
+    jpeg_mem_dest(&cinfo, &error.buffer, &error.size);
+    cinfo.image_width = static_cast<JDIMENSION>(width);
+    cinfo.image_height = static_cast<JDIMENSION>(height);
+    cinfo.input_components = 3;
+    cinfo.in_color_space = JCS_RGB;
+    jpeg_set_defaults(&cinfo);
+    jpeg_set_quality(&cinfo, std::min(std::max(quality, 1), 100), TRUE);
+    cinfo.dct_method = JDCT_IFAST;
+
+    jpeg_start_compress(&cinfo, TRUE);
+    while (cinfo.next_scanline < cinfo.image_height) {
+        JSAMPROW row = const_cast<JSAMPROW>(rgb + static_cast<size_t>(cinfo.next_scanline) * stride);
+        jpeg_write_scanlines(&cinfo, &row, 1);
+    }
+    jpeg_finish_compress(&cinfo);
+
+    out.assign(error.buffer, error.buffer + error.size);
+    jpeg_destroy_compress(&cinfo);
+    std::free(error.buffer);
+    return true;
+}
+
+bool EvidenceEncoder::available() {
+    return true;
+}
+
+#else
+
+bool encode_jpeg(const uint8_t*, int, int, size_t, int, std::vector<uint8_t>&) {
+    return false;
+}
+
+bool EvidenceEncoder::available() {
+    return false;
+}
+
+#endif
+
+EvidenceEncoder& EvidenceEncoder::instance() {
+    static EvidenceEncoder encoder;
+    return encoder;
+}
+
+EvidenceEncoder::EvidenceEncoder() {
+    for (int i = 0; i < kJobs; i++) {
+        jobs_.emplace_back(new Job());
+        free_.push_back(jobs_.back().get());
+    }
+}
+
+EvidenceEncoder::~EvidenceEncoder() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    wake_.notify_all();
+    if (worker_.joinable()) worker_.join();
+}
+
+EvidenceEncoder::Job* EvidenceEncoder::acquire() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (free_.empty()) {
+        dropped_++;
+        return nullptr;
+    }
+    Job* job = free_.back();
+    free_.pop_back();
+    return job;
+}
+
+void EvidenceEncoder::submit(Job* job) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!worker_.joinable()) worker_ = std::thread(&EvidenceEncoder::worker_loop, this);
+        queue_.push_back(job);
+        submitted_++;
+    }
+    wake_.notify_one();
+}
+
+void EvidenceEncoder::release(Job* job) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    free_.push_back(job);
+}
+
+int EvidenceEncoder::pop(const std::string& prefix, EvidenceInfo& info, uint8_t* buffer, size_t capacity) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = std::find_if(ready_.begin(), ready_.end(), [&](const Job* job) {
+        return std::strncmp(job->info.source, prefix.c_str(), prefix.size()) == 0;
+    });
+    if (it == ready_.end()) return 0;
+
+    Job* job = *it;
+    info = job->info;
+    if (capacity < job->plate_jpeg.size() + job->frame_jpeg.size()) return -1;
+
+    std::memcpy(buffer, job->plate_jpeg.data(), job->plate_jpeg.size());
+    std::memcpy(buffer + job->plate_jpeg.size(), job->frame_jpeg.data(), job->frame_jpeg.size());
+    ready_.erase(it);
+    free_.push_back(job);
+    popped_++;
+    return 1;
+}
+
+EvidenceStats EvidenceEncoder::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    EvidenceStats stats = {};
+    stats.available = available() ? 1 : 0;
+    stats.jobs = static_cast<uint32_t>(jobs_.size());
+    stats.queued = static_cast<uint32_t>(queue_.size()) + encoding_;
+    stats.ready = static_cast<uint32_t>(ready_.size());
+    stats.submitted = submitted_;
+    stats.encoded = encoded_;
+    stats.dropped = dropped_;
+    stats.failed = failed_;
+    stats.popped = popped_;
+    stats.encode_ns = encode_ns_;
+    return stats;
+}
+
+void EvidenceEncoder::worker_loop() {
+    pthread_setname_np(pthread_self(), "anpr_evidence");
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        wake_.wait(lock, [&] { return stop_ || !queue_.empty(); });
+        if (stop_) return;
+
+        Job* job = queue_.front();
+        queue_.pop_front();
+        encoding_++;
+        lock.unlock();
+
+        const auto start = std::chrono::steady_clock::now();
+        const EvidenceInfo& info = job->info;
+        const bool ok =
+            encode_jpeg(job->plate_rgb.data(), static_cast<int>(info.plate_width), static_cast<int>(info.plate_height),
+                        static_cast<size_t>(info.plate_width) * 3, job->quality, job->plate_jpeg) &&
+            encode_jpeg(job->frame_rgb.data(), static_cast<int>(info.frame_width), static_cast<int>(info.frame_height),
+                        static_cast<size_t>(info.frame_width) * 3, job->quality, job->frame_jpeg);
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+
+        lock.lock();
+        encoding_--;
+        encode_ns_ += static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+        if (ok) {
+            job->info.plate_bytes = static_cast<uint32_t>(job->plate_jpeg.size());
+            job->info.frame_bytes = static_cast<uint32_t>(job->frame_jpeg.size());
+            ready_.push_back(job);
+            encoded_++;
+        } else {
+            free_.push_back(job);
+            failed_++;
+        }
+    }
+}
+
+}  // namespace anpr
+
+/**
+ * Take the oldest finished evidence of the pipeline under `prefix`
+ * (e.g. "cam3_"); the plate JPEG then the frame JPEG go to `buffer`.
+ *
+ * @return: 1 if copied, 0 if none is ready, -1 if `capacity` is too small
+ *          (`info` holds the sizes, the evidence stays queued)
+ */
+extern "C" int evidence_pop(const char* prefix, anpr::EvidenceInfo* info, uint8_t* buffer, size_t capacity) {
+    return anpr::EvidenceEncoder::instance().pop(prefix ? prefix : "", *info, buffer, capacity);
+}
+
+extern "C" void evidence_stats(anpr::EvidenceStats* out) {
+    *out = anpr::EvidenceEncoder::instance().stats();
+}
@@ -0,0 +1,152 @@
+/**
+ * Evidence snapshots (plate crop + context frame) for track-final events.
+ *
+ * When plate_tracker decides a track's plate, crop_plates copies the plate
+ * region (at up to its native resolution) and a downscaled frame out of that
+ * same frame into an evidence job and hands it to a background thread, which
+ * JPEG-encodes both (libjpeg, SIMD-accelerated when it is libjpeg-turbo).
+ * The Python pipeline pops the finished JPEGs through evidence_pop() of
+ * libanpr_core.so and attaches them to the track's event, so exported events
+ * carry compressed evidence without any image work in Python or on the
+ * streaming thread beyond two resizes per track.
+ *
+ * Jobs come from a fixed pool shared by queued, encoding and unread
+ * evidence, which bounds the memory and keeps the streaming thread from ever
+ * waiting: with no free job the snapshot is dropped and counted. Finished
+ * evidence is labelled with the producing thread's name ("cam3_crop:src"),
+ * so each pipeline pops its own under its element prefix like the event
+ * rings (event_ring.hpp).
+ */
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace anpr {
+
+/**
+ * Finished evidence, laid out for ctypes. evidence_pop() writes the plate
+ * JPEG followed by the frame JPEG into the caller's buffer.
+ */
+struct EvidenceInfo {
+    char source[32];          // producing streaming thread
+    uint64_t timestamp_ns;    // wall clock (CLOCK_REALTIME) of the frame
+    uint64_t track_id;
+    int32_t stream_index;     // i of stream id "sink_<i>", -1 in single-stream pipelines
+    uint32_t plate_width;
+    uint32_t plate_height;
+    uint32_t frame_width;
+    uint32_t frame_height;
+    uint32_t plate_bytes;     // JPEG sizes
+    uint32_t frame_bytes;
+};
+
+/**
+ * Encoder counters, laid out for ctypes.
+ */
+struct EvidenceStats {
+    uint32_t available;  // 1 if built with a JPEG encoder
+    uint32_t jobs;       // pool size
+    uint32_t queued;     // waiting for or in encoding
+    uint32_t ready;      // encoded, not popped yet
+    uint64_t submitted;
+    uint64_t encoded;
+    uint64_t dropped;    // snapshots skipped for want of a free job
+    uint64_t failed;     // encoder errors
+    uint64_t popped;
+    uint64_t encode_ns;  // total encoding time
+};
+
+/**
+ * Encode [height, width] RGB rows as a baseline JPEG.
+ *
+ * @return: false if no encoder is built in or encoding failed
+ */
+bool encode_jpeg(const uint8_t* rgb, int width, int height, size_t stride, int quality, std::vector<uint8_t>& out);
+
+class EvidenceEncoder {
+public:
+    static constexpr int kJobs = 16;
+
+    /**
+     * One snapshot. The producer fills info (without the JPEG sizes),
+     * quality and the RGB buffers; buffers keep their capacity across uses.
+     */
+    struct Job {
+        EvidenceInfo info;
+        int quality = 85;
+        std::vector<uint8_t> plate_rgb;  // plate_height rows of plate_width * 3
+        std::vector<uint8_t> frame_rgb;  // frame_height rows of frame_width * 3
+        std::vector<uint8_t> plate_jpeg;
+        std::vector<uint8_t> frame_jpeg;
+    };
+
+    static EvidenceEncoder& instance();
+
+    // Built with a JPEG encoder
+    static bool available();
+
+    /**
+     * Take a free job (never blocks).
+     *
+     * @return: nullptr, counted as dropped, if every job is in use
+     */
+    Job* acquire();
+
+    /**
+     * Queue a filled job for encoding; starts the encoder thread on first use.
+     */
+    void submit(Job* job);
+
+    /**
+     * Return a job that will not be submitted.
+     */
+    void release(Job* job);
+
+    /**
+     * Take the oldest finished evidence of the sources under `prefix`.
+     *
+     * @param buffer: Receives the plate JPEG, then the frame JPEG
+     * @return: 1 if copied, 0 if there is none, -1 if `capacity` is smaller
+     *          than plate_bytes + frame_bytes (`info` is filled in and the
+     *          evidence stays queued)
+     */
+    int pop(const std::string& prefix, EvidenceInfo& info, uint8_t* buffer, size_t capacity);
+
+    EvidenceStats stats() const;
+
+    ~EvidenceEncoder();
+
+private:
+    EvidenceEncoder();
+
+    void worker_loop();
+
+    mutable std::mutex mutex_;
+    std::condition_variable wake_;
+    std::vector<std::unique_ptr<Job>> jobs_;
+    std::vector<Job*> free_;
+    std::deque<Job*> queue_;
+    std::deque<Job*> ready_;
+    std::thread worker_;
+    bool stop_ = false;
+    uint32_t encoding_ = 0;
+
+    uint64_t submitted_ = 0;
+    uint64_t encoded_ = 0;
+    uint64_t dropped_ = 0;
+    uint64_t failed_ = 0;
+    uint64_t popped_ = 0;
+    uint64_t encode_ns_ = 0;
+};
+
+}  // namespace anpr
@@ -0,0 +1,133 @@
+/**
+ * Activity Gate: adaptive inference frame rate
+ *
+ * Loaded by the Python pipeline (ctypes), not by a Hailo element: a pad probe
+ * in front of the detection hailonet calls frame_gate_admit() for every
+ * decoded frame and drops the ones the gate rejects. The decision combines a
+ * coarse luma frame difference (frame_gate.hpp) with the "frames without
+ * detections" count plate_detection keeps in libanpr_core.so
+ * (scene_activity.hpp).
+ *
+ * Frames the gate passes are then offered to the inference scheduler
+ * (scheduler.hpp), which skips frames of cameras over their share of the
+ * device; skipped frames count as not passed.
+ *
+ * Gates register themselves, so the per-camera input and inference rates can
+ * be read through frame_gate_stats().
+ */
+
+#include "frame_gate.hpp"
+#include "scene_activity.hpp"
+#include "scheduler.hpp"
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * Gate state, laid out for ctypes.
+ */
+struct FrameGateStats {
+    char name[32];
+    uint32_t active;
+    float input_fps;
+    float inference_fps;
+    uint64_t frames_in;
+    uint64_t frames_passed;
+};
+
+struct FrameGateHandle {
+    std::string name;
+    std::string activity_key;
+    anpr::FrameGateOptions options;
+    anpr::LumaMotion motion;
+
+    mutable std::mutex mutex;  // admit() runs on the streaming thread, stats on the caller's
+    anpr::FrameGate gate;
+};
+
+namespace {
+
+std::mutex registry_mutex;
+std::vector<FrameGateHandle*> registry;
+
+}  // namespace
+
+/**
+ * Create a gate.
+ *
+ * @param name: Label reported in stats (the pipeline's element prefix)
+ * @param activity_key: SceneActivity key plate_detection reports under
+ * @param idle_fps: Inference rate without activity
+ * @param idle_after_frames: Inferred frames without detections before going idle
+ */
+extern "C" FrameGateHandle* frame_gate_open(const char* name, const char* activity_key, float idle_fps,
+                                            uint32_t idle_after_frames) {
+    auto* handle = new FrameGateHandle();
+    handle->name = name;
+    handle->activity_key = activity_key;
+    handle->options.idle_fps = idle_fps;
+    handle->options.idle_after_frames = idle_after_frames;
+
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    registry.push_back(handle);
+    return handle;
+}
+
+extern "C" void frame_gate_close(FrameGateHandle* handle) {
+    {
+        std::lock_guard<std::mutex> lock(registry_mutex);
+        registry.erase(std::remove(registry.begin(), registry.end(), handle), registry.end());
+    }
+    delete handle;
+}
+
+/**
+ * Decide whether a decoded frame goes to the detection network.
+ *
+ * @param data: First plane of the frame (packed RGB or a luma plane)
+ * @param pixel_stride: Bytes per pixel of that plane (3 RGB, 1 luma)
+ * @return: 1 to infer the frame, 0 to drop it
+ */
+extern "C" int frame_gate_admit(FrameGateHandle* handle, const uint8_t* data, int width, int height, size_t stride,
+                                int pixel_stride) {
+    const uint64_t now_ns = anpr::InferenceScheduler::now_ns();
+    const float motion = handle->motion.update(data, width, height, stride, pixel_stride, handle->options);
+    const uint32_t idle_frames = anpr::SceneActivity::instance().frames_without_detections(handle->activity_key);
+    anpr::InferenceScheduler& scheduler = anpr::InferenceScheduler::instance();
+
+    std::lock_guard<std::mutex> lock(handle->mutex);
+    return handle->gate.admit(now_ns, motion, idle_frames, handle->options, [&] {
+        return scheduler.admit_frame(handle->activity_key, now_ns);
+    }) ? 1 : 0;
+}
+
+extern "C" size_t frame_gate_count() {
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    return registry.size();
+}
+
+/**
+ * Copy the state of up to `max_gates` gates into `out`.
+ *
+ * @return: Number of entries written
+ */
+extern "C" size_t frame_gate_stats(FrameGateStats* out, size_t max_gates) {
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    const size_t count = std::min(max_gates, registry.size());
+    for (size_t i = 0; i < count; i++) {
+        const FrameGateHandle& handle = *registry[i];
+        FrameGateStats& s = out[i];
+        std::memset(&s, 0, sizeof(s));
+        std::strncpy(s.name, handle.name.c_str(), sizeof(s.name) - 1);
+
+        std::lock_guard<std::mutex> lock(handle.mutex);
+        s.active = handle.gate.active() ? 1 : 0;
+        s.input_fps = handle.gate.input_fps();
+        s.inference_fps = handle.gate.inference_fps();
+        s.frames_in = handle.gate.frames_in();
+        s.frames_passed = handle.gate.frames_passed();
+    }
+    return count;
+}
@@ -0,0 +1,171 @@
+/**
+ * Activity-gated inference rate.
+ *
+ * LumaMotion samples the luma of a frame on a coarse grid (one pixel per
+ * block, so the cost does not depend on the frame resolution) and reports the
+ * share of grid cells that changed since the previous frame.
+ *
+ * FrameGate decides per decoded frame whether it goes to the detection
+ * network:
+ *  - active: every frame passes, while plates were detected within the last
+ *    idle_after_frames inferred frames or motion was seen within motion_hold
+ *  - idle:   frames pass at idle_fps at most
+ * and measures the input and inference rates it produces. Frames it would
+ * pass can still be skipped by a scheduler (scheduler.hpp).
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+namespace anpr {
+
+struct FrameGateOptions {
+    float idle_fps = 2.0f;              // inference rate without activity
+    uint32_t idle_after_frames = 30;    // inferred frames without detections before going idle
+    uint64_t motion_hold_ns = 1000000000ull;  // stay active this long after motion
+    int grid_cols = 64;                 // luma sampling grid
+    int grid_rows = 48;
+    int pixel_threshold = 16;           // luma change that counts a cell as changed
+    float motion_fraction = 0.01f;      // changed cells that count as motion
+};
+
+class LumaMotion {
+public:
+    /**
+     * Compare a frame against the previous one.
+     *
+     * @param pixel_stride: 3 for packed RGB (luma approximated from R, G, B),
+     *                      1 for a luma plane (NV12, GRAY8)
+     * @return: Share of grid cells whose luma changed by more than
+     *          pixel_threshold; 0 for the first frame or after a size change
+     */
+    float update(const uint8_t* data, int width, int height, size_t stride, int pixel_stride,
+                 const FrameGateOptions& options) {
+        const int cols = std::max(1, std::min(options.grid_cols, width));
+        const int rows = std::max(1, std::min(options.grid_rows, height));
+        const size_t cells = static_cast<size_t>(cols) * rows;
+
+        const bool comparable = previous_.size() == cells && width == width_ && height == height_;
+        current_.resize(cells);
+
+        for (int r = 0; r < rows; r++) {
+            const int y = (2 * r + 1) * height / (2 * rows);
+            const uint8_t* row = data + static_cast<size_t>(y) * stride;
+            uint8_t* out = current_.data() + static_cast<size_t>(r) * cols;
+            for (int c = 0; c < cols; c++) {
+                const int x = (2 * c + 1) * width / (2 * cols);
+                const uint8_t* p = row + static_cast<size_t>(x) * pixel_stride;
+                out[c] = pixel_stride >= 3 ? static_cast<uint8_t>((p[0] + 2 * p[1] + p[2]) >> 2) : p[0];
+            }
+        }
+
+        size_t changed = 0;
+        if (comparable) {
+            for (size_t i = 0; i < cells; i++) {
+                changed += std::abs(static_cast<int>(current_[i]) - previous_[i]) > options.pixel_threshold;
+            }
+        }
+
+        previous_.swap(current_);
+        width_ = width;
+        height_ = height;
+        return comparable ? static_cast<float>(changed) / cells : 0.0f;
+    }
+
+private:
+    std::vector<uint8_t> previous_;
+    std::vector<uint8_t> current_;
+    int width_ = 0;
+    int height_ = 0;
+};
+
+class FrameGate {
+public:
+    /**
+     * Decide whether a frame is inferred.
+     *
+     * @param now_ns: Monotonic timestamp of the frame
+     * @param motion: LumaMotion::update() result for the frame
+     * @param frames_without_detections: From SceneActivity
+     */
+    bool admit(uint64_t now_ns, float motion, uint32_t frames_without_detections, const FrameGateOptions& options) {
+        return admit(now_ns, motion, frames_without_detections, options, [] { return true; });
+    }
+
+    /**
+     * Same, with the frames the gate would pass offered to `schedule`
+     * (returns false to skip the frame, see scheduler.hpp).
+     */
+    template <typename Schedule>
+    bool admit(uint64_t now_ns, float motion, uint32_t frames_without_detections, const FrameGateOptions& options,
+               Schedule&& schedule) {
+        if (motion >= options.motion_fraction) motion_until_ns_ = now_ns + options.motion_hold_ns;
+        active_ = frames_without_detections < options.idle_after_frames || now_ns < motion_until_ns_;
+
+        bool pass = active_;
+        if (!pass) {
+            const uint64_t interval_ns =
+                options.idle_fps > 0.0f ? static_cast<uint64_t>(1e9f / options.idle_fps) : UINT64_MAX;
+            pass = !has_passed_ || now_ns - last_pass_ns_ >= interval_ns;
+        }
+        pass = pass && schedule();
+        if (pass) {
+            has_passed_ = true;
+            last_pass_ns_ = now_ns;
+        }
+
+        count(now_ns, pass);
+        return pass;
+    }
+
+    bool active() const { return active_; }
+    float input_fps() const { return input_fps_; }
+    float inference_fps() const { return inference_fps_; }
+    uint64_t frames_in() const { return frames_in_; }
+    uint64_t frames_passed() const { return frames_passed_; }
+
+private:
+    static constexpr uint64_t kRateWindowNs = 1000000000ull;
+
+    // Rates over ~1 s windows
+    void count(uint64_t now_ns, bool pass) {
+        frames_in_++;
+        frames_passed_ += pass;
+        if (!window_started_) {
+            window_started_ = true;
+            window_start_ns_ = now_ns;
+        }
+
+        window_in_++;
+        window_passed_ += pass;
+        const uint64_t elapsed = now_ns - window_start_ns_;
+        if (elapsed >= kRateWindowNs) {
+            input_fps_ = window_in_ * 1e9f / elapsed;
+            inference_fps_ = window_passed_ * 1e9f / elapsed;
+            window_start_ns_ = now_ns;
+            window_in_ = 0;
+            window_passed_ = 0;
+        }
+    }
+
+    bool active_ = true;
+    bool has_passed_ = false;
+    uint64_t last_pass_ns_ = 0;
+    uint64_t motion_until_ns_ = 0;
+
+    uint64_t frames_in_ = 0;
+    uint64_t frames_passed_ = 0;
+    bool window_started_ = false;
+    uint64_t window_start_ns_ = 0;
+    uint32_t window_in_ = 0;
+    uint32_t window_passed_ = 0;
+    float input_fps_ = 0.0f;
+    float inference_fps_ = 0.0f;
+};
+
+}  // namespace anpr
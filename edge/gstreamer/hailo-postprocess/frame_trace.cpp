@@ -0,0 +1,149 @@
+/**
+ * Shared frame tracer (libanpr_core.so), see frame_trace.hpp.
+ */
+
+#include "frame_trace.hpp"
+#include "stage_stats.hpp"
+
+#include <cstring>
+
+namespace anpr {
+
+namespace {
+
+/**
+ * Trace state of the calling streaming thread.
+ */
+struct ThreadTrace {
+    uint64_t pts_ns = FrameTracer::kNoPts;  // set by enter(), taken by begin()
+    uint64_t frame_id = 0;                  // found by the last begin()
+};
+
+ThreadTrace& thread_trace() {
+    static thread_local ThreadTrace trace;
+    return trace;
+}
+
+}  // namespace
+
+FrameTracer& FrameTracer::instance() {
+    static FrameTracer tracer;
+    return tracer;
+}
+
+uint64_t FrameTracer::open(const std::string& key, uint64_t pts_ns, uint64_t capture_ns, uint64_t now_ns) {
+    if (!enabled() || key.empty() || key.size() > kMaxKeyLength) return 0;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    const uint64_t frame_id = next_id_++;
+    if (next_id_ > kMaxFrameId) next_id_ = 1;
+    FrameTraceRecord& record = slot(frame_id);
+    std::memset(&record, 0, sizeof(record));
+    key.copy(record.key, kMaxKeyLength);
+    record.frame_id = frame_id;
+    record.pts_ns = pts_ns;
+    record.stage_ns[static_cast<int>(TraceStage::Capture)] = capture_ns;
+    record.stage_ns[static_cast<int>(TraceStage::Source)] = now_ns;
+    opened_++;
+    return frame_id;
+}
+
+void FrameTracer::enter(uint64_t pts_ns) {
+    thread_trace().pts_ns = pts_ns;
+}
+
+uint64_t FrameTracer::begin(const std::string& key, TraceStage stage, uint64_t now_ns) {
+    ThreadTrace& trace = thread_trace();
+    const uint64_t pts_ns = trace.pts_ns;
+    trace.pts_ns = kNoPts;
+    trace.frame_id = 0;
+    if (!enabled() || pts_ns == kNoPts) return 0;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    // Newest first: a PTS repeats across cameras, rarely within one camera's lookback
+    const uint64_t oldest = next_id_ > kLookback ? next_id_ - kLookback : 1;
+    for (uint64_t frame_id = next_id_ - 1; frame_id >= oldest; frame_id--) {
+        FrameTraceRecord& record = slot(frame_id);
+        if (record.frame_id != frame_id || record.pts_ns != pts_ns || key.compare(record.key) != 0) continue;
+        uint64_t& stamped = record.stage_ns[static_cast<int>(stage)];
+        if (!stamped) stamped = now_ns;
+        matched_++;
+        trace.frame_id = frame_id;
+        return frame_id;
+    }
+    missed_++;
+    return 0;
+}
+
+uint64_t FrameTracer::thread_frame() {
+    return thread_trace().frame_id;
+}
+
+void FrameTracer::stamp(uint64_t frame_id, TraceStage stage, uint64_t now_ns) {
+    if (!frame_id) return;
+    std::lock_guard<std::mutex> lock(mutex_);
+    FrameTraceRecord& record = slot(frame_id);
+    if (record.frame_id != frame_id) return;
+    uint64_t& stamped = record.stage_ns[static_cast<int>(stage)];
+    if (!stamped) stamped = now_ns;
+}
+
+bool FrameTracer::get(uint64_t frame_id, FrameTraceRecord& out) const {
+    if (!frame_id) return false;
+    std::lock_guard<std::mutex> lock(mutex_);
+    const FrameTraceRecord& record = slot(frame_id);
+    if (record.frame_id != frame_id) return false;
+    out = record;
+    return true;
+}
+
+FrameTraceStats FrameTracer::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    FrameTraceStats s = {};
+    s.enabled = enabled() ? 1 : 0;
+    s.slots = static_cast<uint32_t>(kSlots);
+    s.opened = opened_;
+    s.matched = matched_;
+    s.missed = missed_;
+    return s;
+}
+
+}  // namespace anpr
+
+/**
+ * Turn frame tracing on or off for every pipeline of the process.
+ */
+extern "C" void frame_trace_enable(int enabled) {
+    anpr::FrameTracer::instance().set_enabled(enabled != 0);
+}
+
+/**
+ * Open a frame's trace (source pad probe).
+ *
+ * @param key: SceneActivity key of the camera
+ * @return: Frame id, 0 if not traced
+ */
+extern "C" uint64_t frame_trace_open(const char* key, uint64_t pts_ns, uint64_t capture_ns) {
+    return anpr::FrameTracer::instance().open(key, pts_ns, capture_ns, anpr::monotonic_ns());
+}
+
+/**
+ * Hand the PTS of the buffer entering plate_detection to the calling
+ * streaming thread (detection queue pad probe).
+ */
+extern "C" void frame_trace_enter(uint64_t pts_ns) {
+    anpr::FrameTracer::enter(pts_ns);
+}
+
+/**
+ * Copy a frame's trace into `out`.
+ *
+ * @return: 1 if found, 0 if the frame is unknown or its slot was reused
+ */
+extern "C" int frame_trace_get(uint64_t frame_id, anpr::FrameTraceRecord* out) {
+    return out && anpr::FrameTracer::instance().get(frame_id, *out) ? 1 : 0;
+}
+
+extern "C" void frame_trace_stats(anpr::FrameTraceStats* out) {
+    if (out) *out = anpr::FrameTracer::instance().stats();
+}
@@ -0,0 +1,137 @@
+/**
+ * End-to-end latency tracing of frames, from the RTSP capture timestamp to
+ * the published plate event.
+ *
+ * With tracing enabled, a pad probe behind the frame gate (frame_trace.py)
+ * opens a trace for every frame entering inference. The trace holds the
+ * buffer PTS, the capture time (pipeline base time + PTS, i.e. when rtspsrc
+ * timestamped the frame) and the time the frame left decode and scaling.
+ * Each stage then stamps the time the frame reached it: plate_detection,
+ * plate_tracker, crop_plates and plate_ocr. Published plate events carry
+ * the frame id (PlateEventRecord::trace_frame), so the Python side can give
+ * every event its capture time and per-stage timestamps.
+ *
+ * The plugins only see HailoROIs, not buffers. A second probe, on the
+ * output of the detection queue, hands the buffer PTS to the streaming
+ * thread (enter()). plate_detection then looks the trace up by camera and
+ * PTS (begin()) and tags the detections with its frame id (a "frame_trace"
+ * classification, hailo_roi.hpp), which follows the crops to plate_ocr.
+ *
+ * All times are CLOCK_MONOTONIC, the clock of GStreamer's system clock.
+ * Traces live in a fixed table indexed by frame id; a slot is reused kSlots
+ * frames later, long after the frame's events were drained.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+namespace anpr {
+
+enum class TraceStage : uint32_t {
+    Capture = 0,    // rtspsrc timestamp (base time + PTS)
+    Source = 1,     // decoded and scaled, admitted by the frame gate
+    Detection = 2,  // plate_detection started
+    Tracker = 3,    // plate_tracker started
+    Crop = 4,       // crop_plates started
+    OCR = 5,        // plate_ocr started on the frame's first crop
+};
+
+constexpr int kTraceStages = 6;
+
+/**
+ * One frame's trace, laid out for ctypes.
+ */
+struct FrameTraceRecord {
+    char key[32];  // SceneActivity key of the camera
+    uint64_t frame_id;
+    uint64_t pts_ns;
+    uint64_t stage_ns[kTraceStages];  // by TraceStage, 0 if not reached
+};
+
+/**
+ * Tracer counters, laid out for ctypes.
+ */
+struct FrameTraceStats {
+    uint32_t enabled;
+    uint32_t slots;
+    uint64_t opened;   // traces opened by the source probe
+    uint64_t matched;  // frames plate_detection found a trace for
+    uint64_t missed;   // frames plate_detection saw with a PTS but no trace
+};
+
+class FrameTracer {
+public:
+    static constexpr size_t kSlots = 1024;    // power of two
+    static constexpr size_t kLookback = 256;  // newest traces searched by begin()
+    static constexpr size_t kMaxKeyLength = 31;
+    static constexpr uint64_t kNoPts = ~0ull;  // GST_CLOCK_TIME_NONE
+    static constexpr uint64_t kMaxFrameId = 0x7fffffff;  // ids travel as int ROI metadata, then wrap
+
+    static FrameTracer& instance();
+
+    void set_enabled(bool enabled) { enabled_.store(enabled, std::memory_order_relaxed); }
+    bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+    /**
+     * Open the trace of a frame entering inference.
+     *
+     * @param capture_ns: Capture time of the frame, 0 if unknown
+     * @return: Frame id, 0 if tracing is off or the key is invalid
+     */
+    uint64_t open(const std::string& key, uint64_t pts_ns, uint64_t capture_ns, uint64_t now_ns);
+
+    /**
+     * Hand the PTS of the buffer about to be processed to the calling
+     * streaming thread, for the next begin().
+     */
+    static void enter(uint64_t pts_ns);
+
+    /**
+     * Find the trace of the calling thread's current buffer (enter()) and
+     * stamp `stage`. The frame id is kept for thread_frame() until the next
+     * begin().
+     *
+     * @return: Frame id, 0 if the frame has no trace
+     */
+    uint64_t begin(const std::string& key, TraceStage stage, uint64_t now_ns);
+
+    /**
+     * Frame id found by the calling thread's last begin(), 0 if none.
+     */
+    static uint64_t thread_frame();
+
+    /**
+     * Record that a traced frame reached `stage`; the first stamp of a stage
+     * is kept, later ones (further crops of the frame) are ignored.
+     */
+    void stamp(uint64_t frame_id, TraceStage stage, uint64_t now_ns);
+
+    /**
+     * @return: false if the frame's slot was reused (or never traced)
+     */
+    bool get(uint64_t frame_id, FrameTraceRecord& out) const;
+
+    FrameTraceStats stats() const;
+
+private:
+    FrameTracer() = default;
+
+    FrameTraceRecord& slot(uint64_t frame_id) { return slots_[frame_id & (kSlots - 1)]; }
+    const FrameTraceRecord& slot(uint64_t frame_id) const { return slots_[frame_id & (kSlots - 1)]; }
+
+    mutable std::mutex mutex_;
+    std::atomic<bool> enabled_{false};
+    uint64_t next_id_ = 1;  // 0 means "not traced"
+    FrameTraceRecord slots_[kSlots] = {};
+
+    uint64_t opened_ = 0;
+    uint64_t matched_ = 0;
+    uint64_t missed_ = 0;
+};
+
+}  // namespace anpr
@@ -0,0 +1,46 @@
+/**
+ * Adapters between Hailo image buffers and the crop kernels.
+ */
+
+#pragma once
+
+#include "hailo_common.hpp"
+#include "plate_resize.hpp"
+
+#include <memory>
+
+namespace anpr {
+
+/**
+ * Plane pointers and strides of a frame.
+ *
+ * @return: false for pixel formats the crop kernel does not read
+ */
+template <typename Image>
+inline bool image_view(const Image& image, ImageView& view) {
+    switch (image.format) {
+        case HAILO_MAT_RGB: view.format = PixelFormat::RGB; break;
+        case HAILO_MAT_NV12: view.format = PixelFormat::NV12; break;
+        default: return false;
+    }
+    view.width = image.width;
+    view.height = image.height;
+    for (int p = 0; p < 2; p++) {
+        view.planes[p] = image.planes[p];
+        view.strides[p] = image.strides[p];
+    }
+    return true;
+}
+
+/**
+ * Hand an already resized RGB crop to hailocropper, which then forwards it to
+ * the OCR network as-is instead of resizing the bbox itself. The buffer is
+ * shared, so its pool slot is recycled once hailonet releases the crop.
+ */
+inline void attach_crop_buffer(HailoCroppedImage& crop, std::shared_ptr<uint8_t> data, size_t stride) {
+    crop.data = std::move(data);
+    crop.stride = stride;
+    crop.format = HAILO_MAT_RGB;
+}
+
+}  // namespace anpr
@@ -0,0 +1,142 @@
+/**
+ * Track id and stream id tagging of Hailo ROIs.
+ *
+ * Track ids travel with a detection as a HailoUniqueID object in TRACKING_ID
+ * mode, the same way hailotracker tags its detections, so downstream stages
+ * (the OCR filter, Python) can read them from the ROI.
+ *
+ * In multi-stream pipelines hailoroundrobin sets the frame ROI's stream id
+ * (its sink pad name, e.g. "sink_2"); detections carry it on so per-stream
+ * state further down (cropper, tracker) stays separate and
+ * hailostreamrouter can route results back to their camera.
+ *
+ * With ROI-restricted detection the frame carries a "lane_mosaic" detection
+ * whose "lane_layout" classification holds the tile layout (lane_tiles.hpp).
+ *
+ * Detections of frames captured into a tensor dump carry a "tensor_capture"
+ * classification with the capture frame id (tensor_capture.hpp), so the OCR
+ * filter captures their crops too. Detections of traced frames carry a
+ * "frame_trace" classification with the trace frame id (frame_trace.hpp) in
+ * the same way.
+ */
+
+#pragma once
+
+#include "hailo_common.hpp"
+#include "lane_tiles.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <variant>
+#include <vector>
+
+namespace anpr {
+
+inline void set_track_id(HailoDetection& detection, uint64_t track_id) {
+    detection.add_object(std::make_shared<HailoUniqueID>(static_cast<int>(track_id), TRACKING_ID));
+}
+
+/**
+ * @return: The ROI's tracking id, or 0 if it has none
+ */
+template <typename Roi>
+inline uint64_t track_id(const Roi& roi) {
+    for (const auto& object : roi.get_objects_typed(HAILO_UNIQUE_ID)) {
+        auto unique_id = std::dynamic_pointer_cast<HailoUniqueID>(object);
+        if (unique_id && unique_id->get_mode() == TRACKING_ID && unique_id->get_id() > 0) {
+            return static_cast<uint64_t>(unique_id->get_id());
+        }
+    }
+    return 0;
+}
+
+/**
+ * @return: The ROI's stream id, empty in single-stream pipelines
+ */
+template <typename Roi>
+inline std::string stream_id(const Roi& roi) {
+    return roi.get_stream_id();
+}
+
+inline void set_stream_id(HailoDetection& detection, const std::string& stream) {
+    if (!stream.empty()) detection.set_stream_id(stream);
+}
+
+/**
+ * Tag a detection with a frame id under `label` (tensor_capture, frame_trace).
+ */
+inline void set_frame_tag(HailoDetection& detection, const char* label, uint64_t frame_id) {
+    auto classification = std::make_shared<HailoClassification>();
+    classification->label = label;
+    classification->metadata["type"] = std::string(label);
+    classification->metadata["frame"] = static_cast<int>(frame_id);
+    detection.add_object(classification);
+}
+
+/**
+ * @return: The frame id a detection is tagged with under `label`, 0 if none
+ */
+template <typename Roi>
+inline uint64_t frame_tag(const Roi& roi, const char* label) {
+    for (const auto& object : roi.get_objects_typed(HAILO_CLASSIFICATION)) {
+        auto classification = std::dynamic_pointer_cast<HailoClassification>(object);
+        if (!classification || classification->label != label) continue;
+
+        auto frame = classification->metadata.find("frame");
+        if (frame == classification->metadata.end()) continue;
+        const int* id = std::get_if<int>(&frame->second);
+        if (id && *id > 0) return static_cast<uint64_t>(*id);
+    }
+    return 0;
+}
+
+inline void set_capture_frame(HailoDetection& detection, uint64_t frame_id) {
+    set_frame_tag(detection, "tensor_capture", frame_id);
+}
+
+/**
+ * @return: The capture frame id of a detection's frame, 0 if not captured
+ */
+template <typename Roi>
+inline uint64_t capture_frame(const Roi& roi) {
+    return frame_tag(roi, "tensor_capture");
+}
+
+inline void set_trace_frame(HailoDetection& detection, uint64_t frame_id) {
+    set_frame_tag(detection, "frame_trace", frame_id);
+}
+
+/**
+ * @return: The trace frame id of a detection's frame, 0 if not traced
+ */
+template <typename Roi>
+inline uint64_t trace_frame(const Roi& roi) {
+    return frame_tag(roi, "frame_trace");
+}
+
+const char* const kLaneMosaicLabel = "lane_mosaic";
+
+/**
+ * Read the lane tile layout attached to a lane mosaic ROI.
+ *
+ * @return: false if the ROI has no (valid) layout
+ */
+template <typename Roi>
+inline bool lane_layout(const Roi& roi, LaneLayout& layout) {
+    for (const auto& object : roi.get_objects_typed(HAILO_CLASSIFICATION)) {
+        auto classification = std::dynamic_pointer_cast<HailoClassification>(object);
+        if (!classification) continue;
+
+        auto type = classification->metadata.find("type");
+        auto tiles = classification->metadata.find("tiles");
+        if (type == classification->metadata.end() || tiles == classification->metadata.end()) continue;
+
+        const std::string* name = std::get_if<std::string>(&type->second);
+        const std::vector<float>* data = std::get_if<std::vector<float>>(&tiles->second);
+        if (name && *name == "lane_layout" && data) return layout.parse(*data);
+    }
+    return false;
+}
+
+}  // namespace anpr
@@ -0,0 +1,50 @@
+/**
+ * Accessors for the element type and quantization parameters of a
+ * Hailo output tensor.
+ */
+
+#pragma once
+
+#include "hailo_common.hpp"
+#include "quant.hpp"
+#include "tensor_dump.hpp"
+
+namespace anpr {
+
+template <typename Tensor>
+inline TensorDType tensor_dtype(const Tensor& tensor) {
+    switch (tensor.vstream_info().format.type) {
+        case HAILO_FORMAT_TYPE_UINT8: return TensorDType::UInt8;
+        case HAILO_FORMAT_TYPE_UINT16: return TensorDType::UInt16;
+        default: return TensorDType::Float32;
+    }
+}
+
+template <typename Tensor>
+inline QuantInfo tensor_quant(const Tensor& tensor) {
+    const auto& quant_info = tensor.vstream_info().quant_info;
+    return QuantInfo{quant_info.qp_scale, quant_info.qp_zp};
+}
+
+/**
+ * Tensor dump record header of an output tensor (tensor_dump.hpp); the
+ * capture fills in the timestamp, frame id and frame size.
+ */
+template <typename Tensor>
+inline TensorRecordHeader tensor_record_header(const Tensor& tensor, TensorKind kind, int32_t stream_index) {
+    TensorRecordHeader header{};
+    const TensorDType dtype = tensor_dtype(tensor);
+    const QuantInfo quant = tensor_quant(tensor);
+    header.kind = static_cast<uint32_t>(kind);
+    header.dtype = static_cast<uint32_t>(dtype);
+    header.height = tensor.height();
+    header.width = tensor.width();
+    header.count = 1;
+    header.payload_bytes = static_cast<uint32_t>(header.height * header.width * dtype_size(dtype));
+    header.quant_scale = dtype == TensorDType::Float32 ? 1.0f : quant.scale;
+    header.quant_zero_point = dtype == TensorDType::Float32 ? 0.0f : quant.zero_point;
+    header.stream_index = stream_index;
+    return header;
+}
+
+}  // namespace anpr
@@ -0,0 +1,240 @@
+/**
+ * Minimal JSON reader for plugin config files (hailofilter config-path=).
+ *
+ * Parses a complete document into a small DOM. Covers what the configs use:
+ * objects, arrays, numbers, strings (\uXXXX escapes limited to ASCII),
+ * true/false/null. Not meant for untrusted or large input.
+ */
+
+#pragma once
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace anpr {
+namespace json {
+
+class Value {
+public:
+    enum class Type { Null, Bool, Number, String, Array, Object };
+
+    Type type() const { return type_; }
+    bool is_null() const { return type_ == Type::Null; }
+    bool is_number() const { return type_ == Type::Number; }
+    bool is_string() const { return type_ == Type::String; }
+    bool is_array() const { return type_ == Type::Array; }
+    bool is_object() const { return type_ == Type::Object; }
+
+    double number(double fallback = 0.0) const { return type_ == Type::Number ? number_ : fallback; }
+    bool boolean(bool fallback = false) const { return type_ == Type::Bool ? bool_ : fallback; }
+    const std::string& string() const { return string_; }
+
+    const std::vector<Value>& items() const { return items_; }
+    size_t size() const { return items_.size(); }
+    const Value& operator[](size_t i) const { return i < items_.size() ? items_[i] : null_value(); }
+
+    /**
+     * Member of an object, or a null value if absent.
+     */
+    const Value& get(const std::string& key) const {
+        for (size_t i = 0; i < keys_.size(); i++) {
+            if (keys_[i] == key) return items_[i];
+        }
+        return null_value();
+    }
+    const std::vector<std::string>& keys() const { return keys_; }
+
+private:
+    friend class Parser;
+
+    static const Value& null_value() {
+        static const Value null;
+        return null;
+    }
+
+    Type type_ = Type::Null;
+    bool bool_ = false;
+    double number_ = 0.0;
+    std::string string_;
+    std::vector<Value> items_;      // array items or object values
+    std::vector<std::string> keys_;  // object keys, parallel to items_
+};
+
+class Parser {
+public:
+    explicit Parser(const std::string& text)
+        : begin_(text.c_str()), p_(text.c_str()), end_(text.c_str() + text.size()) {}
+
+    bool parse(Value& out, std::string* error) {
+        const bool ok = value(out, 0) && (skip_ws(), p_ == end_);
+        if (!ok && error) *error = "invalid JSON near offset " + std::to_string(p_ - begin_);
+        return ok;
+    }
+
+private:
+    static constexpr int kMaxDepth = 32;
+
+    void skip_ws() {
+        while (p_ < end_ && (*p_ == ' ' || *p_ == '\t' || *p_ == '\n' || *p_ == '\r')) p_++;
+    }
+
+    bool literal(const char* word) {
+        const char* q = p_;
+        for (; *word; word++, q++) {
+            if (q == end_ || *q != *word) return false;
+        }
+        p_ = q;
+        return true;
+    }
+
+    bool value(Value& out, int depth) {
+        if (depth > kMaxDepth) return false;
+        skip_ws();
+        if (p_ == end_) return false;
+
+        switch (*p_) {
+            case '{': return object(out, depth);
+            case '[': return array(out, depth);
+            case '"': out.type_ = Value::Type::String; return string(out.string_);
+            case 't': out.type_ = Value::Type::Bool; out.bool_ = true; return literal("true");
+            case 'f': out.type_ = Value::Type::Bool; out.bool_ = false; return literal("false");
+            case 'n': out.type_ = Value::Type::Null; return literal("null");
+            default: return number(out);
+        }
+    }
+
+    bool number(Value& out) {
+        // strtod needs a terminated buffer; configs are small, copy the token
+        const char* q = p_;
+        while (q < end_ && ((*q >= '0' && *q <= '9') || (*q && std::strchr("+-.eE", *q)))) q++;
+        if (q == p_) return false;
+        const std::string token(p_, q);
+        char* parsed = nullptr;
+        out.number_ = std::strtod(token.c_str(), &parsed);
+        if (parsed != token.c_str() + token.size()) return false;
+        out.type_ = Value::Type::Number;
+        p_ = q;
+        return true;
+    }
+
+    bool string(std::string& out) {
+        p_++;  // opening quote
+        out.clear();
+        while (p_ < end_ && *p_ != '"') {
+            char c = *p_++;
+            if (c == '\\') {
+                if (p_ == end_) return false;
+                switch (*p_++) {
+                    case '"': c = '"'; break;
+                    case '\\': c = '\\'; break;
+                    case '/': c = '/'; break;
+                    case 'b': c = '\b'; break;
+                    case 'f': c = '\f'; break;
+                    case 'n': c = '\n'; break;
+                    case 'r': c = '\r'; break;
+                    case 't': c = '\t'; break;
+                    case 'u': {
+                        if (end_ - p_ < 4) return false;
+                        const std::string hex(p_, p_ + 4);
+                        char* parsed = nullptr;
+                        const long code = std::strtol(hex.c_str(), &parsed, 16);
+                        if (parsed != hex.c_str() + 4 || code > 0x7f) return false;
+                        c = static_cast<char>(code);
+                        p_ += 4;
+                        break;
+                    }
+                    default: return false;
+                }
+            }
+            out.push_back(c);
+        }
+        if (p_ == end_) return false;
+        p_++;  // closing quote
+        return true;
+    }
+
+    bool array(Value& out, int depth) {
+        out.type_ = Value::Type::Array;
+        p_++;
+        skip_ws();
+        if (p_ < end_ && *p_ == ']') {
+            p_++;
+            return true;
+        }
+        while (true) {
+            out.items_.emplace_back();
+            if (!value(out.items_.back(), depth + 1)) return false;
+            skip_ws();
+            if (p_ < end_ && *p_ == ',') {
+                p_++;
+                continue;
+            }
+            if (p_ < end_ && *p_ == ']') {
+                p_++;
+                return true;
+            }
+            return false;
+        }
+    }
+
+    bool object(Value& out, int depth) {
+        out.type_ = Value::Type::Object;
+        p_++;
+        skip_ws();
+        if (p_ < end_ && *p_ == '}') {
+            p_++;
+            return true;
+        }
+        while (true) {
+            skip_ws();
+            if (p_ == end_ || *p_ != '"') return false;
+            out.keys_.emplace_back();
+            if (!string(out.keys_.back())) return false;
+            skip_ws();
+            if (p_ == end_ || *p_ != ':') return false;
+            p_++;
+            out.items_.emplace_back();
+            if (!value(out.items_.back(), depth + 1)) return false;
+            skip_ws();
+            if (p_ < end_ && *p_ == ',') {
+                p_++;
+                continue;
+            }
+            if (p_ < end_ && *p_ == '}') {
+                p_++;
+                return true;
+            }
+            return false;
+        }
+    }
+
+    const char* begin_;
+    const char* p_;
+    const char* end_;
+};
+
+inline bool parse(const std::string& text, Value& out, std::string* error = nullptr) {
+    return Parser(text).parse(out, error);
+}
+
+/**
+ * Read and parse a JSON file.
+ */
+inline bool parse_file(const std::string& path, Value& out, std::string* error = nullptr) {
+    std::ifstream file(path);
+    if (!file) {
+        if (error) *error = "cannot open " + path;
+        return false;
+    }
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    return parse(buffer.str(), out, error);
+}
+
+}  // namespace json
+}  // namespace anpr
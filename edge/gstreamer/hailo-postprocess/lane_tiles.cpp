@@ -0,0 +1,129 @@
+/**
+ * Hailo Post-Processing Plugin: Lane ROI Tiling
+ *
+ * Two hailofilter functions around the detection network when detection is
+ * restricted to lane ROIs (lane_tiles.hpp):
+ *   lane_layout  before the lane cropper: attaches a "lane_mosaic" detection
+ *                with the tile layout to the frame
+ *   lane_merge   after the aggregator: moves the plates plate_detection found
+ *                in the mosaic (already in frame coordinates) up to the frame
+ *                and removes the mosaic detection
+ *
+ * The ROIs come from the JSON file given as the hailofilter config-path:
+ *   {"frame_size": [1920, 1080], "input_size": [640, 480],
+ *    "rois": [[x, y, width, height], ...]}
+ * with ROIs normalized to the frame.
+ */
+
+#include "hailo_common.hpp"
+#include "hailo_roi.hpp"
+#include "json_lite.hpp"
+#include "lane_tiles.hpp"
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Detection network input
+const int DETECTION_WIDTH = 640;
+const int DETECTION_HEIGHT = 480;
+
+struct LaneParams {
+    anpr::LaneLayout layout;
+    std::vector<float> serialized;
+};
+
+/**
+ * Build the layout from a parsed config file.
+ *
+ * @return: false (with a message) if there are no usable ROIs
+ */
+bool load_config(const anpr::json::Value& config, LaneParams& params, std::string& error) {
+    const anpr::json::Value& frame = config.get("frame_size");
+    const anpr::json::Value& input = config.get("input_size");
+
+    std::vector<anpr::NormRect> rois;
+    for (const anpr::json::Value& roi : config.get("rois").items()) {
+        if (roi.size() != 4) {
+            error = "ROIs must be [x, y, width, height]";
+            return false;
+        }
+        rois.push_back(anpr::NormRect{static_cast<float>(roi[0].number()), static_cast<float>(roi[1].number()),
+                                      static_cast<float>(roi[2].number()), static_cast<float>(roi[3].number())});
+    }
+
+    if (!params.layout.build(rois.data(), static_cast<int>(rois.size()), static_cast<int>(frame[0].number(1920)),
+                             static_cast<int>(frame[1].number(1080)),
+                             static_cast<int>(input[0].number(DETECTION_WIDTH)),
+                             static_cast<int>(input[1].number(DETECTION_HEIGHT)))) {
+        error = "needs 1 to " + std::to_string(anpr::LaneLayout::kMaxTiles) + " non-empty ROIs";
+        return false;
+    }
+    params.serialized = params.layout.serialize();
+    return true;
+}
+
+/**
+ * Called by hailofilter once per element, with its config-path.
+ *
+ * Without a valid config no mosaic is attached and lane_merge has nothing to do.
+ */
+extern "C" void* init(const std::string config_path, const std::string function_name) {
+    auto* params = new LaneParams();
+
+    if (!config_path.empty() && config_path != "NULL") {
+        anpr::json::Value config;
+        std::string error;
+        if (!anpr::json::parse_file(config_path, config, &error) || !load_config(config, *params, error)) {
+            std::fprintf(stderr, "%s: ignoring config %s: %s\n", function_name.c_str(), config_path.c_str(),
+                         error.c_str());
+            delete params;
+            params = new LaneParams();
+        }
+    }
+    return params;
+}
+
+extern "C" void free_resources(void* params_void_ptr) {
+    delete static_cast<LaneParams*>(params_void_ptr);
+}
+
+/**
+ * Attach the lane mosaic detection (covering the frame) to the frame ROI.
+ */
+extern "C" void lane_layout(HailoROIPtr roi, void* params_void_ptr) {
+    const auto* params = static_cast<const LaneParams*>(params_void_ptr);
+    if (!params || params->serialized.empty()) return;
+
+    auto mosaic = std::make_shared<HailoDetection>();
+    mosaic->bbox = HailoBBox(0.0f, 0.0f, 1.0f, 1.0f);
+    mosaic->confidence = 1.0f;
+    mosaic->class_id = -1;
+    mosaic->label = anpr::kLaneMosaicLabel;
+    mosaic->set_stream_id(anpr::stream_id(*roi));
+
+    auto layout = std::make_shared<HailoClassification>();
+    layout->label = "lane_layout";
+    layout->confidence = 1.0f;
+    layout->metadata["type"] = std::string("lane_layout");
+    layout->metadata["tiles"] = params->serialized;
+    mosaic->add_object(layout);
+
+    roi->add_object(mosaic);
+}
+
+/**
+ * Move the plates found in the mosaic to the frame and drop the mosaic.
+ */
+extern "C" void lane_merge(HailoROIPtr roi, void* /*params_void_ptr*/) {
+    std::vector<std::shared_ptr<HailoDetection>> mosaics;
+    for (const auto& object : roi->get_objects_typed(HAILO_DETECTION)) {
+        auto detection = std::dynamic_pointer_cast<HailoDetection>(object);
+        if (detection && detection->label == anpr::kLaneMosaicLabel) mosaics.push_back(detection);
+    }
+
+    for (const auto& mosaic : mosaics) {
+        for (const auto& plate : mosaic->get_objects_typed(HAILO_DETECTION)) roi->add_object(plate);
+        roi->remove_object(mosaic);
+    }
+}
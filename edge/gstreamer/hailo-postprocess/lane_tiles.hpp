@@ -0,0 +1,170 @@
+/**
+ * Lane ROI mosaic for ROI-restricted detection.
+ *
+ * Instead of downscaling the whole frame to the detection input, only the
+ * configured lane ROIs are inferred: LaneLayout packs them as tiles on the
+ * grid of the detection input that gives them the most pixels (each ROI
+ * scaled to fill its cell with its aspect ratio kept), the cropper renders that mosaic straight from the full
+ * resolution frame, and plate_detection maps the boxes found in the mosaic
+ * back to frame coordinates. Boxes whose center falls on the padding between
+ * tiles are dropped before NMS.
+ *
+ * The layout travels with the frame as a flat float vector in the metadata
+ * of a "lane_mosaic" detection (serialize() / parse()), so the cropper and
+ * the detection filter see the same tiles without sharing a config.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+namespace anpr {
+
+// Normalized corner rectangle
+struct NormRect {
+    float x, y, width, height;
+};
+
+struct LaneTile {
+    NormRect frame;           // ROI in the frame, normalized
+    int x, y, width, height;  // placement in the detection input, pixels
+};
+
+class LaneLayout {
+public:
+    static constexpr int kMaxTiles = 8;
+
+    /**
+     * Pack ROIs onto the detection input.
+     *
+     * @param rois: Lane ROIs, normalized to the frame (clamped to it)
+     * @param frame_width, frame_height: Frame size the ROIs keep their
+     *                                   aspect ratio in
+     * @return: false if there are no usable ROIs or more than kMaxTiles
+     */
+    bool build(const NormRect* rois, int count, int frame_width, int frame_height, int input_width,
+               int input_height) {
+        tiles_.clear();
+        input_width_ = input_width;
+        input_height_ = input_height;
+        if (count <= 0 || count > kMaxTiles || frame_width <= 0 || frame_height <= 0) return false;
+
+        // Grid shape that gives the ROIs the most pixels (the smallest scale counts)
+        int cols = 1;
+        float best_scale = -1.0f;
+        for (int c = 1; c <= count; c++) {
+            const float cell_w = static_cast<float>(input_width / c);
+            const float cell_h = static_cast<float>(input_height / ((count + c - 1) / c));
+            float scale = 1e9f;
+            for (int i = 0; i < count; i++) {
+                if (!(rois[i].width > 0.0f) || !(rois[i].height > 0.0f)) continue;
+                scale = std::min(scale, std::min(cell_w / (rois[i].width * frame_width),
+                                                 cell_h / (rois[i].height * frame_height)));
+            }
+            if (scale > best_scale) {
+                best_scale = scale;
+                cols = c;
+            }
+        }
+        const int rows = (count + cols - 1) / cols;
+        const int cell_w = input_width / cols;
+        const int cell_h = input_height / rows;
+
+        for (int i = 0; i < count; i++) {
+            NormRect roi = rois[i];
+            const float x1 = std::min(1.0f, roi.x + roi.width), y1 = std::min(1.0f, roi.y + roi.height);
+            roi.x = std::max(0.0f, roi.x);
+            roi.y = std::max(0.0f, roi.y);
+            roi.width = x1 - roi.x;
+            roi.height = y1 - roi.y;
+            if (!(roi.width > 0.0f) || !(roi.height > 0.0f)) continue;
+
+            const int slot = static_cast<int>(tiles_.size());
+            const float scale =
+                std::min(cell_w / (roi.width * frame_width), cell_h / (roi.height * frame_height));
+            LaneTile tile;
+            tile.frame = roi;
+            tile.width = std::max(1, std::min(cell_w, static_cast<int>(roi.width * frame_width * scale)));
+            tile.height = std::max(1, std::min(cell_h, static_cast<int>(roi.height * frame_height * scale)));
+            tile.x = (slot % cols) * cell_w + (cell_w - tile.width) / 2;
+            tile.y = (slot / cols) * cell_h + (cell_h - tile.height) / 2;
+            tiles_.push_back(tile);
+        }
+        return !tiles_.empty();
+    }
+
+    /**
+     * Map a box from detection input coordinates (normalized) to the frame.
+     * The box is clipped to the tile holding its center.
+     *
+     * @return: false if the center lies outside every tile
+     */
+    bool to_frame(const NormRect& box, NormRect& out) const {
+        const float cx = (box.x + box.width * 0.5f) * input_width_;
+        const float cy = (box.y + box.height * 0.5f) * input_height_;
+
+        for (const LaneTile& tile : tiles_) {
+            if (cx < tile.x || cy < tile.y || cx >= tile.x + tile.width || cy >= tile.y + tile.height) continue;
+
+            const float x0 = std::max(box.x * input_width_, static_cast<float>(tile.x));
+            const float y0 = std::max(box.y * input_height_, static_cast<float>(tile.y));
+            const float x1 = std::min((box.x + box.width) * input_width_, static_cast<float>(tile.x + tile.width));
+            const float y1 = std::min((box.y + box.height) * input_height_, static_cast<float>(tile.y + tile.height));
+
+            const float sx = tile.frame.width / tile.width;
+            const float sy = tile.frame.height / tile.height;
+            out.x = tile.frame.x + (x0 - tile.x) * sx;
+            out.y = tile.frame.y + (y0 - tile.y) * sy;
+            out.width = (x1 - x0) * sx;
+            out.height = (y1 - y0) * sy;
+            return true;
+        }
+        return false;
+    }
+
+    const std::vector<LaneTile>& tiles() const { return tiles_; }
+    int input_width() const { return input_width_; }
+    int input_height() const { return input_height_; }
+
+    /**
+     * Flat form for HailoClassification metadata:
+     * input_width, input_height, then 8 values per tile.
+     */
+    std::vector<float> serialize() const {
+        std::vector<float> out{static_cast<float>(input_width_), static_cast<float>(input_height_)};
+        for (const LaneTile& t : tiles_) {
+            out.insert(out.end(), {t.frame.x, t.frame.y, t.frame.width, t.frame.height, static_cast<float>(t.x),
+                                   static_cast<float>(t.y), static_cast<float>(t.width),
+                                   static_cast<float>(t.height)});
+        }
+        return out;
+    }
+
+    bool parse(const std::vector<float>& data) {
+        tiles_.clear();
+        if (data.size() < 2 || (data.size() - 2) % 8 != 0 || (data.size() - 2) / 8 > kMaxTiles) return false;
+
+        input_width_ = static_cast<int>(data[0]);
+        input_height_ = static_cast<int>(data[1]);
+        for (size_t i = 2; i < data.size(); i += 8) {
+            LaneTile t;
+            t.frame = NormRect{data[i], data[i + 1], data[i + 2], data[i + 3]};
+            t.x = static_cast<int>(data[i + 4]);
+            t.y = static_cast<int>(data[i + 5]);
+            t.width = static_cast<int>(data[i + 6]);
+            t.height = static_cast<int>(data[i + 7]);
+            if (t.width <= 0 || t.height <= 0) return false;
+            tiles_.push_back(t);
+        }
+        return input_width_ > 0 && input_height_ > 0 && !tiles_.empty();
+    }
+
+private:
+    std::vector<LaneTile> tiles_;
+    int input_width_ = 0;
+    int input_height_ = 0;
+};
+
+}  // namespace anpr
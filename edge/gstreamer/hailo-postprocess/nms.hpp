@@ -0,0 +1,267 @@
+/**
+ * Non-Maximum Suppression engine for the detection post-processing.
+ *
+ * Produces exactly the boxes of the classic greedy NMS (sort by confidence,
+ * keep a box unless an already kept box overlaps it by more than the IoU
+ * threshold), but:
+ *  - boxes are stored as structure-of-arrays and only an index array is sorted
+ *  - kept boxes are binned into a uniform grid, so a candidate is only tested
+ *    against kept boxes it can actually overlap
+ *  - all scratch buffers live in the engine and are reused between calls;
+ *    use thread_nms_engine() to get one per streaming thread
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct Detection {
+    float x, y, width, height;
+    float confidence;
+    int class_id;
+};
+
+/**
+ * Compute Intersection over Union (IoU)
+ */
+inline float compute_iou(const Detection& a, const Detection& b) {
+    float x1 = std::max(a.x, b.x);
+    float y1 = std::max(a.y, b.y);
+    float x2 = std::min(a.x + a.width, b.x + b.width);
+    float y2 = std::min(a.y + a.height, b.y + b.height);
+
+    if (x2 < x1 || y2 < y1) return 0.0f;
+
+    float intersection = (x2 - x1) * (y2 - y1);
+    float area_a = a.width * a.height;
+    float area_b = b.width * b.height;
+    float union_area = area_a + area_b - intersection;
+
+    return intersection / union_area;
+}
+
+namespace anpr {
+
+struct NmsOptions {
+    float iou_threshold = 0.45f;
+    // Only the top-K candidates by confidence enter NMS (0 = no cap)
+    size_t max_candidates = 0;
+    // Stop once this many boxes are kept (0 = no cap)
+    size_t max_output = 0;
+};
+
+class NmsEngine {
+public:
+    /**
+     * Run greedy NMS.
+     *
+     * @param detections: Candidate boxes (not modified)
+     * @param count: Number of candidates
+     * @param options: Threshold and caps
+     * @param out: Receives the kept boxes in descending confidence order
+     */
+    void run(const Detection* detections, size_t count, const NmsOptions& options,
+             std::vector<Detection>& out) {
+        out.clear();
+        if (count == 0) return;
+
+        load(detections, count);
+        sort_candidates(options.max_candidates);
+
+        const size_t limit = options.max_output ? options.max_output : order_.size();
+        kept_.clear();
+
+        if (order_.size() <= kBruteForceLimit || options.iou_threshold < 0.0f) {
+            run_linear(options.iou_threshold, limit);
+        } else {
+            run_grid(options.iou_threshold, limit);
+        }
+
+        out.reserve(kept_.size());
+        for (uint32_t idx : kept_) {
+            out.push_back(detections[idx]);
+        }
+    }
+
+private:
+    // Below this many candidates a plain sweep over the kept list is cheaper
+    static constexpr size_t kBruteForceLimit = 32;
+    static constexpr int kMaxGridDim = 32;
+
+    void load(const Detection* detections, size_t count) {
+        x1_.resize(count);
+        y1_.resize(count);
+        x2_.resize(count);
+        y2_.resize(count);
+        area_.resize(count);
+        score_.resize(count);
+
+        for (size_t i = 0; i < count; i++) {
+            const Detection& d = detections[i];
+            x1_[i] = d.x;
+            y1_[i] = d.y;
+            x2_[i] = d.x + d.width;
+            y2_[i] = d.y + d.height;
+            area_[i] = d.width * d.height;
+            score_[i] = d.confidence;
+        }
+    }
+
+    void sort_candidates(size_t max_candidates) {
+        const size_t count = score_.size();
+        order_.resize(count);
+        for (size_t i = 0; i < count; i++) {
+            order_[i] = static_cast<uint32_t>(i);
+        }
+
+        // Descending confidence, ties broken by input order for determinism
+        auto by_score = [this](uint32_t a, uint32_t b) {
+            return score_[a] > score_[b] || (score_[a] == score_[b] && a < b);
+        };
+
+        if (max_candidates && max_candidates < count) {
+            std::partial_sort(order_.begin(), order_.begin() + max_candidates, order_.end(), by_score);
+            order_.resize(max_candidates);
+        } else {
+            std::sort(order_.begin(), order_.end(), by_score);
+        }
+    }
+
+    // IoU of kept box `a` against candidate `b`, same arithmetic as compute_iou()
+    bool overlaps(uint32_t a, uint32_t b, float iou_threshold) const {
+        float x1 = std::max(x1_[a], x1_[b]);
+        float y1 = std::max(y1_[a], y1_[b]);
+        float x2 = std::min(x2_[a], x2_[b]);
+        float y2 = std::min(y2_[a], y2_[b]);
+
+        if (x2 < x1 || y2 < y1) return 0.0f > iou_threshold;
+
+        float intersection = (x2 - x1) * (y2 - y1);
+        float union_area = area_[a] + area_[b] - intersection;
+        return intersection / union_area > iou_threshold;
+    }
+
+    void run_linear(float iou_threshold, size_t limit) {
+        for (uint32_t cand : order_) {
+            bool suppressed = false;
+            for (uint32_t k : kept_) {
+                if (overlaps(k, cand, iou_threshold)) {
+                    suppressed = true;
+                    break;
+                }
+            }
+            if (suppressed) continue;
+
+            kept_.push_back(cand);
+            if (kept_.size() >= limit) break;
+        }
+    }
+
+    void run_grid(float iou_threshold, size_t limit) {
+        setup_grid();
+
+        for (uint32_t cand : order_) {
+            int cx0, cy0, cx1, cy1;
+            cell_range(cand, cx0, cy0, cx1, cy1);
+
+            bool suppressed = false;
+            for (int gy = cy0; gy <= cy1 && !suppressed; gy++) {
+                for (int gx = cx0; gx <= cx1 && !suppressed; gx++) {
+                    for (int32_t e = cell_head_[gy * grid_w_ + gx]; e >= 0; e = entries_[e].next) {
+                        const uint32_t k = entries_[e].box;
+                        // A kept box spanning several cells is only tested once
+                        if (tested_[k] == cand) continue;
+                        tested_[k] = cand;
+
+                        if (overlaps(k, cand, iou_threshold)) {
+                            suppressed = true;
+                            break;
+                        }
+                    }
+                }
+            }
+            if (suppressed) continue;
+
+            kept_.push_back(cand);
+            if (kept_.size() >= limit) break;
+
+            for (int gy = cy0; gy <= cy1; gy++) {
+                for (int gx = cx0; gx <= cx1; gx++) {
+                    const int cell = gy * grid_w_ + gx;
+                    entries_.push_back({cand, cell_head_[cell]});
+                    cell_head_[cell] = static_cast<int32_t>(entries_.size() - 1);
+                }
+            }
+        }
+    }
+
+    void setup_grid() {
+        float min_x = x1_[order_[0]], min_y = y1_[order_[0]];
+        float max_x = x2_[order_[0]], max_y = y2_[order_[0]];
+        for (uint32_t i : order_) {
+            min_x = std::min(min_x, x1_[i]);
+            min_y = std::min(min_y, y1_[i]);
+            max_x = std::max(max_x, x2_[i]);
+            max_y = std::max(max_y, y2_[i]);
+        }
+
+        // Roughly one candidate per cell, capped so the grid stays cache sized
+        const int dim = std::min(kMaxGridDim,
+                                 static_cast<int>(std::sqrt(static_cast<float>(order_.size()))) + 1);
+        grid_w_ = dim;
+        grid_h_ = dim;
+        origin_x_ = min_x;
+        origin_y_ = min_y;
+        inv_cell_w_ = max_x > min_x ? dim / (max_x - min_x) : 0.0f;
+        inv_cell_h_ = max_y > min_y ? dim / (max_y - min_y) : 0.0f;
+
+        cell_head_.assign(static_cast<size_t>(grid_w_) * grid_h_, -1);
+        entries_.clear();
+        tested_.assign(score_.size(), UINT32_MAX);
+    }
+
+    int cell_of(float v, float origin, float inv_cell, int dim) const {
+        int c = static_cast<int>((v - origin) * inv_cell);
+        return std::max(0, std::min(c, dim - 1));
+    }
+
+    void cell_range(uint32_t i, int& cx0, int& cy0, int& cx1, int& cy1) const {
+        cx0 = cell_of(x1_[i], origin_x_, inv_cell_w_, grid_w_);
+        cy0 = cell_of(y1_[i], origin_y_, inv_cell_h_, grid_h_);
+        cx1 = cell_of(x2_[i], origin_x_, inv_cell_w_, grid_w_);
+        cy1 = cell_of(y2_[i], origin_y_, inv_cell_h_, grid_h_);
+    }
+
+    struct GridEntry {
+        uint32_t box;
+        int32_t next;
+    };
+
+    // Structure-of-arrays box storage
+    std::vector<float> x1_, y1_, x2_, y2_, area_, score_;
+
+    std::vector<uint32_t> order_;
+    std::vector<uint32_t> kept_;
+
+    // Uniform grid over the candidate extent, cells hold linked lists of kept boxes
+    int grid_w_ = 0, grid_h_ = 0;
+    float origin_x_ = 0.0f, origin_y_ = 0.0f;
+    float inv_cell_w_ = 0.0f, inv_cell_h_ = 0.0f;
+    std::vector<int32_t> cell_head_;
+    std::vector<GridEntry> entries_;
+    std::vector<uint32_t> tested_;
+};
+
+/**
+ * NMS engine owned by the calling thread; its buffers persist between frames.
+ */
+inline NmsEngine& thread_nms_engine() {
+    static thread_local NmsEngine engine;
+    return engine;
+}
+
+}  // namespace anpr
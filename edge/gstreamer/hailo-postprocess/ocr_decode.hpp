@@ -0,0 +1,266 @@
+/**
+ * OCR output decoding, independent of the Hailo types.
+ *
+ * CTC decoding (greedy or prefix beam search) and plate text validation of
+ * OCR output tensors, shared by the plate_ocr filter and the offline
+ * benchmark (bench/bench_postprocess.cpp). Templated on the plate region
+ * (plate_region.hpp).
+ */
+
+#pragma once
+
+#include "ctc_argmax.hpp"
+#include "ctc_beam.hpp"
+#include "plate_grammar.hpp"
+#include "plate_text.hpp"
+#include "quant.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace anpr {
+
+struct OCRDecodeOptions {
+    bool beam_search = true;  // Prefix beam search; false for greedy decoding
+    int beam_width = 8;
+    float min_confidence = 0.6f;
+    int min_length = 0;  // Accepted plate lengths, 0: the region's limits
+    int max_length = 0;
+};
+
+// Outcome of one decoded crop
+enum class OCRVerdict { Accepted, Invalid, LowConfidence };
+
+// Decoded text and per-character confidences are stored inline (no heap)
+struct OCRResult {
+    PlateText text;
+    float confidence = 0.0f;
+};
+
+/**
+ * Per-thread argmax scratch, sized for the largest batch seen so far.
+ */
+template <typename T>
+struct ArgmaxScratch {
+    std::vector<uint8_t> idx;
+    std::vector<T> val;
+
+    void reserve(size_t rows) {
+        if (idx.size() < rows) {
+            idx.resize(rows);
+            val.resize(rows);
+        }
+    }
+};
+
+template <typename T>
+ArgmaxScratch<T>& argmax_scratch() {
+    static thread_local ArgmaxScratch<T> scratch;
+    return scratch;
+}
+
+/**
+ * Argmax over [rows, num_classes]. When the model width matches the region
+ * the width is a compile-time constant; other widths (e.g. models with extra
+ * classes) use the generic kernel.
+ */
+template <typename Region, typename T>
+void region_argmax(const T* data, size_t rows, int num_classes, uint8_t* idx, T* val) {
+    if (num_classes == Region::num_classes) {
+        argmax_rows<T, Region::num_classes>(data, rows, num_classes, idx, val);
+    } else {
+        argmax_rows<T>(data, rows, num_classes, idx, val);
+    }
+}
+
+/**
+ * CTC collapse of a precomputed best path.
+ * Skips blanks and repeated characters; only emitted scores are dequantized.
+ */
+template <typename Region, typename T>
+OCRResult ctc_collapse(const uint8_t* best_idx, const T* best_val, int timesteps,
+                       const QuantInfo& quant) {
+    OCRResult result;
+
+    int prev_char = Region::blank;
+    float total_conf = 0.0f;
+    int char_count = 0;
+
+    for (int t = 0; t < timesteps; t++) {
+        const int max_idx = best_idx[t];
+
+        // CTC decoding: skip blanks and repeated characters
+        if (max_idx != Region::blank && max_idx != prev_char) {
+            if (max_idx < Region::blank) {
+                const float max_prob = dequantize(best_val[t], quant);
+                if (result.text.push(Region::charset[max_idx], max_prob)) {
+                    total_conf += max_prob;
+                    char_count++;
+                }
+            }
+        }
+
+        prev_char = max_idx;
+    }
+
+    // Calculate average confidence
+    result.confidence = char_count > 0 ? total_conf / char_count : 0.0f;
+
+    return result;
+}
+
+/**
+ * CTC Greedy Decoder
+ * Decodes CTC output sequence by taking the most likely character at each timestep.
+ *
+ * T is float or a native quantized type; the argmax runs on raw values
+ * (dequantization is monotonic) and only the winning score is dequantized.
+ */
+template <typename Region, typename T>
+OCRResult ctc_greedy_decode(const T* output_data, int timesteps, int num_classes,
+                            const QuantInfo& quant = QuantInfo{}) {
+    ArgmaxScratch<T>& scratch = argmax_scratch<T>();
+    scratch.reserve(timesteps);
+
+    region_argmax<Region>(output_data, timesteps, num_classes, scratch.idx.data(), scratch.val.data());
+    return ctc_collapse<Region>(scratch.idx.data(), scratch.val.data(), timesteps, quant);
+}
+
+/**
+ * Plate format automaton of a region, compiled once on first use.
+ */
+template <typename Region>
+const PlateGrammar* plate_grammar() {
+    static const PlateGrammar grammar = [] {
+        PlateGrammar g;
+        g.compile(Region::format, Region::charset);
+        return g;
+    }();
+    return grammar.enabled() ? &grammar : nullptr;
+}
+
+/**
+ * CTC Beam Search Decoder (more accurate but slower)
+ * Considers multiple candidate sequences and returns the most likely one.
+ * Prefixes that cannot match the region's plate format are dropped during the search.
+ */
+template <typename Region, typename T>
+OCRResult ctc_beam_search_decode(const T* output_data, int timesteps, int num_classes, const QuantInfo& quant,
+                                 int beam_width) {
+    // Decoder state is fixed-size, one instance per streaming thread
+    static thread_local CtcBeamSearch decoder;
+
+    BeamSearchOptions options;
+    options.beam_width = beam_width;
+    options.grammar = plate_grammar<Region>();
+
+    BeamSearchResult beam;
+    decoder.decode(output_data, timesteps, num_classes, Region::blank, quant, options, beam);
+
+    OCRResult result;
+    result.confidence = beam.confidence;
+    for (int i = 0; i < beam.length; i++) {
+        if (beam.symbols[i] >= Region::blank) continue;  // Model classes outside the charset
+        result.text.push(Region::charset[beam.symbols[i]], beam.char_confidences[i]);
+    }
+
+    return result;
+}
+
+/**
+ * Post-process and validate plate text
+ * Apply regex patterns, length checks, etc.
+ *
+ * @param text: Decoded text
+ * @param cleaned: Receives the text with invalid characters removed
+ * @param min_length: Shortest accepted plate
+ * @param max_length: Longest accepted plate
+ * @return: false if the plate is invalid
+ */
+template <typename Region>
+bool validate_plate_text(const PlateText& text, PlateText& cleaned, int min_length = Region::min_length,
+                         int max_length = Region::max_length) {
+    static constexpr CharTable char_table(Region::charset);
+
+    // Remove any invalid characters
+    cleaned.clear();
+    for (int i = 0; i < text.length; i++) {
+        if (char_table.contains(text.chars[i])) {
+            cleaned.push(text.chars[i], text.confidences[i]);
+        }
+    }
+
+    return cleaned.length >= min_length && cleaned.length <= max_length;
+}
+
+/**
+ * Validate a decoded read against the region, the length limits and the
+ * confidence threshold.
+ *
+ * @param cleaned: Receives the validated text
+ * @return: Accepted, or why the read was rejected (validation first)
+ */
+template <typename Region>
+OCRVerdict check_read(const OCRResult& result, const OCRDecodeOptions& options, PlateText& cleaned) {
+    const int min_length = options.min_length > 0 ? options.min_length : Region::min_length;
+    const int max_length = options.max_length > 0 ? options.max_length : Region::max_length;
+    if (!validate_plate_text<Region>(result.text, cleaned, min_length, max_length)) return OCRVerdict::Invalid;
+    if (result.confidence < options.min_confidence) return OCRVerdict::LowConfidence;
+    return OCRVerdict::Accepted;
+}
+
+/**
+ * Decode N consecutive [timesteps, num_classes] blocks of element type T.
+ * Greedy decoding runs a single argmax pass over all N blocks.
+ */
+template <typename Region, typename T>
+void decode_blocks(const T* data, size_t num_crops, int timesteps, int num_classes, const QuantInfo& quant,
+                   const OCRDecodeOptions& options, OCRResult* out) {
+    const size_t block = static_cast<size_t>(timesteps) * num_classes;
+    if (options.beam_search) {
+        for (size_t i = 0; i < num_crops; i++) {
+            out[i] = ctc_beam_search_decode<Region>(data + i * block, timesteps, num_classes, quant,
+                                                    options.beam_width);
+        }
+        return;
+    }
+
+    const size_t rows = num_crops * timesteps;
+    ArgmaxScratch<T>& scratch = argmax_scratch<T>();
+    scratch.reserve(rows);
+
+    region_argmax<Region>(data, rows, num_classes, scratch.idx.data(), scratch.val.data());
+
+    for (size_t i = 0; i < num_crops; i++) {
+        const size_t offset = i * timesteps;
+        out[i] = ctc_collapse<Region>(scratch.idx.data() + offset, scratch.val.data() + offset, timesteps, quant);
+    }
+}
+
+/**
+ * Decode the OCR output of `num_crops` crops (1 for the per-ROI filter).
+ *
+ * @param data: num_crops consecutive [timesteps, num_classes] blocks
+ * @param out: Receives num_crops results
+ */
+template <typename Region>
+void decode_crops(const void* data, TensorDType dtype, size_t num_crops, int timesteps, int num_classes,
+                  const QuantInfo& quant, const OCRDecodeOptions& options, OCRResult* out) {
+    switch (dtype) {
+        case TensorDType::UInt8:
+            decode_blocks<Region>(static_cast<const uint8_t*>(data), num_crops, timesteps, num_classes, quant,
+                                  options, out);
+            break;
+        case TensorDType::UInt16:
+            decode_blocks<Region>(static_cast<const uint16_t*>(data), num_crops, timesteps, num_classes, quant,
+                                  options, out);
+            break;
+        default:
+            decode_blocks<Region>(static_cast<const float*>(data), num_crops, timesteps, num_classes, QuantInfo{},
+                                  options, out);
+            break;
+    }
+}
+
+}  // namespace anpr
@@ -0,0 +1,92 @@
+/**
+ * Plate OCR of a frame's crops, independent of the Hailo types.
+ *
+ * The per-ROI filter (plate_ocr_<region>) reads one crop per call; the frame
+ * filter (plate_ocr_frame_<region>) runs after the OCR branch's
+ * hailoaggregator and reads every crop of the frame at once. Both go through
+ * these functions: read_crops decodes and validates the crops, on the shared
+ * worker pool (worker_pool.hpp) when it has threads, and joins before
+ * returning; the caller then reports the accepted reads with report_read in
+ * ROI order, so the track registry and the event ring see the same sequence
+ * from either filter.
+ */
+
+#pragma once
+
+#include "event_ring.hpp"
+#include "ocr_decode.hpp"
+#include "quant.hpp"
+#include "track_registry.hpp"
+#include "worker_pool.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace anpr {
+
+// OCR output of one plate crop and what its detection carried
+struct OCRCrop {
+    const void* data = nullptr;  // [timesteps, num_classes] block
+    TensorDType dtype = TensorDType::Float32;
+    QuantInfo quant;
+    int timesteps = 0;
+    int num_classes = 0;
+    OCRDecodeOptions options;  // the camera's decoding options
+
+    std::string stream;  // stream id, empty in single-stream pipelines
+    uint64_t track_id = 0;
+    uint64_t trace_frame = 0;  // frame_trace.hpp id, 0 if not traced
+    float bbox[4] = {};        // normalized x, y, width, height; zero without a detection
+    float detection_confidence = 0.0f;
+};
+
+struct OCRRead {
+    OCRResult result;
+    PlateText text;  // validated text of an accepted read
+    OCRVerdict verdict = OCRVerdict::Invalid;
+};
+
+template <typename Region>
+void read_crop(const OCRCrop& crop, OCRRead& read) {
+    decode_crops<Region>(crop.data, crop.dtype, 1, crop.timesteps, crop.num_classes, crop.quant, crop.options,
+                         &read.result);
+    read.verdict = check_read<Region>(read.result, crop.options, read.text);
+}
+
+/**
+ * Decode and validate `count` crops; reads[i] belongs to crops[i].
+ *
+ * With workers configured the crops are spread over the pool, the calling
+ * thread taking its share; otherwise they are read on the calling thread.
+ */
+template <typename Region>
+void read_crops(const OCRCrop* crops, size_t count, OCRRead* reads, WorkerPool& pool = WorkerPool::instance()) {
+    if (pool.threads() > 0 && count > 1) {
+        pool.parallel_for(count, [&](size_t i) { read_crop<Region>(crops[i], reads[i]); });
+        return;
+    }
+    for (size_t i = 0; i < count; i++) read_crop<Region>(crops[i], reads[i]);
+}
+
+/**
+ * Report an accepted read: into its track's consensus (the cropper also
+ * sees the track has a read, crop-level dedup) and as a plate event into
+ * `ring` (dropped and counted there if Python is not keeping up).
+ */
+inline void report_read(const OCRCrop& crop, const OCRRead& read, TrackRegistry& registry, PlateEventRing* ring) {
+    registry.report_read(crop.track_id, read.text.chars, read.text.length, read.result.confidence,
+                         read.text.confidences, crop.trace_frame);
+    if (!ring) return;
+
+    PlateEventRecord record =
+        make_event_record(PlateEventKind::Read, crop.stream, crop.track_id, read.text.chars, read.text.length);
+    record.ocr_confidence = read.result.confidence;
+    record.trace_frame = crop.trace_frame;
+    std::copy(crop.bbox, crop.bbox + 4, record.bbox);
+    record.detection_confidence = crop.detection_confidence;
+    ring->push(record);
+}
+
+}  // namespace anpr
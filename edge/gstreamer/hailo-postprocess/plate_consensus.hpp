@@ -0,0 +1,169 @@
+/**
+ * Character-level plate consensus over the OCR reads of one track.
+ *
+ * Every accepted read votes per position with its per-character confidences
+ * (plate_ocr's char_confidences), so a track can settle on a text that no
+ * single frame read completely: "ABC1Z3" and "A8C123" still fuse to
+ * "ABC123". Reads are aligned by position within their length; reads of up
+ * to kMaxLengths distinct lengths are kept apart (a dropped character shifts
+ * every position after it) and count against the others.
+ *
+ * The support of a position is the winning character's confidence weight
+ * over all weight that position could have received, including reads of
+ * other lengths; the consensus is the weakest position's support. Storage
+ * is fixed (no heap), so an accumulator can live in each TrackRegistry slot.
+ */
+
+#pragma once
+
+#include "plate_text.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+namespace anpr {
+
+struct ConsensusResult {
+    PlateText text;          // winning character per position, with its mean confidence
+    float confidence = 0.0f;  // mean of the text's character confidences
+    float consensus = 0.0f;   // support of the weakest position, [0, 1]
+    uint32_t votes = 0;       // reads agreeing at the weakest-agreeing position
+};
+
+class PlateConsensus {
+public:
+    static constexpr int kMaxLengths = 2;
+    static constexpr int kMaxCandidates = 4;  // characters tracked per position
+
+    /**
+     * Add one read.
+     *
+     * @param char_confidences: Per-character confidences, or nullptr to
+     *                          weigh every character with `confidence`
+     * @param confidence: Read confidence, its weight against other lengths
+     */
+    void add(const char* text, const float* char_confidences, int length, float confidence) {
+        if (length <= 0) return;
+        length = std::min(length, kMaxPlateChars);
+        reads_++;
+        total_weight_ += confidence;
+
+        LengthSlot& slot = length_slot(length);
+        slot.reads++;
+        slot.weight += confidence;
+        for (int p = 0; p < length; p++) {
+            vote(slot.positions[p], text[p], char_confidences ? char_confidences[p] : confidence);
+        }
+    }
+
+    /**
+     * Fuse the reads so far.
+     *
+     * @return: false if there are no reads
+     */
+    bool result(ConsensusResult& out) const {
+        out = ConsensusResult();
+        const LengthSlot* best = nullptr;
+        for (int i = 0; i < num_lengths_; i++) {
+            if (!best || slots_[i].weight > best->weight) best = &slots_[i];
+        }
+        if (!best) return false;
+
+        const float other_weight = total_weight_ - best->weight;
+        float confidence_sum = 0.0f;
+        out.consensus = 1.0f;
+        out.votes = best->reads;
+        for (int p = 0; p < best->length; p++) {
+            const Position& position = best->positions[p];
+            const Candidate* winner = &position.candidates[0];
+            for (int c = 1; c < position.num_candidates; c++) {
+                if (position.candidates[c].weight > winner->weight) winner = &position.candidates[c];
+            }
+
+            const float char_confidence = winner->weight / winner->count;
+            out.text.push(winner->c, char_confidence);
+            confidence_sum += char_confidence;
+
+            const float available = position.total + other_weight;
+            out.consensus = std::min(out.consensus, available > 0.0f ? winner->weight / available : 0.0f);
+            out.votes = std::min<uint32_t>(out.votes, winner->count);
+        }
+        out.confidence = confidence_sum / best->length;
+        return true;
+    }
+
+    uint32_t reads() const { return reads_; }
+
+private:
+    struct Candidate {
+        char c;
+        uint16_t count;
+        float weight;
+    };
+
+    struct Position {
+        Candidate candidates[kMaxCandidates];
+        int num_candidates;
+        float total;  // all weight voted here, evicted candidates included
+    };
+
+    struct LengthSlot {
+        int length;
+        uint32_t reads;
+        float weight;  // sum of the reads' confidences
+        Position positions[kMaxPlateChars];
+    };
+
+    // Slot of `length`; when all are taken the lightest one starts over
+    LengthSlot& length_slot(int length) {
+        for (int i = 0; i < num_lengths_; i++) {
+            if (slots_[i].length == length) return slots_[i];
+        }
+
+        int s = num_lengths_;
+        if (s == kMaxLengths) {
+            s = 0;
+            for (int i = 1; i < num_lengths_; i++) {
+                if (slots_[i].weight < slots_[s].weight) s = i;
+            }
+        } else {
+            num_lengths_++;
+        }
+        LengthSlot& slot = slots_[s];
+        std::memset(&slot, 0, sizeof(slot));
+        slot.length = length;
+        return slot;
+    }
+
+    // Add weight to a position's candidate; when full the lightest one is replaced
+    static void vote(Position& position, char c, float weight) {
+        position.total += weight;
+        for (int i = 0; i < position.num_candidates; i++) {
+            Candidate& candidate = position.candidates[i];
+            if (candidate.c == c) {
+                candidate.count++;
+                candidate.weight += weight;
+                return;
+            }
+        }
+
+        int i = position.num_candidates;
+        if (i == kMaxCandidates) {
+            i = 0;
+            for (int k = 1; k < kMaxCandidates; k++) {
+                if (position.candidates[k].weight < position.candidates[i].weight) i = k;
+            }
+        } else {
+            position.num_candidates++;
+        }
+        position.candidates[i] = Candidate{c, 1, weight};
+    }
+
+    LengthSlot slots_[kMaxLengths] = {};
+    int num_lengths_ = 0;
+    uint32_t reads_ = 0;
+    float total_weight_ = 0.0f;
+};
+
+}  // namespace anpr
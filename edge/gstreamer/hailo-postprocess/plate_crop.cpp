@@ -3,11 +3,217 @@
  *
  * This plugin crops detected license plate regions and prepares them
  * for the OCR model.
+ *
+ * Crops are produced here in a single fused pass (plate_resize.hpp): the
+ * plate is read straight from the RGB/NV12 frame, resized bilinearly to the
+ * OCR input size and converted to RGB, so hailocropper forwards the buffer
+ * as-is. Detections are normalized, so the same code crops from the
+ * inference frame or from the full-resolution decoded frame (the pipeline's
+ * dual-resolution mode, where hailomuxer attaches the detections of a
+ * downscaled branch to the decoded NV12 frame).
+ *
+ * Detections are associated across frames (crop_dedup.hpp, or the track ids
+ * of plate_tracker when it runs upstream) and each crop is tagged with its
+ * track id; tracks that already have a stable OCR read are only re-sent to
+ * OCR every DEDUP_REVERIFY_INTERVAL frames. Dedup state is kept per stream
+ * id, so one cropper serves all cameras of a multi-stream pipeline.
+ *
+ * crop_lanes renders the lane ROI mosaic for ROI-restricted detection
+ * (lane_tiles.hpp) with the same kernel, from the full-resolution frame.
+ *
+ * Cameras throttled by the inference scheduler (scheduler.hpp) get only
+ * their share of a frame's OCR crops admitted; the rest is deferred to a
+ * later frame of the track.
+ *
+ * When plate_tracker decides a track's plate, crop_plates also takes that
+ * track's evidence snapshot from the same frame: a plate crop with some
+ * context and a downscaled frame, copied into a job of the shared evidence
+ * encoder (evidence.hpp), which JPEG-encodes them off the streaming thread.
+ *
+ * Both record their latency and crop counters per streaming thread
+ * (stage_stats.hpp). Traced frames (frame_trace.hpp) are stamped when
+ * crop_plates starts on them; the crops keep the trace tag for plate_ocr.
+ *
+ * The OCR input size comes from the camera's postprocess parameters
+ * (postprocess_params.hpp, loaded by plate_detection/plate_ocr). In the
+ * pipeline's zero-copy mode the frames are DMA-BUF buffers of the hardware
+ * decoder/converter mapped by hailocropper; the "crop.dmabuf" parameter then
+ * has both croppers stage the rows under each crop (CropResizer::run_staged)
+ * instead of resampling straight from uncached memory.
  */
 
 #include "hailo_common.hpp"
+#include "crop_dedup.hpp"
+#include "crop_pool.hpp"
+#include "event_ring.hpp"
+#include "evidence.hpp"
+#include "frame_trace.hpp"
+#include "hailo_image.hpp"
+#include "hailo_roi.hpp"
+#include "plate_resize.hpp"
+#include "postprocess_params.hpp"
+#include "scene_activity.hpp"
+#include "scheduler.hpp"
+#include "stage_stats.hpp"
+#include "track_registry.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
+// OCR model input channels; the size is a postprocess parameter
+const int OCR_CHANNELS = 3;  // RGB
+
+// Detection network input; with letterboxing the detections are mapped back
+// to the frame before cropping
+const bool DETECTION_LETTERBOX = false;
+const int DETECTION_WIDTH = 640;
+const int DETECTION_HEIGHT = 480;
+
+// Crop buffers per pipeline, and how long a frame may wait for a free one
+// before its remaining crops are dropped
+const size_t CROP_POOL_SLOTS = 32;
+const std::chrono::milliseconds CROP_POOL_WAIT(20);
+
+// Skip OCR for tracks with a stable read (same text DEDUP_STABLE_READS times
+// in a row at DEDUP_STABLE_CONFIDENCE or better), re-verifying every Nth frame
+const bool DEDUP_ENABLED = true;
+const float DEDUP_MATCH_IOU = 0.3f;
+const float DEDUP_STABLE_CONFIDENCE = 0.85f;
+const uint32_t DEDUP_STABLE_READS = 2;
+const uint32_t DEDUP_REVERIFY_INTERVAL = 10;
+const uint32_t DEDUP_MAX_MISSED_FRAMES = 10;
+
+// Lane mosaic buffers per pipeline (frames in flight in the detection network)
+const size_t LANE_POOL_SLOTS = 4;
+const std::chrono::milliseconds LANE_POOL_WAIT(50);
+
+// Stage counters (stage_stats.hpp)
+enum CropCounter { DETECTIONS, CROPS, DEDUP_SKIPPED, POOL_DROPPED, EVIDENCE, OCR_DEFERRED };
+enum LaneCounter { MOSAICS, FULL_FRAMES, LANE_POOL_DROPPED };
+
+/**
+ * Crop buffer pool of the calling streaming thread (one per pipeline),
+ * labelled with the thread name so stats can be matched to a camera.
+ * Replaced when the crop size changes or the thread is renamed (reused by
+ * another pipeline); crops still in flight keep the old pool alive.
+ */
+anpr::CropBufferPool& thread_crop_pool(size_t slot_bytes) {
+    static thread_local anpr::ThreadNameCache<std::shared_ptr<anpr::CropBufferPool>> pools;
+    const auto create = [slot_bytes](const char* name) {
+        return anpr::CropBufferPool::create(name, CROP_POOL_SLOTS, slot_bytes);
+    };
+    std::shared_ptr<anpr::CropBufferPool>& pool = pools.get("crop", create);
+    if (pool->slot_bytes() != slot_bytes) pool = create(pools.name());
+    return *pool;
+}
+
+/**
+ * Dedup state of one stream.
+ */
+struct StreamCropState {
+    anpr::CropDedup dedup;
+    bool tracker_upstream = false;  // detections arrive with plate_tracker ids
+};
+
+/**
+ * Map a normalized detection box to frame pixels, undoing the detection
+ * input letterbox if enabled.
+ */
+anpr::CropRect to_frame_rect(const HailoBBox& bbox, int frame_width, int frame_height) {
+    float x = bbox.x, y = bbox.y, w = bbox.width, h = bbox.height;
+
+    if (DETECTION_LETTERBOX) {
+        const float scale = std::min(static_cast<float>(DETECTION_WIDTH) / frame_width,
+                                     static_cast<float>(DETECTION_HEIGHT) / frame_height);
+        const float content_w = frame_width * scale / DETECTION_WIDTH;
+        const float content_h = frame_height * scale / DETECTION_HEIGHT;
+        x = (x - (1.0f - content_w) * 0.5f) / content_w;
+        y = (y - (1.0f - content_h) * 0.5f) / content_h;
+        w /= content_w;
+        h /= content_h;
+    }
+
+    // Clamp to image boundaries
+    const float x0 = std::max(0.0f, x) * frame_width;
+    const float y0 = std::max(0.0f, y) * frame_height;
+    const float x1 = std::min(1.0f, x + w) * frame_width;
+    const float y1 = std::min(1.0f, y + h) * frame_height;
+
+    return anpr::CropRect{x0, y0, x1 - x0, y1 - y0};
+}
+
+/**
+ * Size of a snapshot of `width` x `height` pixels at most `max_width` wide
+ * (never upscaled), with an even height for the encoder's chroma subsampling.
+ */
+void evidence_size(float width, float height, int max_width, uint32_t& out_width, uint32_t& out_height) {
+    const float scale = std::min(1.0f, static_cast<float>(max_width) / width);
+    out_width = static_cast<uint32_t>(std::max(2.0f, width * scale));
+    out_height = static_cast<uint32_t>(std::max(2.0f, height * scale)) & ~1u;
+}
+
+/**
+ * Copy the evidence of a decided track (plate with context, downscaled
+ * frame) into an encoder job and queue it.
+ *
+ * @return: false if no job was free or the frame could not be resampled
+ */
+bool submit_evidence(anpr::CropResizer& resizer, const anpr::ImageView& view, const anpr::CropRect& plate,
+                     int frame_width, int frame_height, const anpr::PostprocessParams& params,
+                     const std::string& stream, uint64_t track_id) {
+    // The evidence drain of the thread's current pipeline takes it by this prefix
+    static thread_local anpr::ThreadNameCache<std::string> sources;
+    const std::string& source = sources.get("crop", [](const char* name) { return std::string(name); });
+
+    anpr::EvidenceEncoder& encoder = anpr::EvidenceEncoder::instance();
+    anpr::EvidenceEncoder::Job* job = encoder.acquire();
+    if (!job) return false;
+
+    anpr::EvidenceInfo& info = job->info;
+    std::memset(&info, 0, sizeof(info));
+    std::memcpy(info.source, source.c_str(), std::min(source.size(), sizeof(info.source) - 1));
+    timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    info.timestamp_ns = static_cast<uint64_t>(now.tv_sec) * 1000000000ull + static_cast<uint64_t>(now.tv_nsec);
+    info.track_id = track_id;
+    info.stream_index = anpr::stream_index(stream);
+    job->quality = params.evidence_quality;
+
+    // Plate with context, clamped to the frame
+    const float margin_x = plate.width * params.evidence_margin;
+    const float margin_y = plate.height * params.evidence_margin;
+    const float x0 = std::max(0.0f, plate.x - margin_x);
+    const float y0 = std::max(0.0f, plate.y - margin_y);
+    const float x1 = std::min(static_cast<float>(frame_width), plate.x + plate.width + margin_x);
+    const float y1 = std::min(static_cast<float>(frame_height), plate.y + plate.height + margin_y);
+    const anpr::CropRect context{x0, y0, x1 - x0, y1 - y0};
+    const anpr::CropRect frame{0.0f, 0.0f, static_cast<float>(frame_width), static_cast<float>(frame_height)};
+
+    evidence_size(context.width, context.height, params.evidence_plate_width, info.plate_width, info.plate_height);
+    evidence_size(frame.width, frame.height, params.evidence_frame_width, info.frame_width, info.frame_height);
+    const size_t plate_stride = static_cast<size_t>(info.plate_width) * OCR_CHANNELS;
+    const size_t frame_stride = static_cast<size_t>(info.frame_width) * OCR_CHANNELS;
+    job->plate_rgb.resize(plate_stride * info.plate_height);
+    job->frame_rgb.resize(frame_stride * info.frame_height);
+
+    const bool resized =
+        resizer.run(view, context, job->plate_rgb.data(), static_cast<int>(info.plate_width),
+                    static_cast<int>(info.plate_height), plate_stride) &&
+        resizer.run(view, frame, job->frame_rgb.data(), static_cast<int>(info.frame_width),
+                    static_cast<int>(info.frame_height), frame_stride);
+    if (!resized) {
+        encoder.release(job);
+        return false;
+    }
+
+    encoder.submit(job);
+    return true;
+}
+
 /**
  * Main cropper function called by GStreamer hailocropper element.
  *
@@ -19,37 +225,240 @@ extern "C" std::vector<HailoCroppedImage> crop_plates(
     HailoImagePtr image,
     std::vector<HailoDetection> detections
 ) {
+    static thread_local anpr::CropResizer resizer;
+    static thread_local std::unordered_map<std::string, StreamCropState> streams;
+    static thread_local std::vector<anpr::DedupBox> boxes;
+    static thread_local std::vector<anpr::DedupDecision> decisions;
+    static thread_local std::vector<uint64_t> track_ids;
+    static thread_local anpr::ThreadStage stage(
+        "crop_plates", {"detections", "crops", "dedup_skipped", "pool_dropped", "evidence", "ocr_deferred"});
+    anpr::StageStats& stats = stage.get();
+    anpr::StageTimer timer(stats);
+    stats.add(DETECTIONS, detections.size());
+
+    // All detections of a frame come from the same stream. Frames without
+    // detections carry no stream id, so multi-stream pipelines run
+    // plate_tracker upstream (it sees every frame) rather than relying on the
+    // missed-frame aging of the local dedup
+    const std::string stream = detections.empty() ? std::string() : anpr::stream_id(detections[0]);
+    if (!detections.empty()) {
+        anpr::FrameTracer::instance().stamp(anpr::trace_frame(detections[0]), anpr::TraceStage::Crop,
+                                            anpr::monotonic_ns());
+    }
+    StreamCropState& state = streams[stream];
+    bool& tracker_upstream = state.tracker_upstream;
+
+    // Same camera key as plate_detection, which runs on this thread
+    const std::string& camera = stream.empty() ? anpr::thread_activity_key() : stream;
+    const anpr::PostprocessParams& params = anpr::thread_postprocess_params(camera);
+    const int ocr_width = params.ocr_width;
+    const int ocr_height = params.ocr_height;
+    const bool staged = params.crop_dmabuf;
+    const size_t stride = static_cast<size_t>(ocr_width) * OCR_CHANNELS;
+
     std::vector<HailoCroppedImage> cropped_plates;
+    cropped_plates.reserve(detections.size());
 
-    // OCR model input size (adjust based on your model)
-    const int OCR_WIDTH = 200;
-    const int OCR_HEIGHT = 64;
+    decisions.assign(detections.size(), anpr::DedupDecision());
+    if (DEDUP_ENABLED) {
+        anpr::DedupOptions options;
+        options.match_iou = DEDUP_MATCH_IOU;
+        options.stable_confidence = DEDUP_STABLE_CONFIDENCE;
+        options.stable_reads = DEDUP_STABLE_READS;
+        options.reverify_interval = DEDUP_REVERIFY_INTERVAL;
+        options.max_missed_frames = DEDUP_MAX_MISSED_FRAMES;
 
-    for (const auto& det : detections) {
-        // Get detection bounding box
-        int x = static_cast<int>(det.bbox.x * image->width);
-        int y = static_cast<int>(det.bbox.y * image->height);
-        int w = static_cast<int>(det.bbox.width * image->width);
-        int h = static_cast<int>(det.bbox.height * image->height);
-
-        // Clamp to image boundaries
-        x = std::max(0, std::min(x, image->width - 1));
-        y = std::max(0, std::min(y, image->height - 1));
-        w = std::min(w, image->width - x);
-        h = std::min(h, image->height - y);
+        // With plate_tracker upstream, reuse its track ids instead of associating here
+        track_ids.clear();
+        for (const auto& det : detections) {
+            track_ids.push_back(anpr::track_id(det));
+            tracker_upstream = tracker_upstream || track_ids.back() != 0;
+        }
+
+        if (tracker_upstream) {
+            state.dedup.update_tracked(track_ids.data(), track_ids.size(), options, decisions.data());
+        } else {
+            boxes.clear();
+            for (const auto& det : detections) {
+                boxes.push_back(anpr::DedupBox{det.bbox.x, det.bbox.y, det.bbox.width, det.bbox.height});
+            }
+            state.dedup.update(boxes.data(), boxes.size(), options, decisions.data());
+        }
+    }
+
+    // OCR admission of the camera's schedule, in detection order
+    const size_t wanted = static_cast<size_t>(std::count_if(
+        decisions.begin(), decisions.end(), [](const anpr::DedupDecision& d) { return d.run_ocr; }));
+    size_t ocr_admitted =
+        anpr::InferenceScheduler::instance().admit_ocr(camera, wanted, anpr::InferenceScheduler::now_ns());
+
+    anpr::ImageView view;
+    const bool fused = anpr::image_view(*image, view);
+    const bool evidence = fused && params.evidence_enabled && anpr::EvidenceEncoder::available();
+    bool pool_exhausted = false;
+
+    for (size_t i = 0; i < detections.size(); i++) {
+        const HailoDetection& det = detections[i];
+
+        // Decided tracks (plate_tracker ids) usually skip OCR, their snapshot is taken regardless
+        const uint64_t track_id = evidence ? anpr::track_id(det) : 0;
+        if (track_id && anpr::TrackRegistry::instance().claim_evidence(track_id)) {
+            const anpr::CropRect rect = to_frame_rect(det.bbox, image->width, image->height);
+            if (rect.width >= 1.0f && rect.height >= 1.0f &&
+                submit_evidence(resizer, view, rect, image->width, image->height, params, stream, track_id)) {
+                stats.add(EVIDENCE);
+            }
+        }
+
+        if (!decisions[i].run_ocr) {
+            stats.add(DEDUP_SKIPPED);  // Stable read, not due for re-verification
+            continue;
+        }
+
+        const anpr::CropRect rect = to_frame_rect(det.bbox, image->width, image->height);
 
         // Skip invalid crops
-        if (w <= 0 || h <= 0) continue;
+        if (rect.width < 1.0f || rect.height < 1.0f) continue;
+        if (ocr_admitted == 0) {
+            stats.add(OCR_DEFERRED);  // Camera over its OCR share
+            continue;
+        }
+        ocr_admitted--;
 
         // Crop and resize for OCR
         HailoCroppedImage crop;
-        crop.bbox = HailoBBox(x, y, w, h);
-        crop.target_width = OCR_WIDTH;
-        crop.target_height = OCR_HEIGHT;
+        crop.bbox = HailoBBox(rect.x, rect.y, rect.width, rect.height);
+        crop.target_width = ocr_width;
+        crop.target_height = ocr_height;
         crop.detection = det;
+        if (decisions[i].track_id && !tracker_upstream) {
+            anpr::set_track_id(crop.detection, decisions[i].track_id);
+        }
+
+        // Other pixel formats fall back to hailocropper's own resize
+        if (fused) {
+            std::shared_ptr<uint8_t> out =
+                pool_exhausted ? nullptr : thread_crop_pool(stride * ocr_height).acquire(CROP_POOL_WAIT);
+            if (!out) {
+                pool_exhausted = true;  // OCR is not keeping up, drop the rest of this frame
+                stats.add(POOL_DROPPED);
+                continue;
+            }
 
-        cropped_plates.push_back(crop);
+            const bool resized = staged ? resizer.run_staged(view, rect, out.get(), ocr_width, ocr_height, stride)
+                                        : resizer.run(view, rect, out.get(), ocr_width, ocr_height, stride);
+            if (resized) {
+                anpr::attach_crop_buffer(crop, std::move(out), stride);
+            }
+        }
+
+        cropped_plates.push_back(std::move(crop));
     }
 
+    stats.add(CROPS, cropped_plates.size());
     return cropped_plates;
 }
+
+/**
+ * Lane mosaic cropper called by the hailocropper in front of the detection
+ * network (ROI-restricted detection).
+ *
+ * @param image: Full-resolution frame
+ * @param detections: Frame detections; lane_layout() adds the mosaic one
+ * @return: The mosaic as a single crop of the detection input size, or the
+ *          whole frame (plain detection) for pixel formats the kernel lacks
+ */
+extern "C" std::vector<HailoCroppedImage> crop_lanes(
+    HailoImagePtr image,
+    std::vector<HailoDetection> detections
+) {
+    static thread_local anpr::CropResizer resizer;
+    static thread_local anpr::LaneLayout layout;
+    static thread_local std::vector<float> pool_layout;
+    static thread_local anpr::ThreadNameCache<std::shared_ptr<anpr::CropBufferPool>> pools;
+    static thread_local anpr::ThreadStage stage("crop_lanes", {"mosaics", "full_frames", "pool_dropped"});
+    anpr::StageStats& stats = stage.get();
+    anpr::StageTimer timer(stats);
+
+    // Lane detection is single-stream: the "<prefix>_lanes" thread's camera
+    const bool staged = anpr::thread_postprocess_params(anpr::thread_activity_key()).crop_dmabuf;
+
+    std::vector<HailoCroppedImage> crops;
+    for (const auto& det : detections) {
+        if (det.label != anpr::kLaneMosaicLabel) continue;
+
+        HailoCroppedImage crop;
+        crop.bbox = HailoBBox(0.0f, 0.0f, static_cast<float>(image->width), static_cast<float>(image->height));
+        crop.target_width = DETECTION_WIDTH;
+        crop.target_height = DETECTION_HEIGHT;
+
+        anpr::ImageView view;
+        if (!anpr::lane_layout(det, layout) || !anpr::image_view(*image, view)) {
+            // Infer the whole frame; without a layout plate_detection keeps frame coordinates
+            crop.detection.bbox = det.bbox;
+            crop.detection.confidence = det.confidence;
+            crop.detection.class_id = det.class_id;
+            crop.detection.label = det.label;
+            crops.push_back(std::move(crop));
+            stats.add(FULL_FRAMES);
+            break;
+        }
+
+        // Padding between tiles stays black: slots start zeroed and every
+        // frame writes the same tiles, so the pool is rebuilt on layout change
+        const std::vector<float> key = layout.serialize();
+        const size_t stride = static_cast<size_t>(layout.input_width()) * OCR_CHANNELS;
+        const auto create = [&](const char* name) {
+            pool_layout = key;
+            return anpr::CropBufferPool::create(name, LANE_POOL_SLOTS, stride * layout.input_height());
+        };
+        std::shared_ptr<anpr::CropBufferPool>& pool = pools.get("lanes", create);
+        if (key != pool_layout) pool = create(pools.name());
+
+        std::shared_ptr<uint8_t> out = pool->acquire(LANE_POOL_WAIT);
+        if (!out) {
+            stats.add(LANE_POOL_DROPPED);  // Detection network is not keeping up, skip this frame
+            break;
+        }
+
+        for (const anpr::LaneTile& tile : layout.tiles()) {
+            const anpr::CropRect rect{tile.frame.x * image->width, tile.frame.y * image->height,
+                                      tile.frame.width * image->width, tile.frame.height * image->height};
+            uint8_t* dst =
+                out.get() + static_cast<size_t>(tile.y) * stride + static_cast<size_t>(tile.x) * OCR_CHANNELS;
+            if (staged) {
+                resizer.run_staged(view, rect, dst, tile.width, tile.height, stride);
+            } else {
+                resizer.run(view, rect, dst, tile.width, tile.height, stride);
+            }
+        }
+
+        crop.target_width = layout.input_width();
+        crop.target_height = layout.input_height();
+        crop.detection = det;
+        anpr::attach_crop_buffer(crop, std::move(out), stride);
+        crops.push_back(std::move(crop));
+        stats.add(MOSAICS);
+        break;
+    }
+    return crops;
+}
+
+/**
+ * Number of live crop buffer pools (one per running pipeline).
+ */
+extern "C" size_t crop_pool_count() {
+    return anpr::CropBufferPool::all_stats().size();
+}
+
+/**
+ * Copy occupancy stats of up to `max_pools` pools into `out`.
+ *
+ * @return: Number of entries written
+ */
+extern "C" size_t crop_pool_stats(anpr::CropPoolStats* out, size_t max_pools) {
+    const std::vector<anpr::CropPoolStats> stats = anpr::CropBufferPool::all_stats();
+    const size_t count = std::min(max_pools, stats.size());
+    std::copy(stats.begin(), stats.begin() + count, out);
+    return count;
+}
@@ -3,75 +3,78 @@
  *
  * This plugin processes YOLO detection model outputs and extracts
  * license plate bounding boxes with confidence scores.
+ *
+ * When the ROI is a lane mosaic (ROI-restricted detection, lane_tiles.hpp)
+ * the boxes are mapped from the mosaic back to frame coordinates before NMS,
+ * and boxes centered on the padding between tiles are dropped.
+ *
+ * Per-frame latency, candidates over the threshold and NMS survivors are
+ * recorded per streaming thread (stage_stats.hpp).
+ *
+ * Cameras with tensor capture on (tensor_capture.hpp) get the raw output
+ * tensor of rate-limited frames appended to their dump, and the detections
+ * of those frames tagged so their crops' OCR output is captured as well.
+ *
+ * The thresholds come from the camera's postprocess parameters
+ * (postprocess_params.hpp), loaded from the hailofilter config-path and
+ * reloadable while the stream runs, as do the detection fast mode (top-K
+ * and plate geometry prefilter, detection_decode.hpp) and the plates cap.
+ *
+ * Every processed frame is reported to the inference scheduler
+ * (scheduler.hpp), which measures each camera's throughput and its queue
+ * latency from the frame gate to here.
+ *
+ * With latency tracing on (frame_trace.hpp), the frame's trace is found by
+ * the buffer PTS handed over by the detection queue's pad probe, stamped,
+ * and its id attached to the detections for the stages further down.
  */
 
 #include "hailo_common.hpp"
+#include "detection_decode.hpp"
+#include "event_ring.hpp"
+#include "frame_trace.hpp"
+#include "hailo_roi.hpp"
+#include "hailo_tensor.hpp"
+#include "postprocess_params.hpp"
+#include "scene_activity.hpp"
+#include "scheduler.hpp"
+#include "stage_stats.hpp"
+#include "tensor_capture.hpp"
 #include <algorithm>
 #include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <string>
 #include <vector>
 
-struct Detection {
-    float x, y, width, height;
-    float confidence;
-    int class_id;
-};
+// Stage counters (stage_stats.hpp)
+enum DetectionCounter { CANDIDATES, DETECTIONS };
 
 /**
- * Non-Maximum Suppression (NMS)
- * Filters overlapping detections, keeping only the highest confidence ones.
+ * Called by hailofilter once per element, with its config-path.
+ *
+ * The config is published to the shared parameter store; a missing or
+ * invalid file leaves the current parameters in place.
  */
-std::vector<Detection> apply_nms(std::vector<Detection>& detections, float iou_threshold = 0.45) {
-    std::vector<Detection> result;
-
-    // Sort by confidence (descending)
-    std::sort(detections.begin(), detections.end(),
-              [](const Detection& a, const Detection& b) {
-                  return a.confidence > b.confidence;
-              });
-
-    std::vector<bool> suppressed(detections.size(), false);
-
-    for (size_t i = 0; i < detections.size(); i++) {
-        if (suppressed[i]) continue;
-
-        result.push_back(detections[i]);
-
-        // Suppress overlapping boxes
-        for (size_t j = i + 1; j < detections.size(); j++) {
-            if (suppressed[j]) continue;
-
-            float iou = compute_iou(detections[i], detections[j]);
-            if (iou > iou_threshold) {
-                suppressed[j] = true;
-            }
-        }
+extern "C" void* init(const std::string config_path, const std::string function_name) {
+    anpr::PostprocessParamStore& store = anpr::PostprocessParamStore::instance();
+    std::string error;
+    if (!config_path.empty() && config_path != "NULL" && !store.load_file(config_path, &error)) {
+        std::fprintf(stderr, "%s: ignoring config %s: %s\n", function_name.c_str(), config_path.c_str(),
+                     error.c_str());
     }
-
-    return result;
+    return &store;
 }
 
-/**
- * Compute Intersection over Union (IoU)
- */
-float compute_iou(const Detection& a, const Detection& b) {
-    float x1 = std::max(a.x, b.x);
-    float y1 = std::max(a.y, b.y);
-    float x2 = std::min(a.x + a.width, b.x + b.width);
-    float y2 = std::min(a.y + a.height, b.y + b.height);
-
-    if (x2 < x1 || y2 < y1) return 0.0f;
-
-    float intersection = (x2 - x1) * (y2 - y1);
-    float area_a = a.width * a.height;
-    float area_b = b.width * b.height;
-    float union_area = area_a + area_b - intersection;
-
-    return intersection / union_area;
-}
+// The store outlives the elements
+extern "C" void free_resources(void*) {}
 
 /**
  * Main filter function called by GStreamer hailofilter element.
  *
+ * The output tensor may be float32 or the HEF's native uint8/uint16
+ * quantized format; the latter avoids host-side dequantization.
+ *
  * @param output_tensors: YOLO model output tensors from Hailo
  * @param roi: Region of interest for processing
  * @return: Vector of HailoDetection objects
@@ -80,55 +83,76 @@ extern "C" std::vector<HailoDetection> plate_detection(
     HailoTensorPtr output_tensors,
     HailoROIPtr roi
 ) {
-    // Configuration
-    const float CONFIDENCE_THRESHOLD = 0.5f;
-    const float NMS_THRESHOLD = 0.45f;
-    const int NUM_CLASSES = 1;  // Only "license_plate" class
+    static thread_local anpr::ThreadStage stage("plate_detection", {"candidates", "detections"});
+    anpr::StageStats& stats = stage.get();
+    anpr::StageTimer timer(stats);
 
-    std::vector<Detection> raw_detections;
+    // Per-thread frame buffers, their capacity is kept between frames
+    static thread_local std::vector<Detection> raw_detections;
+    static thread_local std::vector<Detection> filtered;
+    static thread_local anpr::LaneLayout lanes;
 
     // Parse YOLO output format (depends on model architecture)
     // Assuming YOLOv8 format: [batch, 84, 8400]
     // 84 = 4 (bbox) + 80 (classes) -> simplified to 4 + 1 for single class
-
     auto tensor = output_tensors[0];
-    float* data = reinterpret_cast<float*>(tensor.data());
-
-    int num_detections = tensor.width();  // e.g., 8400
-    int stride = tensor.height();         // e.g., 84 or 5
-
-    for (int i = 0; i < num_detections; i++) {
-        // Extract bbox coordinates (center x, center y, width, height)
-        float cx = data[i * stride + 0];
-        float cy = data[i * stride + 1];
-        float w = data[i * stride + 2];
-        float h = data[i * stride + 3];
-        float conf = data[i * stride + 4];  // objectness * class score
-
-        if (conf >= CONFIDENCE_THRESHOLD) {
-            Detection det;
-            det.x = cx - w / 2.0f;
-            det.y = cy - h / 2.0f;
-            det.width = w;
-            det.height = h;
-            det.confidence = conf;
-            det.class_id = 0;  // license_plate
-
-            raw_detections.push_back(det);
-        }
+
+    // Frames are reported under the stream id, else the "<prefix>_det" thread's prefix
+    const std::string stream = anpr::stream_id(*roi);
+    const std::string& camera = stream.empty() ? anpr::thread_activity_key() : stream;
+
+    // Trace of the frame, when latency tracing is on
+    const uint64_t trace_frame =
+        anpr::FrameTracer::instance().begin(camera, anpr::TraceStage::Detection, anpr::monotonic_ns());
+
+    const anpr::PostprocessParams& params = anpr::thread_postprocess_params(camera);
+    anpr::DetectionOptions options;
+    options.confidence_threshold = params.confidence_threshold;
+    options.nms_threshold = params.nms_threshold;
+    options.max_plates = static_cast<size_t>(params.max_plates);
+    if (params.fast_detection) {
+        options.top_k = static_cast<size_t>(params.top_k);
+        options.min_width = params.min_plate_width;
+        options.min_height = params.min_plate_height;
+        options.min_aspect = params.min_plate_aspect;
+        options.max_aspect = params.max_plate_aspect;
     }
 
-    // Apply NMS
-    std::vector<Detection> filtered = apply_nms(raw_detections, NMS_THRESHOLD);
+    // Lane mosaic input: boxes are mapped back to frame coordinates
+    const bool mosaic = anpr::lane_layout(*roi, lanes);
+    const size_t candidates = anpr::decode_detections(
+        tensor.data(), anpr::tensor_dtype(tensor), anpr::anchor_grid(tensor.height(), tensor.width()),
+        anpr::tensor_quant(tensor), mosaic ? &lanes : nullptr, options, raw_detections, filtered);
+    stats.add(CANDIDATES, candidates);
+    stats.add(DETECTIONS, filtered.size());
+
+    // Activity for the frame gate in front of the detection network
+    anpr::SceneActivity::instance().report_frame(camera, filtered.size());
+
+    // Throughput and queue latency of the camera's schedule
+    anpr::InferenceScheduler::instance().report_inferred(camera, anpr::InferenceScheduler::now_ns());
+
+    // Raw tensor of the frame into the camera's dump, if it captures
+    uint64_t capture_frame = 0;
+    anpr::TensorCapture& capture = anpr::TensorCapture::instance();
+    if (capture.any_active()) {
+        anpr::TensorRecordHeader header =
+            anpr::tensor_record_header(tensor, anpr::TensorKind::Detection, anpr::stream_index(stream));
+        capture_frame = capture.capture_detection(camera, header, tensor.data());
+    }
 
     // Convert to Hailo format
     std::vector<HailoDetection> hailo_detections;
+    hailo_detections.reserve(filtered.size());
     for (const auto& det : filtered) {
         HailoDetection hdet;
         hdet.bbox = HailoBBox(det.x, det.y, det.width, det.height);
         hdet.confidence = det.confidence;
         hdet.class_id = det.class_id;
         hdet.label = "license_plate";
+        anpr::set_stream_id(hdet, stream);
+        if (capture_frame) anpr::set_capture_frame(hdet, capture_frame);
+        if (trace_frame) anpr::set_trace_frame(hdet, trace_frame);
 
         hailo_detections.push_back(hdet);
     }
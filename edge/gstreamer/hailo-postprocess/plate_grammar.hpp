@@ -0,0 +1,256 @@
+/**
+ * Plate-format automaton for constrained CTC decoding.
+ *
+ * Compiles a plate format regex into a small DFA over charset indices, so the
+ * beam search can drop prefixes that can no longer become a valid plate.
+ *
+ * Supported syntax (enough for plate formats, no backtracking constructs):
+ *   literals        ABC123
+ *   classes         [A-Z]  [A-HJ-NP-Z0-9]  \d  .
+ *   repetition      {n}  {n,m}  ?
+ *   alternation     LLL|LL  (top level only)
+ *   anchors         ^ and $ are accepted and ignored (matching is always whole-plate)
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace anpr {
+
+class PlateGrammar {
+public:
+    static constexpr uint8_t kDead = 0xFF;
+    static constexpr int kMaxSymbols = 64;
+    static constexpr int kMaxStates = 64;
+
+    /**
+     * Compile `pattern` over `charset` (symbol i is charset[i]).
+     *
+     * @return: false on unsupported syntax or if the automaton is too large;
+     *          the grammar is then left disabled
+     */
+    bool compile(const char* pattern, const char* charset) {
+        num_states_ = 0;
+        if (!pattern || !*pattern || !charset) return false;
+
+        charset_size_ = static_cast<int>(std::strlen(charset));
+        if (charset_size_ > kMaxSymbols) return false;
+        charset_ = charset;
+
+        num_nodes_ = 0;
+        end_mask_ = 0;
+        start_mask_ = 0;
+
+        // Strip anchors
+        size_t len = std::strlen(pattern);
+        size_t begin = 0;
+        if (len && pattern[0] == '^') begin = 1;
+        if (len > begin && pattern[len - 1] == '$') len--;
+
+        // One linear chain of atoms per top-level alternative
+        size_t alt_start = begin;
+        for (size_t i = begin; i <= len; i++) {
+            if (i == len || pattern[i] == '|') {
+                if (!parse_chain(pattern + alt_start, pattern + i)) return false;
+                alt_start = i + 1;
+            }
+        }
+
+        return build_dfa();
+    }
+
+    bool enabled() const { return num_states_ > 0; }
+
+    uint8_t start() const { return 0; }
+
+    uint8_t step(uint8_t state, int symbol) const {
+        if (state == kDead || symbol < 0 || symbol >= charset_size_) return kDead;
+        return next_[state][symbol];
+    }
+
+    bool accepting(uint8_t state) const {
+        return state != kDead && (accept_ >> state) & 1u;
+    }
+
+    /**
+     * Validate a whole plate string.
+     */
+    bool matches(const char* text, size_t length) const {
+        if (!enabled()) return true;
+        uint8_t state = start();
+        for (size_t i = 0; i < length && state != kDead; i++) {
+            state = step(state, symbol_of(text[i]));
+        }
+        return accepting(state);
+    }
+
+private:
+    static constexpr int kMaxNodes = 64;
+
+    int symbol_of(char c) const {
+        const char* p = std::strchr(charset_, c);
+        return (p && c) ? static_cast<int>(p - charset_) : -1;
+    }
+
+    uint64_t range_mask(char lo, char hi) const {
+        uint64_t mask = 0;
+        for (int s = 0; s < charset_size_; s++) {
+            if (charset_[s] >= lo && charset_[s] <= hi) mask |= uint64_t(1) << s;
+        }
+        return mask;
+    }
+
+    uint64_t all_mask() const {
+        return charset_size_ == 64 ? ~uint64_t(0) : (uint64_t(1) << charset_size_) - 1;
+    }
+
+    bool add_node(uint64_t mask, bool optional) {
+        if (num_nodes_ >= kMaxNodes) return false;
+        node_mask_[num_nodes_] = mask;
+        node_optional_[num_nodes_] = optional;
+        num_nodes_++;
+        return true;
+    }
+
+    // Parse one alternative into nodes; node i consumes a symbol and moves to i + 1
+    bool parse_chain(const char* p, const char* end) {
+        if (p == end) return false;
+        start_mask_ |= uint64_t(1) << num_nodes_;
+
+        while (p < end) {
+            uint64_t mask = 0;
+
+            if (*p == '[') {
+                p++;
+                while (p < end && *p != ']') {
+                    if (*p == '\\' && p + 1 < end && p[1] == 'd') {
+                        mask |= range_mask('0', '9');
+                        p += 2;
+                    } else if (p + 2 < end && p[1] == '-' && p[2] != ']') {
+                        mask |= range_mask(p[0], p[2]);
+                        p += 3;
+                    } else {
+                        mask |= range_mask(*p, *p);
+                        p++;
+                    }
+                }
+                if (p == end) return false;
+                p++;
+            } else if (*p == '\\') {
+                if (p + 1 >= end || p[1] != 'd') return false;
+                mask = range_mask('0', '9');
+                p += 2;
+            } else if (*p == '.') {
+                mask = all_mask();
+                p++;
+            } else if ((*p >= 'A' && *p <= 'Z') || (*p >= '0' && *p <= '9')) {
+                mask = range_mask(*p, *p);
+                p++;
+            } else {
+                return false;  // Groups, '*', '+' etc. are not supported
+            }
+
+            int min_rep = 1, max_rep = 1;
+            if (p < end && *p == '?') {
+                min_rep = 0;
+                p++;
+            } else if (p < end && *p == '{') {
+                p++;
+                min_rep = 0;
+                while (p < end && *p >= '0' && *p <= '9') min_rep = min_rep * 10 + (*p++ - '0');
+                max_rep = min_rep;
+                if (p < end && *p == ',') {
+                    p++;
+                    max_rep = 0;
+                    while (p < end && *p >= '0' && *p <= '9') max_rep = max_rep * 10 + (*p++ - '0');
+                }
+                if (p == end || *p != '}' || max_rep < min_rep || max_rep == 0) return false;
+                p++;
+            }
+
+            for (int r = 0; r < max_rep; r++) {
+                if (!add_node(mask, r >= min_rep)) return false;
+            }
+        }
+
+        // Terminal node of the chain
+        end_mask_ |= uint64_t(1) << num_nodes_;
+        return add_node(0, false);
+    }
+
+    bool is_end(int node) const { return (end_mask_ >> node) & 1u; }
+
+    // Optional nodes may be skipped; edges only go forward, so one ascending pass suffices
+    uint64_t closure(uint64_t set) const {
+        for (int n = 0; n < num_nodes_; n++) {
+            if ((set >> n) & 1u && !is_end(n) && node_optional_[n]) {
+                set |= uint64_t(1) << (n + 1);
+            }
+        }
+        return set;
+    }
+
+    bool build_dfa() {
+        uint64_t sets[kMaxStates];
+        sets[0] = closure(start_mask_);
+        num_states_ = 1;
+        accept_ = 0;
+
+        for (int s = 0; s < num_states_; s++) {
+            if (sets[s] & end_mask_) accept_ |= uint64_t(1) << s;
+
+            for (int sym = 0; sym < charset_size_; sym++) {
+                uint64_t moved = 0;
+                for (int n = 0; n < num_nodes_; n++) {
+                    if ((sets[s] >> n) & 1u && !is_end(n) && (node_mask_[n] >> sym) & 1u) {
+                        moved |= uint64_t(1) << (n + 1);
+                    }
+                }
+
+                if (!moved) {
+                    next_[s][sym] = kDead;
+                    continue;
+                }
+                moved = closure(moved);
+
+                int target = -1;
+                for (int k = 0; k < num_states_; k++) {
+                    if (sets[k] == moved) {
+                        target = k;
+                        break;
+                    }
+                }
+                if (target < 0) {
+                    if (num_states_ >= kMaxStates) {
+                        num_states_ = 0;
+                        return false;
+                    }
+                    target = num_states_;
+                    sets[num_states_++] = moved;
+                }
+                next_[s][sym] = static_cast<uint8_t>(target);
+            }
+        }
+        return true;
+    }
+
+    const char* charset_ = "";
+    int charset_size_ = 0;
+
+    // Chain NFA
+    uint64_t node_mask_[kMaxNodes];
+    bool node_optional_[kMaxNodes];
+    int num_nodes_ = 0;
+    uint64_t start_mask_ = 0;
+    uint64_t end_mask_ = 0;
+
+    // DFA
+    uint8_t next_[kMaxStates][kMaxSymbols];
+    uint64_t accept_ = 0;
+    int num_states_ = 0;
+};
+
+}  // namespace anpr
@@ -3,100 +3,262 @@
  *
  * This plugin processes OCR model outputs using CTC (Connectionist Temporal Classification)
  * decoding to extract license plate text.
+ *
+ * The decoder is instantiated per plate region (plate_region.hpp); each region
+ * has its own entry points, selected with hailofilter's function-name=:
+ *   plate_ocr / plate_ocr_eu    generic European charset and lengths
+ *   plate_ocr_lt                Lithuanian ABC123 format
+ *   plate_ocr_us                US plates
+ * and a frame-level entry point each (plate_ocr_frame_eu, ...) that runs on
+ * the frame after the OCR branch's hailoaggregator and reads all of its
+ * plate crops at once (ocr_frame.hpp). The camera pipelines use those.
+ *
+ * Accepted reads are also published to the thread's plate event ring
+ * (event_ring.hpp), which the Python pipeline drains from its own thread.
+ * Crops of traced frames (frame_trace.hpp) stamp the frame when their OCR
+ * starts, and their reads carry its id into the event and the track.
+ * Decode latency and read outcomes are recorded per streaming thread
+ * (stage_stats.hpp). Crops of frames captured into a tensor dump have their
+ * raw OCR output appended to it (tensor_capture.hpp).
+ *
+ * Decoding options, the confidence threshold and the plate length limits come
+ * from the camera's postprocess parameters (postprocess_params.hpp), loaded
+ * from the hailofilter config-path and reloadable while the stream runs.
+ *
+ * When the process has configured the shared worker pool (worker_pool.hpp),
+ * the frame entry points decode and validate a frame's crops in parallel and
+ * join before the frame is pushed on; the per-ROI entry points get a single
+ * crop per call and always decode on the streaming thread.
  */
 
 #include "hailo_common.hpp"
+#include "hailo_roi.hpp"
+#include "hailo_tensor.hpp"
+#include "event_ring.hpp"
+#include "frame_trace.hpp"
+#include "ocr_decode.hpp"
+#include "ocr_frame.hpp"
+#include "plate_region.hpp"
+#include "postprocess_params.hpp"
+#include "scene_activity.hpp"
+#include "stage_stats.hpp"
+#include "tensor_capture.hpp"
+#include "track_registry.hpp"
+#include <memory>
 #include <string>
 #include <vector>
 #include <algorithm>
 #include <cmath>
+#include <cstdio>
+
+// Stage counters (stage_stats.hpp)
+enum OCRCounter { CROPS, READS, INVALID, LOW_CONFIDENCE };
+
+/**
+ * Called by hailofilter once per element, with its config-path.
+ *
+ * The config is published to the shared parameter store; a missing or
+ * invalid file leaves the current parameters in place.
+ */
+extern "C" void* init(const std::string config_path, const std::string function_name) {
+    anpr::PostprocessParamStore& store = anpr::PostprocessParamStore::instance();
+    std::string error;
+    if (!config_path.empty() && config_path != "NULL" && !store.load_file(config_path, &error)) {
+        std::fprintf(stderr, "%s: ignoring config %s: %s\n", function_name.c_str(), config_path.c_str(),
+                     error.c_str());
+    }
+    return &store;
+}
+
+// The store outlives the elements
+extern "C" void free_resources(void*) {}
+
+/**
+ * Stage stats of the calling thread, shared by all regions and entry points.
+ */
+anpr::StageStats& ocr_stats() {
+    static thread_local anpr::ThreadStage stage("plate_ocr", {"crops", "reads", "invalid", "low_confidence"});
+    return stage.get();
+}
+
+/**
+ * Decoding options of the camera a crop belongs to.
+ */
+anpr::OCRDecodeOptions decode_options(const std::string& stream) {
+    // Same camera key as plate_detection: the stream id, else the "<prefix>_ocr" thread's prefix
+    const anpr::PostprocessParams& params =
+        anpr::thread_postprocess_params(stream.empty() ? anpr::thread_activity_key() : stream);
 
-// Character set for license plates (customize based on your region)
-const std::string CHARSET = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
-const int BLANK_INDEX = CHARSET.length();  // CTC blank token
+    anpr::OCRDecodeOptions options;
+    options.beam_search = params.beam_search;
+    options.beam_width = params.beam_width;
+    options.min_confidence = params.min_confidence;
+    options.min_length = params.min_plate_length;
+    options.max_length = params.max_plate_length;
+    return options;
+}
+
+void count_verdict(anpr::StageStats& stats, anpr::OCRVerdict verdict) {
+    stats.add(verdict == anpr::OCRVerdict::Accepted  ? READS
+              : verdict == anpr::OCRVerdict::Invalid ? INVALID
+                                                     : LOW_CONFIDENCE);
+}
 
-struct OCRResult {
-    std::string text;
-    float confidence;
-    std::vector<float> char_confidences;
-};
 
 /**
- * CTC Greedy Decoder
- * Decodes CTC output sequence by taking the most likely character at each timestep.
+ * Turn an accepted read into a classification.
+ *
+ * The label and raw text fit in std::string's small-buffer storage, and the
+ * confidences vector is built once at its final size, so attaching the
+ * metadata does no intermediate copies.
  */
-OCRResult ctc_greedy_decode(float* output_data, int timesteps, int num_classes) {
-    OCRResult result;
-    result.text = "";
-    result.char_confidences.clear();
-
-    int prev_char = BLANK_INDEX;
-    float total_conf = 0.0f;
-    int char_count = 0;
-
-    for (int t = 0; t < timesteps; t++) {
-        // Find character with highest probability at this timestep
-        int max_idx = 0;
-        float max_prob = output_data[t * num_classes];
-
-        for (int c = 1; c < num_classes; c++) {
-            float prob = output_data[t * num_classes + c];
-            if (prob > max_prob) {
-                max_prob = prob;
-                max_idx = c;
-            }
-        }
-
-        // CTC decoding: skip blanks and repeated characters
-        if (max_idx != BLANK_INDEX && max_idx != prev_char) {
-            if (max_idx < CHARSET.length()) {
-                result.text += CHARSET[max_idx];
-                result.char_confidences.push_back(max_prob);
-                total_conf += max_prob;
-                char_count++;
-            }
-        }
-
-        prev_char = max_idx;
+void make_classification(const anpr::OCRRead& read, HailoClassification& classification) {
+    classification.label.assign(read.text.chars, read.text.length);
+    classification.confidence = read.result.confidence;
+
+    // Store per-character confidences in metadata
+    const anpr::PlateText& raw = read.result.text;
+    classification.metadata["char_confidences"] = std::vector<float>(raw.confidences, raw.confidences + raw.length);
+    classification.metadata["raw_text"] = std::string(raw.chars, raw.length);
+}
+
+/**
+ * OCR output of a crop and the tags of its ROI (ocr_frame.hpp).
+ *
+ * Expected tensor format: [timesteps, num_classes], where num_classes =
+ * len(charset) + 1 (blank); the element type is float32 or the HEF's native
+ * uint8/uint16.
+ */
+template <typename Tensor>
+anpr::OCRCrop make_crop(const Tensor& tensor, const HailoROIPtr& roi) {
+    anpr::OCRCrop crop;
+    crop.data = tensor.data();
+    crop.dtype = anpr::tensor_dtype(tensor);
+    crop.quant = anpr::tensor_quant(tensor);
+    crop.timesteps = tensor.height();
+    crop.num_classes = tensor.width();
+    if (roi) {
+        crop.stream = anpr::stream_id(*roi);
+        crop.track_id = anpr::track_id(*roi);
+        crop.trace_frame = anpr::trace_frame(*roi);
+    }
+    crop.options = decode_options(crop.stream);
+    if (auto detection = std::dynamic_pointer_cast<HailoDetection>(roi)) {
+        crop.bbox[0] = detection->bbox.x;
+        crop.bbox[1] = detection->bbox.y;
+        crop.bbox[2] = detection->bbox.width;
+        crop.bbox[3] = detection->bbox.height;
+        crop.detection_confidence = detection->confidence;
     }
+    return crop;
+}
 
-    // Calculate average confidence
-    result.confidence = char_count > 0 ? total_conf / char_count : 0.0f;
+/**
+ * Append a crop's OCR output to its camera's tensor dump if the crop comes
+ * from a captured frame.
+ */
+template <typename Tensor>
+void capture_tensor(const Tensor& tensor, const HailoROIPtr& roi) {
+    const uint64_t frame = roi ? anpr::capture_frame(*roi) : 0;
+    if (!frame) return;
 
-    return result;
+    // Same camera key as plate_detection: the stream id, else the "<prefix>_ocr" thread's prefix
+    const std::string stream = anpr::stream_id(*roi);
+    anpr::TensorRecordHeader header =
+        anpr::tensor_record_header(tensor, anpr::TensorKind::OCR, anpr::stream_index(stream));
+    anpr::TensorCapture::instance().capture_ocr(stream.empty() ? anpr::thread_activity_key() : stream, frame, header,
+                                                tensor.data());
 }
 
 /**
- * CTC Beam Search Decoder (more accurate but slower)
- * Considers multiple candidate sequences and returns the most likely one.
+ * Per-ROI filter implementation shared by the per-region entry points.
  */
-OCRResult ctc_beam_search_decode(float* output_data, int timesteps, int num_classes, int beam_width = 5) {
-    // Simplified implementation - full beam search would be more complex
-    // For production, consider using a library like TensorFlow CTC or similar
+template <typename Region>
+std::vector<HailoClassification> plate_ocr_impl(HailoTensorPtr output_tensors, const HailoROIPtr& roi) {
+    anpr::StageStats& stats = ocr_stats();
+    anpr::StageTimer timer(stats);
+    stats.add(CROPS);
+
+    auto tensor = output_tensors[0];
+    const anpr::OCRCrop crop = make_crop(tensor, roi);
+
+    // The first crop of a traced frame marks when its OCR started
+    anpr::FrameTracer::instance().stamp(crop.trace_frame, anpr::TraceStage::OCR, anpr::monotonic_ns());
 
-    // For now, fall back to greedy decode
-    return ctc_greedy_decode(output_data, timesteps, num_classes);
+    // Decode CTC output
+    anpr::OCRRead read;
+    anpr::read_crop<Region>(crop, read);
+    if (anpr::TensorCapture::instance().any_active()) capture_tensor(tensor, roi);
+
+    std::vector<HailoClassification> results;
+    count_verdict(stats, read.verdict);
+    if (read.verdict == anpr::OCRVerdict::Accepted) {
+        anpr::report_read(crop, read, anpr::TrackRegistry::instance(), anpr::thread_event_ring());
+        results.emplace_back();
+        make_classification(read, results.back());
+    }
+
+    return results;
 }
 
 /**
- * Post-process and validate plate text
- * Apply regex patterns, length checks, etc.
+ * Frame filter implementation shared by the per-region entry points.
+ *
+ * Plate detections carry the OCR output of their crop once the aggregator
+ * has joined the OCR branch; detections that were not cropped (deduplicated,
+ * decided tracks) carry none and are skipped. Reads are reported and
+ * attached in ROI order, with the same side effects as the per-ROI filter.
  */
-std::string validate_plate_text(const std::string& text) {
-    // Remove any invalid characters
-    std::string cleaned;
-    for (char c : text) {
-        if (CHARSET.find(c) != std::string::npos) {
-            cleaned += c;
-        }
+template <typename Region>
+void plate_ocr_frame_impl(const HailoROIPtr& roi) {
+    if (!roi) return;
+
+    static thread_local std::vector<std::shared_ptr<HailoDetection>> plates;
+    static thread_local std::vector<std::shared_ptr<HailoTensor>> tensors;
+    static thread_local std::vector<anpr::OCRCrop> crops;
+    static thread_local std::vector<anpr::OCRRead> reads;
+    plates.clear();
+    tensors.clear();
+    crops.clear();
+    for (const auto& object : roi->get_objects_typed(HAILO_DETECTION)) {
+        auto detection = std::dynamic_pointer_cast<HailoDetection>(object);
+        if (!detection) continue;
+        auto outputs = detection->get_tensors();
+        if (outputs.empty()) continue;
+
+        plates.push_back(detection);
+        tensors.push_back(outputs[0]);
+        crops.push_back(make_crop(*outputs[0], detection));
     }
+    if (crops.empty()) return;
 
-    // Apply length validation (typical plates: 4-8 characters)
-    if (cleaned.length() < 4 || cleaned.length() > 8) {
-        return "";  // Invalid plate
+    anpr::StageStats& stats = ocr_stats();
+    anpr::StageTimer timer(stats);
+    stats.add(CROPS, crops.size());
+
+    // The first crop of a traced frame marks when its OCR started
+    const uint64_t now = anpr::monotonic_ns();
+    for (const anpr::OCRCrop& crop : crops) {
+        anpr::FrameTracer::instance().stamp(crop.trace_frame, anpr::TraceStage::OCR, now);
     }
 
-    return cleaned;
+    // Decode on the worker pool; joins before anything is reported
+    if (reads.size() < crops.size()) reads.resize(crops.size());
+    anpr::read_crops<Region>(crops.data(), crops.size(), reads.data());
+
+    const bool capturing = anpr::TensorCapture::instance().any_active();
+    anpr::TrackRegistry& registry = anpr::TrackRegistry::instance();
+    anpr::PlateEventRing* ring = anpr::thread_event_ring();
+    for (size_t i = 0; i < crops.size(); i++) {
+        if (capturing) capture_tensor(*tensors[i], plates[i]);
+        count_verdict(stats, reads[i].verdict);
+        if (reads[i].verdict != anpr::OCRVerdict::Accepted) continue;
+
+        anpr::report_read(crops[i], reads[i], registry, ring);
+        auto classification = std::make_shared<HailoClassification>();
+        make_classification(reads[i], *classification);
+        plates[i]->add_object(classification);
+    }
 }
 
 /**
@@ -110,43 +272,39 @@ extern "C" std::vector<HailoClassification> plate_ocr(
     HailoTensorPtr output_tensors,
     HailoROIPtr roi
 ) {
-    std::vector<HailoClassification> results;
-
-    // Configuration
-    const float MIN_CONFIDENCE = 0.6f;
-    const bool USE_BEAM_SEARCH = false;  // Set to true for better accuracy
-
-    // Get OCR model output tensor
-    // Expected format: [timesteps, num_classes]
-    // Where num_classes = len(CHARSET) + 1 (blank)
-    auto tensor = output_tensors[0];
-    float* data = reinterpret_cast<float*>(tensor.data());
-
-    int timesteps = tensor.height();
-    int num_classes = tensor.width();
+    return plate_ocr_impl<anpr::region::EU>(output_tensors, roi);
+}
 
-    // Decode CTC output
-    OCRResult ocr_result;
-    if (USE_BEAM_SEARCH) {
-        ocr_result = ctc_beam_search_decode(data, timesteps, num_classes);
-    } else {
-        ocr_result = ctc_greedy_decode(data, timesteps, num_classes);
-    }
+extern "C" std::vector<HailoClassification> plate_ocr_eu(HailoTensorPtr output_tensors, HailoROIPtr roi) {
+    return plate_ocr_impl<anpr::region::EU>(output_tensors, roi);
+}
 
-    // Validate and clean plate text
-    std::string plate_text = validate_plate_text(ocr_result.text);
+extern "C" std::vector<HailoClassification> plate_ocr_lt(HailoTensorPtr output_tensors, HailoROIPtr roi) {
+    return plate_ocr_impl<anpr::region::LT>(output_tensors, roi);
+}
 
-    if (!plate_text.empty() && ocr_result.confidence >= MIN_CONFIDENCE) {
-        HailoClassification classification;
-        classification.label = plate_text;
-        classification.confidence = ocr_result.confidence;
+extern "C" std::vector<HailoClassification> plate_ocr_us(HailoTensorPtr output_tensors, HailoROIPtr roi) {
+    return plate_ocr_impl<anpr::region::US>(output_tensors, roi);
+}
 
-        // Store per-character confidences in metadata
-        classification.metadata["char_confidences"] = ocr_result.char_confidences;
-        classification.metadata["raw_text"] = ocr_result.text;
+/**
+ * Frame filter called by hailofilter on the aggregated frame, after
+ * `hailocropper ... hailoaggregator` has joined the OCR branch.
+ *
+ * Each plate detection with OCR output gets a classification with its plate
+ * text, attached to the detection. Decoding parameters come from the store
+ * init() loaded the config-path into.
+ *
+ * @param roi: Frame ROI holding the plate detections
+ */
+extern "C" void plate_ocr_frame_eu(HailoROIPtr roi, void*) {
+    plate_ocr_frame_impl<anpr::region::EU>(roi);
+}
 
-        results.push_back(classification);
-    }
+extern "C" void plate_ocr_frame_lt(HailoROIPtr roi, void*) {
+    plate_ocr_frame_impl<anpr::region::LT>(roi);
+}
 
-    return results;
+extern "C" void plate_ocr_frame_us(HailoROIPtr roi, void*) {
+    plate_ocr_frame_impl<anpr::region::US>(roi);
 }
@@ -0,0 +1,71 @@
+/**
+ * Compile-time plate region descriptions for the OCR post-processing.
+ *
+ * Each region fixes the OCR model's charset, the CTC blank position, the
+ * accepted plate lengths and the plate format used to constrain beam search.
+ * plate_ocr.cpp instantiates one decoder per region, so argmax widths and
+ * charset lookups are compile-time constants, and exports one
+ * plate_ocr_<region> entry point each (selected with hailofilter's
+ * function-name=).
+ */
+
+#pragma once
+
+#include "plate_text.hpp"
+
+namespace anpr {
+namespace region {
+
+/**
+ * Generic European plates: digits and Latin letters, no fixed format.
+ */
+struct EU {
+    static constexpr const char* name = "eu";
+    static constexpr char charset[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+    static constexpr int blank = sizeof(charset) - 1;  // CTC blank follows the charset
+    static constexpr int num_classes = blank + 1;
+    static constexpr int min_length = 4;
+    static constexpr int max_length = 8;
+    static constexpr const char* format = "";
+};
+
+/**
+ * Lithuanian plates: three letters followed by three digits (ABC123).
+ */
+struct LT {
+    static constexpr const char* name = "lt";
+    static constexpr char charset[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+    static constexpr int blank = sizeof(charset) - 1;
+    static constexpr int num_classes = blank + 1;
+    static constexpr int min_length = 6;
+    static constexpr int max_length = 6;
+    static constexpr const char* format = "^[A-Z]{3}[0-9]{3}$";
+};
+
+/**
+ * US plates: formats vary per state, so only the length is constrained.
+ */
+struct US {
+    static constexpr const char* name = "us";
+    static constexpr char charset[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+    static constexpr int blank = sizeof(charset) - 1;
+    static constexpr int num_classes = blank + 1;
+    static constexpr int min_length = 2;
+    static constexpr int max_length = 8;
+    static constexpr const char* format = "";
+};
+
+}  // namespace region
+
+template <typename Region>
+constexpr bool valid_region() {
+    return Region::blank > 0 && Region::num_classes <= 256 &&
+           Region::min_length > 0 && Region::max_length <= kMaxPlateChars &&
+           Region::min_length <= Region::max_length;
+}
+
+static_assert(valid_region<region::EU>(), "invalid EU region");
+static_assert(valid_region<region::LT>(), "invalid LT region");
+static_assert(valid_region<region::US>(), "invalid US region");
+
+}  // namespace anpr
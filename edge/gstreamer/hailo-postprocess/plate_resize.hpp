@@ -0,0 +1,336 @@
+/**
+ * Fused crop + bilinear resize + color conversion for OCR input.
+ *
+ * Reads a plate region straight from the RGB or NV12 frame and writes the
+ * OCR input (interleaved RGB, 8 bit) in one pass over the output rows:
+ *  - per-column source offsets and weights are computed once per crop
+ *  - for each output row the two source rows are blended vertically over the
+ *    crop span only (SIMD), then the row is resampled horizontally
+ *  - NV12 luma and chroma are resampled separately and converted to RGB
+ *    (BT.601, limited range) while writing the output pixel
+ *
+ * Only the rows and columns under the plate are touched, so cropping from a
+ * full-resolution frame costs the same as from the inference frame. Frames
+ * in mapped DMA-BUF memory are read through run_staged(), which copies just
+ * those rows into cached memory first.
+ * Weights are 8.8 fixed point; the vertical kernel has AVX2 (x86-64) and NEON
+ * (AArch64) variants chosen at runtime (ANPR_SIMD=scalar forces scalar).
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <immintrin.h>
+#define ANPR_HAVE_AVX2_KERNEL 1
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#define ANPR_HAVE_NEON_KERNEL 1
+#endif
+
+namespace anpr {
+
+enum class PixelFormat { RGB, NV12 };
+
+/**
+ * Source frame planes. RGB uses plane 0 (interleaved, 3 bytes per pixel);
+ * NV12 uses plane 0 for Y and plane 1 for interleaved UV at half resolution.
+ *
+ * The planes may hold only a region of the frame starting at pixel
+ * (origin_x, origin_y), even for NV12; width/height stay the frame's and
+ * crops must lie inside the region (CropResizer::run_staged).
+ */
+struct ImageView {
+    PixelFormat format = PixelFormat::RGB;
+    int width = 0;
+    int height = 0;
+    const uint8_t* planes[2] = {nullptr, nullptr};
+    size_t strides[2] = {0, 0};
+    int origin_x = 0;
+    int origin_y = 0;
+};
+
+// Crop in source pixel coordinates
+struct CropRect {
+    float x = 0.0f;
+    float y = 0.0f;
+    float width = 0.0f;
+    float height = 0.0f;
+};
+
+inline void blend_rows_scalar(const uint8_t* a, const uint8_t* b, size_t n, int wy, uint16_t* out) {
+    const int wa = 256 - wy;
+    for (size_t i = 0; i < n; i++) {
+        out[i] = static_cast<uint16_t>(a[i] * wa + b[i] * wy);
+    }
+}
+
+#ifdef ANPR_HAVE_AVX2_KERNEL
+__attribute__((target("avx2")))
+inline void blend_rows_avx2(const uint8_t* a, const uint8_t* b, size_t n, int wy, uint16_t* out) {
+    // a * (256 - wy) + b * wy <= 255 * 256, so 16-bit lanes never overflow
+    const __m256i va = _mm256_set1_epi16(static_cast<short>(256 - wy));
+    const __m256i vb = _mm256_set1_epi16(static_cast<short>(wy));
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        const __m256i pa = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i)));
+        const __m256i pb = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i)));
+        const __m256i sum = _mm256_add_epi16(_mm256_mullo_epi16(pa, va), _mm256_mullo_epi16(pb, vb));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), sum);
+    }
+    blend_rows_scalar(a + i, b + i, n - i, wy, out + i);
+}
+#endif
+
+#ifdef ANPR_HAVE_NEON_KERNEL
+inline void blend_rows_neon(const uint8_t* a, const uint8_t* b, size_t n, int wy, uint16_t* out) {
+    const uint16x8_t va = vdupq_n_u16(static_cast<uint16_t>(256 - wy));
+    const uint16x8_t vb = vdupq_n_u16(static_cast<uint16_t>(wy));
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const uint16x8_t pa = vmovl_u8(vld1_u8(a + i));
+        const uint16x8_t pb = vmovl_u8(vld1_u8(b + i));
+        vst1q_u16(out + i, vmlaq_u16(vmulq_u16(pa, va), pb, vb));
+    }
+    blend_rows_scalar(a + i, b + i, n - i, wy, out + i);
+}
+#endif
+
+using BlendRowsFn = void (*)(const uint8_t*, const uint8_t*, size_t, int, uint16_t*);
+
+inline BlendRowsFn resolve_blend_rows() {
+    const char* forced = std::getenv("ANPR_SIMD");
+    if (forced && std::strcmp(forced, "scalar") == 0) {
+        return blend_rows_scalar;
+    }
+#ifdef ANPR_HAVE_AVX2_KERNEL
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return blend_rows_avx2;
+    }
+#endif
+#ifdef ANPR_HAVE_NEON_KERNEL
+    return blend_rows_neon;
+#endif
+    return blend_rows_scalar;
+}
+
+/**
+ * Vertical blend of two source rows: out[i] = a[i] * (256 - wy) + b[i] * wy.
+ */
+inline void blend_rows(const uint8_t* a, const uint8_t* b, size_t n, int wy, uint16_t* out) {
+    static const BlendRowsFn kernel = resolve_blend_rows();
+    kernel(a, b, n, wy, out);
+}
+
+inline uint8_t clamp_u8(int v) {
+    return static_cast<uint8_t>(v < 0 ? 0 : (v > 255 ? 255 : v));
+}
+
+/**
+ * Crop/resize engine. Keeps its coefficient tables and row buffers between
+ * calls (one instance per streaming thread), so steady-state crops do not
+ * allocate.
+ */
+class CropResizer {
+public:
+    /**
+     * Crop `rect` out of `src` and resize it to [out_height, out_width] RGB.
+     *
+     * @param out: Output buffer of out_height rows of out_stride bytes
+     *             (out_stride >= out_width * 3)
+     * @return: false if the frame or crop is empty or the format is unusable
+     */
+    bool run(const ImageView& src, const CropRect& rect, uint8_t* out, int out_width, int out_height,
+             size_t out_stride) {
+        if (src.width <= 0 || src.height <= 0 || !src.planes[0] || out_width <= 0 || out_height <= 0 ||
+            !(rect.width > 0.0f) || !(rect.height > 0.0f)) {
+            return false;
+        }
+
+        if (src.format == PixelFormat::NV12) {
+            if (!src.planes[1]) return false;
+            resize_nv12(src, rect, out, out_width, out_height, out_stride);
+        } else {
+            resize_rgb(src, rect, out, out_width, out_height, out_stride);
+        }
+        return true;
+    }
+
+    /**
+     * As run(), but first copy the source rows under the crop (plus a margin
+     * covering every bilinear tap) into a cached staging buffer, one
+     * sequential read per row. Meant for frames mapped from DMA-BUF, which
+     * are uncached or write-combined on most SoCs: run() reads each source
+     * row up to twice and resamples with scattered loads, much slower there
+     * than from cached memory. The output is identical to run().
+     */
+    bool run_staged(const ImageView& src, const CropRect& rect, uint8_t* out, int out_width, int out_height,
+                    size_t out_stride) {
+        if (src.width <= 0 || src.height <= 0 || !src.planes[0] || !(rect.width > 0.0f) ||
+            !(rect.height > 0.0f) || src.origin_x != 0 || src.origin_y != 0) {
+            return false;
+        }
+        const bool nv12 = src.format == PixelFormat::NV12;
+        if (nv12 && !src.planes[1]) return false;
+
+        // Taps reach at most one pixel past the rect; NV12 regions start on even pixels
+        int x0 = std::min(std::max(static_cast<int>(std::floor(rect.x)) - 2, 0), src.width - 1);
+        int y0 = std::min(std::max(static_cast<int>(std::floor(rect.y)) - 2, 0), src.height - 1);
+        const int x1 = std::min(std::max(static_cast<int>(std::ceil(rect.x + rect.width)) + 2, x0 + 1), src.width);
+        const int y1 = std::min(std::max(static_cast<int>(std::ceil(rect.y + rect.height)) + 2, y0 + 1), src.height);
+        if (nv12) {
+            x0 &= ~1;
+            y0 &= ~1;
+        }
+
+        ImageView region = src;
+        region.origin_x = x0;
+        region.origin_y = y0;
+        const size_t row_bytes = static_cast<size_t>(x1 - x0) * (nv12 ? 1 : 3);
+        const size_t rows = static_cast<size_t>(y1 - y0);
+        const size_t chroma_bytes = nv12 ? static_cast<size_t>((x1 + 1) / 2 - x0 / 2) * 2 : 0;
+        const size_t chroma_rows = nv12 ? static_cast<size_t>((y1 + 1) / 2 - y0 / 2) : 0;
+        staging_.resize(row_bytes * rows + chroma_bytes * chroma_rows);
+
+        uint8_t* dst = staging_.data();
+        for (int y = y0; y < y1; y++, dst += row_bytes) {
+            std::memcpy(dst, src.planes[0] + y * src.strides[0] + x0 * (nv12 ? 1 : 3), row_bytes);
+        }
+        region.planes[0] = staging_.data();
+        region.strides[0] = row_bytes;
+        if (nv12) {
+            region.planes[1] = dst;
+            region.strides[1] = chroma_bytes;
+            for (int cy = y0 / 2; cy < (y1 + 1) / 2; cy++, dst += chroma_bytes) {
+                std::memcpy(dst, src.planes[1] + cy * src.strides[1] + x0, chroma_bytes);
+            }
+        }
+        return run(region, rect, out, out_width, out_height, out_stride);
+    }
+
+private:
+    // Source position of output index d along one axis, as integer taps and an 8-bit weight
+    struct Tap {
+        int i0;
+        int i1;
+        int w;  // weight of i1, 0..256
+    };
+
+    static Tap make_tap(float pos, int size) {
+        pos = std::min(std::max(pos, 0.0f), static_cast<float>(size - 1));
+        const int i0 = static_cast<int>(pos);
+        const int i1 = std::min(i0 + 1, size - 1);
+        const int w = static_cast<int>(std::lround((pos - i0) * 256.0f));
+        return Tap{i0, i1, w};
+    }
+
+    // Output index d -> source coordinate, pixel centers aligned
+    static void build_taps(float start, float length, int out_size, int src_size, float subsample,
+                           std::vector<Tap>& taps) {
+        taps.resize(out_size);
+        const float scale = length / out_size;
+        for (int d = 0; d < out_size; d++) {
+            const float pos = start + (d + 0.5f) * scale;  // full-resolution coordinate
+            taps[d] = make_tap(pos / subsample - 0.5f, src_size);
+        }
+    }
+
+    // Resample one vertically blended row (element stride `channels`) to the output
+    static uint32_t sample(const uint16_t* row, const Tap& tap, int channels, int c, int base) {
+        const uint32_t v0 = row[(tap.i0 - base) * channels + c];
+        const uint32_t v1 = row[(tap.i1 - base) * channels + c];
+        return v0 * (256 - tap.w) + v1 * tap.w;  // 16.16 fixed point
+    }
+
+    static uint8_t to_u8(uint32_t v) {
+        return static_cast<uint8_t>((v + (1u << 15)) >> 16);
+    }
+
+    void resize_rgb(const ImageView& src, const CropRect& rect, uint8_t* out, int out_width, int out_height,
+                    size_t out_stride) {
+        build_taps(rect.x, rect.width, out_width, src.width, 1.0f, x_taps_);
+        build_taps(rect.y, rect.height, out_height, src.height, 1.0f, y_taps_);
+
+        const int x_min = x_taps_.front().i0;
+        const int x_max = x_taps_.back().i1;
+        const size_t span = static_cast<size_t>(x_max - x_min + 1) * 3;
+        row_.resize(span);
+
+        const uint8_t* plane = src.planes[0] + static_cast<ptrdiff_t>(x_min - src.origin_x) * 3;
+        for (int dy = 0; dy < out_height; dy++) {
+            const Tap& ty = y_taps_[dy];
+            const uint8_t* a = plane + (ty.i0 - src.origin_y) * src.strides[0];
+            const uint8_t* b = plane + (ty.i1 - src.origin_y) * src.strides[0];
+            blend_rows(a, b, span, ty.w, row_.data());
+
+            uint8_t* dst = out + dy * out_stride;
+            for (int dx = 0; dx < out_width; dx++) {
+                const Tap& tx = x_taps_[dx];
+                dst[dx * 3 + 0] = to_u8(sample(row_.data(), tx, 3, 0, x_min));
+                dst[dx * 3 + 1] = to_u8(sample(row_.data(), tx, 3, 1, x_min));
+                dst[dx * 3 + 2] = to_u8(sample(row_.data(), tx, 3, 2, x_min));
+            }
+        }
+    }
+
+    void resize_nv12(const ImageView& src, const CropRect& rect, uint8_t* out, int out_width, int out_height,
+                     size_t out_stride) {
+        const int chroma_width = (src.width + 1) / 2;
+        const int chroma_height = (src.height + 1) / 2;
+
+        build_taps(rect.x, rect.width, out_width, src.width, 1.0f, x_taps_);
+        build_taps(rect.y, rect.height, out_height, src.height, 1.0f, y_taps_);
+        build_taps(rect.x, rect.width, out_width, chroma_width, 2.0f, cx_taps_);
+        build_taps(rect.y, rect.height, out_height, chroma_height, 2.0f, cy_taps_);
+
+        const int x_min = x_taps_.front().i0;
+        const size_t span = static_cast<size_t>(x_taps_.back().i1 - x_min + 1);
+        const int cx_min = cx_taps_.front().i0;
+        const size_t chroma_span = static_cast<size_t>(cx_taps_.back().i1 - cx_min + 1) * 2;
+        row_.resize(span);
+        chroma_row_.resize(chroma_span);
+
+        const uint8_t* luma = src.planes[0] + (x_min - src.origin_x);
+        const uint8_t* chroma = src.planes[1] + static_cast<ptrdiff_t>(cx_min - src.origin_x / 2) * 2;
+        for (int dy = 0; dy < out_height; dy++) {
+            const Tap& ty = y_taps_[dy];
+            blend_rows(luma + (ty.i0 - src.origin_y) * src.strides[0], luma + (ty.i1 - src.origin_y) * src.strides[0],
+                       span, ty.w, row_.data());
+
+            const Tap& tcy = cy_taps_[dy];
+            const int cy_origin = src.origin_y / 2;
+            blend_rows(chroma + (tcy.i0 - cy_origin) * src.strides[1], chroma + (tcy.i1 - cy_origin) * src.strides[1],
+                       chroma_span, tcy.w, chroma_row_.data());
+
+            uint8_t* dst = out + dy * out_stride;
+            for (int dx = 0; dx < out_width; dx++) {
+                const int y = to_u8(sample(row_.data(), x_taps_[dx], 1, 0, x_min)) - 16;
+                const int u = to_u8(sample(chroma_row_.data(), cx_taps_[dx], 2, 0, cx_min)) - 128;
+                const int v = to_u8(sample(chroma_row_.data(), cx_taps_[dx], 2, 1, cx_min)) - 128;
+
+                const int luma = 298 * y + 128;
+                dst[dx * 3 + 0] = clamp_u8((luma + 409 * v) >> 8);
+                dst[dx * 3 + 1] = clamp_u8((luma - 100 * u - 208 * v) >> 8);
+                dst[dx * 3 + 2] = clamp_u8((luma + 516 * u) >> 8);
+            }
+        }
+    }
+
+    std::vector<Tap> x_taps_;
+    std::vector<Tap> y_taps_;
+    std::vector<Tap> cx_taps_;
+    std::vector<Tap> cy_taps_;
+    std::vector<uint16_t> row_;
+    std::vector<uint16_t> chroma_row_;
+    std::vector<uint8_t> staging_;
+};
+
+}  // namespace anpr
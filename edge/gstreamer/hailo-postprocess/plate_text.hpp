@@ -0,0 +1,74 @@
+/**
+ * Fixed-size plate text storage and charset lookup for the OCR stage.
+ *
+ * Plates are at most a handful of characters, so the decoded text and its
+ * per-character confidences are kept inline instead of in std::string /
+ * std::vector, and charset membership is a single table lookup.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace anpr {
+
+constexpr int kMaxPlateChars = 16;
+
+/**
+ * 256-entry map from character to charset index.
+ */
+class CharTable {
+public:
+    static constexpr uint8_t kInvalid = 0xFF;
+
+    constexpr explicit CharTable(const char* charset) : index_{} {
+        for (int i = 0; i < 256; i++) index_[i] = kInvalid;
+        for (int i = 0; charset[i] && i < kInvalid; i++) {
+            index_[static_cast<uint8_t>(charset[i])] = static_cast<uint8_t>(i);
+        }
+    }
+
+    constexpr bool contains(char c) const {
+        return index_[static_cast<uint8_t>(c)] != kInvalid;
+    }
+
+    constexpr int index_of(char c) const {
+        return index_[static_cast<uint8_t>(c)] == kInvalid ? -1 : index_[static_cast<uint8_t>(c)];
+    }
+
+private:
+    uint8_t index_[256];
+};
+
+/**
+ * Plate text with per-character confidences, stored inline.
+ */
+struct PlateText {
+    char chars[kMaxPlateChars + 1] = {};
+    float confidences[kMaxPlateChars] = {};
+    int length = 0;
+
+    void clear() {
+        length = 0;
+        chars[0] = '\0';
+    }
+
+    /**
+     * Append a character.
+     *
+     * @return: false (and nothing appended) once the text is full
+     */
+    bool push(char c, float confidence) {
+        if (length >= kMaxPlateChars) return false;
+        chars[length] = c;
+        confidences[length] = confidence;
+        chars[++length] = '\0';
+        return true;
+    }
+
+    const char* c_str() const { return chars; }
+    bool empty() const { return length == 0; }
+};
+
+}  // namespace anpr
@@ -0,0 +1,359 @@
+/**
+ * Hailo Post-Processing Plugin: Plate Tracking
+ *
+ * Runs after plate_detection as a hailofilter. Detections on the frame are
+ * associated into tracks (plate_tracker.hpp) and tagged with a HailoUniqueID
+ * track id; tracks with OCR reads also get a "plate_vote" classification
+ * with their current consensus text (plate_consensus.hpp). Track-level
+ * events are attached to the frame as "track_event" classifications:
+ *   plate_decided   a track's consensus became confident (once per track)
+ *   track_ended     a confirmed track disappeared, with its final consensus
+ * so consumers handle one event per vehicle instead of per-frame detections.
+ * Track events are also published to the thread's plate event ring
+ * (event_ring.hpp) for the Python pipeline.
+ *
+ * Zones (zone_map.hpp) are evaluated here as well, on the track centers:
+ * crossings are published to the event ring next to the track events and
+ * attached as "zone_event" classifications (label = zone name, event
+ * entered/exited). Zones come from the JSON file given as the
+ * hailofilter config-path:
+ *   {"zones": [{"name": "entry_zone", "polygon": [[x, y], ...]}, ...],
+ *    "zone_grid": [cols, rows],
+ *    "tracker": {"match_iou": 0.2, "max_age": 15, ...},
+ *    "streams": {"sink_0": {"zones": [...]}, ...}}
+ * with polygon points normalized to the frame.
+ *
+ * Tracks and zones are kept per stream id, so one element serves all cameras
+ * of a multi-stream pipeline; "streams" overrides the zones per stream
+ * (hailoroundrobin pad name), other streams use the top-level "zones".
+ *
+ * Latency and event counts are recorded per streaming thread
+ * (stage_stats.hpp). Traced frames (frame_trace.hpp) are stamped here, and
+ * a plate_decided event carries the trace of the frame whose read decided
+ * it, so its latency runs from that frame's capture.
+ */
+
+#include "hailo_common.hpp"
+#include "event_ring.hpp"
+#include "frame_trace.hpp"
+#include "hailo_roi.hpp"
+#include "json_lite.hpp"
+#include "plate_tracker.hpp"
+#include "stage_stats.hpp"
+#include "track_registry.hpp"
+#include "zone_map.hpp"
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Configuration
+const float MATCH_IOU = 0.2f;
+const float HIGH_CONFIDENCE = 0.6f;
+const uint32_t MIN_HITS = 3;
+const uint32_t MAX_AGE = 15;          // frames
+const uint32_t MIN_PLATE_VOTES = 3;
+const float MIN_CONSENSUS = 0.5f;
+const int ZONE_GRID_COLS = 160;       // zone raster resolution (detection input / 4)
+const int ZONE_GRID_ROWS = 120;
+
+// Stage counters (stage_stats.hpp)
+enum TrackerCounter { DETECTIONS, TRACK_EVENTS, ZONE_EVENTS };
+
+/**
+ * Tracks and zone state of one stream.
+ */
+struct StreamTracker {
+    anpr::PlateTracker tracker;
+    anpr::ZoneMap zones;
+    anpr::ZoneCrossing crossing;
+};
+
+/**
+ * Per-element state, created by init() from the config-path file.
+ */
+struct TrackerParams {
+    anpr::TrackerOptions options;
+    anpr::ZoneMap zones;  // streams without an entry in stream_zones
+    std::unordered_map<std::string, anpr::ZoneMap> stream_zones;
+    std::unordered_map<std::string, std::unique_ptr<StreamTracker>> streams;
+
+    StreamTracker& stream(const std::string& id) {
+        std::unique_ptr<StreamTracker>& state = streams[id];
+        if (!state) {
+            state.reset(new StreamTracker());
+            auto it = stream_zones.find(id);
+            state->zones = it != stream_zones.end() ? it->second : zones;
+        }
+        return *state;
+    }
+
+    std::vector<std::shared_ptr<HailoDetection>> detections;
+    std::vector<anpr::TrackerDetection> inputs;
+    std::vector<uint64_t> track_ids;
+    std::vector<anpr::TrackEvent> events;
+    std::vector<anpr::ZoneEvent> zone_events;
+
+    TrackerParams() {
+        options.match_iou = MATCH_IOU;
+        options.high_confidence = HIGH_CONFIDENCE;
+        options.min_hits = MIN_HITS;
+        options.max_age = MAX_AGE;
+        options.min_plate_votes = MIN_PLATE_VOTES;
+        options.min_consensus = MIN_CONSENSUS;
+    }
+};
+
+/**
+ * Compile a JSON zone list into a zone map.
+ *
+ * @return: false (with a message) if a zone is malformed
+ */
+bool load_zones(const anpr::json::Value& zones, const anpr::json::Value& grid, anpr::ZoneMap& map,
+                std::string& error) {
+    std::vector<float> points;
+    for (const anpr::json::Value& zone : zones.items()) {
+        const std::string& name = zone.get("name").string();
+        const anpr::json::Value& polygon = zone.get("polygon");
+
+        points.clear();
+        for (const anpr::json::Value& point : polygon.items()) {
+            if (point.size() != 2 || !point[0].is_number() || !point[1].is_number()) {
+                error = "zone '" + name + "': polygon points must be [x, y]";
+                return false;
+            }
+            points.push_back(static_cast<float>(point[0].number()));
+            points.push_back(static_cast<float>(point[1].number()));
+        }
+        if (!map.add_zone(name, points.data(), static_cast<int>(points.size() / 2))) {
+            error = "zone '" + name + "': needs at least 3 points (max " +
+                    std::to_string(anpr::ZoneMap::kMaxZones) + " zones)";
+            return false;
+        }
+    }
+
+    map.build(static_cast<int>(grid[0].number(ZONE_GRID_COLS)), static_cast<int>(grid[1].number(ZONE_GRID_ROWS)));
+    return true;
+}
+
+/**
+ * Apply a parsed config file to the params.
+ *
+ * @return: false (with a message) if a zone is malformed
+ */
+bool load_config(const anpr::json::Value& config, TrackerParams& params, std::string& error) {
+    const anpr::json::Value& tracker = config.get("tracker");
+    anpr::TrackerOptions& o = params.options;
+    o.match_iou = static_cast<float>(tracker.get("match_iou").number(o.match_iou));
+    o.high_confidence = static_cast<float>(tracker.get("high_confidence").number(o.high_confidence));
+    o.min_hits = static_cast<uint32_t>(tracker.get("min_hits").number(o.min_hits));
+    o.max_age = static_cast<uint32_t>(tracker.get("max_age").number(o.max_age));
+    o.min_plate_votes = static_cast<uint32_t>(tracker.get("min_plate_votes").number(o.min_plate_votes));
+    o.min_consensus = static_cast<float>(tracker.get("min_consensus").number(o.min_consensus));
+
+    const anpr::json::Value& grid = config.get("zone_grid");
+    if (!load_zones(config.get("zones"), grid, params.zones, error)) return false;
+
+    const anpr::json::Value& streams = config.get("streams");
+    for (size_t i = 0; i < streams.keys().size(); i++) {
+        const std::string& id = streams.keys()[i];
+        if (!load_zones(streams[i].get("zones"), grid, params.stream_zones[id], error)) {
+            error = "stream " + id + ": " + error;
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Classification describing one track event.
+ */
+HailoClassification make_event(const anpr::TrackEvent& event) {
+    HailoClassification classification;
+    classification.label = event.text;
+    classification.confidence = event.confidence;
+    classification.metadata["type"] = std::string("track_event");
+    classification.metadata["event"] =
+        std::string(event.type == anpr::TrackEventType::PlateDecided ? "plate_decided" : "track_ended");
+    classification.metadata["track_id"] = static_cast<int>(event.track_id);
+    classification.metadata["bbox"] =
+        std::vector<float>{event.box.x, event.box.y, event.box.width, event.box.height};
+    classification.metadata["age"] = static_cast<int>(event.age);
+    classification.metadata["votes"] = static_cast<int>(event.votes);
+    classification.metadata["total_reads"] = static_cast<int>(event.total_reads);
+    classification.metadata["consensus"] = event.consensus;
+    classification.metadata["detection_confidence"] = event.detection_confidence;
+    return classification;
+}
+
+/**
+ * Publish a track event to the calling thread's event ring.
+ *
+ * @param trace_frame: Traced frame being processed, 0 if none
+ */
+void publish_event(const anpr::TrackEvent& event, const std::string& stream_id, uint64_t trace_frame) {
+    anpr::PlateEventRing* ring = anpr::thread_event_ring();
+    if (!ring) return;
+
+    const anpr::PlateEventKind kind = event.type == anpr::TrackEventType::PlateDecided
+                                          ? anpr::PlateEventKind::PlateDecided
+                                          : anpr::PlateEventKind::TrackEnded;
+    anpr::PlateEventRecord record =
+        anpr::make_event_record(kind, stream_id, event.track_id, event.text, std::strlen(event.text));
+    record.bbox[0] = event.box.x;
+    record.bbox[1] = event.box.y;
+    record.bbox[2] = event.box.width;
+    record.bbox[3] = event.box.height;
+    record.detection_confidence = event.detection_confidence;
+    record.ocr_confidence = event.confidence;
+    record.votes = event.votes;
+    record.total_reads = event.total_reads;
+    record.trace_frame = trace_frame;
+    anpr::TrackRead read;
+    if (kind == anpr::PlateEventKind::PlateDecided && anpr::TrackRegistry::instance().read(event.track_id, read) &&
+        read.trace_frame) {
+        record.trace_frame = read.trace_frame;
+    }
+    ring->push(record);
+}
+
+/**
+ * Publish the zone crossings of one detection to the calling thread's event ring.
+ *
+ * @param trace_frame: Traced frame being processed, 0 if none
+ */
+void publish_zone_events(const anpr::ZoneEvent* events, size_t count, const std::string& stream_id,
+                         const anpr::TrackerDetection& detection, uint64_t trace_frame) {
+    anpr::PlateEventRing* ring = count ? anpr::thread_event_ring() : nullptr;
+    if (!ring) return;
+
+    for (size_t i = 0; i < count; i++) {
+        anpr::PlateEventRecord record = anpr::zone_event_record(events[i], stream_id, detection);
+        record.trace_frame = trace_frame;
+        ring->push(record);
+    }
+}
+
+/**
+ * Classification describing one zone crossing.
+ */
+HailoClassification make_zone_event(const anpr::ZoneEvent& event, const anpr::ZoneMap& zones) {
+    HailoClassification classification;
+    classification.label = zones.zone_name(event.zone);
+    classification.confidence = 1.0f;
+    classification.metadata["type"] = std::string("zone_event");
+    classification.metadata["event"] =
+        std::string(event.type == anpr::ZoneEventType::Entered ? "entered" : "exited");
+    classification.metadata["track_id"] = static_cast<int>(event.track_id);
+    return classification;
+}
+
+/**
+ * Called by hailofilter once per element, with its config-path.
+ *
+ * A missing or invalid config file leaves the defaults (no zones) in place.
+ */
+extern "C" void* init(const std::string config_path, const std::string function_name) {
+    auto* params = new TrackerParams();
+
+    if (!config_path.empty() && config_path != "NULL") {
+        anpr::json::Value config;
+        std::string error;
+        if (!anpr::json::parse_file(config_path, config, &error) || !load_config(config, *params, error)) {
+            std::fprintf(stderr, "%s: ignoring config %s: %s\n", function_name.c_str(), config_path.c_str(),
+                         error.c_str());
+            delete params;
+            params = new TrackerParams();
+        }
+    }
+    return params;
+}
+
+extern "C" void free_resources(void* params_void_ptr) {
+    delete static_cast<TrackerParams*>(params_void_ptr);
+}
+
+/**
+ * Main filter function called by GStreamer hailofilter element.
+ *
+ * @param roi: Frame ROI holding this frame's plate detections
+ * @param params_void_ptr: State returned by init()
+ */
+extern "C" void plate_tracker(HailoROIPtr roi, void* params_void_ptr) {
+    static thread_local TrackerParams fallback;
+    static thread_local anpr::ThreadStage stage("plate_tracker", {"detections", "track_events", "zone_events"});
+    anpr::StageStats& stats = stage.get();
+    anpr::StageTimer timer(stats);
+
+    TrackerParams& params = params_void_ptr ? *static_cast<TrackerParams*>(params_void_ptr) : fallback;
+    auto& detections = params.detections;
+    auto& inputs = params.inputs;
+    auto& track_ids = params.track_ids;
+    auto& events = params.events;
+    auto& zone_events = params.zone_events;
+    const std::string stream_id = anpr::stream_id(*roi);
+    StreamTracker& stream = params.stream(stream_id);
+
+    detections.clear();
+    inputs.clear();
+    for (const auto& object : roi->get_objects_typed(HAILO_DETECTION)) {
+        auto detection = std::dynamic_pointer_cast<HailoDetection>(object);
+        if (!detection) continue;
+        detections.push_back(detection);
+        const HailoBBox& b = detection->bbox;
+        inputs.push_back(anpr::TrackerDetection{{b.x, b.y, b.width, b.height}, detection->confidence});
+    }
+
+    // Detections of a traced frame carry its id (frame_trace.hpp)
+    const uint64_t trace_frame = detections.empty() ? 0 : anpr::trace_frame(*detections.front());
+    anpr::FrameTracer::instance().stamp(trace_frame, anpr::TraceStage::Tracker, anpr::monotonic_ns());
+
+    track_ids.resize(inputs.size());
+    events.clear();
+    stream.tracker.update(inputs.data(), inputs.size(), params.options, track_ids.data(), events);
+
+    anpr::TrackRegistry& registry = anpr::TrackRegistry::instance();
+    zone_events.clear();
+    for (size_t i = 0; i < detections.size(); i++) {
+        if (!track_ids[i]) continue;
+        anpr::set_track_id(*detections[i], track_ids[i]);
+
+        if (stream.zones.num_zones() > 0) {
+            const anpr::TrackBox& b = inputs[i].box;
+            const size_t first = zone_events.size();
+            stream.crossing.update(stream.zones, track_ids[i], b.x + b.width * 0.5f, b.y + b.height * 0.5f,
+                                   zone_events);
+            publish_zone_events(zone_events.data() + first, zone_events.size() - first, stream_id, inputs[i],
+                                trace_frame);
+        }
+
+        // Current consensus of the track
+        anpr::TrackRead read;
+        anpr::ConsensusResult consensus;
+        if (registry.read(track_ids[i], read) && read.consensus.result(consensus)) {
+            auto classification = std::make_shared<HailoClassification>();
+            classification->label = consensus.text.c_str();
+            classification->confidence = consensus.confidence;
+            classification->metadata["type"] = std::string("plate_vote");
+            classification->metadata["votes"] = static_cast<int>(consensus.votes);
+            classification->metadata["total_reads"] = static_cast<int>(read.total_reads);
+            classification->metadata["consensus"] = consensus.consensus;
+            detections[i]->add_object(classification);
+        }
+    }
+
+    stats.add(DETECTIONS, detections.size());
+    stats.add(TRACK_EVENTS, events.size());
+    stats.add(ZONE_EVENTS, zone_events.size());
+
+    for (const auto& event : zone_events) {
+        roi->add_object(std::make_shared<HailoClassification>(make_zone_event(event, stream.zones)));
+    }
+    for (const auto& event : events) {
+        if (event.type == anpr::TrackEventType::TrackEnded) stream.crossing.remove(event.track_id);
+        roi->add_object(std::make_shared<HailoClassification>(make_event(event)));
+        publish_event(event, stream_id, trace_frame);
+    }
+}
@@ -0,0 +1,373 @@
+/**
+ * Multi-object plate tracker (SORT / ByteTrack style).
+ *
+ *  - every track has a constant-velocity Kalman filter over the box
+ *    (center x/y, width, height), run as four decoupled position/velocity
+ *    filters; state and covariances are stored as SoA arrays over the
+ *    fixed-capacity track table so predict/update are flat loops
+ *  - association is greedy on IoU against the predicted boxes, highest
+ *    overlap first: confident detections are matched first, then the low
+ *    confidence ones may continue (but never start) a track
+ *  - tracks are confirmed after min_hits matches and end after max_age
+ *    unmatched frames
+ *
+ * Track ids come from the TrackRegistry, so the crop dedup and the OCR filter
+ * use the same ids, and the character-level consensus of each track's reads
+ * (plate_consensus.hpp) is read from there. The tracker reports track-level
+ * events (plate decided, track ended) instead of per-frame detections; a
+ * track's plate is decided exactly once, as soon as its consensus is
+ * confident enough, and the track is then marked decided in the registry so
+ * its crops stop going to OCR. Zone crossings of the tracks (zone_map.hpp)
+ * become plate event records the same way (zone_event_record).
+ */
+
+#pragma once
+
+#include "event_ring.hpp"
+#include "track_registry.hpp"
+#include "zone_map.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace anpr {
+
+struct TrackerOptions {
+    float match_iou = 0.2f;          // min IoU between a predicted box and a detection
+    float high_confidence = 0.6f;    // detections below this only continue existing tracks
+    uint32_t min_hits = 3;           // matches before a track is confirmed
+    uint32_t max_age = 15;           // unmatched frames before a track ends
+    uint32_t min_plate_votes = 3;    // reads agreeing at every position before a plate is decided
+    float min_consensus = 0.5f;      // weighted support of the weakest position
+    float position_noise = 1e-5f;    // process noise, normalized units
+    float velocity_noise = 1e-5f;
+    float measurement_noise = 1e-4f;
+};
+
+// Normalized corner box
+struct TrackBox {
+    float x, y, width, height;
+};
+
+struct TrackerDetection {
+    TrackBox box;
+    float confidence;
+};
+
+enum class TrackEventType { PlateDecided, TrackEnded };
+
+struct TrackEvent {
+    TrackEventType type;
+    uint64_t track_id;
+    TrackBox box;                      // last filtered box
+    uint32_t age;                      // frames since the track started
+    char text[kMaxPlateChars + 1];     // consensus plate text, empty if never read
+    uint32_t votes;                    // reads agreeing at the weakest-agreeing position
+    uint32_t total_reads;
+    float confidence;                  // mean character confidence of the consensus text
+    float consensus;                   // support of the weakest position
+    float detection_confidence;        // mean confidence of the track's detections
+};
+
+/**
+ * Plate event record of a zone crossing: the zone's index in the stream's
+ * zone list, the crossing detection and the track's consensus plate so far
+ * (empty if it has no reads yet).
+ */
+inline PlateEventRecord zone_event_record(const ZoneEvent& event, const std::string& stream_id,
+                                          const TrackerDetection& detection,
+                                          const TrackRegistry& registry = TrackRegistry::instance()) {
+    TrackRead read;
+    ConsensusResult consensus;
+    const bool has_text = registry.read(event.track_id, read) && read.consensus.result(consensus);
+
+    const PlateEventKind kind = event.type == ZoneEventType::Entered ? PlateEventKind::ZoneEntered
+                                                                      : PlateEventKind::ZoneExited;
+    PlateEventRecord record = make_event_record(kind, stream_id, event.track_id, consensus.text.chars,
+                                                has_text ? consensus.text.length : 0);
+    record.zone = event.zone;
+    record.bbox[0] = detection.box.x;
+    record.bbox[1] = detection.box.y;
+    record.bbox[2] = detection.box.width;
+    record.bbox[3] = detection.box.height;
+    record.detection_confidence = detection.confidence;
+    if (has_text) {
+        record.ocr_confidence = consensus.confidence;
+        record.votes = consensus.votes;
+        record.total_reads = read.total_reads;
+    }
+    return record;
+}
+
+class PlateTracker {
+public:
+    static constexpr int kMaxTracks = 64;
+
+    explicit PlateTracker(TrackRegistry& registry = TrackRegistry::instance()) : registry_(registry) {}
+
+    /**
+     * Advance one frame.
+     *
+     * @param track_ids: Receives the track id per detection (tentative tracks
+     *                   included), 0 for detections that start no track
+     * @param events: Receives this frame's track events (appended)
+     */
+    void update(const TrackerDetection* detections, size_t count, const TrackerOptions& options,
+                uint64_t* track_ids, std::vector<TrackEvent>& events) {
+        predict(options);
+
+        assignment_.assign(count, -1);
+        track_taken_ = 0;
+        associate(detections, count, options, true);
+        associate(detections, count, options, false);
+
+        for (int t = 0; t < num_tracks_; t++) matched_[t] = false;
+
+        for (size_t i = 0; i < count; i++) {
+            int t = assignment_[i];
+            if (t >= 0) {
+                correct(t, detections[i].box, options);
+            } else if (detections[i].confidence >= options.high_confidence) {
+                t = start_track(detections[i].box, options);
+            }
+
+            track_ids[i] = 0;
+            if (t < 0) continue;
+
+            matched_[t] = true;
+            missed_[t] = 0;
+            hits_[t]++;
+            detection_sum_[t] += detections[i].confidence;
+            track_ids[i] = ids_[t];
+        }
+
+        for (int t = 0; t < num_tracks_;) {
+            age_[t]++;
+            if (!matched_[t]) missed_[t]++;
+
+            if (missed_[t] > options.max_age) {
+                end_track(t, options, events);
+                continue;
+            }
+            if (hits_[t] >= options.min_hits && !decided_[t]) {
+                check_plate(t, options, events);
+            }
+            t++;
+        }
+    }
+
+    /**
+     * End all tracks (e.g. at end of stream), emitting their events.
+     */
+    void flush(const TrackerOptions& options, std::vector<TrackEvent>& events) {
+        while (num_tracks_ > 0) end_track(0, options, events);
+    }
+
+    int num_tracks() const { return num_tracks_; }
+
+    TrackBox box(int t) const {
+        return TrackBox{x_[0][t] - x_[2][t] * 0.5f, x_[1][t] - x_[3][t] * 0.5f, x_[2][t], x_[3][t]};
+    }
+
+private:
+    struct Pair {
+        float iou;
+        int track;
+        int detection;
+    };
+
+    // Axis order in the SoA arrays: center x, center y, width, height
+    static void to_measurement(const TrackBox& b, float* z) {
+        z[0] = b.x + b.width * 0.5f;
+        z[1] = b.y + b.height * 0.5f;
+        z[2] = b.width;
+        z[3] = b.height;
+    }
+
+    static float iou(const TrackBox& a, const TrackBox& b) {
+        const float x1 = std::max(a.x, b.x);
+        const float y1 = std::max(a.y, b.y);
+        const float x2 = std::min(a.x + a.width, b.x + b.width);
+        const float y2 = std::min(a.y + a.height, b.y + b.height);
+        if (x2 <= x1 || y2 <= y1) return 0.0f;
+
+        const float intersection = (x2 - x1) * (y2 - y1);
+        return intersection / (a.width * a.height + b.width * b.height - intersection);
+    }
+
+    // x += v; P = F P F' + Q, per axis
+    void predict(const TrackerOptions& options) {
+        for (int a = 0; a < 4; a++) {
+            float* x = x_[a];
+            float* v = v_[a];
+            float* p00 = p00_[a];
+            float* p01 = p01_[a];
+            float* p11 = p11_[a];
+            for (int t = 0; t < num_tracks_; t++) {
+                x[t] += v[t];
+                p00[t] += 2.0f * p01[t] + p11[t] + options.position_noise;
+                p01[t] += p11[t];
+                p11[t] += options.velocity_noise;
+            }
+        }
+        // Keep predicted sizes positive
+        for (int t = 0; t < num_tracks_; t++) {
+            x_[2][t] = std::max(x_[2][t], 1e-4f);
+            x_[3][t] = std::max(x_[3][t], 1e-4f);
+        }
+    }
+
+    void correct(int t, const TrackBox& measured, const TrackerOptions& options) {
+        float z[4];
+        to_measurement(measured, z);
+        for (int a = 0; a < 4; a++) {
+            const float s = p00_[a][t] + options.measurement_noise;
+            const float k0 = p00_[a][t] / s;
+            const float k1 = p01_[a][t] / s;
+            const float residual = z[a] - x_[a][t];
+
+            x_[a][t] += k0 * residual;
+            v_[a][t] += k1 * residual;
+
+            const float p00 = p00_[a][t], p01 = p01_[a][t];
+            p00_[a][t] = (1.0f - k0) * p00;
+            p01_[a][t] = (1.0f - k0) * p01;
+            p11_[a][t] -= k1 * p01;
+        }
+    }
+
+    void associate(const TrackerDetection* detections, size_t count, const TrackerOptions& options,
+                   bool high) {
+        pairs_.clear();
+        for (int t = 0; t < num_tracks_; t++) {
+            if ((track_taken_ >> t) & 1u) continue;
+            const TrackBox predicted = box(t);
+            for (size_t i = 0; i < count; i++) {
+                if (assignment_[i] >= 0 || (detections[i].confidence >= options.high_confidence) != high) continue;
+                const float overlap = iou(predicted, detections[i].box);
+                if (overlap >= options.match_iou) pairs_.push_back(Pair{overlap, t, static_cast<int>(i)});
+            }
+        }
+        std::sort(pairs_.begin(), pairs_.end(), [](const Pair& a, const Pair& b) {
+            if (a.iou != b.iou) return a.iou > b.iou;
+            return a.track != b.track ? a.track < b.track : a.detection < b.detection;
+        });
+
+        for (const Pair& p : pairs_) {
+            if ((track_taken_ >> p.track) & 1u || assignment_[p.detection] >= 0) continue;
+            track_taken_ |= uint64_t(1) << p.track;
+            assignment_[p.detection] = p.track;
+        }
+    }
+
+    int start_track(const TrackBox& measured, const TrackerOptions& options) {
+        if (num_tracks_ == kMaxTracks) return -1;
+
+        const int t = num_tracks_++;
+        float z[4];
+        to_measurement(measured, z);
+        for (int a = 0; a < 4; a++) {
+            x_[a][t] = z[a];
+            v_[a][t] = 0.0f;
+            p00_[a][t] = options.measurement_noise;
+            p01_[a][t] = 0.0f;
+            p11_[a][t] = options.measurement_noise * 10.0f;
+        }
+        ids_[t] = registry_.new_track();
+        hits_[t] = 0;
+        detection_sum_[t] = 0.0f;
+        missed_[t] = 0;
+        age_[t] = 0;
+        decided_[t] = false;
+        matched_[t] = true;
+        return t;
+    }
+
+    void fill_event(int t, TrackEventType type, const TrackRead* read, TrackEvent& event) const {
+        std::memset(&event, 0, sizeof(event));
+        event.type = type;
+        event.track_id = ids_[t];
+        event.box = box(t);
+        event.age = age_[t];
+        event.detection_confidence = hits_[t] ? detection_sum_[t] / hits_[t] : 0.0f;
+
+        ConsensusResult result;
+        if (read && read->consensus.result(result)) {
+            std::memcpy(event.text, result.text.chars, sizeof(event.text));
+            event.votes = result.votes;
+            event.total_reads = read->total_reads;
+            event.confidence = result.confidence;
+            event.consensus = result.consensus;
+        }
+    }
+
+    // Early termination: decide the plate once the consensus is confident enough
+    void check_plate(int t, const TrackerOptions& options, std::vector<TrackEvent>& events) {
+        TrackRead read;
+        ConsensusResult result;
+        if (!registry_.read(ids_[t], read) || !read.consensus.result(result)) return;
+        if (result.votes < options.min_plate_votes || result.consensus < options.min_consensus) return;
+
+        decided_[t] = true;
+        registry_.mark_decided(ids_[t]);
+        events.emplace_back();
+        fill_event(t, TrackEventType::PlateDecided, &read, events.back());
+    }
+
+    // Emit the end event of a confirmed track and swap-remove track t
+    void end_track(int t, const TrackerOptions& options, std::vector<TrackEvent>& events) {
+        if (hits_[t] >= options.min_hits) {
+            TrackRead read;
+            const bool has_read = registry_.read(ids_[t], read);
+            events.emplace_back();
+            fill_event(t, TrackEventType::TrackEnded, has_read ? &read : nullptr, events.back());
+        }
+        registry_.forget(ids_[t]);
+
+        const int last = --num_tracks_;
+        if (t != last) {
+            for (int a = 0; a < 4; a++) {
+                x_[a][t] = x_[a][last];
+                v_[a][t] = v_[a][last];
+                p00_[a][t] = p00_[a][last];
+                p01_[a][t] = p01_[a][last];
+                p11_[a][t] = p11_[a][last];
+            }
+            ids_[t] = ids_[last];
+            hits_[t] = hits_[last];
+            detection_sum_[t] = detection_sum_[last];
+            missed_[t] = missed_[last];
+            age_[t] = age_[last];
+            decided_[t] = decided_[last];
+            matched_[t] = matched_[last];
+        }
+    }
+
+    TrackRegistry& registry_;
+
+    // Kalman state, [axis][track]
+    float x_[4][kMaxTracks];
+    float v_[4][kMaxTracks];
+    float p00_[4][kMaxTracks];
+    float p01_[4][kMaxTracks];
+    float p11_[4][kMaxTracks];
+
+    uint64_t ids_[kMaxTracks];
+    uint32_t hits_[kMaxTracks];
+    float detection_sum_[kMaxTracks];  // confidences of the matched detections
+    uint32_t missed_[kMaxTracks];
+    uint32_t age_[kMaxTracks];
+    bool decided_[kMaxTracks];
+    bool matched_[kMaxTracks];
+    int num_tracks_ = 0;
+
+    std::vector<int> assignment_;
+    std::vector<Pair> pairs_;
+    uint64_t track_taken_ = 0;  // kMaxTracks <= 64
+};
+
+}  // namespace anpr
@@ -0,0 +1,201 @@
+/**
+ * Shared postprocess parameter store (libanpr_core.so), see postprocess_params.hpp.
+ */
+
+#include "postprocess_params.hpp"
+#include "ctc_beam.hpp"
+#include "plate_text.hpp"
+
+#include <cstdio>
+
+namespace anpr {
+
+namespace {
+
+constexpr int kMaxCropSize = 4096;
+constexpr int kMaxTopK = 1024;
+
+/**
+ * Apply the detection/ocr/crop/evidence sections of `config` on top of `params`.
+ */
+bool load_params(const json::Value& config, PostprocessParams& params, std::string& error) {
+    const json::Value& detection = config.get("detection");
+    params.confidence_threshold =
+        static_cast<float>(detection.get("confidence_threshold").number(params.confidence_threshold));
+    params.nms_threshold = static_cast<float>(detection.get("nms_threshold").number(params.nms_threshold));
+    params.fast_detection = detection.get("fast").boolean(params.fast_detection);
+    params.top_k = static_cast<int>(detection.get("top_k").number(params.top_k));
+    params.max_plates = static_cast<int>(detection.get("max_plates").number(params.max_plates));
+    params.min_plate_width = static_cast<float>(detection.get("min_width").number(params.min_plate_width));
+    params.min_plate_height = static_cast<float>(detection.get("min_height").number(params.min_plate_height));
+    params.min_plate_aspect = static_cast<float>(detection.get("min_aspect").number(params.min_plate_aspect));
+    params.max_plate_aspect = static_cast<float>(detection.get("max_aspect").number(params.max_plate_aspect));
+
+    const json::Value& ocr = config.get("ocr");
+    params.min_confidence = static_cast<float>(ocr.get("min_confidence").number(params.min_confidence));
+    params.beam_search = ocr.get("beam_search").boolean(params.beam_search);
+    params.beam_width = static_cast<int>(ocr.get("beam_width").number(params.beam_width));
+    params.min_plate_length = static_cast<int>(ocr.get("min_length").number(params.min_plate_length));
+    params.max_plate_length = static_cast<int>(ocr.get("max_length").number(params.max_plate_length));
+
+    const json::Value& crop = config.get("crop");
+    params.ocr_width = static_cast<int>(crop.get("width").number(params.ocr_width));
+    params.ocr_height = static_cast<int>(crop.get("height").number(params.ocr_height));
+    params.crop_dmabuf = crop.get("dmabuf").boolean(params.crop_dmabuf);
+
+    const json::Value& evidence = config.get("evidence");
+    params.evidence_enabled = evidence.get("enabled").boolean(params.evidence_enabled);
+    params.evidence_quality = static_cast<int>(evidence.get("quality").number(params.evidence_quality));
+    params.evidence_plate_width = static_cast<int>(evidence.get("plate_width").number(params.evidence_plate_width));
+    params.evidence_frame_width = static_cast<int>(evidence.get("frame_width").number(params.evidence_frame_width));
+    params.evidence_margin = static_cast<float>(evidence.get("margin").number(params.evidence_margin));
+
+    const auto unit = [](float v) { return v >= 0.0f && v <= 1.0f; };
+    if (!unit(params.confidence_threshold) || !unit(params.nms_threshold) || !unit(params.min_confidence)) {
+        error = "thresholds must be within [0, 1]";
+        return false;
+    }
+    if (params.top_k < 1 || params.top_k > kMaxTopK || params.max_plates < 0) {
+        error = "top_k must be within [1, " + std::to_string(kMaxTopK) + "], max_plates >= 0";
+        return false;
+    }
+    if (!unit(params.min_plate_width) || !unit(params.min_plate_height) || params.min_plate_aspect < 0.0f ||
+        params.max_plate_aspect <= 0.0f || params.min_plate_aspect > params.max_plate_aspect) {
+        error = "plate sizes must be within [0, 1], 0 <= min_aspect <= max_aspect, max_aspect > 0";
+        return false;
+    }
+    if (params.beam_width < 1 || params.beam_width > CtcBeamSearch::kMaxBeamWidth) {
+        error = "beam_width must be within [1, " + std::to_string(CtcBeamSearch::kMaxBeamWidth) + "]";
+        return false;
+    }
+    if (params.min_plate_length < 0 || params.max_plate_length < 0 || params.min_plate_length > kMaxPlateChars ||
+        params.max_plate_length > kMaxPlateChars ||
+        (params.max_plate_length && params.min_plate_length > params.max_plate_length)) {
+        error = "plate lengths must be within [0, " + std::to_string(kMaxPlateChars) + "], min <= max";
+        return false;
+    }
+    if (params.ocr_width < 1 || params.ocr_height < 1 || params.ocr_width > kMaxCropSize ||
+        params.ocr_height > kMaxCropSize) {
+        error = "crop size must be within [1, " + std::to_string(kMaxCropSize) + "]";
+        return false;
+    }
+    if (params.evidence_quality < 1 || params.evidence_quality > 100) {
+        error = "evidence quality must be within [1, 100]";
+        return false;
+    }
+    if (params.evidence_plate_width < 1 || params.evidence_frame_width < 1 ||
+        params.evidence_plate_width > kMaxCropSize || params.evidence_frame_width > kMaxCropSize) {
+        error = "evidence widths must be within [1, " + std::to_string(kMaxCropSize) + "]";
+        return false;
+    }
+    if (params.evidence_margin < 0.0f || params.evidence_margin > 1.0f) {
+        error = "evidence margin must be within [0, 1]";
+        return false;
+    }
+    return true;
+}
+
+void set_camera(PostprocessParamBlock& block, const std::string& key, const PostprocessParams& params) {
+    for (auto& camera : block.cameras) {
+        if (camera.first == key) {
+            camera.second = params;
+            return;
+        }
+    }
+    block.cameras.emplace_back(key, params);
+}
+
+}  // namespace
+
+PostprocessParamStore& PostprocessParamStore::instance() {
+    static PostprocessParamStore store;
+    return store;
+}
+
+PostprocessParamStore::PostprocessParamStore() : block_(std::make_shared<const PostprocessParamBlock>()) {}
+
+std::shared_ptr<const PostprocessParamBlock> PostprocessParamStore::snapshot() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return block_;
+}
+
+void PostprocessParamStore::publish(std::shared_ptr<PostprocessParamBlock> block) {
+    block->version = block_->version + 1;
+    block_ = std::move(block);
+    version_.store(block_->version, std::memory_order_release);
+}
+
+bool PostprocessParamStore::load_file(const std::string& path, std::string* error) {
+    json::Value config;
+    return json::parse_file(path, config, error) && load(config, error);
+}
+
+bool PostprocessParamStore::load(const json::Value& config, std::string* error) {
+    std::string reason;
+    if (!config.is_object()) {
+        if (error) *error = "config is not an object";
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto block = std::make_shared<PostprocessParamBlock>(*block_);
+
+    // Top-level sections replace the defaults
+    PostprocessParams base = block->defaults;
+    if (!config.get("detection").is_null() || !config.get("ocr").is_null() || !config.get("crop").is_null() ||
+        !config.get("evidence").is_null()) {
+        base = PostprocessParams();
+        if (!load_params(config, base, reason)) {
+            if (error) *error = reason;
+            return false;
+        }
+        block->defaults = base;
+    }
+
+    const json::Value& cameras = config.get("cameras");
+    for (size_t i = 0; i < cameras.keys().size(); i++) {
+        const std::string& key = cameras.keys()[i];
+        PostprocessParams params = base;
+        if (!load_params(cameras[i], params, reason)) {
+            if (error) *error = "camera " + key + ": " + reason;
+            return false;
+        }
+
+        set_camera(*block, key, params);
+    }
+
+    publish(std::move(block));
+    return true;
+}
+
+void PostprocessParamStore::set(const std::string& key, const PostprocessParams& params) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto block = std::make_shared<PostprocessParamBlock>(*block_);
+    if (key.empty()) {
+        block->defaults = params;
+    } else {
+        set_camera(*block, key, params);
+    }
+    publish(std::move(block));
+}
+
+}  // namespace anpr
+
+/**
+ * Load a postprocess config file into the shared store while the pipelines run.
+ *
+ * @param path: JSON config (see postprocess_params.hpp)
+ * @return: 1 if published, 0 if rejected (the previous parameters stay in effect)
+ */
+extern "C" int postprocess_params_load(const char* path) {
+    std::string error;
+    if (!anpr::PostprocessParamStore::instance().load_file(path, &error)) {
+        std::fprintf(stderr, "postprocess_params: ignoring config %s: %s\n", path, error.c_str());
+        return 0;
+    }
+    return 1;
+}
+
+extern "C" uint64_t postprocess_params_version() {
+    return anpr::PostprocessParamStore::instance().version();
+}
@@ -0,0 +1,155 @@
+/**
+ * Runtime postprocess parameters, per camera, hot-reloadable.
+ *
+ * The detection thresholds, the OCR decoding options, the plate length
+ * limits and the crop size used to be compile-time constants of the plugins.
+ * They are now read from a parameter block published by
+ * PostprocessParamStore (libanpr_core.so): plate_detection and plate_ocr load
+ * their hailofilter config-path into it at init, and Python reloads a
+ * rewritten file through postprocess_params_load() while the streams run.
+ *
+ * Publishing is RCU-style: a load builds a new immutable block and swaps it
+ * in; readers keep a per-thread reference to the block they last used and
+ * only take the store's mutex when its version changes, so the plugins' hot
+ * path is one acquire load. A superseded block is freed once the last
+ * streaming thread has moved past it.
+ *
+ * Config format (every key optional; cameras start from the defaults):
+ *   {
+ *     "detection": {"confidence_threshold": 0.5, "nms_threshold": 0.45,
+ *                   "fast": false, "top_k": 16, "max_plates": 0,
+ *                   "min_width": 0.01, "min_height": 0.005,
+ *                   "min_aspect": 0.5, "max_aspect": 10},
+ *     "ocr": {"min_confidence": 0.6, "beam_search": true, "beam_width": 8,
+ *             "min_length": 0, "max_length": 0},
+ *     "crop": {"width": 200, "height": 64, "dmabuf": false},
+ *     "evidence": {"enabled": false, "quality": 85, "plate_width": 320,
+ *                  "frame_width": 640, "margin": 0.15},
+ *     "cameras": {"cam3": {"detection": {...}, ...}, "sink_1": {...}}
+ *   }
+ *
+ * Cameras are keyed like SceneActivity (activity_key()). Top-level sections
+ * replace the defaults; camera entries of a file replace those cameras'
+ * entries and leave the other cameras alone, so pipelines sharing the
+ * process each load their own file. Plate lengths of 0 keep the region's
+ * limits (plate_region.hpp); the crop size must match the OCR network input.
+ * "fast" turns on the detection fast mode (detection_decode.hpp): only the
+ * top_k candidates of plausible geometry (normalized network input size and
+ * width/height ratio) are decoded. max_plates caps the boxes per frame in
+ * either mode, 0 for no cap.
+ * Evidence widths are upper bounds: snapshots are never upscaled.
+ */
+
+#pragma once
+
+#include "json_lite.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace anpr {
+
+struct PostprocessParams {
+    // plate_detection
+    float confidence_threshold = 0.5f;
+    float nms_threshold = 0.45f;
+    bool fast_detection = false;  // Top-K and geometry prefilter before NMS
+    int top_k = 16;
+    int max_plates = 0;  // 0: no cap
+    float min_plate_width = 0.01f;
+    float min_plate_height = 0.005f;
+    float min_plate_aspect = 0.5f;
+    float max_plate_aspect = 10.0f;
+
+    // plate_ocr
+    float min_confidence = 0.6f;
+    bool beam_search = true;  // Prefix beam search; false for greedy decoding
+    int beam_width = 8;
+    int min_plate_length = 0;  // 0: the region's limit
+    int max_plate_length = 0;
+
+    // crop_plates: OCR network input size
+    int ocr_width = 200;
+    int ocr_height = 64;
+    bool crop_dmabuf = false;  // Frames are mapped DMA-BUF: stage crop rows (CropResizer::run_staged)
+
+    // crop_plates: JPEG snapshots of decided tracks (evidence.hpp)
+    bool evidence_enabled = false;
+    int evidence_quality = 85;
+    int evidence_plate_width = 320;
+    int evidence_frame_width = 640;
+    float evidence_margin = 0.15f;  // Context around the plate, fraction of its size per side
+};
+
+/**
+ * One published set of parameters; never modified once published.
+ */
+struct PostprocessParamBlock {
+    uint64_t version = 0;
+    PostprocessParams defaults;
+    std::vector<std::pair<std::string, PostprocessParams>> cameras;
+
+    /**
+     * Parameters of a camera, the defaults if it has no entry.
+     */
+    const PostprocessParams& find(const std::string& key) const {
+        for (const auto& camera : cameras) {
+            if (camera.first == key) return camera.second;
+        }
+        return defaults;
+    }
+};
+
+class PostprocessParamStore {
+public:
+    static PostprocessParamStore& instance();
+
+    /**
+     * Parse a config file and publish it (see the format above).
+     *
+     * @param error: Receives the reason if the file is rejected
+     * @return: false if the file cannot be read or holds invalid values; the
+     *          published parameters are then left unchanged
+     */
+    bool load_file(const std::string& path, std::string* error = nullptr);
+    bool load(const json::Value& config, std::string* error = nullptr);
+
+    /**
+     * Publish parameters for one camera (empty key: the defaults).
+     */
+    void set(const std::string& key, const PostprocessParams& params);
+
+    // Changes whenever a block is published
+    uint64_t version() const { return version_.load(std::memory_order_acquire); }
+
+    std::shared_ptr<const PostprocessParamBlock> snapshot() const;
+
+private:
+    PostprocessParamStore();
+
+    void publish(std::shared_ptr<PostprocessParamBlock> block);
+
+    mutable std::mutex mutex_;  // serializes loads, guards block_
+    std::shared_ptr<const PostprocessParamBlock> block_;
+    std::atomic<uint64_t> version_{0};
+};
+
+/**
+ * Parameters of `key` for the calling thread.
+ *
+ * The reference stays valid until the thread's next call, which may pick up
+ * a newly published block; read the fields needed for a frame once.
+ */
+inline const PostprocessParams& thread_postprocess_params(const std::string& key) {
+    static thread_local std::shared_ptr<const PostprocessParamBlock> block;
+    const PostprocessParamStore& store = PostprocessParamStore::instance();
+    if (!block || block->version != store.version()) block = store.snapshot();
+    return block->find(key);
+}
+
+}  // namespace anpr
@@ -0,0 +1,84 @@
+/**
+ * Quantization helpers for reading native HEF output tensors.
+ *
+ * Hailo outputs are affine-quantized: real = (q - zero_point) * scale.
+ * Instead of dequantizing whole tensors on the host, the post-processing
+ * converts its thresholds into the quantized domain once per frame, compares
+ * integers in the hot loops and only dequantizes the values that survive.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+namespace anpr {
+
+enum class TensorDType {
+    Float32,
+    UInt8,
+    UInt16,
+};
+
+struct QuantInfo {
+    float scale = 1.0f;
+    float zero_point = 0.0f;
+};
+
+/**
+ * Dequantize a single value. Float tensors are passed through unchanged.
+ */
+template <typename T>
+inline float dequantize(T value, const QuantInfo& quant) {
+    if constexpr (std::is_floating_point<T>::value) {
+        return value;
+    } else {
+        return (static_cast<float>(value) - quant.zero_point) * quant.scale;
+    }
+}
+
+/**
+ * Convert `threshold` into the quantized domain of T.
+ *
+ * On success `out` is the smallest q with dequantize(q) >= threshold, so
+ * `q >= out` is exactly equivalent to `dequantize(q) >= threshold`.
+ *
+ * @return: false if no representable value can reach the threshold
+ */
+template <typename T>
+inline bool quantize_threshold(float threshold, const QuantInfo& quant, T& out) {
+    if constexpr (std::is_floating_point<T>::value) {
+        out = threshold;
+        return true;
+    } else {
+        const int64_t max_q = std::numeric_limits<T>::max();
+
+        if (!(quant.scale > 0.0f) || std::isnan(threshold)) return false;
+
+        // Clamp before the cast: a tiny scale would overflow the integer
+        const double estimate = std::ceil(static_cast<double>(threshold) / quant.scale + quant.zero_point);
+        if (std::isnan(estimate)) return false;
+        int64_t q = static_cast<int64_t>(std::max(0.0, std::min(estimate, static_cast<double>(max_q + 1))));
+
+        // Correct for rounding in the division so the comparison is exact
+        while (q > 0 && dequantize<T>(static_cast<T>(q - 1), quant) >= threshold) q--;
+        while (q <= max_q && dequantize<T>(static_cast<T>(q), quant) < threshold) q++;
+
+        if (q > max_q) return false;
+        out = static_cast<T>(q);
+        return true;
+    }
+}
+
+inline int dtype_size(TensorDType dtype) {
+    switch (dtype) {
+        case TensorDType::UInt8: return 1;
+        case TensorDType::UInt16: return 2;
+        default: return 4;
+    }
+}
+
+}  // namespace anpr
@@ -0,0 +1,46 @@
+/**
+ * Shared scene activity state (libanpr_core.so), see scene_activity.hpp.
+ */
+
+#include "scene_activity.hpp"
+
+#include <cstring>
+
+namespace anpr {
+
+SceneActivity& SceneActivity::instance() {
+    static SceneActivity activity;
+    return activity;
+}
+
+int SceneActivity::find(const std::string& key) const {
+    for (int i = 0; i < num_entries_; i++) {
+        if (key.compare(0, kMaxKeyLength, entries_[i].key) == 0) return i;
+    }
+    return -1;
+}
+
+void SceneActivity::report_frame(const std::string& key, size_t detections) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    int i = find(key);
+    if (i < 0) {
+        if (num_entries_ == kMaxStreams) return;
+        i = num_entries_++;
+        std::strncpy(entries_[i].key, key.c_str(), kMaxKeyLength);
+    }
+
+    Entry& entry = entries_[i];
+    if (detections) {
+        entry.frames_without_detections = 0;
+    } else if (entry.frames_without_detections < UINT32_MAX) {
+        entry.frames_without_detections++;
+    }
+}
+
+uint32_t SceneActivity::frames_without_detections(const std::string& key) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const int i = find(key);
+    return i >= 0 ? entries_[i].frames_without_detections : 0;
+}
+
+}  // namespace anpr
@@ -0,0 +1,78 @@
+/**
+ * Process-wide "frames since the last plate detection" per stream.
+ *
+ * plate_detection reports every inferred frame here; the activity gate in
+ * libframe_gate.so (in front of the detection hailonet) reads it to decide
+ * whether a camera can drop to the idle inference rate. Like the track
+ * registry it lives in libanpr_core.so so both plugins see one instance.
+ *
+ * Streams are keyed by activity_key(): the ROI stream id in multi-stream
+ * pipelines ("sink_2"), otherwise the pipeline's element prefix ("cam3").
+ */
+
+#pragma once
+
+#include "thread_name.hpp"
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+namespace anpr {
+
+class SceneActivity {
+public:
+    static constexpr int kMaxStreams = 64;
+    static constexpr size_t kMaxKeyLength = 31;
+
+    static SceneActivity& instance();
+
+    /**
+     * Record one inferred frame of a stream and its number of detections.
+     */
+    void report_frame(const std::string& key, size_t detections);
+
+    /**
+     * @return: Inferred frames since the stream's last detection, 0 for
+     *          streams that have not reported yet (treated as active)
+     */
+    uint32_t frames_without_detections(const std::string& key) const;
+
+private:
+    struct Entry {
+        char key[kMaxKeyLength + 1] = {};
+        uint32_t frames_without_detections = 0;
+    };
+
+    SceneActivity() = default;
+
+    int find(const std::string& key) const;
+
+    mutable std::mutex mutex_;
+    Entry entries_[kMaxStreams];
+    int num_entries_ = 0;
+};
+
+/**
+ * Camera key of the calling streaming thread: its element prefix, followed
+ * when the thread is renamed (a pooled thread reused by another pipeline).
+ */
+inline const std::string& thread_activity_key() {
+    // Streaming threads are named after their queue, "<prefix>_det:src"
+    static thread_local ThreadNameCache<std::string> key;
+    return key.get("", [](const char* name) {
+        const std::string thread_name(name);
+        return thread_name.substr(0, thread_name.find('_'));
+    });
+}
+
+/**
+ * Activity key of the calling streaming thread's stream.
+ *
+ * @param stream_id: The frame ROI's stream id (empty in single-stream pipelines)
+ */
+inline std::string activity_key(const std::string& stream_id) {
+    return stream_id.empty() ? thread_activity_key() : stream_id;
+}
+
+}  // namespace anpr
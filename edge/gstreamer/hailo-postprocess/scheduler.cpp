@@ -0,0 +1,339 @@
+/**
+ * Shared inference scheduler (libanpr_core.so), see scheduler.hpp.
+ */
+
+#include "scheduler.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <functional>
+
+namespace anpr {
+
+void allocate_fps(const int* priority, const float* demand, const float* min_fps, size_t count, float capacity,
+                  float* grant) {
+    // Floors first, whatever the priority
+    float remaining = capacity;
+    for (size_t i = 0; i < count; i++) {
+        grant[i] = std::min(demand[i], min_fps[i]);
+        remaining -= grant[i];
+    }
+    remaining = std::max(0.0f, remaining);
+
+    // Then the rest of each level's demand, highest level first
+    std::vector<int> levels(priority, priority + count);
+    std::sort(levels.begin(), levels.end(), std::greater<int>());
+    levels.erase(std::unique(levels.begin(), levels.end()), levels.end());
+
+    for (const int level : levels) {
+        float extra = 0.0f;
+        for (size_t i = 0; i < count; i++) {
+            if (priority[i] == level) extra += demand[i] - grant[i];
+        }
+        if (extra <= 0.0f) continue;
+
+        const float share = std::min(1.0f, remaining / extra);
+        for (size_t i = 0; i < count; i++) {
+            if (priority[i] == level) grant[i] += (demand[i] - grant[i]) * share;
+        }
+        remaining -= extra * share;
+        if (remaining <= 0.0f) remaining = 0.0f;
+    }
+}
+
+InferenceScheduler& InferenceScheduler::instance() {
+    static InferenceScheduler scheduler;
+    return scheduler;
+}
+
+uint64_t InferenceScheduler::now_ns() {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+            .count());
+}
+
+int InferenceScheduler::find(const std::string& key) const {
+    for (int i = 0; i < num_entries_; i++) {
+        if (key.compare(entries_[i].key) == 0) return i;
+    }
+    return -1;
+}
+
+void InferenceScheduler::configure(const SchedulerOptions& options) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    options_ = options;
+    options_.device_fps = std::max(0.0f, options.device_fps);
+    scale_ = 1.0f;
+}
+
+bool InferenceScheduler::set_camera(const std::string& key, const CameraBudget& budget) {
+    if (key.empty() || key.size() > kMaxKeyLength) return false;
+    if (!(budget.fps >= 0.0f) || !(budget.min_fps >= 0.0f) || !(budget.ocr_fps >= 0.0f)) return false;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    int i = find(key);
+    if (i < 0) {
+        if (num_entries_ == kMaxCameras) return false;
+        i = num_entries_++;
+        entries_[i] = Entry();
+        std::strncpy(entries_[i].key, key.c_str(), kMaxKeyLength);
+    }
+    entries_[i].budget = budget;
+    return true;
+}
+
+void InferenceScheduler::remove_camera(const std::string& key) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const int i = find(key);
+    if (i < 0) return;
+    entries_[i] = entries_[num_entries_ - 1];
+    num_entries_--;
+}
+
+float InferenceScheduler::ocr_share(const Entry& entry) const {
+    if (!entry.throttled) return 1.0f;
+    const float demand = entry.budget.fps > 0.0f ? std::min(entry.budget.fps, entry.offered_fps) : entry.offered_fps;
+    return demand > 0.0f ? std::min(1.0f, entry.granted_fps / demand) : 1.0f;
+}
+
+void InferenceScheduler::tick(uint64_t now_ns) {
+    if (round_start_ns_ == 0) {
+        round_start_ns_ = now_ns;
+        return;
+    }
+    if (now_ns - round_start_ns_ < kTickNs) return;
+    const float elapsed_s = (now_ns - round_start_ns_) / 1e9f;
+    round_start_ns_ = now_ns;
+    rounds_++;
+
+    // Measurements of the round
+    float worst_latency_ms = 0.0f;
+    for (int i = 0; i < num_entries_; i++) {
+        Entry& e = entries_[i];
+        e.offered_fps = e.window_offered / elapsed_s;
+        e.achieved_fps = e.window_inferred / elapsed_s;
+        if (e.window_offered == 0 && e.window_inferred == 0) {
+            e.pending_count = 0;  // Stream stopped, its queued frames are gone
+        }
+        if (e.window_latency_samples) {
+            e.latency_ms = static_cast<float>(e.window_latency_ms / e.window_latency_samples);
+            e.latency_max_ms = e.window_latency_max_ms;
+        } else {
+            // Nothing came back: as old as the oldest frame still queued
+            e.latency_ms = e.pending_count ? (now_ns - e.pending[e.pending_head]) / 1e6f : 0.0f;
+            e.latency_max_ms = e.latency_ms;
+        }
+        worst_latency_ms = std::max(worst_latency_ms, e.latency_ms);
+        e.window_offered = 0;
+        e.window_inferred = 0;
+        e.window_latency_samples = 0;
+        e.window_latency_ms = 0.0;
+        e.window_latency_max_ms = 0.0f;
+    }
+
+    // Latency controller: multiplicative decrease, additive increase
+    overloaded_ = worst_latency_ms > options_.target_latency_ms;
+    if (overloaded_) {
+        scale_ = std::max(kMinScale, scale_ * 0.85f);
+    } else if (worst_latency_ms < 0.5f * options_.target_latency_ms) {
+        scale_ = std::min(1.0f, scale_ + 0.05f);
+    }
+
+    int priority[kMaxCameras];
+    float demand[kMaxCameras];
+    float min_fps[kMaxCameras];
+    float grant[kMaxCameras];
+    float total_demand = 0.0f;
+    for (int i = 0; i < num_entries_; i++) {
+        const Entry& e = entries_[i];
+        priority[i] = e.budget.priority;
+        demand[i] = e.budget.fps > 0.0f ? std::min(e.budget.fps, e.offered_fps) : e.offered_fps;
+        min_fps[i] = e.budget.min_fps;
+        total_demand += demand[i];
+    }
+
+    capacity_fps_ = (options_.device_fps > 0.0f ? options_.device_fps : total_demand) * scale_;
+    allocate_fps(priority, demand, min_fps, static_cast<size_t>(num_entries_), capacity_fps_, grant);
+
+    for (int i = 0; i < num_entries_; i++) {
+        Entry& e = entries_[i];
+        e.granted_fps = grant[i];
+        e.throttled = grant[i] < demand[i] * 0.99f;
+        e.measured = true;
+    }
+}
+
+bool InferenceScheduler::admit_frame(const std::string& key, uint64_t now_ns) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    tick(now_ns);
+    const int i = find(key);
+    if (i < 0) return true;
+
+    Entry& e = entries_[i];
+    e.frames_offered++;
+    e.window_offered++;
+
+    // Fixed-rate admission at the grant, with a burst of a frame and a half
+    bool admit = true;
+    if (e.measured && e.throttled) {
+        const float dt = e.last_admit_ns ? std::min(1.0f, (now_ns - e.last_admit_ns) / 1e9f) : 0.0f;
+        e.credit = std::min(1.5f, e.credit + e.granted_fps * dt);
+        admit = e.credit >= 1.0f;
+        if (admit) e.credit -= 1.0f;
+    }
+    e.last_admit_ns = now_ns;
+
+    if (!admit) {
+        e.frames_skipped++;
+        return false;
+    }
+
+    e.frames_admitted++;
+    if (e.pending_count == kPendingFrames) {
+        e.pending_head = (e.pending_head + 1) % kPendingFrames;  // oldest never came back
+        e.pending_count--;
+    }
+    e.pending[(e.pending_head + e.pending_count) % kPendingFrames] = now_ns;
+    e.pending_count++;
+    return true;
+}
+
+void InferenceScheduler::report_inferred(const std::string& key, uint64_t now_ns) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const int i = find(key);
+    if (i < 0) return;
+
+    Entry& e = entries_[i];
+    e.frames_inferred++;
+    e.window_inferred++;
+    if (e.pending_count == 0) return;  // No gate in front of this camera
+
+    const uint64_t admitted_ns = e.pending[e.pending_head];
+    e.pending_head = (e.pending_head + 1) % kPendingFrames;
+    e.pending_count--;
+
+    const float latency_ms = now_ns > admitted_ns ? (now_ns - admitted_ns) / 1e6f : 0.0f;
+    e.window_latency_ms += latency_ms;
+    e.window_latency_samples++;
+    e.window_latency_max_ms = std::max(e.window_latency_max_ms, latency_ms);
+}
+
+size_t InferenceScheduler::admit_ocr(const std::string& key, size_t requested, uint64_t now_ns) {
+    if (requested == 0) return 0;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    const int i = find(key);
+    if (i < 0) return requested;
+
+    Entry& e = entries_[i];
+    const float share = ocr_share(e);
+    size_t admitted = requested;
+    if (e.budget.ocr_fps > 0.0f) {
+        // Token bucket at the OCR budget, scaled like the frames
+        const float rate = e.budget.ocr_fps * share;
+        const float burst = std::max(2.0f, rate);
+        const float dt = e.last_ocr_ns ? std::min(1.0f, (now_ns - e.last_ocr_ns) / 1e9f) : 1.0f;
+        e.ocr_tokens = std::min(burst, e.ocr_tokens + rate * dt);
+        admitted = std::min(requested, static_cast<size_t>(e.ocr_tokens));
+        e.ocr_tokens -= admitted;
+    } else if (share < 1.0f) {
+        admitted = std::max<size_t>(1, static_cast<size_t>(std::ceil(requested * share)));
+    }
+    e.last_ocr_ns = now_ns;
+
+    e.ocr_admitted += admitted;
+    e.ocr_deferred += requested - admitted;
+    return admitted;
+}
+
+std::vector<CameraSchedule> InferenceScheduler::cameras() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<CameraSchedule> out(static_cast<size_t>(num_entries_));
+    for (int i = 0; i < num_entries_; i++) {
+        const Entry& e = entries_[i];
+        CameraSchedule& s = out[i];
+        std::memset(&s, 0, sizeof(s));
+        std::strncpy(s.key, e.key, sizeof(s.key) - 1);
+        s.priority = e.budget.priority;
+        s.budget_fps = e.budget.fps;
+        s.offered_fps = e.offered_fps;
+        s.granted_fps = e.granted_fps;
+        s.achieved_fps = e.achieved_fps;
+        s.queue_latency_ms = e.latency_ms;
+        s.queue_latency_max_ms = e.latency_max_ms;
+        s.ocr_share = ocr_share(e);
+        s.throttled = e.throttled ? 1 : 0;
+        s.frames_offered = e.frames_offered;
+        s.frames_admitted = e.frames_admitted;
+        s.frames_skipped = e.frames_skipped;
+        s.frames_inferred = e.frames_inferred;
+        s.ocr_admitted = e.ocr_admitted;
+        s.ocr_deferred = e.ocr_deferred;
+    }
+    return out;
+}
+
+SchedulerState InferenceScheduler::state() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    SchedulerState s = {};
+    s.device_fps = options_.device_fps;
+    s.target_latency_ms = options_.target_latency_ms;
+    s.capacity_fps = capacity_fps_;
+    s.scale = scale_;
+    s.cameras = static_cast<uint32_t>(num_entries_);
+    s.overloaded = overloaded_ ? 1 : 0;
+    s.rounds = rounds_;
+    return s;
+}
+
+}  // namespace anpr
+
+/**
+ * Set the device budget and the queue latency target of all cameras.
+ */
+extern "C" void scheduler_configure(float device_fps, float target_latency_ms) {
+    anpr::SchedulerOptions options;
+    options.device_fps = device_fps;
+    options.target_latency_ms = target_latency_ms;
+    anpr::InferenceScheduler::instance().configure(options);
+}
+
+/**
+ * Add or update a camera (key as SceneActivity).
+ *
+ * @return: 1 if set, 0 if the key or budget is invalid or the table is full
+ */
+extern "C" int scheduler_set_camera(const char* key, int priority, float fps, float min_fps, float ocr_fps) {
+    anpr::CameraBudget budget;
+    budget.priority = priority;
+    budget.fps = fps;
+    budget.min_fps = min_fps;
+    budget.ocr_fps = ocr_fps;
+    return anpr::InferenceScheduler::instance().set_camera(key, budget) ? 1 : 0;
+}
+
+extern "C" void scheduler_remove_camera(const char* key) {
+    anpr::InferenceScheduler::instance().remove_camera(key);
+}
+
+extern "C" size_t scheduler_count() {
+    return anpr::InferenceScheduler::instance().cameras().size();
+}
+
+/**
+ * Copy the schedules of up to `max_cameras` cameras into `out`.
+ *
+ * @return: Number of entries written
+ */
+extern "C" size_t scheduler_stats(anpr::CameraSchedule* out, size_t max_cameras) {
+    const std::vector<anpr::CameraSchedule> cameras = anpr::InferenceScheduler::instance().cameras();
+    const size_t count = std::min(max_cameras, cameras.size());
+    std::copy(cameras.begin(), cameras.begin() + count, out);
+    return count;
+}
+
+extern "C" void scheduler_state(anpr::SchedulerState* out) {
+    *out = anpr::InferenceScheduler::instance().state();
+}
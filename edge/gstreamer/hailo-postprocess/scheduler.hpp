@@ -0,0 +1,198 @@
+/**
+ * Process-wide inference scheduler: per-camera priorities and budgets on the
+ * shared Hailo device.
+ *
+ * Every camera pipeline of the process feeds the same device. Without
+ * coordination an oversubscribed box slows all cameras down alike, so the
+ * entry lane waits behind the overview camera. The scheduler gives each
+ * camera a budget (inference fps, OCR crops per second) and a priority, and
+ * enforces them at the two points where work enters the device:
+ *  - frame skipping: the frame gate in front of the detection network
+ *    (frame_gate.cpp) asks admit_frame() for every frame it would pass
+ *  - OCR admission: crop_plates asks admit_ocr() how many of a frame's
+ *    crops go to the OCR network
+ *
+ * Every kTickNs the scheduler hands out the device capacity by priority
+ * level. Each camera first gets its floor (min_fps). The rest goes to the
+ * highest level's demand (offered frame rate, capped by its budget), and
+ * what is left goes down the levels; the first level that does not fit is
+ * shared in proportion to demand. The capacity is device_fps, or the total
+ * demand if it is not configured. It is scaled by a latency controller: when
+ * a camera's queue latency (gate admission to plate_detection) goes over
+ * target_latency_ms the scale drops multiplicatively, and it recovers
+ * additively once every camera is well below the target. Lower priorities
+ * absorb the cut first, so critical lanes keep a predictable latency.
+ *
+ * Cameras are keyed like SceneActivity (activity_key()). Cameras without an
+ * entry are never throttled.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace anpr {
+
+struct CameraBudget {
+    int priority = 0;       // higher is served first
+    float fps = 0.0f;       // inference budget, 0: whatever the camera offers
+    float min_fps = 1.0f;   // kept even under overload
+    float ocr_fps = 0.0f;   // OCR crops per second, 0: unlimited
+};
+
+struct SchedulerOptions {
+    float device_fps = 0.0f;           // frames/s the device sustains for all cameras, 0: unknown
+    float target_latency_ms = 150.0f;  // queue latency that counts as overload
+};
+
+/**
+ * One camera's schedule and measurements, laid out for ctypes.
+ */
+struct CameraSchedule {
+    char key[32];
+    int32_t priority;
+    float budget_fps;
+    float offered_fps;           // frames asking for admission
+    float granted_fps;           // admission rate of the last round
+    float achieved_fps;          // frames plate_detection processed
+    float queue_latency_ms;      // mean over the last round
+    float queue_latency_max_ms;
+    float ocr_share;             // granted / demanded, scales OCR admission
+    uint32_t throttled;
+    uint64_t frames_offered;
+    uint64_t frames_admitted;
+    uint64_t frames_skipped;
+    uint64_t frames_inferred;
+    uint64_t ocr_admitted;
+    uint64_t ocr_deferred;
+};
+
+/**
+ * Device-level state, laid out for ctypes.
+ */
+struct SchedulerState {
+    float device_fps;
+    float target_latency_ms;
+    float capacity_fps;  // handed out in the last round
+    float scale;         // latency controller, (0, 1]
+    uint32_t cameras;
+    uint32_t overloaded;  // last round saw a queue latency over the target
+    uint64_t rounds;
+};
+
+/**
+ * Grants of one round.
+ *
+ * @param demand: Frame rate each camera would use
+ * @param grant: Receives the admission rate of each camera
+ */
+void allocate_fps(const int* priority, const float* demand, const float* min_fps, size_t count, float capacity,
+                  float* grant);
+
+class InferenceScheduler {
+public:
+    static constexpr uint64_t kTickNs = 500000000ull;
+    static constexpr int kMaxCameras = 64;
+    static constexpr size_t kMaxKeyLength = 31;
+    static constexpr float kMinScale = 0.1f;
+
+    static InferenceScheduler& instance();
+
+    void configure(const SchedulerOptions& options);
+
+    /**
+     * Add or update a camera.
+     *
+     * @return: false if the key is too long, the budget invalid or the table full
+     */
+    bool set_camera(const std::string& key, const CameraBudget& budget);
+
+    void remove_camera(const std::string& key);
+
+    /**
+     * Decide whether a frame the gate would pass goes to the network.
+     *
+     * @param now_ns: Monotonic time of the frame (steady clock)
+     */
+    bool admit_frame(const std::string& key, uint64_t now_ns);
+
+    /**
+     * Record that plate_detection processed a frame of `key`.
+     */
+    void report_inferred(const std::string& key, uint64_t now_ns);
+
+    /**
+     * Number of a frame's `requested` OCR crops that may go to the network.
+     */
+    size_t admit_ocr(const std::string& key, size_t requested, uint64_t now_ns);
+
+    std::vector<CameraSchedule> cameras() const;
+    SchedulerState state() const;
+
+    static uint64_t now_ns();
+
+private:
+    static constexpr size_t kPendingFrames = 64;
+
+    struct Entry {
+        char key[kMaxKeyLength + 1] = {};
+        CameraBudget budget;
+
+        // Recomputed every round
+        float offered_fps = 0.0f;
+        float granted_fps = 0.0f;
+        float achieved_fps = 0.0f;
+        float latency_ms = 0.0f;
+        float latency_max_ms = 0.0f;
+        bool measured = false;  // at least one round since it was added
+        bool throttled = false;
+
+        // Admission credit (frames) and OCR tokens (crops)
+        float credit = 1.0f;
+        uint64_t last_admit_ns = 0;
+        float ocr_tokens = 0.0f;
+        uint64_t last_ocr_ns = 0;
+
+        // Admission times of frames not processed yet
+        uint64_t pending[kPendingFrames] = {};
+        size_t pending_head = 0;
+        size_t pending_count = 0;
+
+        // Current round
+        uint32_t window_offered = 0;
+        uint32_t window_inferred = 0;
+        uint32_t window_latency_samples = 0;
+        double window_latency_ms = 0.0;
+        float window_latency_max_ms = 0.0f;
+
+        uint64_t frames_offered = 0;
+        uint64_t frames_admitted = 0;
+        uint64_t frames_skipped = 0;
+        uint64_t frames_inferred = 0;
+        uint64_t ocr_admitted = 0;
+        uint64_t ocr_deferred = 0;
+    };
+
+    InferenceScheduler() = default;
+
+    int find(const std::string& key) const;
+    void tick(uint64_t now_ns);
+    float ocr_share(const Entry& entry) const;
+
+    mutable std::mutex mutex_;
+    SchedulerOptions options_;
+    Entry entries_[kMaxCameras];
+    int num_entries_ = 0;
+
+    uint64_t round_start_ns_ = 0;
+    float scale_ = 1.0f;
+    float capacity_fps_ = 0.0f;
+    bool overloaded_ = false;
+    uint64_t rounds_ = 0;
+};
+
+}  // namespace anpr
@@ -0,0 +1,87 @@
+/**
+ * Shared stage stats (libanpr_core.so), see stage_stats.hpp.
+ */
+
+#include "stage_stats.hpp"
+
+#include <cstring>
+
+namespace anpr {
+
+StageRegistry& StageRegistry::instance() {
+    static StageRegistry registry;
+    return registry;
+}
+
+StageStats& StageRegistry::thread_stage(const char* stage, const std::vector<const char*>& counters) {
+    char thread[kThreadNameLength];
+    current_thread_name(thread, "");
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& entry : stages_) {
+        if (entry->thread() == thread && entry->stage() == std::string(stage).substr(0, 15)) return *entry;
+    }
+    if (stages_.size() == kMaxStages) return overflow_;
+
+    stages_.emplace_back(new StageStats(thread, stage, counters));
+    return *stages_.back();
+}
+
+std::vector<StageStatsSnapshot> StageRegistry::snapshots() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<StageStatsSnapshot> snapshots;
+    snapshots.reserve(stages_.size());
+    for (const auto& entry : stages_) snapshots.push_back(entry->snapshot());
+    return snapshots;
+}
+
+bool StageRegistry::histogram(size_t index, uint64_t* out) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (index >= stages_.size()) return false;
+    const LatencyHistogram& histogram = stages_[index]->histogram();
+    for (int b = 0; b < LatencyHistogram::kBuckets; b++) out[b] = histogram.count(b);
+    return true;
+}
+
+}  // namespace anpr
+
+/**
+ * Number of stage entries (one per stage and streaming thread).
+ */
+extern "C" size_t stage_stats_count() {
+    return anpr::StageRegistry::instance().snapshots().size();
+}
+
+/**
+ * Copy snapshots of up to `max_stages` entries into `out`.
+ *
+ * @return: Number of entries written
+ */
+extern "C" size_t stage_stats(anpr::StageStatsSnapshot* out, size_t max_stages) {
+    const std::vector<anpr::StageStatsSnapshot> snapshots = anpr::StageRegistry::instance().snapshots();
+    const size_t count = std::min(max_stages, snapshots.size());
+    std::copy(snapshots.begin(), snapshots.begin() + count, out);
+    return count;
+}
+
+/**
+ * Latency histogram of entry `index` (same order as stage_stats()).
+ *
+ * @param out: stage_stats_num_buckets() counts
+ * @return: 0 if there is no such entry
+ */
+extern "C" int stage_stats_histogram(size_t index, uint64_t* out) {
+    return anpr::StageRegistry::instance().histogram(index, out) ? 1 : 0;
+}
+
+extern "C" int stage_stats_num_buckets() {
+    return anpr::LatencyHistogram::kBuckets;
+}
+
+/**
+ * Lower bound in ns of a histogram bucket (the upper bound is the next
+ * bucket's lower bound).
+ */
+extern "C" uint64_t stage_stats_bucket_lower_ns(int bucket) {
+    return anpr::LatencyHistogram::bucket_lower(bucket);
+}
@@ -0,0 +1,239 @@
+/**
+ * Per-stage latency histograms and counters of the postprocess plugins.
+ *
+ * Every plugin entry point (plate_detection, crop_plates, plate_ocr, ...)
+ * times itself into a StageStats owned by the calling streaming thread and
+ * bumps a few stage-specific counters (candidates over the threshold, NMS
+ * survivors, OCR reads failing validation, ...). Each StageStats has a
+ * single writer, so recording is a handful of relaxed loads and stores with
+ * no locking; readers get a consistent-enough snapshot at any time.
+ *
+ * Latencies go into a log-linear (HDR style) histogram: 8 sub-buckets per
+ * power of two of nanoseconds, i.e. at most 12.5% relative error, from 1 ns
+ * to ~34 s. The stats live in libanpr_core.so and are read through the
+ * stage_stats_* C API.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "thread_name.hpp"
+
+namespace anpr {
+
+inline uint64_t monotonic_ns() {
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return static_cast<uint64_t>(now.tv_sec) * 1000000000ull + static_cast<uint64_t>(now.tv_nsec);
+}
+
+class LatencyHistogram {
+public:
+    static constexpr int kSubBuckets = 8;
+    static constexpr int kBuckets = 272;  // up to 2^35 ns
+
+    static int bucket_of(uint64_t ns) {
+        if (ns < kSubBuckets) return static_cast<int>(ns);
+        const int exponent = 63 - __builtin_clzll(ns);  // >= 3
+        const int sub = static_cast<int>((ns >> (exponent - 3)) & (kSubBuckets - 1));
+        return std::min((exponent - 2) * kSubBuckets + sub, kBuckets - 1);
+    }
+
+    // Smallest value of a bucket; bucket b holds [lower(b), lower(b + 1))
+    static uint64_t bucket_lower(int bucket) {
+        if (bucket < kSubBuckets) return static_cast<uint64_t>(bucket);
+        const int exponent = bucket / kSubBuckets + 2;
+        return static_cast<uint64_t>(kSubBuckets + bucket % kSubBuckets) << (exponent - 3);
+    }
+
+    // Writer only
+    void record(uint64_t ns) { bump(counts_[bucket_of(ns)], 1); }
+
+    uint64_t count(int bucket) const { return counts_[bucket].load(std::memory_order_relaxed); }
+
+    /**
+     * Value at quantile q (0..1): the upper end of the bucket holding it, so
+     * p99 never under-reports. 0 if empty.
+     */
+    uint64_t quantile(double q) const {
+        uint64_t total = 0;
+        for (int b = 0; b < kBuckets; b++) total += count(b);
+        if (total == 0) return 0;
+
+        const uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(q * total + 0.5));
+        uint64_t seen = 0;
+        for (int b = 0; b < kBuckets; b++) {
+            seen += count(b);
+            if (seen >= rank) return b + 1 < kBuckets ? bucket_lower(b + 1) - 1 : bucket_lower(b);
+        }
+        return bucket_lower(kBuckets - 1);
+    }
+
+    static void bump(std::atomic<uint64_t>& value, uint64_t n) {
+        value.store(value.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<uint64_t> counts_[kBuckets] = {};
+};
+
+/**
+ * Stage snapshot, laid out for ctypes.
+ */
+struct StageStatsSnapshot {
+    static constexpr int kMaxCounters = 4;
+
+    char thread[16];  // streaming thread name, e.g. "cam3_det:src"
+    char stage[16];   // e.g. "plate_detection"
+    uint64_t calls;
+    uint64_t total_ns;
+    uint64_t max_ns;
+    uint64_t p50_ns;
+    uint64_t p90_ns;
+    uint64_t p99_ns;
+    uint64_t counters[kMaxCounters];
+    char counter_names[kMaxCounters][24];  // empty for unused counters
+};
+
+class StageStats {
+public:
+    static constexpr int kMaxCounters = StageStatsSnapshot::kMaxCounters;
+
+    StageStats(const std::string& thread, const std::string& stage, const std::vector<const char*>& counters)
+        : thread_(thread.substr(0, 15)), stage_(stage.substr(0, 15)) {
+        for (const char* name : counters) {
+            if (num_counters_ == kMaxCounters) break;
+            counter_names_[num_counters_++] = std::string(name).substr(0, 23);
+        }
+    }
+
+    // Writer (owning streaming thread) only
+    void record(uint64_t ns) {
+        LatencyHistogram::bump(calls_, 1);
+        LatencyHistogram::bump(total_ns_, ns);
+        if (ns > max_ns_.load(std::memory_order_relaxed)) max_ns_.store(ns, std::memory_order_relaxed);
+        histogram_.record(ns);
+    }
+
+    void add(int counter, uint64_t n = 1) { LatencyHistogram::bump(counters_[counter], n); }
+
+    const std::string& thread() const { return thread_; }
+    const std::string& stage() const { return stage_; }
+    const LatencyHistogram& histogram() const { return histogram_; }
+
+    StageStatsSnapshot snapshot() const {
+        StageStatsSnapshot s{};
+        thread_.copy(s.thread, sizeof(s.thread) - 1);
+        stage_.copy(s.stage, sizeof(s.stage) - 1);
+        s.calls = calls_.load(std::memory_order_relaxed);
+        s.total_ns = total_ns_.load(std::memory_order_relaxed);
+        s.max_ns = max_ns_.load(std::memory_order_relaxed);
+        s.p50_ns = std::min(histogram_.quantile(0.50), s.max_ns);
+        s.p90_ns = std::min(histogram_.quantile(0.90), s.max_ns);
+        s.p99_ns = std::min(histogram_.quantile(0.99), s.max_ns);
+        for (int c = 0; c < num_counters_; c++) {
+            s.counters[c] = counters_[c].load(std::memory_order_relaxed);
+            counter_names_[c].copy(s.counter_names[c], sizeof(s.counter_names[c]) - 1);
+        }
+        return s;
+    }
+
+private:
+    const std::string thread_;
+    const std::string stage_;
+    std::string counter_names_[kMaxCounters];
+    int num_counters_ = 0;
+
+    std::atomic<uint64_t> calls_{0};
+    std::atomic<uint64_t> total_ns_{0};
+    std::atomic<uint64_t> max_ns_{0};
+    std::atomic<uint64_t> counters_[kMaxCounters] = {};
+    LatencyHistogram histogram_;
+};
+
+/**
+ * Process-wide stage stats (libanpr_core.so). Entries are never removed, so
+ * snapshot indices stay valid; a restarted pipeline continues its entries.
+ */
+class StageRegistry {
+public:
+    static constexpr int kMaxStages = 128;
+
+    static StageRegistry& instance();
+
+    /**
+     * Stats of `stage` on the calling thread, created on first use. Callers
+     * keep it in a thread_local ThreadStage, which looks it up again when the
+     * thread is renamed. When the table is full a shared overflow entry
+     * (never reported) is returned.
+     *
+     * @param counters: Counter names, at most StageStats::kMaxCounters
+     */
+    StageStats& thread_stage(const char* stage, const std::vector<const char*>& counters);
+
+    std::vector<StageStatsSnapshot> snapshots() const;
+
+    /**
+     * Bucket counts of entry `index` (LatencyHistogram::kBuckets values).
+     *
+     * @return: false if there is no such entry
+     */
+    bool histogram(size_t index, uint64_t* out) const;
+
+private:
+    StageRegistry() : overflow_("", "", {}) {}
+
+    mutable std::mutex mutex_;
+    std::vector<std::unique_ptr<StageStats>> stages_;
+    StageStats overflow_;
+};
+
+/**
+ * A stage's stats on the calling thread under its current name, so a pooled
+ * streaming thread reused by another pipeline records into that pipeline's
+ * entry (thread_name.hpp). Keep one in a static thread_local per stage.
+ */
+class ThreadStage {
+public:
+    ThreadStage(const char* stage, std::vector<const char*> counters)
+        : stage_(stage), counters_(std::move(counters)) {}
+
+    StageStats& get() {
+        return *stats_.get("", [this](const char*) {
+            return &StageRegistry::instance().thread_stage(stage_, counters_);
+        });
+    }
+
+private:
+    const char* stage_;
+    std::vector<const char*> counters_;
+    ThreadNameCache<StageStats*> stats_;
+};
+
+/**
+ * Times a scope into a stage.
+ */
+class StageTimer {
+public:
+    explicit StageTimer(StageStats& stats) : stats_(stats), start_(monotonic_ns()) {}
+    ~StageTimer() { stats_.record(monotonic_ns() - start_); }
+
+    StageTimer(const StageTimer&) = delete;
+    StageTimer& operator=(const StageTimer&) = delete;
+
+private:
+    StageStats& stats_;
+    const uint64_t start_;
+};
+
+}  // namespace anpr
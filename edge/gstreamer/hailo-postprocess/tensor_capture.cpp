@@ -0,0 +1,199 @@
+/**
+ * Shared tensor capture registry (libanpr_core.so), see tensor_capture.hpp.
+ */
+
+#include "tensor_capture.hpp"
+#include "stage_stats.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <ctime>
+
+namespace anpr {
+
+namespace {
+
+uint64_t realtime_ns() {
+    timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    return static_cast<uint64_t>(now.tv_sec) * 1000000000ull + static_cast<uint64_t>(now.tv_nsec);
+}
+
+}  // namespace
+
+TensorCapture& TensorCapture::instance() {
+    static TensorCapture capture;
+    return capture;
+}
+
+TensorCapture::Capture* TensorCapture::find(const std::string& key) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (int i = 0; i < num_entries_; i++) {
+        if (key.compare(0, kMaxKeyLength, entries_[i]->key) == 0) return entries_[i].get();
+    }
+    return nullptr;
+}
+
+bool TensorCapture::start(const std::string& key, const TensorCaptureOptions& options) {
+    Capture* capture = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (int i = 0; i < num_entries_ && !capture; i++) {
+            if (key.compare(0, kMaxKeyLength, entries_[i]->key) == 0) capture = entries_[i].get();
+        }
+        if (!capture) {
+            if (num_entries_ == kMaxCaptures) return false;
+            capture = new Capture();
+            std::strncpy(capture->key, key.c_str(), kMaxKeyLength);
+            entries_[num_entries_++].reset(capture);
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(capture->mutex);
+    const bool was_open = capture->writer.is_open();
+    if (!capture->writer.open(options.path, key, realtime_ns())) {
+        if (was_open) active_.fetch_sub(1, std::memory_order_relaxed);
+        return false;
+    }
+    if (!was_open) active_.fetch_add(1, std::memory_order_relaxed);
+
+    capture->options = options;
+    capture->min_interval_ns =
+        options.max_fps > 0.0f ? static_cast<uint64_t>(std::llround(1e9 / options.max_fps)) : 0;
+    capture->last_frame_ns = 0;
+    capture->bytes = capture->writer.size();
+    return true;
+}
+
+bool TensorCapture::stop(const std::string& key) {
+    Capture* capture = find(key);
+    if (!capture) return false;
+
+    std::lock_guard<std::mutex> lock(capture->mutex);
+    if (!capture->writer.is_open()) return false;
+    capture->writer.close();
+    active_.fetch_sub(1, std::memory_order_relaxed);
+    return true;
+}
+
+bool TensorCapture::append(Capture& capture, const TensorRecordHeader& header, const void* payload) {
+    const uint64_t record_bytes = sizeof(TensorRecordHeader) + padded_payload(header.payload_bytes);
+    if (capture.bytes + record_bytes > capture.options.max_bytes || !capture.writer.append(header, payload)) {
+        capture.errors++;
+        return false;
+    }
+    capture.bytes += record_bytes;
+    return true;
+}
+
+uint64_t TensorCapture::capture_detection(const std::string& key, TensorRecordHeader& header, const void* payload) {
+    Capture* capture = find(key);
+    if (!capture) return 0;
+
+    std::lock_guard<std::mutex> lock(capture->mutex);
+    if (!capture->writer.is_open()) return 0;
+
+    const uint64_t now = monotonic_ns();
+    if (capture->last_frame_ns && now - capture->last_frame_ns < capture->min_interval_ns) {
+        capture->rate_limited++;
+        return 0;
+    }
+
+    header.timestamp_ns = realtime_ns();
+    header.frame_id = capture->next_frame_id;
+    header.frame_width = capture->options.frame_width;
+    header.frame_height = capture->options.frame_height;
+    if (!append(*capture, header, payload)) return 0;
+
+    capture->last_frame_ns = now;
+    capture->frames++;
+    return capture->next_frame_id++;
+}
+
+bool TensorCapture::capture_ocr(const std::string& key, uint64_t frame_id, TensorRecordHeader& header,
+                                const void* payload) {
+    Capture* capture = find(key);
+    if (!capture) return false;
+
+    std::lock_guard<std::mutex> lock(capture->mutex);
+    if (!capture->writer.is_open()) return false;
+
+    header.timestamp_ns = realtime_ns();
+    header.frame_id = frame_id;
+    header.frame_width = capture->options.frame_width;
+    header.frame_height = capture->options.frame_height;
+    if (!append(*capture, header, payload)) return false;
+
+    capture->ocr_records++;
+    return true;
+}
+
+std::vector<TensorCaptureStats> TensorCapture::stats() const {
+    std::vector<Capture*> captures;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (int i = 0; i < num_entries_; i++) captures.push_back(entries_[i].get());
+    }
+
+    std::vector<TensorCaptureStats> stats(captures.size());
+    for (size_t i = 0; i < captures.size(); i++) {
+        Capture& capture = *captures[i];
+        TensorCaptureStats& s = stats[i];
+        std::memset(&s, 0, sizeof(s));
+        std::memcpy(s.key, capture.key, sizeof(capture.key));
+
+        std::lock_guard<std::mutex> lock(capture.mutex);
+        s.active = capture.writer.is_open();
+        s.max_fps = capture.options.max_fps;
+        s.frames = capture.frames;
+        s.ocr_records = capture.ocr_records;
+        s.rate_limited = capture.rate_limited;
+        s.bytes = capture.bytes;
+        s.errors = capture.errors;
+    }
+    return stats;
+}
+
+}  // namespace anpr
+
+/**
+ * Start capturing the output tensors of a camera.
+ *
+ * @param key: Camera key (see activity_key())
+ * @param path: Dump file, appended to if it exists
+ * @param max_fps: Captured detection frames per second (<= 0: every frame)
+ * @param max_bytes: Stop writing once the dump reaches this size
+ * @param frame_width: Camera frame size stored in the records
+ * @return: 1 on success, 0 if the dump cannot be opened
+ */
+extern "C" int tensor_capture_start(const char* key, const char* path, float max_fps, uint64_t max_bytes,
+                                    int frame_width, int frame_height) {
+    anpr::TensorCaptureOptions options;
+    options.path = path;
+    options.max_fps = max_fps;
+    options.max_bytes = max_bytes;
+    options.frame_width = frame_width;
+    options.frame_height = frame_height;
+    return anpr::TensorCapture::instance().start(key, options) ? 1 : 0;
+}
+
+extern "C" int tensor_capture_stop(const char* key) {
+    return anpr::TensorCapture::instance().stop(key) ? 1 : 0;
+}
+
+extern "C" size_t tensor_capture_count() {
+    return anpr::TensorCapture::instance().stats().size();
+}
+
+/**
+ * Copy the counters of up to `max_captures` cameras into `out`.
+ *
+ * @return: Number of entries written
+ */
+extern "C" size_t tensor_capture_stats(anpr::TensorCaptureStats* out, size_t max_captures) {
+    const std::vector<anpr::TensorCaptureStats> stats = anpr::TensorCapture::instance().stats();
+    const size_t count = std::min(max_captures, stats.size());
+    std::copy(stats.begin(), stats.begin() + count, out);
+    return count;
+}
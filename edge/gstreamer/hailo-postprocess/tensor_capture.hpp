@@ -0,0 +1,121 @@
+/**
+ * Per-camera capture of raw output tensors into tensor dumps.
+ *
+ * When capture is on for a camera, plate_detection appends the detection
+ * output of at most max_fps frames per second to the camera's dump
+ * (tensor_dump.hpp) and tags the frame's detections with the capture frame
+ * id. plate_ocr then appends the OCR output of every crop carrying that tag,
+ * so a dump holds complete frames (detection and all their reads) that
+ * bench_postprocess replays exactly. Capture stops writing once the dump
+ * reaches max_bytes.
+ *
+ * Cameras are keyed like SceneActivity (activity_key()): the stream id in
+ * multi-stream pipelines ("sink_2"), otherwise the element prefix ("cam3").
+ * The registry lives in libanpr_core.so; Python starts and stops captures
+ * through the tensor_capture_* C API. With no capture running the plugins
+ * only pay one relaxed atomic load per call.
+ */
+
+#pragma once
+
+#include "tensor_dump.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace anpr {
+
+struct TensorCaptureOptions {
+    std::string path;                  // dump file, appended to if it exists
+    float max_fps = 1.0f;              // captured detection frames per second
+    uint64_t max_bytes = 256u << 20;   // stop writing at this dump size
+    int frame_width = 0;               // camera frame size stored in the records
+    int frame_height = 0;
+};
+
+/**
+ * Capture counters, laid out for ctypes.
+ */
+struct TensorCaptureStats {
+    char key[32];
+    uint32_t active;
+    float max_fps;
+    uint64_t frames;        // detection records written
+    uint64_t ocr_records;
+    uint64_t rate_limited;  // detection frames skipped by max_fps
+    uint64_t bytes;         // dump size
+    uint64_t errors;        // failed writes and records refused at max_bytes
+};
+
+class TensorCapture {
+public:
+    static constexpr int kMaxCaptures = 64;
+    static constexpr size_t kMaxKeyLength = 31;
+
+    static TensorCapture& instance();
+
+    /**
+     * Start (or restart with new options) capturing a camera.
+     *
+     * @return: false if the dump cannot be opened or the table is full
+     */
+    bool start(const std::string& key, const TensorCaptureOptions& options);
+
+    /**
+     * @return: false if the camera was not capturing
+     */
+    bool stop(const std::string& key);
+
+    // Cheap check for the plugins' hot path
+    bool any_active() const { return active_.load(std::memory_order_relaxed) > 0; }
+
+    /**
+     * Append a detection output if the camera captures and its rate limit
+     * allows. Fills in the timestamp, frame id and frame size of `header`.
+     *
+     * @return: The capture frame id (> 0) to tag the frame's detections
+     *          with, 0 if the frame was not captured
+     */
+    uint64_t capture_detection(const std::string& key, TensorRecordHeader& header, const void* payload);
+
+    /**
+     * Append the OCR output of a crop of captured frame `frame_id`.
+     */
+    bool capture_ocr(const std::string& key, uint64_t frame_id, TensorRecordHeader& header, const void* payload);
+
+    std::vector<TensorCaptureStats> stats() const;
+
+private:
+    struct Capture {
+        char key[kMaxKeyLength + 1] = {};
+        std::mutex mutex;  // writer and counters; detection and OCR threads share a camera
+        TensorDumpWriter writer;
+        TensorCaptureOptions options;
+        uint64_t min_interval_ns = 0;
+        uint64_t last_frame_ns = 0;
+        uint64_t next_frame_id = 1;
+        uint64_t frames = 0;
+        uint64_t ocr_records = 0;
+        uint64_t rate_limited = 0;
+        uint64_t bytes = 0;
+        uint64_t errors = 0;
+    };
+
+    TensorCapture() = default;
+
+    // Entry of `key`, nullptr if it never captured
+    Capture* find(const std::string& key) const;
+    bool append(Capture& capture, const TensorRecordHeader& header, const void* payload);
+
+    mutable std::mutex mutex_;  // entry table; entries are never removed
+    std::unique_ptr<Capture> entries_[kMaxCaptures];
+    int num_entries_ = 0;
+    std::atomic<int> active_{0};
+};
+
+}  // namespace anpr
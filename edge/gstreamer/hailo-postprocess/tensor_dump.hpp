@@ -0,0 +1,249 @@
+/**
+ * Recorded output tensors (tensor dumps).
+ *
+ * A dump is an append-only file: a file header followed by records, each a
+ * fixed 64-byte header describing one output tensor (kind, shape, dtype,
+ * quantization, frame metadata) and its raw payload, padded to 8 bytes.
+ * Records are written with a single fwrite, and a reader stops at the first
+ * incomplete record, so a dump cut short by a crash or a full disk is still
+ * readable up to its last complete record.
+ *
+ * Readers map the file and hand out pointers into the mapping, so replaying
+ * a dump (bench/bench_postprocess.cpp) feeds the decoders exactly the bytes
+ * the device produced, without copies.
+ */
+
+#pragma once
+
+#include "quant.hpp"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace anpr {
+
+enum class TensorKind : uint32_t {
+    Detection = 1,  // [height, width] detection output of one frame
+    OCR = 2,        // `count` consecutive [height, width] blocks, one per crop
+};
+
+struct TensorDumpFileHeader {
+    static constexpr char kMagic[8] = {'A', 'N', 'P', 'R', 'T', 'N', 'S', '1'};
+    static constexpr uint32_t kVersion = 1;
+
+    char magic[8];
+    uint32_t version;
+    uint32_t record_header_bytes;  // sizeof(TensorRecordHeader) of the writer
+    uint64_t created_ns;           // CLOCK_REALTIME
+    char source[32];               // e.g. camera id, NUL padded
+    uint64_t reserved;
+};
+
+struct TensorRecordHeader {
+    uint32_t kind;           // TensorKind
+    uint32_t dtype;          // TensorDType
+    int32_t height;
+    int32_t width;
+    uint32_t count;          // blocks of [height, width] (OCR batch size, 1 otherwise)
+    uint32_t payload_bytes;  // unpadded
+    float quant_scale;
+    float quant_zero_point;
+    uint64_t timestamp_ns;   // CLOCK_REALTIME of the capture
+    uint64_t frame_id;       // per-stream frame counter of the capturing filter
+    int32_t stream_index;    // multi-stream sink index, -1 for single-stream pipelines
+    int32_t frame_width;     // frame the tensor belongs to, 0 if unknown
+    int32_t frame_height;
+    uint32_t reserved;
+};
+
+static_assert(sizeof(TensorDumpFileHeader) == 64, "TensorDumpFileHeader layout");
+static_assert(sizeof(TensorRecordHeader) == 64, "TensorRecordHeader layout");
+
+inline size_t padded_payload(size_t bytes) {
+    return (bytes + 7) & ~static_cast<size_t>(7);
+}
+
+/**
+ * Appends records to a dump, creating it (and its header) if needed.
+ * One writer per file.
+ */
+class TensorDumpWriter {
+public:
+    TensorDumpWriter() = default;
+    ~TensorDumpWriter() { close(); }
+
+    TensorDumpWriter(const TensorDumpWriter&) = delete;
+    TensorDumpWriter& operator=(const TensorDumpWriter&) = delete;
+
+    /**
+     * @param source: Stored in the file header of a new dump
+     * @return: false if the file cannot be opened or is not a dump
+     */
+    bool open(const std::string& path, const std::string& source, uint64_t created_ns) {
+        close();
+        file_ = std::fopen(path.c_str(), "ab+");
+        if (!file_) return false;
+
+        std::fseek(file_, 0, SEEK_END);
+        if (std::ftell(file_) == 0) {
+            TensorDumpFileHeader header{};
+            std::memcpy(header.magic, TensorDumpFileHeader::kMagic, sizeof(header.magic));
+            header.version = TensorDumpFileHeader::kVersion;
+            header.record_header_bytes = sizeof(TensorRecordHeader);
+            header.created_ns = created_ns;
+            source.copy(header.source, sizeof(header.source) - 1);
+            if (std::fwrite(&header, sizeof(header), 1, file_) != 1) {
+                close();
+                return false;
+            }
+        } else {
+            TensorDumpFileHeader header;
+            std::rewind(file_);
+            const bool valid = std::fread(&header, sizeof(header), 1, file_) == 1 &&
+                               std::memcmp(header.magic, TensorDumpFileHeader::kMagic, sizeof(header.magic)) == 0 &&
+                               header.record_header_bytes == sizeof(TensorRecordHeader);
+            if (!valid) {
+                close();
+                return false;
+            }
+            std::fseek(file_, 0, SEEK_END);
+        }
+        return true;
+    }
+
+    bool is_open() const { return file_ != nullptr; }
+
+    // Current file size in bytes
+    uint64_t size() const { return file_ ? static_cast<uint64_t>(std::ftell(file_)) : 0; }
+
+    /**
+     * Append one record; payload_bytes is taken from `header`.
+     */
+    bool append(const TensorRecordHeader& header, const void* payload) {
+        if (!file_) return false;
+
+        const size_t padded = padded_payload(header.payload_bytes);
+        buffer_.resize(sizeof(header) + padded);
+        std::memcpy(buffer_.data(), &header, sizeof(header));
+        std::memcpy(buffer_.data() + sizeof(header), payload, header.payload_bytes);
+        std::memset(buffer_.data() + sizeof(header) + header.payload_bytes, 0, padded - header.payload_bytes);
+
+        return std::fwrite(buffer_.data(), buffer_.size(), 1, file_) == 1 && std::fflush(file_) == 0;
+    }
+
+    void close() {
+        if (file_) std::fclose(file_);
+        file_ = nullptr;
+    }
+
+private:
+    std::FILE* file_ = nullptr;
+    std::vector<uint8_t> buffer_;  // header + padded payload, one fwrite per record
+};
+
+/**
+ * Read-only view of a dump.
+ */
+class TensorDumpReader {
+public:
+    struct Record {
+        const TensorRecordHeader* header;
+        const void* payload;
+
+        TensorKind kind() const { return static_cast<TensorKind>(header->kind); }
+        TensorDType dtype() const { return static_cast<TensorDType>(header->dtype); }
+        QuantInfo quant() const { return QuantInfo{header->quant_scale, header->quant_zero_point}; }
+    };
+
+    TensorDumpReader() = default;
+    ~TensorDumpReader() { close(); }
+
+    TensorDumpReader(const TensorDumpReader&) = delete;
+    TensorDumpReader& operator=(const TensorDumpReader&) = delete;
+
+    /**
+     * Map a dump and index its complete records.
+     *
+     * @return: false if the file cannot be mapped or has no valid header
+     */
+    bool open(const std::string& path) {
+        close();
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+
+        struct stat st;
+        if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(TensorDumpFileHeader)) {
+            ::close(fd);
+            return false;
+        }
+        size_ = static_cast<size_t>(st.st_size);
+        void* mapping = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (mapping == MAP_FAILED) {
+            size_ = 0;
+            return false;
+        }
+        data_ = static_cast<const uint8_t*>(mapping);
+
+        header_ = reinterpret_cast<const TensorDumpFileHeader*>(data_);
+        if (std::memcmp(header_->magic, TensorDumpFileHeader::kMagic, sizeof(header_->magic)) != 0 ||
+            header_->version != TensorDumpFileHeader::kVersion ||
+            header_->record_header_bytes != sizeof(TensorRecordHeader)) {
+            close();
+            return false;
+        }
+
+        size_t offset = sizeof(TensorDumpFileHeader);
+        while (size_ - offset >= sizeof(TensorRecordHeader)) {
+            const auto* record = reinterpret_cast<const TensorRecordHeader*>(data_ + offset);
+            const size_t padded = padded_payload(record->payload_bytes);
+            if (size_ - offset - sizeof(TensorRecordHeader) < padded || !consistent(*record)) break;
+            records_.push_back(Record{record, data_ + offset + sizeof(TensorRecordHeader)});
+            offset += sizeof(TensorRecordHeader) + padded;
+        }
+        return true;
+    }
+
+    const TensorDumpFileHeader& file_header() const { return *header_; }
+    const std::vector<Record>& records() const { return records_; }
+
+    void close() {
+        if (data_) munmap(const_cast<uint8_t*>(data_), size_);
+        data_ = nullptr;
+        header_ = nullptr;
+        size_ = 0;
+        records_.clear();
+    }
+
+private:
+    // Payload size matches the shape (guards against a torn or foreign record)
+    static bool consistent(const TensorRecordHeader& header) {
+        if (header.kind != static_cast<uint32_t>(TensorKind::Detection) &&
+            header.kind != static_cast<uint32_t>(TensorKind::OCR)) {
+            return false;
+        }
+        if (header.dtype > static_cast<uint32_t>(TensorDType::UInt16) || header.height <= 0 || header.width <= 0 ||
+            header.count == 0) {
+            return false;
+        }
+        const uint64_t bytes = static_cast<uint64_t>(header.height) * header.width * header.count *
+                               dtype_size(static_cast<TensorDType>(header.dtype));
+        return bytes == header.payload_bytes;
+    }
+
+    const uint8_t* data_ = nullptr;
+    size_t size_ = 0;
+    const TensorDumpFileHeader* header_ = nullptr;
+    std::vector<Record> records_;
+};
+
+}  // namespace anpr
@@ -0,0 +1,223 @@
+/**
+ * Crop dedup tests
+ *
+ * Checks track association across frames, OCR skipping/re-verification for
+ * stable reads and the TrackRegistry read bookkeeping. No Hailo device
+ * required.
+ */
+
+#include "crop_dedup.hpp"
+#include "track_registry.hpp"
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+static int failures = 0;
+
+#define CHECK(cond)                                                        \
+    do {                                                                   \
+        if (!(cond)) {                                                     \
+            std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__,    \
+                         __LINE__, #cond);                                 \
+            failures++;                                                    \
+        }                                                                  \
+    } while (0)
+
+static void test_registry_agreement() {
+    anpr::TrackRegistry& registry = anpr::TrackRegistry::instance();
+    const uint64_t id = registry.new_track();
+
+    anpr::TrackRead read;
+    CHECK(!registry.read(id, read));
+
+    registry.report_read(id, "ABC123", 6, 0.9f);
+    registry.report_read(id, "ABC123", 6, 0.95f);
+    CHECK(registry.read(id, read));
+    CHECK(std::strcmp(read.text, "ABC123") == 0);
+    CHECK(read.agreeing_reads == 2);
+    CHECK(read.total_reads == 2);
+    CHECK(read.confidence == 0.95f);
+
+    // A different text restarts agreement
+    registry.report_read(id, "ABC128", 6, 0.7f);
+    CHECK(registry.read(id, read));
+    CHECK(std::strcmp(read.text, "ABC128") == 0);
+    CHECK(read.agreeing_reads == 1);
+    CHECK(read.confidence == 0.7f);
+
+    registry.forget(id);
+    CHECK(!registry.read(id, read));
+
+    // Unknown and untagged tracks are ignored
+    registry.report_read(0, "XYZ", 3, 0.9f);
+    CHECK(!registry.read(0, read));
+}
+
+static void test_stable_track_is_subsampled() {
+    anpr::CropDedup dedup;
+    anpr::DedupOptions options;
+    options.reverify_interval = 5;
+
+    anpr::DedupBox box{0.4f, 0.5f, 0.1f, 0.04f};
+    anpr::DedupDecision decision;
+
+    dedup.update(&box, 1, options, &decision);
+    CHECK(decision.run_ocr);
+    const uint64_t id = decision.track_id;
+    CHECK(id != 0);
+
+    // Not stable yet: every frame goes to OCR
+    anpr::TrackRegistry::instance().report_read(id, "ABC123", 6, 0.9f);
+    box.x += 0.002f;
+    dedup.update(&box, 1, options, &decision);
+    CHECK(decision.track_id == id);
+    CHECK(decision.run_ocr);
+
+    // Two agreeing confident reads: OCR only every 5th frame
+    anpr::TrackRegistry::instance().report_read(id, "ABC123", 6, 0.92f);
+    int ocr_frames = 0;
+    for (int frame = 0; frame < 20; frame++) {
+        box.x += 0.002f;
+        dedup.update(&box, 1, options, &decision);
+        CHECK(decision.track_id == id);
+        ocr_frames += decision.run_ocr;
+    }
+    CHECK(ocr_frames == 4);
+    CHECK(dedup.crops_skipped() == 16);
+
+    // A disagreeing re-verification makes the track unstable again
+    anpr::TrackRegistry::instance().report_read(id, "ABC128", 6, 0.9f);
+    dedup.update(&box, 1, options, &decision);
+    CHECK(decision.run_ocr);
+}
+
+static void test_low_confidence_is_not_stable() {
+    anpr::CropDedup dedup;
+    anpr::DedupOptions options;
+
+    anpr::DedupBox box{0.1f, 0.1f, 0.1f, 0.04f};
+    anpr::DedupDecision decision;
+    dedup.update(&box, 1, options, &decision);
+    for (int i = 0; i < 3; i++) {
+        anpr::TrackRegistry::instance().report_read(decision.track_id, "ABC123", 6, 0.6f);
+    }
+    for (int frame = 0; frame < 5; frame++) {
+        dedup.update(&box, 1, options, &decision);
+        CHECK(decision.run_ocr);
+    }
+}
+
+static void test_association_and_expiry() {
+    anpr::CropDedup dedup;
+    anpr::DedupOptions options;
+    options.max_missed_frames = 2;
+
+    std::vector<anpr::DedupBox> boxes = {{0.1f, 0.1f, 0.1f, 0.05f}, {0.6f, 0.6f, 0.1f, 0.05f}};
+    std::vector<anpr::DedupDecision> decisions(2);
+    dedup.update(boxes.data(), boxes.size(), options, decisions.data());
+    CHECK(decisions[0].track_id != decisions[1].track_id);
+    const uint64_t first = decisions[0].track_id;
+    const uint64_t second = decisions[1].track_id;
+
+    // Order of detections does not matter
+    std::swap(boxes[0], boxes[1]);
+    dedup.update(boxes.data(), boxes.size(), options, decisions.data());
+    CHECK(decisions[0].track_id == second);
+    CHECK(decisions[1].track_id == first);
+
+    // A track that disappears for too long ends; a box in its place starts a new one
+    anpr::DedupBox only = boxes[0];
+    for (int frame = 0; frame < 3; frame++) {
+        dedup.update(&only, 1, options, decisions.data());
+    }
+    CHECK(dedup.num_tracks() == 1);
+
+    anpr::DedupBox back = boxes[1];
+    dedup.update(&back, 1, options, decisions.data());
+    CHECK(decisions[0].track_id != first);
+}
+
+static void test_full_table() {
+    anpr::CropDedup dedup;
+    anpr::DedupOptions options;
+
+    // More simultaneous plates than table slots: the overflow is still OCR'd, untracked
+    std::vector<anpr::DedupBox> boxes;
+    for (int i = 0; i < anpr::CropDedup::kMaxTracks + 4; i++) {
+        boxes.push_back(anpr::DedupBox{(i % 10) * 0.1f, (i / 10) * 0.1f, 0.05f, 0.02f});
+    }
+    std::vector<anpr::DedupDecision> decisions(boxes.size());
+    dedup.update(boxes.data(), boxes.size(), options, decisions.data());
+
+    int untracked = 0;
+    for (const auto& d : decisions) {
+        CHECK(d.run_ocr);
+        untracked += d.track_id == 0;
+    }
+    CHECK(untracked == 4);
+    CHECK(dedup.num_tracks() == anpr::CropDedup::kMaxTracks);
+}
+
+static void test_upstream_track_ids() {
+    anpr::CropDedup dedup;
+    anpr::DedupOptions options;
+    options.reverify_interval = 3;
+    anpr::TrackRegistry& registry = anpr::TrackRegistry::instance();
+
+    const uint64_t id = registry.new_track();
+    registry.report_read(id, "LTU777", 6, 0.95f);
+    registry.report_read(id, "LTU777", 6, 0.95f);
+
+    const uint64_t ids[2] = {id, 0};
+    anpr::DedupDecision decisions[2];
+    int ocr_frames = 0;
+    for (int frame = 0; frame < 9; frame++) {
+        dedup.update_tracked(ids, 2, options, decisions);
+        CHECK(decisions[0].track_id == id);
+        CHECK(decisions[1].run_ocr);  // Untracked detections are always read
+        ocr_frames += decisions[0].run_ocr;
+    }
+    CHECK(ocr_frames == 3);
+
+    // Upstream ids are not released by the dedup
+    for (int frame = 0; frame < 20; frame++) dedup.update_tracked(nullptr, 0, options, decisions);
+    CHECK(dedup.num_tracks() == 0);
+    anpr::TrackRead read;
+    CHECK(registry.read(id, read));
+}
+
+static void test_decided_track_skips_ocr() {
+    anpr::CropDedup dedup;
+    anpr::DedupOptions options;
+    options.reverify_interval = 3;
+    anpr::TrackRegistry& registry = anpr::TrackRegistry::instance();
+
+    const uint64_t id = registry.new_track();
+    registry.report_read(id, "KLM456", 6, 0.7f);
+    registry.mark_decided(id);
+
+    // Not stable by agreement, but the plate is out: never re-verified
+    anpr::DedupDecision decision;
+    for (int frame = 0; frame < 9; frame++) {
+        dedup.update_tracked(&id, 1, options, &decision);
+        CHECK(!decision.run_ocr);
+    }
+    registry.forget(id);
+}
+
+int main() {
+    test_registry_agreement();
+    test_stable_track_is_subsampled();
+    test_low_confidence_is_not_stable();
+    test_association_and_expiry();
+    test_full_table();
+    test_upstream_track_ids();
+    test_decided_track_skips_ocr();
+
+    if (failures) {
+        std::fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    std::printf("All crop dedup tests passed\n");
+    return 0;
+}
@@ -0,0 +1,87 @@
+/**
+ * Crop buffer pool tests
+ *
+ * Checks slot recycling, bounded waits when the pool is exhausted, occupancy
+ * stats and registry lifetime of anpr::CropBufferPool. No Hailo device
+ * required.
+ */
+
+#include "crop_pool.hpp"
+#include <chrono>
+#include <cstdio>
+#include <thread>
+
+static int failures = 0;
+
+#define CHECK(cond)                                                        \
+    do {                                                                   \
+        if (!(cond)) {                                                     \
+            std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__,    \
+                         __LINE__, #cond);                                 \
+            failures++;                                                    \
+        }                                                                  \
+    } while (0)
+
+using std::chrono::milliseconds;
+
+static void test_exhaustion_and_recycling() {
+    auto pool = anpr::CropBufferPool::create("test", 2, 64);
+
+    auto a = pool->acquire(milliseconds(1));
+    auto b = pool->acquire(milliseconds(1));
+    CHECK(a && b && a.get() != b.get());
+
+    // Exhausted: times out instead of allocating
+    CHECK(!pool->acquire(milliseconds(5)));
+
+    // Released slot wakes a waiting acquire
+    std::thread releaser([&a] {
+        std::this_thread::sleep_for(milliseconds(10));
+        a.reset();
+    });
+    auto c = pool->acquire(milliseconds(1000));
+    releaser.join();
+    CHECK(c != nullptr);
+
+    const anpr::CropPoolStats stats = pool->stats();
+    CHECK(stats.slots == 2);
+    CHECK(stats.in_use == 2);
+    CHECK(stats.peak_in_use == 2);
+    CHECK(stats.slot_bytes == 64);
+    CHECK(stats.acquired == 3);
+    CHECK(stats.waited == 2);
+    CHECK(stats.dropped == 1);
+
+    b.reset();
+    c.reset();
+    CHECK(pool->stats().in_use == 0);
+}
+
+static void test_registry_lifetime() {
+    CHECK(anpr::CropBufferPool::all_stats().empty());
+
+    auto pool = anpr::CropBufferPool::create("cam1_det:src", 4, 16);
+    auto buffer = pool->acquire(milliseconds(1));
+
+    auto stats = anpr::CropBufferPool::all_stats();
+    CHECK(stats.size() == 1);
+    CHECK(std::string(stats[0].name) == "cam1_det:src");
+
+    // Outstanding buffers keep the pool alive after its owner is gone
+    pool.reset();
+    CHECK(anpr::CropBufferPool::all_stats().size() == 1);
+    buffer.reset();
+    CHECK(anpr::CropBufferPool::all_stats().empty());
+}
+
+int main() {
+    test_exhaustion_and_recycling();
+    test_registry_lifetime();
+
+    if (failures) {
+        std::fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    std::printf("All crop pool tests passed\n");
+    return 0;
+}
@@ -0,0 +1,199 @@
+/**
+ * CTC beam search and plate grammar tests
+ *
+ * Runs the prefix beam search on synthetic probability matrices. No Hailo
+ * device required.
+ */
+
+#include "ctc_beam.hpp"
+#include "plate_grammar.hpp"
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+static int failures = 0;
+
+#define CHECK(cond)                                                        \
+    do {                                                                   \
+        if (!(cond)) {                                                     \
+            std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__,    \
+                         __LINE__, #cond);                                 \
+            failures++;                                                    \
+        }                                                                  \
+    } while (0)
+
+static const char* CHARSET = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+static const int NUM_CLASSES = 37;
+static const int BLANK = 36;
+
+static int symbol(char c) {
+    return static_cast<int>(std::strchr(CHARSET, c) - CHARSET);
+}
+
+/**
+ * Builds a [timesteps, NUM_CLASSES] probability matrix. Each timestep
+ * spreads its remaining mass evenly over the other classes.
+ */
+struct Scores {
+    std::vector<float> data;
+    int timesteps = 0;
+
+    void add(std::vector<std::pair<int, float>> peaks) {
+        float used = 0.0f;
+        for (auto& p : peaks) used += p.second;
+        const float rest = (1.0f - used) / (NUM_CLASSES - peaks.size());
+
+        std::vector<float> row(NUM_CLASSES, rest);
+        for (auto& p : peaks) row[p.first] = p.second;
+        data.insert(data.end(), row.begin(), row.end());
+        timesteps++;
+    }
+
+    void blank() { add({{BLANK, 0.9995f}}); }
+    void chr(char c, float p = 0.95f) { add({{symbol(c), p}}); }
+};
+
+static std::string decode(const Scores& scores, const anpr::PlateGrammar* grammar = nullptr,
+                          bool* found = nullptr) {
+    static anpr::CtcBeamSearch decoder;
+    anpr::BeamSearchOptions options;
+    options.grammar = grammar;
+
+    anpr::BeamSearchResult result;
+    decoder.decode(scores.data.data(), scores.timesteps, NUM_CLASSES, BLANK, anpr::QuantInfo{},
+                   options, result);
+
+    if (found) *found = result.found;
+    std::string text;
+    for (int i = 0; i < result.length; i++) text += CHARSET[result.symbols[i]];
+    return text;
+}
+
+static void test_clean_sequence() {
+    Scores s;
+    for (char c : std::string("ABC123")) {
+        s.blank();
+        s.chr(c);
+        s.chr(c);  // repeats collapse
+    }
+    s.blank();
+
+    CHECK(decode(s) == "ABC123");
+}
+
+static void test_double_letter_needs_blank() {
+    Scores s;
+    s.chr('A');
+    s.blank();
+    s.chr('A');
+    s.chr('B');
+
+    CHECK(decode(s) == "AAB");
+}
+
+static void test_beats_greedy_path() {
+    // Greedy picks blank at every step (0.4 > 0.3 + 0.3 split), but the
+    // summed probability of all paths collapsing to "A" is higher.
+    Scores s;
+    s.add({{BLANK, 0.4f}, {symbol('A'), 0.35f}, {symbol('B'), 0.25f}});
+    s.add({{BLANK, 0.4f}, {symbol('A'), 0.35f}, {symbol('B'), 0.25f}});
+
+    CHECK(decode(s) == "A");
+}
+
+static void test_grammar_rejects_invalid_prefixes() {
+    anpr::PlateGrammar grammar;
+    CHECK(grammar.compile("^[A-Z]{3}[0-9]{3}$", CHARSET));
+
+    CHECK(grammar.matches("ABC123", 6));
+    CHECK(!grammar.matches("AB1234", 6));
+    CHECK(!grammar.matches("ABC12", 5));
+
+    // The model slightly prefers '8' for the third character, but a digit
+    // there cannot form a valid plate; the grammar forces the letter 'B'.
+    Scores s;
+    s.chr('A');
+    s.blank();
+    s.chr('B');
+    s.blank();
+    s.add({{symbol('8'), 0.5f}, {symbol('B'), 0.45f}});
+    s.blank();
+    for (char c : std::string("123")) {
+        s.chr(c);
+        s.blank();
+    }
+
+    CHECK(decode(s) == "AB8123");
+    bool found = false;
+    CHECK(decode(s, &grammar, &found) == "ABB123");
+    CHECK(found);
+}
+
+static void test_grammar_alternatives_and_ranges() {
+    anpr::PlateGrammar grammar;
+    CHECK(grammar.compile("[A-Z]{2,3}\\d{3}|\\d{2}[A-HJ-NP-Z]{2}", CHARSET));
+
+    CHECK(grammar.matches("AB123", 5));
+    CHECK(grammar.matches("ABC123", 6));
+    CHECK(grammar.matches("12AB", 4));
+    CHECK(!grammar.matches("12AI", 4));
+    CHECK(!grammar.matches("ABCD123", 7));
+
+    CHECK(!grammar.compile("(AB)+", CHARSET));
+    CHECK(!grammar.enabled());
+}
+
+static void test_no_valid_plate() {
+    anpr::PlateGrammar grammar;
+    CHECK(grammar.compile("[0-9]{4}", CHARSET));
+
+    Scores s;
+    for (char c : std::string("ABCD")) {
+        s.chr(c, 0.999f);
+        s.blank();
+    }
+
+    bool found = true;
+    decode(s, &grammar, &found);
+    CHECK(!found);
+}
+
+static void test_quantized_input() {
+    Scores s;
+    for (char c : std::string("LT42")) {
+        s.chr(c);
+        s.blank();
+    }
+
+    // real = q / 255
+    anpr::QuantInfo quant{1.0f / 255.0f, 0.0f};
+    std::vector<uint8_t> q(s.data.size());
+    for (size_t i = 0; i < q.size(); i++) q[i] = static_cast<uint8_t>(s.data[i] * 255.0f + 0.5f);
+
+    anpr::CtcBeamSearch decoder;
+    anpr::BeamSearchResult result;
+    decoder.decode(q.data(), s.timesteps, NUM_CLASSES, BLANK, quant, anpr::BeamSearchOptions{}, result);
+
+    std::string text;
+    for (int i = 0; i < result.length; i++) text += CHARSET[result.symbols[i]];
+    CHECK(text == "LT42");
+    CHECK(result.confidence > 0.9f);
+}
+
+int main() {
+    test_clean_sequence();
+    test_double_letter_needs_blank();
+    test_beats_greedy_path();
+    test_grammar_rejects_invalid_prefixes();
+    test_grammar_alternatives_and_ranges();
+    test_no_valid_plate();
+    test_quantized_input();
+
+    if (failures) {
+        std::fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    std::printf("All CTC beam search tests passed\n");
+    return 0;
+}
@@ -0,0 +1,176 @@
+/**
+ * Detection decoding tests
+ *
+ * Checks the detection fast mode of anpr::decode_detections(): the top-K
+ * heap keeps the strongest candidates (ties to the earlier anchor, as NMS),
+ * the geometry prefilter drops implausible boxes, max_plates caps the
+ * output, and with nothing pruned fast mode returns exactly the boxes of
+ * full mode. Also checks that thresholds out of a tensor's quantized range
+ * are rejected. No Hailo device required.
+ */
+
+#include "detection_decode.hpp"
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+static int failures = 0;
+
+#define CHECK(cond)                                                        \
+    do {                                                                   \
+        if (!(cond)) {                                                     \
+            std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__,    \
+                         __LINE__, #cond);                                 \
+            failures++;                                                    \
+        }                                                                  \
+    } while (0)
+
+static const int kAnchors = 400;
+static const anpr::QuantInfo kQuant{1.0f / 255.0f, 0.0f};
+
+// Dequantized confidence of a raw value
+static float conf(int raw) {
+    return anpr::dequantize(static_cast<uint8_t>(raw), kQuant);
+}
+
+/**
+ * Channel-major uint8 output [5, kAnchors] (scale 1/255), background under
+ * the 0.5 threshold.
+ */
+struct Tensor {
+    std::vector<uint8_t> data = std::vector<uint8_t>(5 * kAnchors, 0);
+
+    void set(int anchor, int cx, int cy, int w, int h, int conf) {
+        data[0 * kAnchors + anchor] = static_cast<uint8_t>(cx);
+        data[1 * kAnchors + anchor] = static_cast<uint8_t>(cy);
+        data[2 * kAnchors + anchor] = static_cast<uint8_t>(w);
+        data[3 * kAnchors + anchor] = static_cast<uint8_t>(h);
+        data[4 * kAnchors + anchor] = static_cast<uint8_t>(conf);
+    }
+
+    std::vector<Detection> decode(const anpr::DetectionOptions& options) const {
+        std::vector<Detection> raw, out;
+        anpr::decode_detections(data.data(), anpr::TensorDType::UInt8, anpr::anchor_grid(5, kAnchors), kQuant,
+                                nullptr, options, raw, out);
+        return out;
+    }
+};
+
+static bool same_boxes(const std::vector<Detection>& a, const std::vector<Detection>& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); i++) {
+        if (a[i].x != b[i].x || a[i].y != b[i].y || a[i].width != b[i].width ||
+            a[i].height != b[i].height || a[i].confidence != b[i].confidence) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void test_top_k() {
+    Tensor tensor;
+    // Separate plates, confidences 150..240
+    for (int p = 0; p < 10; p++) tensor.set(10 + p * 30, 10 + p * 24, 100, 20, 8, 150 + p * 10);
+
+    anpr::DetectionOptions fast;
+    fast.top_k = 3;
+    const std::vector<Detection> out = tensor.decode(fast);
+    CHECK(out.size() == 3);
+    CHECK(out.size() == 3 && out[0].confidence > out[1].confidence && out[1].confidence > out[2].confidence);
+    CHECK(out.size() == 3 && out[2].confidence == conf(220));
+
+    // Equal confidences: the earlier anchors win, as NMS breaks ties
+    Tensor ties;
+    for (int p = 0; p < 6; p++) ties.set(10 + p * 30, 10 + p * 30, 100, 20, 8, 200);
+    fast.top_k = 2;
+    const std::vector<Detection> tied = ties.decode(fast);
+    CHECK(tied.size() == 2);
+    CHECK(tied.size() == 2 && tied[0].x < tied[1].x && tied[1].x < 50 / 255.0f);
+}
+
+static void test_geometry() {
+    Tensor tensor;
+    tensor.set(5, 50, 50, 20, 8, 200);     // plate
+    tensor.set(50, 120, 50, 1, 1, 240);    // speck, too small
+    tensor.set(90, 180, 50, 8, 40, 230);   // pole, far too tall
+    tensor.set(130, 50, 150, 12, 10, 210); // square motorcycle plate
+
+    anpr::DetectionOptions full;
+    CHECK(tensor.decode(full).size() == 4);
+
+    anpr::DetectionOptions fast;
+    fast.min_width = 0.01f;
+    fast.min_height = 0.005f;
+    fast.min_aspect = 0.5f;
+    fast.max_aspect = 10.0f;
+    const std::vector<Detection> out = tensor.decode(fast);
+    CHECK(out.size() == 2);
+    CHECK(out.size() == 2 && out[0].confidence == conf(210) && out[1].confidence == conf(200));
+    CHECK(fast.plausible(0.05f, 0.02f) && !fast.plausible(0.5f, 0.02f));
+
+    // A pruned candidate does not take a top-K place from a plausible one
+    fast.top_k = 1;
+    const std::vector<Detection> top = tensor.decode(fast);
+    CHECK(top.size() == 1 && top[0].confidence == conf(210));
+}
+
+static void test_max_plates() {
+    Tensor tensor;
+    for (int p = 0; p < 5; p++) tensor.set(10 + p * 30, 10 + p * 40, 100, 20, 8, 160 + p * 20);
+
+    anpr::DetectionOptions options;
+    options.max_plates = 2;
+    const std::vector<Detection> out = tensor.decode(options);
+    CHECK(out.size() == 2 && out[0].confidence == conf(240) && out[1].confidence == conf(220));
+}
+
+static void test_matches_full_mode() {
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<int> pos(20, 235), score(128, 135), size(16, 22);
+    for (int frame = 0; frame < 20; frame++) {
+        Tensor tensor;
+        // Overlapping anchors with coarse confidences, so NMS suppresses and ties occur
+        for (int p = 0; p < 12; p++) {
+            const int cx = pos(rng), cy = pos(rng);
+            for (int k = 0; k < 3; k++) tensor.set(p * 30 + k, cx + k, cy, size(rng), 7, score(rng));
+        }
+
+        anpr::DetectionOptions full;
+        anpr::DetectionOptions fast;
+        fast.top_k = 64;  // more than the candidates
+        fast.min_width = 0.01f;
+        fast.max_aspect = 10.0f;
+        CHECK(same_boxes(tensor.decode(full), tensor.decode(fast)));
+
+        // Pruned, the strongest box survives and no more than top_k reach NMS
+        fast.top_k = 12;
+        const std::vector<Detection> pruned = tensor.decode(fast);
+        const std::vector<Detection> reference = tensor.decode(full);
+        CHECK(!pruned.empty() && pruned.size() <= 12 && pruned[0].confidence == reference[0].confidence);
+    }
+}
+
+static void test_threshold_out_of_range() {
+    uint8_t q = 0;
+    CHECK(!anpr::quantize_threshold<uint8_t>(0.5f, anpr::QuantInfo{1e-30f, 0.0f}, q));
+    CHECK(!anpr::quantize_threshold<uint8_t>(std::nanf(""), kQuant, q));
+    CHECK(anpr::quantize_threshold<uint8_t>(-1e30f, anpr::QuantInfo{1e-30f, 0.0f}, q) && q == 0);
+    uint16_t q16 = 0;
+    CHECK(anpr::quantize_threshold<uint16_t>(0.5f, kQuant, q16) && q16 == 128);
+}
+
+int main() {
+    test_threshold_out_of_range();
+    test_top_k();
+    test_geometry();
+    test_max_plates();
+    test_matches_full_mode();
+
+    if (failures) {
+        std::fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    std::printf("All detection decode tests passed\n");
+    return 0;
+}
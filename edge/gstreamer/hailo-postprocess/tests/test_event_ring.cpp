@@ -0,0 +1,144 @@
+/**
+ * Plate event ring tests
+ *
+ * Checks the SPSC ring (ordering, overflow counting, a producer and a
+ * consumer thread), the named rings of anpr::EventRings and the rebinding
+ * of a streaming thread's ring when the thread is renamed.
+ * No Hailo device required.
+ */
+
+#include "event_ring.hpp"
+#include <pthread.h>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+static int failures = 0;
+
+#define CHECK(cond)                                                        \
+    do {                                                                   \
+        if (!(cond)) {                                                     \
+            std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__,    \
+                         __LINE__, #cond);                                 \
+            failures++;                                                    \
+        }                                                                  \
+    } while (0)
+
+static void test_order_and_overflow() {
+    anpr::SpscRing<uint64_t> ring(6);
+    CHECK(ring.capacity() == 8);
+
+    for (uint64_t i = 0; i < 10; i++) ring.push(i);
+    CHECK(ring.size() == 8);
+    CHECK(ring.published() == 8);
+    CHECK(ring.dropped() == 2);  // newest records are the ones dropped
+
+    uint64_t out[16];
+    CHECK(ring.pop(out, 3) == 3);
+    CHECK(out[0] == 0 && out[1] == 1 && out[2] == 2);
+    CHECK(ring.push(100));
+    CHECK(ring.pop(out, 16) == 6);
+    CHECK(out[0] == 3 && out[4] == 7 && out[5] == 100);
+    CHECK(ring.pop(out, 16) == 0);
+    CHECK(ring.drained() == 9);
+}
+
+static void test_threads() {
+    const uint64_t count = 200000;
+    anpr::SpscRing<uint64_t> ring(64);
+    std::thread producer([&] {
+        for (uint64_t i = 1; i <= count; i++) {
+            while (!ring.push(i)) std::this_thread::yield();
+        }
+    });
+
+    // Every value arrives once, in order
+    uint64_t expected = 1;
+    bool ordered = true;
+    uint64_t batch[16];
+    while (expected <= count) {
+        const size_t n = ring.pop(batch, 16);
+        for (size_t i = 0; i < n; i++) ordered = ordered && batch[i] == expected++;
+        if (n == 0) std::this_thread::yield();
+    }
+    producer.join();
+
+    CHECK(ordered);
+    CHECK(ring.published() == count);
+    CHECK(ring.drained() == count);
+}
+
+static void test_named_rings() {
+    anpr::EventRings& rings = anpr::EventRings::instance();
+    anpr::PlateEventRing* ocr = rings.ring("cam3_ocr:src");
+    anpr::PlateEventRing* tracker = rings.ring("cam3_det:src");
+    anpr::PlateEventRing* other = rings.ring("cam31_ocr:src");
+    CHECK(ocr && tracker && other && ocr != tracker);
+    CHECK(rings.ring("cam3_ocr:src") == ocr);
+
+    const char text[] = "ABC123";
+    ocr->push(anpr::make_event_record(anpr::PlateEventKind::Read, "", 7, text, sizeof(text) - 1));
+    tracker->push(anpr::make_event_record(anpr::PlateEventKind::PlateDecided, "sink_2", 7, text, sizeof(text) - 1));
+    other->push(anpr::make_event_record(anpr::PlateEventKind::Read, "", 1, "X", 1));
+
+    // "cam3_" does not take cam31's record
+    anpr::PlateEventRecord out[8];
+    CHECK(rings.drain("cam3_", out, 8) == 2);
+    CHECK(out[0].kind == static_cast<uint32_t>(anpr::PlateEventKind::Read));
+    CHECK(out[0].stream_index == -1 && out[0].track_id == 7 && out[0].timestamp_ns > 0);
+    CHECK(std::string(out[0].text) == "ABC123");
+    CHECK(out[1].kind == static_cast<uint32_t>(anpr::PlateEventKind::PlateDecided));
+    CHECK(out[1].stream_index == 2);
+    CHECK(rings.drain("cam3_", out, 8) == 0);
+    CHECK(rings.drain("cam31_", out, 8) == 1);
+
+    // Over-long text is truncated and stays terminated
+    const std::string long_text(40, 'Z');
+    const anpr::PlateEventRecord record =
+        anpr::make_event_record(anpr::PlateEventKind::Read, "", 0, long_text.data(), long_text.size());
+    CHECK(std::string(record.text) == std::string(anpr::kMaxPlateChars, 'Z'));
+
+    CHECK(anpr::stream_index("sink_0") == 0);
+    CHECK(anpr::stream_index("sink_12") == 12);
+    CHECK(anpr::stream_index("") == -1);
+    CHECK(anpr::stream_index("sink_") == -1);
+    CHECK(anpr::stream_index("sink_x") == -1);
+
+    const std::vector<anpr::EventRingStats> stats = rings.stats();
+    CHECK(stats.size() == 3);
+    CHECK(std::string(stats[0].name) == "cam3_ocr:src");
+    CHECK(stats[0].capacity == anpr::EventRings::kCapacity);
+    CHECK(stats[0].published == 1 && stats[0].drained == 1 && stats[0].dropped == 0);
+}
+
+// A pooled streaming thread reused by another camera's pipeline
+static void test_reused_thread() {
+    anpr::EventRings& rings = anpr::EventRings::instance();
+    std::thread worker([] {
+        pthread_setname_np(pthread_self(), "camA_ocr:src");
+        anpr::thread_event_ring()->push(anpr::make_event_record(anpr::PlateEventKind::Read, "", 1, "AAA", 3));
+        pthread_setname_np(pthread_self(), "camB_ocr:src");
+        anpr::thread_event_ring()->push(anpr::make_event_record(anpr::PlateEventKind::Read, "", 2, "BBB", 3));
+    });
+    worker.join();
+
+    anpr::PlateEventRecord out[4];
+    CHECK(rings.drain("camA_", out, 4) == 1);
+    CHECK(out[0].track_id == 1);
+    CHECK(rings.drain("camB_", out, 4) == 1);
+    CHECK(out[0].track_id == 2);
+}
+
+int main() {
+    test_order_and_overflow();
+    test_threads();
+    test_named_rings();
+    test_reused_thread();
+
+    if (failures) {
+        std::fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    std::printf("All event ring tests passed\n");
+    return 0;
+}
@@ -0,0 +1,183 @@
+/**
+ * Evidence encoder tests
+ *
+ * Checks that anpr::EvidenceEncoder never hands out more than its job pool
+ * (counting the snapshots it has to drop), that submitted jobs come back as
+ * JPEGs under their source prefix only, that a short buffer leaves the
+ * evidence queued, and that a decided track's evidence is claimed once.
+ * Encoding checks are skipped when built without a JPEG encoder.
+ * No Hailo device required.
+ */
+
+#include "evidence.hpp"
+#include "track_registry.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+static int failures = 0;
+
+#define CHECK(cond)                                                        \
+    do {                                                                   \
+        if (!(cond)) {                                                     \
+            std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__,    \
+                         __LINE__, #cond);                                 \
+            failures++;                                                    \
+        }                                                                  \
+    } while (0)
+
+static void fill_job(anpr::EvidenceEncoder::Job* job, const char* source, uint64_t track_id) {
+    std::memset(&job->info, 0, sizeof(job->info));
+    std::strncpy(job->info.source, source, sizeof(job->info.source) - 1);
+    job->info.track_id = track_id;
+    job->info.stream_index = -1;
+    job->info.plate_width = 48;
+    job->info.plate_height = 16;
+    job->info.frame_width = 64;
+    job->info.frame_height = 48;
+
+    // Gradients: cheap to encode, easy to tell from garbage
+    job->plate_rgb.resize(48 * 16 * 3);
+    for (size_t i = 0; i < job->plate_rgb.size(); i++) job->plate_rgb[i] = static_cast<uint8_t>(i * 7);
+    job->frame_rgb.resize(64 * 48 * 3);
+    for (size_t i = 0; i < job->frame_rgb.size(); i++) job->frame_rgb[i] = static_cast<uint8_t>(i / 3);
+}
+
+static bool wait_ready(uint32_t ready) {
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (std::chrono::steady_clock::now() < deadline) {
+        const anpr::EvidenceStats stats = anpr::EvidenceEncoder::instance().stats();
+        if (stats.ready >= ready && stats.queued == 0) return true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return false;
+}
+
+static bool is_jpeg(const uint8_t* data, size_t size) {
+    return size > 4 && data[0] == 0xFF && data[1] == 0xD8 && data[size - 2] == 0xFF && data[size - 1] == 0xD9;
+}
+
+static void test_bounded_pool() {
+    anpr::EvidenceEncoder& encoder = anpr::EvidenceEncoder::instance();
+    const uint64_t dropped = encoder.stats().dropped;
+
+    std::vector<anpr::EvidenceEncoder::Job*> jobs;
+    for (int i = 0; i < anpr::EvidenceEncoder::kJobs; i++) {
+        jobs.push_back(encoder.acquire());
+        CHECK(jobs.back() != nullptr);
+    }
+
+    // Pool exhausted: refused without blocking, counted
+    CHECK(encoder.acquire() == nullptr);
+    CHECK(encoder.stats().dropped == dropped + 1);
+
+    for (auto* job : jobs) encoder.release(job);
+    anpr::EvidenceEncoder::Job* job = encoder.acquire();
+    CHECK(job != nullptr);
+    encoder.release(job);
+    CHECK(encoder.stats().jobs == anpr::EvidenceEncoder::kJobs);
+}
+
+static void test_encode_and_pop() {
+    anpr::EvidenceEncoder& encoder = anpr::EvidenceEncoder::instance();
+    const anpr::EvidenceStats before = encoder.stats();
+
+    anpr::EvidenceEncoder::Job* job = encoder.acquire();
+    CHECK(job != nullptr);
+    if (!job) return;
+    fill_job(job, "cam2_crop:src", 42);
+    encoder.submit(job);
+
+    if (!anpr::EvidenceEncoder::available()) {
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (encoder.stats().failed == before.failed && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        CHECK(encoder.stats().failed == before.failed + 1);
+        std::printf("Built without a JPEG encoder, encoding checks skipped\n");
+        return;
+    }
+
+    CHECK(wait_ready(before.ready + 1));
+    anpr::EvidenceInfo info;
+    std::vector<uint8_t> buffer(1 << 20);
+
+    // Other pipelines do not see it
+    CHECK(encoder.pop("cam1_", info, buffer.data(), buffer.size()) == 0);
+
+    // Too small: sizes reported, evidence stays queued
+    CHECK(encoder.pop("cam2_", info, buffer.data(), 16) == -1);
+    CHECK(info.track_id == 42);
+    CHECK(info.plate_bytes > 0 && info.frame_bytes > 0);
+    CHECK(encoder.stats().ready == before.ready + 1);
+
+    CHECK(encoder.pop("cam2_", info, buffer.data(), buffer.size()) == 1);
+    CHECK(info.track_id == 42 && info.stream_index == -1);
+    CHECK(info.plate_width == 48 && info.frame_height == 48);
+    CHECK(std::strcmp(info.source, "cam2_crop:src") == 0);
+    CHECK(is_jpeg(buffer.data(), info.plate_bytes));
+    CHECK(is_jpeg(buffer.data() + info.plate_bytes, info.frame_bytes));
+    CHECK(encoder.pop("cam2_", info, buffer.data(), buffer.size()) == 0);
+
+    const anpr::EvidenceStats after = encoder.stats();
+    CHECK(after.encoded == before.encoded + 1);
+    CHECK(after.popped == before.popped + 1);
+    CHECK(after.encode_ns > before.encode_ns);
+}
+
+static void test_unread_evidence_holds_jobs() {
+    anpr::EvidenceEncoder& encoder = anpr::EvidenceEncoder::instance();
+    if (!anpr::EvidenceEncoder::available()) return;
+
+    // Evidence nobody pops keeps its job: the pool bounds unread evidence too
+    int submitted = 0;
+    while (anpr::EvidenceEncoder::Job* job = encoder.acquire()) {
+        fill_job(job, "cam9_crop:src", static_cast<uint64_t>(100 + submitted));
+        encoder.submit(job);
+        submitted++;
+    }
+    CHECK(submitted == anpr::EvidenceEncoder::kJobs);
+    CHECK(wait_ready(static_cast<uint32_t>(submitted)));
+
+    anpr::EvidenceInfo info;
+    std::vector<uint8_t> buffer(1 << 20);
+    for (int i = 0; i < submitted; i++) {
+        CHECK(encoder.pop("cam9_", info, buffer.data(), buffer.size()) == 1);
+        CHECK(info.track_id == static_cast<uint64_t>(100 + i));  // oldest first
+    }
+    CHECK(encoder.stats().ready == 0);
+}
+
+static void test_claim_once() {
+    anpr::TrackRegistry& registry = anpr::TrackRegistry::instance();
+    const uint64_t track = registry.new_track();
+    registry.report_read(track, "AB123CD", 7, 0.9f);
+
+    // Not decided yet
+    CHECK(!registry.claim_evidence(track));
+    registry.mark_decided(track);
+    CHECK(registry.claim_evidence(track));
+    CHECK(!registry.claim_evidence(track));
+    CHECK(!registry.claim_evidence(0));
+
+    anpr::TrackRead read;
+    CHECK(registry.read(track, read) && read.evidence_taken);
+    registry.forget(track);
+    CHECK(!registry.claim_evidence(track));
+}
+
+int main() {
+    test_bounded_pool();
+    test_encode_and_pop();
+    test_unread_evidence_holds_jobs();
+    test_claim_once();
+
+    if (failures) {
+        std::fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    std::printf("All evidence tests passed\n");
+    return 0;
+}
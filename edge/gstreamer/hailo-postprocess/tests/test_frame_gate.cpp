@@ -0,0 +1,131 @@
+/**
+ * Frame gate tests
+ *
+ * Checks the luma frame difference, the idle/active inference rate of
+ * anpr::FrameGate and the per-stream counters of anpr::SceneActivity.
+ * No Hailo device required.
+ */
+
+#include "frame_gate.hpp"
+#include "scene_activity.hpp"
+#include <cstdio>
+#include <vector>
+
+static int failures = 0;
+
+#define CHECK(cond)                                                        \
+    do {                                                                   \
+        if (!(cond)) {                                                     \
+            std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__,    \
+                         __LINE__, #cond);                                 \
+            failures++;                                                    \
+        }                                                                  \
+    } while (0)
+
+static const uint64_t kFrameNs = 1000000000ull / 30;  // 30 fps camera
+
+static void test_luma_motion() {
+    const int width = 640, height = 480;
+    std::vector<uint8_t> frame(static_cast<size_t>(width) * height * 3, 90);
+    anpr::FrameGateOptions options;
+    anpr::LumaMotion motion;
+
+    CHECK(motion.update(frame.data(), width, height, width * 3, 3, options) == 0.0f);  // first frame
+    CHECK(motion.update(frame.data(), width, height, width * 3, 3, options) == 0.0f);  // static scene
+
+    // A bright 160x120 block (a vehicle) covers 1/16 of the frame
+    for (int y = 200; y < 320; y++) {
+        for (int x = 240; x < 400; x++) {
+            for (int c = 0; c < 3; c++) frame[(static_cast<size_t>(y) * width + x) * 3 + c] = 220;
+        }
+    }
+    const float changed = motion.update(frame.data(), width, height, width * 3, 3, options);
+    CHECK(changed > 0.05f && changed < 0.08f);
+
+    // Sensor noise below the threshold is not motion
+    for (size_t i = 0; i < frame.size(); i += 7) frame[i] += 3;
+    CHECK(motion.update(frame.data(), width, height, width * 3, 3, options) == 0.0f);
+
+    // Luma plane input, size change resets the reference
+    std::vector<uint8_t> luma(320 * 240, 10);
+    CHECK(motion.update(luma.data(), 320, 240, 320, 1, options) == 0.0f);
+    luma.assign(luma.size(), 200);
+    CHECK(motion.update(luma.data(), 320, 240, 320, 1, options) == 1.0f);
+}
+
+static void test_idle_rate() {
+    anpr::FrameGateOptions options;
+    options.idle_fps = 2.0f;
+    options.idle_after_frames = 30;
+    anpr::FrameGate gate;
+
+    // Recent detections: full rate
+    uint64_t now = 0;
+    int passed = 0;
+    for (int i = 0; i < 30; i++, now += kFrameNs) passed += gate.admit(now, 0.0f, 5, options);
+    CHECK(passed == 30);
+    CHECK(gate.active());
+
+    // No detections, no motion: about idle_fps
+    passed = 0;
+    for (int i = 0; i < 300; i++, now += kFrameNs) passed += gate.admit(now, 0.0f, 100, options);
+    CHECK(!gate.active());
+    CHECK(passed >= 18 && passed <= 21);  // 10 s at 2 fps
+    CHECK(gate.inference_fps() > 1.5f && gate.inference_fps() < 2.5f);
+    CHECK(gate.input_fps() > 29.0f && gate.input_fps() < 31.0f);
+    CHECK(gate.frames_in() == 330);
+}
+
+static void test_motion_wakes_gate() {
+    anpr::FrameGateOptions options;
+    options.motion_hold_ns = 500000000ull;
+    anpr::FrameGate gate;
+
+    uint64_t now = 0;
+    for (int i = 0; i < 60; i++, now += kFrameNs) gate.admit(now, 0.0f, 100, options);
+    CHECK(!gate.active());
+
+    // Motion: every frame passes, and for motion_hold after it
+    CHECK(gate.admit(now, 0.2f, 100, options));
+    int passed = 0;
+    for (int i = 0; i < 14; i++) {
+        now += kFrameNs;
+        passed += gate.admit(now, 0.0f, 100, options);
+    }
+    CHECK(passed == 14);
+
+    now += 200000000ull;
+    gate.admit(now, 0.0f, 100, options);
+    CHECK(!gate.active());
+}
+
+static void test_scene_activity() {
+    anpr::SceneActivity& activity = anpr::SceneActivity::instance();
+    CHECK(activity.frames_without_detections("cam1") == 0);  // unknown streams count as active
+
+    activity.report_frame("cam1", 2);
+    activity.report_frame("cam1", 0);
+    activity.report_frame("cam1", 0);
+    activity.report_frame("sink_3", 0);
+    CHECK(activity.frames_without_detections("cam1") == 2);
+    CHECK(activity.frames_without_detections("sink_3") == 1);
+
+    activity.report_frame("cam1", 1);
+    CHECK(activity.frames_without_detections("cam1") == 0);
+
+    CHECK(anpr::activity_key("sink_0") == "sink_0");
+}
+
+int main() {
+    test_luma_motion();
+    test_idle_rate();
+    test_motion_wakes_gate();
+    test_scene_activity();
+
+    if (failures) {
+        std::fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    std::printf("All frame gate tests passed\n");
+    return 0;
+}
@@ -0,0 +1,137 @@
+/**
+ * Frame latency tracer tests
+ *
+ * Checks that anpr::FrameTracer finds a frame's trace from the PTS handed to
+ * the streaming thread, keeps cameras with equal PTS apart, keeps the first
+ * stamp of each stage, forgets traces whose slot was reused, and does
+ * nothing while disabled. Times are simulated. No Hailo device required.
+ */
+
+#include "frame_trace.hpp"
+#include <cstdio>
+#include <thread>
+
+static int failures = 0;
+
+#define CHECK(cond)                                                        \
+    do {                                                                   \
+        if (!(cond)) {                                                     \
+            std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__,    \
+                         __LINE__, #cond);                                 \
+            failures++;                                                    \
+        }                                                                  \
+    } while (0)
+
+using anpr::FrameTracer;
+using anpr::TraceStage;
+
+static uint64_t stage(const anpr::FrameTraceRecord& record, TraceStage s) {
+    return record.stage_ns[static_cast<int>(s)];
+}
+
+static void test_disabled() {
+    FrameTracer& tracer = FrameTracer::instance();
+    tracer.set_enabled(false);
+    CHECK(tracer.open("cam1", 1000, 500, 2000) == 0);
+    FrameTracer::enter(1000);
+    CHECK(tracer.begin("cam1", TraceStage::Detection, 3000) == 0);
+    CHECK(FrameTracer::thread_frame() == 0);
+    CHECK(tracer.stats().opened == 0);
+}
+
+static void test_stages() {
+    FrameTracer& tracer = FrameTracer::instance();
+    tracer.set_enabled(true);
+
+    const uint64_t frame = tracer.open("cam1", 40000000, 1000, 1200);
+    CHECK(frame > 0);
+    CHECK(tracer.open("", 40000000, 1000, 1200) == 0);
+    CHECK(tracer.open(std::string(40, 'x'), 40000000, 1000, 1200) == 0);
+
+    // Without enter() the detection thread has no PTS to look up
+    CHECK(tracer.begin("cam1", TraceStage::Detection, 1500) == 0);
+
+    FrameTracer::enter(40000000);
+    CHECK(tracer.begin("cam1", TraceStage::Detection, 1500) == frame);
+    CHECK(FrameTracer::thread_frame() == frame);
+
+    tracer.stamp(frame, TraceStage::Tracker, 1600);
+    tracer.stamp(frame, TraceStage::Crop, 1700);
+    tracer.stamp(frame, TraceStage::OCR, 1900);
+    tracer.stamp(frame, TraceStage::OCR, 2500);  // second crop of the frame
+    tracer.stamp(0, TraceStage::OCR, 2500);
+
+    anpr::FrameTraceRecord record;
+    CHECK(tracer.get(frame, record));
+    CHECK(std::string(record.key) == "cam1" && record.pts_ns == 40000000);
+    CHECK(stage(record, TraceStage::Capture) == 1000);
+    CHECK(stage(record, TraceStage::Source) == 1200);
+    CHECK(stage(record, TraceStage::Detection) == 1500);
+    CHECK(stage(record, TraceStage::Tracker) == 1600);
+    CHECK(stage(record, TraceStage::Crop) == 1700);
+    CHECK(stage(record, TraceStage::OCR) == 1900);
+    CHECK(!tracer.get(0, record));
+
+    // The PTS is taken by begin(): a frame processed without enter() finds nothing
+    CHECK(tracer.begin("cam1", TraceStage::Detection, 1800) == 0);
+    CHECK(FrameTracer::thread_frame() == 0);
+}
+
+static void test_cameras_with_equal_pts() {
+    FrameTracer& tracer = FrameTracer::instance();
+    tracer.set_enabled(true);
+
+    const uint64_t a = tracer.open("sink_0", 66000000, 100, 200);
+    const uint64_t b = tracer.open("sink_1", 66000000, 110, 210);
+    FrameTracer::enter(66000000);
+    CHECK(tracer.begin("sink_0", TraceStage::Detection, 300) == a);
+    FrameTracer::enter(66000000);
+    CHECK(tracer.begin("sink_1", TraceStage::Detection, 310) == b);
+    FrameTracer::enter(66000000);
+    CHECK(tracer.begin("sink_2", TraceStage::Detection, 320) == 0);
+
+    // Thread state is per streaming thread
+    uint64_t other = 1;
+    std::thread thread([&] { other = tracer.begin("sink_0", TraceStage::Detection, 400); });
+    thread.join();
+    CHECK(other == 0);
+}
+
+static void test_reused_slot() {
+    FrameTracer& tracer = FrameTracer::instance();
+    tracer.set_enabled(true);
+
+    const uint64_t old_frame = tracer.open("cam2", 1, 1, 1);
+    for (size_t i = 0; i < FrameTracer::kSlots; i++) tracer.open("cam3", 1000 + i, 1, 1);
+
+    anpr::FrameTraceRecord record;
+    CHECK(!tracer.get(old_frame, record));
+    tracer.stamp(old_frame, TraceStage::Crop, 5);  // ignored, the slot belongs to a newer frame
+    CHECK(tracer.get(old_frame + FrameTracer::kSlots, record));
+    CHECK(stage(record, TraceStage::Crop) == 0);
+
+    // Beyond the lookback a frame is not found any more
+    FrameTracer::enter(1000);
+    CHECK(tracer.begin("cam3", TraceStage::Detection, 10) == 0);
+    FrameTracer::enter(1000 + FrameTracer::kSlots - 1);
+    CHECK(tracer.begin("cam3", TraceStage::Detection, 10) != 0);
+
+    const anpr::FrameTraceStats stats = tracer.stats();
+    CHECK(stats.enabled == 1 && stats.slots == FrameTracer::kSlots);
+    CHECK(stats.matched == 4 && stats.missed == 2);
+    tracer.set_enabled(false);
+}
+
+int main() {
+    test_disabled();
+    test_stages();
+    test_cameras_with_equal_pts();
+    test_reused_slot();
+
+    if (failures) {
+        std::fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    std::printf("All frame trace tests passed\n");
+    return 0;
+}
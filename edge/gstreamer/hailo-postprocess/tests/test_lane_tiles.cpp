@@ -0,0 +1,127 @@
+/**
+ * Lane tile layout tests
+ *
+ * Checks the packing of lane ROIs onto the detection input, the mapping of
+ * mosaic boxes back to the frame and the metadata round trip of
+ * anpr::LaneLayout. No Hailo device required.
+ */
+
+#include "lane_tiles.hpp"
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+static int failures = 0;
+
+#define CHECK(cond)                                                        \
+    do {                                                                   \
+        if (!(cond)) {                                                     \
+            std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__,    \
+                         __LINE__, #cond);                                 \
+            failures++;                                                    \
+        }                                                                  \
+    } while (0)
+
+static bool near(float a, float b, float tolerance = 2e-3f) {
+    return std::fabs(a - b) <= tolerance;
+}
+
+// Frame box -> mosaic box (normalized to the input), the inverse of to_frame()
+static anpr::NormRect to_mosaic(const anpr::LaneLayout& layout, int tile, const anpr::NormRect& box) {
+    const anpr::LaneTile& t = layout.tiles()[tile];
+    const float sx = t.width / t.frame.width, sy = t.height / t.frame.height;
+    return anpr::NormRect{(t.x + (box.x - t.frame.x) * sx) / layout.input_width(),
+                          (t.y + (box.y - t.frame.y) * sy) / layout.input_height(),
+                          box.width * sx / layout.input_width(), box.height * sy / layout.input_height()};
+}
+
+static void test_packing() {
+    // Two lanes of the lower half of a 1920x1080 frame
+    const anpr::NormRect rois[] = {{0.0f, 0.5f, 0.5f, 0.5f}, {0.5f, 0.5f, 0.5f, 0.5f}};
+    anpr::LaneLayout layout;
+    CHECK(layout.build(rois, 2, 1920, 1080, 640, 480));
+    CHECK(layout.tiles().size() == 2);
+
+    for (const anpr::LaneTile& t : layout.tiles()) {
+        // Inside the input, aspect ratio kept (960x540 ROI)
+        CHECK(t.x >= 0 && t.y >= 0 && t.x + t.width <= 640 && t.y + t.height <= 480);
+        CHECK(near(static_cast<float>(t.width) / t.height, 960.0f / 540.0f, 0.02f));
+        // Each lane gets more pixels than in a downscaled full frame (1/3 scale)
+        CHECK(t.width > 960 / 3);
+    }
+
+    // Tiles do not overlap
+    const anpr::LaneTile& a = layout.tiles()[0];
+    const anpr::LaneTile& b = layout.tiles()[1];
+    CHECK(a.x + a.width <= b.x || b.x + b.width <= a.x || a.y + a.height <= b.y || b.y + b.height <= a.y);
+
+    // Empty and out-of-frame ROIs are rejected, ROIs are clamped to the frame
+    const anpr::NormRect bad[] = {{1.2f, 0.0f, 0.2f, 0.2f}, {-0.1f, 0.8f, 0.3f, 0.4f}};
+    CHECK(layout.build(bad, 2, 1920, 1080, 640, 480));
+    CHECK(layout.tiles().size() == 1);
+    CHECK(near(layout.tiles()[0].frame.x, 0.0f) && near(layout.tiles()[0].frame.height, 0.2f));
+    CHECK(!layout.build(bad, 1, 1920, 1080, 640, 480));
+}
+
+static void test_mapping() {
+    const anpr::NormRect rois[] = {{0.1f, 0.4f, 0.4f, 0.3f}, {0.55f, 0.45f, 0.4f, 0.5f}, {0.3f, 0.0f, 0.3f, 0.2f}};
+    anpr::LaneLayout layout;
+    CHECK(layout.build(rois, 3, 1920, 1080, 640, 480));
+
+    // A plate inside each lane maps back to where it is in the frame
+    for (int tile = 0; tile < 3; tile++) {
+        const anpr::NormRect& roi = rois[tile];
+        const anpr::NormRect plate{roi.x + roi.width * 0.3f, roi.y + roi.height * 0.6f, 0.05f, 0.02f};
+        anpr::NormRect frame_box;
+        CHECK(layout.to_frame(to_mosaic(layout, tile, plate), frame_box));
+        CHECK(near(frame_box.x, plate.x) && near(frame_box.y, plate.y));
+        CHECK(near(frame_box.width, plate.width) && near(frame_box.height, plate.height));
+    }
+
+    // Boxes centered on the padding are dropped
+    anpr::NormRect frame_box;
+    const anpr::LaneTile& last = layout.tiles()[2];
+    const float pad_x = (last.x + last.width + 2.0f) / 640.0f;
+    const float pad_y = (last.y + last.height * 0.5f) / 480.0f;
+    if (last.x + last.width + 4 < 640) {
+        CHECK(!layout.to_frame(anpr::NormRect{pad_x, pad_y, 0.001f, 0.001f}, frame_box));
+    }
+
+    // A box overlapping a tile edge is clipped to its tile
+    const anpr::LaneTile& first = layout.tiles()[0];
+    const anpr::NormRect straddling{(first.x + first.width - 20.0f) / 640.0f, (first.y + 20.0f) / 480.0f,
+                                    30.0f / 640.0f, 10.0f / 480.0f};
+    CHECK(layout.to_frame(straddling, frame_box));
+    CHECK(frame_box.x + frame_box.width <= first.frame.x + first.frame.width + 1e-4f);
+}
+
+static void test_serialize() {
+    const anpr::NormRect rois[] = {{0.0f, 0.3f, 1.0f, 0.4f}, {0.2f, 0.6f, 0.3f, 0.4f}};
+    anpr::LaneLayout layout;
+    CHECK(layout.build(rois, 2, 1280, 720, 640, 640));
+
+    anpr::LaneLayout copy;
+    CHECK(copy.parse(layout.serialize()));
+    CHECK(copy.input_width() == 640 && copy.input_height() == 640);
+    CHECK(copy.tiles().size() == layout.tiles().size());
+    for (size_t i = 0; i < copy.tiles().size(); i++) {
+        CHECK(copy.tiles()[i].x == layout.tiles()[i].x && copy.tiles()[i].width == layout.tiles()[i].width);
+        CHECK(copy.tiles()[i].frame.y == layout.tiles()[i].frame.y);
+    }
+
+    CHECK(!copy.parse(std::vector<float>{640.0f, 480.0f, 1.0f}));
+    CHECK(!copy.parse(std::vector<float>{}));
+}
+
+int main() {
+    test_packing();
+    test_mapping();
+    test_serialize();
+
+    if (failures) {
+        std::fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    std::printf("All lane tile tests passed\n");
+    return 0;
+}
@@ -0,0 +1,182 @@
+/**
+ * NMS engine tests
+ *
+ * Checks that anpr::NmsEngine keeps exactly the boxes of the reference
+ * greedy NMS on random and crowded frames. No Hailo device required.
+ */
+
+#include "nms.hpp"
+#include <cstdio>
+#include <random>
+#include <vector>
+
+static int failures = 0;
+
+#define CHECK(cond)                                                        \
+    do {                                                                   \
+        if (!(cond)) {                                                     \
+            std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__,    \
+                         __LINE__, #cond);                                 \
+            failures++;                                                    \
+        }                                                                  \
+    } while (0)
+
+/**
+ * Reference greedy NMS (the original apply_nms), with a stable sort so that
+ * equal confidences keep their input order.
+ */
+static std::vector<Detection> reference_nms(std::vector<Detection> detections, float iou_threshold) {
+    std::vector<Detection> result;
+
+    std::stable_sort(detections.begin(), detections.end(),
+                     [](const Detection& a, const Detection& b) {
+                         return a.confidence > b.confidence;
+                     });
+
+    std::vector<bool> suppressed(detections.size(), false);
+
+    for (size_t i = 0; i < detections.size(); i++) {
+        if (suppressed[i]) continue;
+
+        result.push_back(detections[i]);
+
+        for (size_t j = i + 1; j < detections.size(); j++) {
+            if (suppressed[j]) continue;
+
+            if (compute_iou(detections[i], detections[j]) > iou_threshold) {
+                suppressed[j] = true;
+            }
+        }
+    }
+
+    return result;
+}
+
+static bool same_boxes(const std::vector<Detection>& a, const std::vector<Detection>& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); i++) {
+        if (a[i].x != b[i].x || a[i].y != b[i].y || a[i].width != b[i].width ||
+            a[i].height != b[i].height || a[i].confidence != b[i].confidence) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Random plates in a 640x480 frame, optionally jittered around a few
+ * cluster centres to mimic the duplicate anchors YOLO emits per plate.
+ */
+static std::vector<Detection> random_frame(std::mt19937& rng, size_t count, bool clustered) {
+    std::uniform_real_distribution<float> ux(0.0f, 600.0f);
+    std::uniform_real_distribution<float> uy(0.0f, 450.0f);
+    std::uniform_real_distribution<float> uw(10.0f, 120.0f);
+    std::uniform_real_distribution<float> uh(5.0f, 40.0f);
+    std::uniform_real_distribution<float> jitter(-6.0f, 6.0f);
+    std::uniform_int_distribution<int> conf_bucket(50, 99);
+
+    std::vector<Detection> centres(clustered ? 1 + count / 12 : 0);
+    for (auto& c : centres) {
+        c = {ux(rng), uy(rng), uw(rng), uh(rng), 0.0f, 0};
+    }
+
+    std::vector<Detection> dets(count);
+    for (auto& d : dets) {
+        if (clustered) {
+            const Detection& c = centres[rng() % centres.size()];
+            d = {c.x + jitter(rng), c.y + jitter(rng), c.width + jitter(rng), c.height + jitter(rng), 0.0f, 0};
+        } else {
+            d = {ux(rng), uy(rng), uw(rng), uh(rng), 0.0f, 0};
+        }
+        // Coarse confidences so that ties actually occur
+        d.confidence = conf_bucket(rng) / 100.0f;
+    }
+    return dets;
+}
+
+static void test_matches_reference() {
+    std::mt19937 rng(42);
+    anpr::NmsEngine engine;
+    std::vector<Detection> out;
+
+    const size_t sizes[] = {0, 1, 2, 5, 31, 32, 33, 100, 400, 1500};
+    const float thresholds[] = {0.0f, 0.3f, 0.45f, 0.7f};
+
+    for (size_t count : sizes) {
+        for (float thr : thresholds) {
+            for (bool clustered : {false, true}) {
+                std::vector<Detection> dets = random_frame(rng, count, clustered);
+
+                anpr::NmsOptions options;
+                options.iou_threshold = thr;
+                engine.run(dets.data(), dets.size(), options, out);
+
+                CHECK(same_boxes(out, reference_nms(dets, thr)));
+            }
+        }
+    }
+}
+
+static void test_output_cap_is_prefix() {
+    std::mt19937 rng(7);
+    anpr::NmsEngine engine;
+    std::vector<Detection> out;
+
+    std::vector<Detection> dets = random_frame(rng, 300, true);
+    std::vector<Detection> expected = reference_nms(dets, 0.45f);
+
+    anpr::NmsOptions options;
+    options.max_output = 3;
+    engine.run(dets.data(), dets.size(), options, out);
+
+    CHECK(out.size() == std::min<size_t>(3, expected.size()));
+    expected.resize(out.size());
+    CHECK(same_boxes(out, expected));
+}
+
+static void test_candidate_cap() {
+    std::mt19937 rng(9);
+    anpr::NmsEngine engine;
+    std::vector<Detection> out;
+
+    std::vector<Detection> dets = random_frame(rng, 500, false);
+
+    // Top-K capped NMS equals full NMS over the K best candidates
+    std::vector<Detection> top = dets;
+    std::stable_sort(top.begin(), top.end(),
+                     [](const Detection& a, const Detection& b) {
+                         return a.confidence > b.confidence;
+                     });
+    top.resize(64);
+
+    anpr::NmsOptions options;
+    options.max_candidates = 64;
+    engine.run(dets.data(), dets.size(), options, out);
+
+    CHECK(same_boxes(out, reference_nms(top, 0.45f)));
+}
+
+static void test_identical_boxes() {
+    anpr::NmsEngine engine;
+    std::vector<Detection> out;
+
+    std::vector<Detection> dets(50, Detection{100.0f, 100.0f, 80.0f, 20.0f, 0.8f, 0});
+    anpr::NmsOptions options;
+    engine.run(dets.data(), dets.size(), options, out);
+
+    CHECK(out.size() == 1);
+}
+
+int main() {
+    test_matches_reference();
+    test_output_cap_is_prefix();
+    test_candidate_cap();
+    test_identical_boxes();
+
+    if (failures) {
+        std::fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    std::printf("All NMS tests passed\n");
+    return 0;
+}
@@ -0,0 +1,168 @@
+/**
+ * Frame-level plate OCR tests
+ *
+ * Reads the same synthetic crops through the per-ROI path (one read_crop
+ * and report_read per crop) and the frame path (read_crops on a worker pool,
+ * then report_read in ROI order) and checks that both leave the same track
+ * registry state and event ring records. No Hailo device required.
+ */
+
+#include "ocr_frame.hpp"
+#include "plate_region.hpp"
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+static int failures = 0;
+
+#define CHECK(cond)                                                        \
+    do {                                                                   \
+        if (!(cond)) {                                                     \
+            std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__,    \
+                         __LINE__, #cond);                                 \
+            failures++;                                                    \
+        }                                                                  \
+    } while (0)
+
+using Region = anpr::region::EU;
+
+/**
+ * [timesteps, num_classes] probabilities spelling `text`, blanks between
+ * characters; p is the probability of each character.
+ */
+static std::vector<float> scores(const std::string& text, float p) {
+    std::vector<float> data;
+    const auto row = [&](int symbol, float probability) {
+        std::vector<float> r(Region::num_classes, (1.0f - probability) / (Region::num_classes - 1));
+        r[symbol] = probability;
+        data.insert(data.end(), r.begin(), r.end());
+    };
+    for (char c : text) {
+        row(Region::blank, 0.999f);
+        row(static_cast<int>(std::strchr(Region::charset, c) - Region::charset), p);
+    }
+    row(Region::blank, 0.999f);
+    return data;
+}
+
+struct Frame {
+    std::vector<std::vector<float>> outputs;  // one per crop
+};
+
+static std::vector<anpr::OCRCrop> crops_of(const Frame& frame, const std::vector<uint64_t>& tracks,
+                                           uint64_t trace_frame) {
+    std::vector<anpr::OCRCrop> crops(frame.outputs.size());
+    for (size_t i = 0; i < crops.size(); i++) {
+        anpr::OCRCrop& crop = crops[i];
+        crop.data = frame.outputs[i].data();
+        crop.timesteps = static_cast<int>(frame.outputs[i].size() / Region::num_classes);
+        crop.num_classes = Region::num_classes;
+        crop.options.beam_search = false;
+        crop.stream = "sink_1";
+        crop.track_id = tracks[i];
+        crop.trace_frame = trace_frame;
+        crop.bbox[0] = 0.1f * i;
+        crop.bbox[1] = 0.5f;
+        crop.bbox[2] = 0.1f;
+        crop.bbox[3] = 0.05f;
+        crop.detection_confidence = 0.7f + 0.1f * i;
+    }
+    return crops;
+}
+
+static bool same_read(uint64_t a, uint64_t b) {
+    anpr::TrackRead x, y;
+    const anpr::TrackRegistry& registry = anpr::TrackRegistry::instance();
+    if (!registry.read(a, x) || !registry.read(b, y)) return false;
+
+    anpr::ConsensusResult cx, cy;
+    const bool rx = x.consensus.result(cx), ry = y.consensus.result(cy);
+    return std::string(x.text) == y.text && x.confidence == y.confidence &&
+           x.agreeing_reads == y.agreeing_reads && x.total_reads == y.total_reads &&
+           x.trace_frame == y.trace_frame && rx == ry && std::string(cx.text.chars) == cy.text.chars &&
+           cx.votes == cy.votes && cx.confidence == cy.confidence;
+}
+
+static void test_frame_matches_per_roi() {
+    // Two plates and a crop too short to be one, read over three frames
+    std::vector<Frame> frames(3);
+    for (size_t f = 0; f < frames.size(); f++) {
+        frames[f].outputs.push_back(scores(f == 1 ? "ABC128" : "ABC123", 0.9f));
+        frames[f].outputs.push_back(scores("XYZ789", 0.8f + 0.05f * f));
+        frames[f].outputs.push_back(scores("A1", 0.95f));
+    }
+
+    anpr::TrackRegistry& registry = anpr::TrackRegistry::instance();
+    std::vector<uint64_t> roi_tracks, frame_tracks;
+    for (int i = 0; i < 3; i++) {
+        roi_tracks.push_back(registry.new_track());
+        frame_tracks.push_back(registry.new_track());
+    }
+
+    anpr::EventRings& rings = anpr::EventRings::instance();
+    anpr::PlateEventRing* roi_ring = rings.ring("roi_ocr:src");
+    anpr::PlateEventRing* frame_ring = rings.ring("frame_ocr:src");
+
+    anpr::WorkerPool& pool = anpr::WorkerPool::instance();
+    CHECK(pool.configure(2));
+    const uint64_t jobs = pool.stats().jobs;
+
+    std::vector<anpr::OCRVerdict> roi_verdicts, frame_verdicts;
+    for (size_t f = 0; f < frames.size(); f++) {
+        for (const anpr::OCRCrop& crop : crops_of(frames[f], roi_tracks, f + 1)) {
+            anpr::OCRRead read;
+            anpr::read_crop<Region>(crop, read);
+            roi_verdicts.push_back(read.verdict);
+            if (read.verdict == anpr::OCRVerdict::Accepted) anpr::report_read(crop, read, registry, roi_ring);
+        }
+
+        const std::vector<anpr::OCRCrop> crops = crops_of(frames[f], frame_tracks, f + 1);
+        std::vector<anpr::OCRRead> reads(crops.size());
+        anpr::read_crops<Region>(crops.data(), crops.size(), reads.data(), pool);
+        for (size_t i = 0; i < crops.size(); i++) {
+            frame_verdicts.push_back(reads[i].verdict);
+            if (reads[i].verdict == anpr::OCRVerdict::Accepted) {
+                anpr::report_read(crops[i], reads[i], registry, frame_ring);
+            }
+        }
+    }
+    CHECK(pool.stats().jobs == jobs + frames.size());
+    CHECK(pool.configure(0));
+
+    CHECK(roi_verdicts == frame_verdicts);
+    CHECK(roi_verdicts[0] == anpr::OCRVerdict::Accepted && roi_verdicts[2] == anpr::OCRVerdict::Invalid);
+
+    // Same track state, consensus included
+    for (int i = 0; i < 2; i++) CHECK(same_read(roi_tracks[i], frame_tracks[i]));
+    anpr::TrackRead read;
+    CHECK(!registry.read(roi_tracks[2], read) && !registry.read(frame_tracks[2], read));
+
+    // Same events in the same order
+    anpr::PlateEventRecord a[16], b[16];
+    const size_t n = rings.drain("roi_", a, 16);
+    CHECK(n == 6);
+    CHECK(rings.drain("frame_", b, 16) == n);
+    for (size_t i = 0; i < n; i++) {
+        const int crop = a[i].track_id == roi_tracks[0] ? 0 : 1;
+        CHECK(a[i].track_id == roi_tracks[crop] && b[i].track_id == frame_tracks[crop]);
+        CHECK(a[i].kind == b[i].kind && a[i].stream_index == 1 && b[i].stream_index == 1);
+        CHECK(std::string(a[i].text) == b[i].text);
+        CHECK(a[i].ocr_confidence == b[i].ocr_confidence);
+        CHECK(a[i].detection_confidence == b[i].detection_confidence && a[i].detection_confidence > 0.0f);
+        CHECK(std::memcmp(a[i].bbox, b[i].bbox, sizeof(a[i].bbox)) == 0);
+        CHECK(a[i].trace_frame == b[i].trace_frame && a[i].trace_frame == i / 2 + 1);
+    }
+    CHECK(std::string(a[2].text) == "ABC128");
+}
+
+int main() {
+    test_frame_matches_per_roi();
+
+    if (failures) {
+        std::fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    std::printf("All frame OCR tests passed\n");
+    return 0;
+}
@@ -0,0 +1,112 @@
+/**
+ * Plate consensus tests
+ *
+ * Checks the position-aligned, confidence-weighted fusion of
+ * anpr::PlateConsensus: partial misreads fuse into the right text, weak
+ * characters lose to confident ones, reads of another length count against
+ * the consensus, and the fixed candidate/length tables evict the lightest
+ * entries. No Hailo device required.
+ */
+
+#include "plate_consensus.hpp"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+static int failures = 0;
+
+#define CHECK(cond)                                                        \
+    do {                                                                   \
+        if (!(cond)) {                                                     \
+            std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__,    \
+                         __LINE__, #cond);                                 \
+            failures++;                                                    \
+        }                                                                  \
+    } while (0)
+
+static bool near(float a, float b) {
+    return std::fabs(a - b) < 1e-4f;
+}
+
+static void test_partial_misreads_fuse() {
+    anpr::PlateConsensus consensus;
+    anpr::ConsensusResult result;
+    CHECK(!consensus.result(result));
+
+    // No single read is right, every position is right in two of three
+    consensus.add("ABC1Z3", nullptr, 6, 0.9f);
+    consensus.add("A8C123", nullptr, 6, 0.9f);
+    consensus.add("ABC723", nullptr, 6, 0.9f);
+    CHECK(consensus.reads() == 3);
+    CHECK(consensus.result(result));
+    CHECK(std::strcmp(result.text.c_str(), "ABC123") == 0);
+    CHECK(result.votes == 2);
+    CHECK(near(result.consensus, 2.0f / 3.0f));
+    CHECK(near(result.confidence, 0.9f));
+}
+
+static void test_char_confidences_weigh_votes() {
+    anpr::PlateConsensus consensus;
+
+    // Two reads say '8' weakly, one says 'B' confidently
+    const float weak[] = {0.9f, 0.3f, 0.9f};
+    const float strong[] = {0.9f, 0.95f, 0.9f};
+    consensus.add("A8C", weak, 3, 0.7f);
+    consensus.add("A8C", weak, 3, 0.7f);
+    consensus.add("ABC", strong, 3, 0.92f);
+
+    anpr::ConsensusResult result;
+    CHECK(consensus.result(result));
+    CHECK(std::strcmp(result.text.c_str(), "ABC") == 0);
+    CHECK(result.votes == 1);
+    CHECK(near(result.text.confidences[1], 0.95f));
+    CHECK(near(result.consensus, 0.95f / 1.55f));
+}
+
+static void test_other_lengths_count_against() {
+    anpr::PlateConsensus consensus;
+    consensus.add("ABC123", nullptr, 6, 0.9f);
+    consensus.add("ABC123", nullptr, 6, 0.9f);
+    consensus.add("ABC12", nullptr, 5, 0.9f);  // dropped character
+
+    anpr::ConsensusResult result;
+    CHECK(consensus.result(result));
+    CHECK(std::strcmp(result.text.c_str(), "ABC123") == 0);
+    CHECK(near(result.consensus, 1.8f / 2.7f));
+
+    // A third length replaces the lightest one, its weight still counts
+    consensus.add("XY", nullptr, 2, 0.5f);
+    CHECK(consensus.result(result));
+    CHECK(std::strcmp(result.text.c_str(), "ABC123") == 0);
+    CHECK(near(result.consensus, 1.8f / 3.2f));
+}
+
+static void test_candidate_eviction() {
+    anpr::PlateConsensus consensus;
+    consensus.add("A", nullptr, 1, 0.9f);
+    consensus.add("A", nullptr, 1, 0.9f);
+    consensus.add("B", nullptr, 1, 0.2f);
+    consensus.add("C", nullptr, 1, 0.3f);
+    consensus.add("D", nullptr, 1, 0.4f);
+    consensus.add("E", nullptr, 1, 0.5f);  // replaces 'B'
+
+    anpr::ConsensusResult result;
+    CHECK(consensus.result(result));
+    CHECK(std::strcmp(result.text.c_str(), "A") == 0);
+    CHECK(result.votes == 2);
+    CHECK(near(result.consensus, 1.8f / 3.2f));
+}
+
+int main() {
+    test_partial_misreads_fuse();
+    test_char_confidences_weigh_votes();
+    test_other_lengths_count_against();
+    test_candidate_eviction();
+
+    if (failures) {
+        std::fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    std::printf("All plate consensus tests passed\n");
+    return 0;
+}
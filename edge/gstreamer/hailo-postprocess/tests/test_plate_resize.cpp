@@ -0,0 +1,234 @@
+/**
+ * Fused crop/resize tests
+ *
+ * Checks anpr::CropResizer against a floating-point bilinear reference on
+ * RGB and NV12 frames, that the SIMD row blend matches the scalar one, and
+ * that staged crops (DMA-BUF frames) match direct ones exactly.
+ * No Hailo device required.
+ */
+
+#include "plate_resize.hpp"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+static int failures = 0;
+
+#define CHECK(cond)                                                        \
+    do {                                                                   \
+        if (!(cond)) {                                                     \
+            std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__,    \
+                         __LINE__, #cond);                                 \
+            failures++;                                                    \
+        }                                                                  \
+    } while (0)
+
+/**
+ * Reference bilinear sample of channel c of an interleaved plane.
+ */
+static float reference_sample(const std::vector<uint8_t>& plane, int width, int height, int channels,
+                              int c, float x, float y) {
+    x = std::min(std::max(x, 0.0f), static_cast<float>(width - 1));
+    y = std::min(std::max(y, 0.0f), static_cast<float>(height - 1));
+    const int x0 = static_cast<int>(x), y0 = static_cast<int>(y);
+    const int x1 = std::min(x0 + 1, width - 1), y1 = std::min(y0 + 1, height - 1);
+    const float fx = x - x0, fy = y - y0;
+    auto at = [&](int px, int py) { return static_cast<float>(plane[(py * width + px) * channels + c]); };
+    return (at(x0, y0) * (1 - fx) + at(x1, y0) * fx) * (1 - fy) + (at(x0, y1) * (1 - fx) + at(x1, y1) * fx) * fy;
+}
+
+static void test_rgb_matches_reference() {
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<int> pixel(0, 255);
+
+    const int width = 320, height = 240;
+    std::vector<uint8_t> frame(width * height * 3);
+    for (auto& p : frame) p = static_cast<uint8_t>(pixel(rng));
+
+    anpr::ImageView view;
+    view.format = anpr::PixelFormat::RGB;
+    view.width = width;
+    view.height = height;
+    view.planes[0] = frame.data();
+    view.strides[0] = width * 3;
+
+    const int out_w = 200, out_h = 64;
+    std::vector<uint8_t> out(out_w * out_h * 3);
+    anpr::CropResizer resizer;
+
+    // Upscale (distant plate), downscale, and a crop touching the frame edge
+    const anpr::CropRect rects[] = {
+        {100.5f, 80.25f, 47.0f, 13.0f},
+        {10.0f, 20.0f, 300.0f, 150.0f},
+        {250.0f, 200.0f, 70.0f, 40.0f},
+    };
+
+    for (const auto& rect : rects) {
+        CHECK(resizer.run(view, rect, out.data(), out_w, out_h, out_w * 3));
+
+        int max_err = 0;
+        for (int dy = 0; dy < out_h; dy++) {
+            for (int dx = 0; dx < out_w; dx++) {
+                const float sx = rect.x + (dx + 0.5f) * rect.width / out_w - 0.5f;
+                const float sy = rect.y + (dy + 0.5f) * rect.height / out_h - 0.5f;
+                for (int c = 0; c < 3; c++) {
+                    const float ref = reference_sample(frame, width, height, 3, c, sx, sy);
+                    const int err = std::abs(out[(dy * out_w + dx) * 3 + c] - static_cast<int>(std::lround(ref)));
+                    max_err = std::max(max_err, err);
+                }
+            }
+        }
+        // 8-bit weights: at most a couple of levels off the exact result
+        CHECK(max_err <= 2);
+    }
+}
+
+static void test_nv12_conversion() {
+    const int width = 64, height = 32;
+    std::vector<uint8_t> y_plane(width * height);
+    std::vector<uint8_t> uv_plane(width * height / 2);
+
+    anpr::ImageView view;
+    view.format = anpr::PixelFormat::NV12;
+    view.width = width;
+    view.height = height;
+    view.planes[0] = y_plane.data();
+    view.planes[1] = uv_plane.data();
+    view.strides[0] = width;
+    view.strides[1] = width;
+
+    const int out_w = 20, out_h = 8;
+    std::vector<uint8_t> out(out_w * out_h * 3);
+    anpr::CropResizer resizer;
+
+    struct Case {
+        uint8_t y, u, v;
+        int r, g, b;
+    };
+    // Limited-range BT.601: black, white, saturated red
+    const Case cases[] = {
+        {16, 128, 128, 0, 0, 0},
+        {235, 128, 128, 255, 255, 255},
+        {81, 90, 240, 255, 0, 0},
+    };
+
+    for (const auto& tc : cases) {
+        std::fill(y_plane.begin(), y_plane.end(), tc.y);
+        for (size_t i = 0; i < uv_plane.size(); i += 2) {
+            uv_plane[i] = tc.u;
+            uv_plane[i + 1] = tc.v;
+        }
+
+        CHECK(resizer.run(view, anpr::CropRect{5.0f, 3.0f, 40.0f, 20.0f}, out.data(), out_w, out_h, out_w * 3));
+        for (int i = 0; i < out_w * out_h; i++) {
+            CHECK(std::abs(out[i * 3 + 0] - tc.r) <= 2);
+            CHECK(std::abs(out[i * 3 + 1] - tc.g) <= 2);
+            CHECK(std::abs(out[i * 3 + 2] - tc.b) <= 2);
+        }
+    }
+
+    // Luma gradient survives the resize
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) y_plane[y * width + x] = static_cast<uint8_t>(16 + x * 3);
+    }
+    std::fill(uv_plane.begin(), uv_plane.end(), 128);
+    CHECK(resizer.run(view, anpr::CropRect{0.0f, 0.0f, 64.0f, 32.0f}, out.data(), out_w, out_h, out_w * 3));
+    for (int dx = 1; dx < out_w; dx++) {
+        CHECK(out[dx * 3] > out[(dx - 1) * 3]);
+    }
+}
+
+static void test_blend_kernel_matches_scalar() {
+    std::mt19937 rng(11);
+    std::uniform_int_distribution<int> pixel(0, 255);
+
+    for (size_t n : {1u, 7u, 16u, 33u, 600u}) {
+        std::vector<uint8_t> a(n), b(n);
+        for (size_t i = 0; i < n; i++) {
+            a[i] = static_cast<uint8_t>(pixel(rng));
+            b[i] = static_cast<uint8_t>(pixel(rng));
+        }
+        for (int wy : {0, 1, 128, 255, 256}) {
+            std::vector<uint16_t> expected(n), actual(n);
+            anpr::blend_rows_scalar(a.data(), b.data(), n, wy, expected.data());
+            anpr::blend_rows(a.data(), b.data(), n, wy, actual.data());
+            CHECK(expected == actual);
+        }
+    }
+}
+
+static void test_rejects_empty() {
+    anpr::ImageView view;
+    uint8_t out[3];
+    anpr::CropResizer resizer;
+    CHECK(!resizer.run(view, anpr::CropRect{0, 0, 1, 1}, out, 1, 1, 3));
+}
+
+static void test_staged_matches_direct() {
+    std::mt19937 rng(11);
+    std::uniform_int_distribution<int> pixel(0, 255);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+    // Odd frame size and padded strides, as decoder buffers have
+    const int width = 321, height = 181;
+    const size_t rgb_stride = width * 3 + 13;
+    const size_t luma_stride = width + 31;
+    const size_t chroma_stride = (width + 1) / 2 * 2 + 7;
+    std::vector<uint8_t> rgb(rgb_stride * height), luma(luma_stride * height), chroma(chroma_stride * (height + 1) / 2);
+    for (auto* plane : {&rgb, &luma, &chroma}) {
+        for (auto& v : *plane) v = static_cast<uint8_t>(pixel(rng));
+    }
+
+    anpr::ImageView views[2];
+    views[0].format = anpr::PixelFormat::RGB;
+    views[0].planes[0] = rgb.data();
+    views[0].strides[0] = rgb_stride;
+    views[1].format = anpr::PixelFormat::NV12;
+    views[1].planes[0] = luma.data();
+    views[1].planes[1] = chroma.data();
+    views[1].strides[0] = luma_stride;
+    views[1].strides[1] = chroma_stride;
+
+    anpr::CropResizer resizer;
+    const int out_width = 50, out_height = 16;
+    std::vector<uint8_t> direct(out_width * out_height * 3), staged(direct.size());
+    int mismatches = 0;
+    for (auto& view : views) {
+        view.width = width;
+        view.height = height;
+        for (int i = 0; i < 200; i++) {
+            // Up- and downscaling crops, some touching or past the frame edges
+            anpr::CropRect rect;
+            rect.width = 4.0f + unit(rng) * 150.0f;
+            rect.height = 2.0f + unit(rng) * 60.0f;
+            rect.x = unit(rng) * (width + 20.0f) - 10.0f - (i % 4 == 0 ? 0.0f : rect.width / 2);
+            rect.y = unit(rng) * (height + 10.0f) - 5.0f - (i % 4 == 0 ? 0.0f : rect.height / 2);
+            rect.x = std::min(std::max(rect.x, 0.0f), width - 1.0f);
+            rect.y = std::min(std::max(rect.y, 0.0f), height - 1.0f);
+            rect.width = std::min(rect.width, width - rect.x);
+            rect.height = std::min(rect.height, height - rect.y);
+
+            CHECK(resizer.run(view, rect, direct.data(), out_width, out_height, out_width * 3));
+            CHECK(resizer.run_staged(view, rect, staged.data(), out_width, out_height, out_width * 3));
+            mismatches += direct != staged;
+        }
+    }
+    CHECK(mismatches == 0);
+}
+
+int main() {
+    test_rgb_matches_reference();
+    test_nv12_conversion();
+    test_blend_kernel_matches_scalar();
+    test_rejects_empty();
+    test_staged_matches_direct();
+
+    if (failures) {
+        std::fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    std::printf("All crop/resize tests passed\n");
+    return 0;
+}
@@ -0,0 +1,310 @@
+/**
+ * Plate tracker tests
+ *
+ * Checks identity across frames for moving and crossing plates, low
+ * confidence handling, track expiry and the plate-vote events of
+ * anpr::PlateTracker, including the early decision on the character-level
+ * consensus and the detection confidence its events carry, and zone
+ * crossings of tracked plates from the crossing to the drained event record.
+ * No Hailo device required.
+ */
+
+#include "plate_tracker.hpp"
+#include "track_registry.hpp"
+#include "zone_map.hpp"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+static int failures = 0;
+
+#define CHECK(cond)                                                        \
+    do {                                                                   \
+        if (!(cond)) {                                                     \
+            std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__,    \
+                         __LINE__, #cond);                                 \
+            failures++;                                                    \
+        }                                                                  \
+    } while (0)
+
+static anpr::TrackerDetection det(float x, float y, float confidence = 0.9f) {
+    return anpr::TrackerDetection{{x, y, 0.08f, 0.03f}, confidence};
+}
+
+static void test_moving_plates_keep_ids() {
+    anpr::PlateTracker tracker;
+    anpr::TrackerOptions options;
+    std::vector<anpr::TrackEvent> events;
+
+    // Two plates moving towards each other on separate lanes, faster than the box width over 10 frames
+    uint64_t ids[2] = {0, 0};
+    for (int frame = 0; frame < 40; frame++) {
+        anpr::TrackerDetection dets[2] = {det(0.1f + frame * 0.01f, 0.3f), det(0.8f - frame * 0.01f, 0.36f)};
+        uint64_t out[2];
+        tracker.update(dets, 2, options, out, events);
+        if (frame == 0) {
+            ids[0] = out[0];
+            ids[1] = out[1];
+            CHECK(ids[0] != 0 && ids[1] != 0 && ids[0] != ids[1]);
+        } else {
+            CHECK(out[0] == ids[0]);
+            CHECK(out[1] == ids[1]);
+        }
+    }
+    CHECK(tracker.num_tracks() == 2);
+    CHECK(events.empty());
+
+    // Velocity is learned: the predicted box leads the last measurement
+    anpr::TrackBox predicted = tracker.box(0);
+    CHECK(predicted.x > 0.1f + 38 * 0.01f);
+}
+
+static void test_low_confidence_continues_only() {
+    anpr::PlateTracker tracker;
+    anpr::TrackerOptions options;
+    std::vector<anpr::TrackEvent> events;
+    uint64_t id = 0, out = 0;
+
+    anpr::TrackerDetection weak = det(0.5f, 0.5f, 0.3f);
+    tracker.update(&weak, 1, options, &out, events);
+    CHECK(out == 0);
+    CHECK(tracker.num_tracks() == 0);
+
+    anpr::TrackerDetection strong = det(0.5f, 0.5f);
+    tracker.update(&strong, 1, options, &id, events);
+    CHECK(id != 0);
+    tracker.update(&weak, 1, options, &out, events);
+    CHECK(out == id);
+}
+
+static void test_votes_and_events() {
+    anpr::PlateTracker tracker;
+    anpr::TrackerOptions options;
+    options.max_age = 3;
+    std::vector<anpr::TrackEvent> events;
+    anpr::TrackRegistry& registry = anpr::TrackRegistry::instance();
+
+    anpr::TrackerDetection d = det(0.2f, 0.2f);
+    uint64_t id = 0;
+    tracker.update(&d, 1, options, &id, events);
+
+    const char* reads[] = {"ABC123", "ABC128", "ABC123", "ABC123"};
+    int decided_at = -1;
+    for (int frame = 0; frame < 4; frame++) {
+        registry.report_read(id, reads[frame], 6, 0.8f + frame * 0.01f);
+        uint64_t out;
+        tracker.update(&d, 1, options, &out, events);
+        if (!events.empty() && decided_at < 0) decided_at = frame;
+    }
+
+    // Decided once the winning text has 3 votes
+    CHECK(decided_at == 3);
+    CHECK(events.size() == 1);
+    CHECK(events[0].type == anpr::TrackEventType::PlateDecided);
+    CHECK(events[0].track_id == id);
+    CHECK(std::strcmp(events[0].text, "ABC123") == 0);
+    CHECK(events[0].votes == 3);
+    CHECK(events[0].total_reads == 4);
+
+    // Plate leaves: exactly one end event after max_age frames
+    events.clear();
+    for (int frame = 0; frame < 4; frame++) {
+        uint64_t unused;
+        tracker.update(nullptr, 0, options, &unused, events);
+    }
+    CHECK(events.size() == 1);
+    CHECK(events[0].type == anpr::TrackEventType::TrackEnded);
+    CHECK(std::strcmp(events[0].text, "ABC123") == 0);
+    CHECK(tracker.num_tracks() == 0);
+
+    anpr::TrackRead read;
+    CHECK(!registry.read(id, read));
+}
+
+static void test_consensus_decides_once() {
+    anpr::PlateTracker tracker;
+    anpr::TrackerOptions options;
+    options.min_plate_votes = 2;
+    options.min_consensus = 0.6f;
+    options.max_age = 2;
+    std::vector<anpr::TrackEvent> events;
+    anpr::TrackRegistry& registry = anpr::TrackRegistry::instance();
+
+    anpr::TrackerDetection d = det(0.6f, 0.2f);
+    uint64_t id = 0;
+    tracker.update(&d, 1, options, &id, events);
+
+    // Every read has one wrong character, with a low confidence on it
+    const char* reads[] = {"LTU7Z7", "L7U777", "LTU77Z", "LTU777", "LTU777"};
+    const int weak_at[] = {4, 1, 5, -1, -1};
+    int decided_at = -1;
+    for (int frame = 0; frame < 5; frame++) {
+        float confidences[6];
+        for (int p = 0; p < 6; p++) confidences[p] = p == weak_at[frame] ? 0.3f : 0.9f;
+        registry.report_read(id, reads[frame], 6, 0.8f, confidences);
+        uint64_t out;
+        tracker.update(&d, 1, options, &out, events);
+        if (!events.empty() && decided_at < 0) decided_at = frame;
+    }
+
+    // Decided on the third frame's reads, although none of them was right
+    CHECK(decided_at == 2);
+    CHECK(events.size() == 1);
+    CHECK(events[0].type == anpr::TrackEventType::PlateDecided);
+    CHECK(std::strcmp(events[0].text, "LTU777") == 0);
+    CHECK(events[0].votes == 2);
+    CHECK(events[0].consensus >= 0.6f);
+
+    // The registry knows, so the cropper stops sending the track to OCR
+    anpr::TrackRead read;
+    CHECK(registry.read(id, read) && read.decided);
+
+    events.clear();
+    for (int frame = 0; frame < 3; frame++) {
+        uint64_t unused;
+        tracker.update(nullptr, 0, options, &unused, events);
+    }
+    CHECK(events.size() == 1);
+    CHECK(events[0].type == anpr::TrackEventType::TrackEnded);
+}
+
+static void test_events_carry_detection_confidence() {
+    anpr::PlateTracker tracker;
+    anpr::TrackerOptions options;
+    options.min_plate_votes = 2;
+    options.max_age = 1;
+    std::vector<anpr::TrackEvent> events;
+    anpr::TrackRegistry& registry = anpr::TrackRegistry::instance();
+
+    // Confident start, then weaker detections that still continue the track
+    const float confidences[] = {0.9f, 0.7f, 0.8f};
+    uint64_t id = 0;
+    for (int frame = 0; frame < 3; frame++) {
+        anpr::TrackerDetection d = det(0.3f, 0.6f, confidences[frame]);
+        uint64_t out;
+        tracker.update(&d, 1, options, &out, events);
+        if (frame == 0) id = out;
+        const float read_confidences[6] = {0.9f, 0.9f, 0.9f, 0.9f, 0.9f, 0.9f};
+        registry.report_read(id, "ABC123", 6, 0.9f, read_confidences);
+    }
+
+    // Decided on the third frame (confirmed, two reads): the mean of its detections
+    CHECK(events.size() == 1);
+    CHECK(!events.empty() && events[0].type == anpr::TrackEventType::PlateDecided);
+    CHECK(!events.empty() && events[0].detection_confidence > 0.0f);
+    CHECK(!events.empty() && std::fabs(events[0].detection_confidence - 0.8f) < 1e-5f);
+
+    anpr::TrackerDetection d = det(0.3f, 0.6f, 0.6f);
+    uint64_t out;
+    tracker.update(&d, 1, options, &out, events);
+
+    for (int frame = 0; frame < 3; frame++) tracker.update(nullptr, 0, options, &out, events);
+    CHECK(events.size() == 2);
+    CHECK(events.size() == 2 && events[1].type == anpr::TrackEventType::TrackEnded &&
+          std::fabs(events[1].detection_confidence - 0.75f) < 1e-5f);  // all four frames
+}
+
+static void test_unconfirmed_tracks_end_silently() {
+    anpr::PlateTracker tracker;
+    anpr::TrackerOptions options;
+    options.max_age = 1;
+    std::vector<anpr::TrackEvent> events;
+
+    anpr::TrackerDetection d = det(0.7f, 0.7f);
+    uint64_t out;
+    tracker.update(&d, 1, options, &out, events);
+    for (int frame = 0; frame < 3; frame++) tracker.update(nullptr, 0, options, &out, events);
+    CHECK(tracker.num_tracks() == 0);
+    CHECK(events.empty());
+}
+
+static void test_full_table() {
+    anpr::PlateTracker tracker;
+    anpr::TrackerOptions options;
+    std::vector<anpr::TrackEvent> events;
+
+    std::vector<anpr::TrackerDetection> dets;
+    for (int i = 0; i < anpr::PlateTracker::kMaxTracks + 5; i++) {
+        dets.push_back(anpr::TrackerDetection{{(i % 10) * 0.1f, (i / 10) * 0.1f, 0.05f, 0.02f}, 0.9f});
+    }
+    std::vector<uint64_t> ids(dets.size());
+    tracker.update(dets.data(), dets.size(), options, ids.data(), events);
+
+    int untracked = 0;
+    for (uint64_t id : ids) untracked += id == 0;
+    CHECK(untracked == 5);
+    CHECK(tracker.num_tracks() == anpr::PlateTracker::kMaxTracks);
+
+    tracker.flush(options, events);
+    CHECK(tracker.num_tracks() == 0);
+}
+
+static void test_zone_events_reach_the_ring() {
+    const float gate[] = {0.4f, 0.0f, 0.6f, 0.0f, 0.6f, 1.0f, 0.4f, 1.0f};
+    anpr::ZoneMap zones;
+    zones.add_zone("entry", gate, 4);
+    zones.add_zone("gate", gate, 4);
+    zones.build(64, 48);
+
+    anpr::PlateTracker tracker;
+    anpr::TrackerOptions options;
+    anpr::ZoneCrossing crossing;
+    std::vector<anpr::TrackEvent> events;
+    std::vector<anpr::ZoneEvent> zone_events;
+    anpr::TrackRegistry& registry = anpr::TrackRegistry::instance();
+    anpr::PlateEventRing* ring = anpr::EventRings::instance().ring("zone3_track:src");
+
+    // A read plate drives left to right through the gate, as plate_tracker publishes it
+    uint64_t id = 0;
+    for (int frame = 0; frame <= 50; frame++) {
+        anpr::TrackerDetection d = det(0.1f + frame * 0.016f, 0.5f, 0.85f);
+        uint64_t out;
+        tracker.update(&d, 1, options, &out, events);
+        if (frame == 0) id = out;
+        if (frame == 2) registry.report_read(id, "ABC123", 6, 0.9f);
+
+        const size_t first = zone_events.size();
+        crossing.update(zones, out, d.box.x + d.box.width * 0.5f, d.box.y + d.box.height * 0.5f, zone_events);
+        for (size_t e = first; e < zone_events.size(); e++) {
+            ring->push(anpr::zone_event_record(zone_events[e], "sink_3", d));
+        }
+    }
+
+    anpr::PlateEventRecord out[8];
+    CHECK(anpr::EventRings::instance().drain("zone3_", out, 8) == 4);
+    const anpr::PlateEventKind kinds[] = {anpr::PlateEventKind::ZoneEntered, anpr::PlateEventKind::ZoneEntered,
+                                          anpr::PlateEventKind::ZoneExited, anpr::PlateEventKind::ZoneExited};
+    for (int i = 0; i < 4; i++) {
+        CHECK(out[i].kind == static_cast<uint32_t>(kinds[i]));
+        CHECK(out[i].zone == i % 2);
+        CHECK(out[i].track_id == id && out[i].stream_index == 3);
+        CHECK(std::string(out[i].text) == "ABC123" && out[i].total_reads == 1);
+        CHECK(std::fabs(out[i].detection_confidence - 0.85f) < 1e-6f);
+        CHECK(out[i].bbox[0] > 0.3f && out[i].bbox[0] < 0.6f && out[i].bbox[2] == 0.08f);
+    }
+    CHECK(out[0].bbox[0] < out[2].bbox[0]);  // entered before it left
+
+    // Track events carry no zone
+    const anpr::PlateEventRecord record = anpr::make_event_record(anpr::PlateEventKind::Read, "", 1, "X", 1);
+    CHECK(record.zone == -1);
+}
+
+int main() {
+    test_moving_plates_keep_ids();
+    test_low_confidence_continues_only();
+    test_votes_and_events();
+    test_consensus_decides_once();
+    test_events_carry_detection_confidence();
+    test_unconfirmed_tracks_end_silently();
+    test_full_table();
+    test_zone_events_reach_the_ring();
+
+    if (failures) {
+        std::fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    std::printf("All plate tracker tests passed\n");
+    return 0;
+}
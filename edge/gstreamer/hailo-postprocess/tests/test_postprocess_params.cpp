@@ -0,0 +1,192 @@
+/**
+ * Postprocess parameter store tests
+ *
+ * Checks config parsing and validation, per-camera merging across loads,
+ * the detection fast mode keys, that per-thread readers pick up a reload and
+ * release the old block, and the runtime plate length limits of
+ * check_read(). No Hailo device required.
+ */
+
+#include "postprocess_params.hpp"
+#include "ocr_decode.hpp"
+#include "plate_region.hpp"
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+static int failures = 0;
+
+#define CHECK(cond)                                                        \
+    do {                                                                   \
+        if (!(cond)) {                                                     \
+            std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__,    \
+                         __LINE__, #cond);                                 \
+            failures++;                                                    \
+        }                                                                  \
+    } while (0)
+
+static bool load(const std::string& text, std::string* error = nullptr) {
+    anpr::json::Value config;
+    return anpr::json::parse(text, config, error) && anpr::PostprocessParamStore::instance().load(config, error);
+}
+
+static void test_load_and_merge() {
+    anpr::PostprocessParamStore& store = anpr::PostprocessParamStore::instance();
+
+    // Nothing loaded: the compiled-in defaults
+    const anpr::PostprocessParams& initial = anpr::thread_postprocess_params("cam1");
+    CHECK(initial.confidence_threshold == 0.5f);
+    CHECK(initial.nms_threshold == 0.45f);
+    CHECK(initial.beam_search && initial.beam_width == 8);
+    CHECK(initial.ocr_width == 200 && initial.ocr_height == 64);
+
+    const uint64_t version = store.version();
+    CHECK(load(R"({"detection": {"confidence_threshold": 0.4},
+                   "cameras": {"cam1": {"detection": {"nms_threshold": 0.3},
+                                        "ocr": {"beam_search": false, "min_length": 5, "max_length": 7}}}})"));
+    CHECK(store.version() == version + 1);
+
+    const anpr::PostprocessParams cam1 = anpr::thread_postprocess_params("cam1");
+    CHECK(cam1.confidence_threshold == 0.4f);  // file defaults apply to its cameras
+    CHECK(cam1.nms_threshold == 0.3f);
+    CHECK(!cam1.beam_search);
+    CHECK(cam1.min_plate_length == 5 && cam1.max_plate_length == 7);
+
+    const anpr::PostprocessParams other = anpr::thread_postprocess_params("cam9");
+    CHECK(other.confidence_threshold == 0.4f);
+    CHECK(other.nms_threshold == 0.45f);
+
+    // A second pipeline's file only touches its own camera
+    CHECK(load(R"({"cameras": {"sink_1": {"ocr": {"min_confidence": 0.8},
+                                          "crop": {"width": 160, "height": 48, "dmabuf": true}}}})"));
+    CHECK(anpr::thread_postprocess_params("cam1").nms_threshold == 0.3f);
+    const anpr::PostprocessParams sink1 = anpr::thread_postprocess_params("sink_1");
+    CHECK(sink1.min_confidence == 0.8f);
+    CHECK(sink1.ocr_width == 160 && sink1.ocr_height == 48);
+    CHECK(sink1.crop_dmabuf && !anpr::thread_postprocess_params("cam1").crop_dmabuf);
+    CHECK(sink1.confidence_threshold == 0.4f);
+
+    // Reloading a camera replaces its entry
+    CHECK(load(R"({"cameras": {"cam1": {"detection": {"confidence_threshold": 0.7}}}})"));
+    const anpr::PostprocessParams reloaded = anpr::thread_postprocess_params("cam1");
+    CHECK(reloaded.confidence_threshold == 0.7f);
+    CHECK(reloaded.beam_search);
+    CHECK(store.snapshot()->cameras.size() == 2);
+}
+
+static void test_invalid_configs() {
+    anpr::PostprocessParamStore& store = anpr::PostprocessParamStore::instance();
+    const uint64_t version = store.version();
+    const float threshold = anpr::thread_postprocess_params("cam1").confidence_threshold;
+
+    std::string error;
+    CHECK(!load(R"({"detection": {"confidence_threshold": 1.5}})", &error));
+    CHECK(!error.empty());
+    CHECK(!load(R"({"cameras": {"cam1": {"ocr": {"beam_width": 0}}}})", &error));
+    CHECK(error.find("cam1") != std::string::npos);
+    CHECK(!load(R"({"cameras": {"cam1": {"ocr": {"min_length": 7, "max_length": 5}}}})"));
+    CHECK(!load(R"({"cameras": {"cam1": {"ocr": {"max_length": 99}}}})"));
+    CHECK(!load(R"({"cameras": {"cam1": {"crop": {"width": 0}}}})"));
+    CHECK(!load(R"({"cameras": {"cam1": {"evidence": {"quality": 0}}}})"));
+    CHECK(!load(R"({"evidence": {"margin": -0.5}})"));
+    CHECK(!load("[1, 2]"));
+
+    // Rejected loads leave the published parameters alone
+    CHECK(store.version() == version);
+    CHECK(anpr::thread_postprocess_params("cam1").confidence_threshold == threshold);
+    CHECK(!store.load_file("/nonexistent/postprocess.json"));
+}
+
+static void test_fast_detection() {
+    anpr::PostprocessParamStore& store = anpr::PostprocessParamStore::instance();
+
+    // Off by default, with the geometry limits fast mode would apply
+    const anpr::PostprocessParams& initial = anpr::thread_postprocess_params("cam4");
+    CHECK(!initial.fast_detection && initial.top_k == 16 && initial.max_plates == 0);
+    CHECK(initial.min_plate_aspect == 0.5f && initial.max_plate_aspect == 10.0f);
+
+    CHECK(load(R"({"cameras": {"cam4": {"detection": {"fast": true, "top_k": 4, "max_plates": 2,
+                                                      "max_aspect": 6}}}})"));
+    const anpr::PostprocessParams cam4 = anpr::thread_postprocess_params("cam4");
+    CHECK(cam4.fast_detection && cam4.top_k == 4 && cam4.max_plates == 2);
+    CHECK(cam4.max_plate_aspect == 6.0f && cam4.min_plate_aspect == 0.5f);
+    CHECK(!anpr::thread_postprocess_params("cam9").fast_detection);
+
+    const uint64_t version = store.version();
+    CHECK(!load(R"({"cameras": {"cam4": {"detection": {"top_k": 0}}}})"));
+    CHECK(!load(R"({"cameras": {"cam4": {"detection": {"max_plates": -1}}}})"));
+    CHECK(!load(R"({"detection": {"min_aspect": 4, "max_aspect": 2}})"));
+    CHECK(!load(R"({"detection": {"min_width": 1.5}})"));
+    CHECK(store.version() == version);
+}
+
+static void test_reload_under_readers() {
+    anpr::PostprocessParamStore& store = anpr::PostprocessParamStore::instance();
+    std::weak_ptr<const anpr::PostprocessParamBlock> old_block = store.snapshot();
+
+    // Readers see either the old or the new block, never a torn one
+    std::atomic<bool> done{false};
+    std::atomic<int> torn{0};
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 4; t++) {
+        readers.emplace_back([&] {
+            while (!done.load()) {
+                const anpr::PostprocessParams& params = anpr::thread_postprocess_params("cam2");
+                if (params.ocr_width * 8 != params.ocr_height * 25) torn++;  // holds for 200x64
+            }
+        });
+    }
+
+    anpr::PostprocessParams params;
+    for (int i = 1; i <= 100; i++) {
+        params.ocr_width = 25 * i;
+        params.ocr_height = 8 * i;
+        store.set("cam2", params);
+    }
+    done = true;
+    for (auto& reader : readers) reader.join();
+    CHECK(torn == 0);
+
+    // The readers have exited; this thread picks up the last block and the first one is gone
+    CHECK(anpr::thread_postprocess_params("cam2").ocr_width == 2500);
+    CHECK(old_block.expired());
+}
+
+static void test_runtime_plate_lengths() {
+    anpr::OCRResult result;
+    for (const char c : std::string("AB12")) result.text.push(c, 0.9f);
+    result.confidence = 0.9f;
+
+    anpr::PlateText cleaned;
+    anpr::OCRDecodeOptions options;
+    CHECK(anpr::check_read<anpr::region::EU>(result, options, cleaned) == anpr::OCRVerdict::Accepted);
+
+    options.min_length = 5;
+    CHECK(anpr::check_read<anpr::region::EU>(result, options, cleaned) == anpr::OCRVerdict::Invalid);
+
+    // A site maximum keeps the region's minimum (2 for US plates)
+    options.min_length = 0;
+    options.max_length = 3;
+    CHECK(anpr::check_read<anpr::region::US>(result, options, cleaned) == anpr::OCRVerdict::Invalid);
+    result.text.clear();
+    for (const char c : std::string("A1")) result.text.push(c, 0.9f);
+    CHECK(anpr::check_read<anpr::region::US>(result, options, cleaned) == anpr::OCRVerdict::Accepted);
+}
+
+int main() {
+    test_load_and_merge();
+    test_invalid_configs();
+    test_fast_detection();
+    test_reload_under_readers();
+    test_runtime_plate_lengths();
+
+    if (failures) {
+        std::fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    std::printf("All postprocess params tests passed\n");
+    return 0;
+}
@@ -0,0 +1,195 @@
+/**
+ * Inference scheduler tests
+ *
+ * Checks that anpr::allocate_fps serves priority levels in order with floors
+ * kept, that anpr::InferenceScheduler leaves cameras alone while the device
+ * keeps up, skips the frames and OCR crops of lower priorities when the
+ * device budget or the queue latency is exceeded, and measures throughput
+ * and queue latency per camera. Time is simulated. No Hailo device required.
+ */
+
+#include "scheduler.hpp"
+#include <cmath>
+#include <cstdio>
+#include <string>
+
+static int failures = 0;
+
+#define CHECK(cond)                                                        \
+    do {                                                                   \
+        if (!(cond)) {                                                     \
+            std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__,    \
+                         __LINE__, #cond);                                 \
+            failures++;                                                    \
+        }                                                                  \
+    } while (0)
+
+static bool near(float a, float b, float tolerance) {
+    return std::fabs(a - b) <= tolerance;
+}
+
+static anpr::CameraSchedule schedule_of(const std::string& key) {
+    for (const anpr::CameraSchedule& s : anpr::InferenceScheduler::instance().cameras()) {
+        if (key == s.key) return s;
+    }
+    return anpr::CameraSchedule{};
+}
+
+/**
+ * Run cameras at 30 fps each for `seconds`; frames that are admitted come
+ * back from detection after `latency_ms`.
+ */
+static uint64_t run(uint64_t start_ns, float seconds, const char* const* keys, int count, float latency_ms) {
+    anpr::InferenceScheduler& scheduler = anpr::InferenceScheduler::instance();
+    const uint64_t frame_ns = 1000000000ull / 30;
+    const uint64_t latency_ns = static_cast<uint64_t>(latency_ms * 1e6f);
+    const int frames = static_cast<int>(seconds * 30);
+    uint64_t now = start_ns;
+    for (int f = 0; f < frames; f++, now += frame_ns) {
+        for (int c = 0; c < count; c++) {
+            if (scheduler.admit_frame(keys[c], now)) scheduler.report_inferred(keys[c], now + latency_ns);
+        }
+    }
+    return now;
+}
+
+static void test_allocate() {
+    const int priority[] = {2, 1, 1, 0};
+    const float demand[] = {30.0f, 30.0f, 10.0f, 30.0f};
+    const float min_fps[] = {1.0f, 1.0f, 1.0f, 2.0f};
+    float grant[4];
+
+    // Everything fits
+    anpr::allocate_fps(priority, demand, min_fps, 4, 200.0f, grant);
+    for (int i = 0; i < 4; i++) CHECK(near(grant[i], demand[i], 1e-3f));
+
+    // 60: the top camera in full, level 1 shares the rest by demand, level 0 keeps its floor
+    anpr::allocate_fps(priority, demand, min_fps, 4, 60.0f, grant);
+    CHECK(near(grant[0], 30.0f, 1e-3f));
+    CHECK(near(grant[1] + grant[2], 28.0f, 1e-3f));
+    CHECK(grant[1] > grant[2] && grant[2] > 1.0f);
+    CHECK(near(grant[3], 2.0f, 1e-3f));
+
+    // Floors are kept even when they exceed the capacity
+    anpr::allocate_fps(priority, demand, min_fps, 4, 1.0f, grant);
+    CHECK(near(grant[0], 1.0f, 1e-3f) && near(grant[3], 2.0f, 1e-3f));
+}
+
+static void test_unscheduled_cameras_pass() {
+    anpr::InferenceScheduler& scheduler = anpr::InferenceScheduler::instance();
+    CHECK(scheduler.admit_frame("unknown", 1));
+    CHECK(scheduler.admit_ocr("unknown", 5, 1) == 5);
+    CHECK(!scheduler.set_camera("", anpr::CameraBudget()));
+    CHECK(!scheduler.set_camera(std::string(40, 'x'), anpr::CameraBudget()));
+    anpr::CameraBudget negative;
+    negative.fps = -1.0f;
+    CHECK(!scheduler.set_camera("cam1", negative));
+}
+
+static void test_device_budget() {
+    anpr::InferenceScheduler& scheduler = anpr::InferenceScheduler::instance();
+    anpr::SchedulerOptions options;
+    options.device_fps = 40.0f;
+    options.target_latency_ms = 1000.0f;
+    scheduler.configure(options);
+
+    anpr::CameraBudget gate;
+    gate.priority = 10;
+    anpr::CameraBudget overview;
+    overview.priority = 0;
+    overview.min_fps = 2.0f;
+    CHECK(scheduler.set_camera("gate", gate));
+    CHECK(scheduler.set_camera("overview", overview));
+
+    // 60 fps offered, 40 available: the gate keeps its 30, the overview gets the rest
+    const char* const keys[] = {"gate", "overview"};
+    uint64_t now = run(1000000000ull, 3.0f, keys, 2, 20.0f);
+    run(now, 4.0f, keys, 2, 20.0f);
+
+    const anpr::CameraSchedule high = schedule_of("gate");
+    const anpr::CameraSchedule low = schedule_of("overview");
+    CHECK(!high.throttled && low.throttled);
+    CHECK(near(high.achieved_fps, 30.0f, 1.0f));
+    CHECK(near(low.granted_fps, 10.0f, 0.5f));
+    CHECK(near(low.achieved_fps, 10.0f, 1.5f));
+    CHECK(low.frames_skipped > 0 && high.frames_skipped == 0);
+    CHECK(near(high.queue_latency_ms, 20.0f, 0.5f));
+    CHECK(low.frames_admitted + low.frames_skipped == low.frames_offered);
+
+    // OCR follows the frame share: a third of the overview's crops
+    CHECK(near(low.ocr_share, 1.0f / 3.0f, 0.05f));
+    CHECK(scheduler.admit_ocr("overview", 9, now) == 3);
+    CHECK(scheduler.admit_ocr("gate", 9, now) == 9);
+    CHECK(schedule_of("overview").ocr_deferred == 6);
+
+    scheduler.remove_camera("gate");
+    scheduler.remove_camera("overview");
+    CHECK(scheduler.state().cameras == 0);
+}
+
+static void test_latency_controller() {
+    anpr::InferenceScheduler& scheduler = anpr::InferenceScheduler::instance();
+    anpr::SchedulerOptions options;
+    options.target_latency_ms = 100.0f;  // no device budget, latency only
+    scheduler.configure(options);
+
+    anpr::CameraBudget gate;
+    gate.priority = 1;
+    anpr::CameraBudget overview;
+    CHECK(scheduler.set_camera("lane", gate));
+    CHECK(scheduler.set_camera("wide", overview));
+
+    // Queue latency over the target: the capacity shrinks, the low priority loses first
+    const char* const keys[] = {"lane", "wide"};
+    uint64_t now = run(100000000000ull, 4.0f, keys, 2, 250.0f);
+    const anpr::SchedulerState overloaded = scheduler.state();
+    CHECK(overloaded.overloaded == 1);
+    CHECK(overloaded.scale < 0.6f);
+    CHECK(schedule_of("wide").throttled && schedule_of("wide").frames_skipped > 0);
+    CHECK(schedule_of("lane").achieved_fps > schedule_of("wide").achieved_fps);
+
+    // Latency back to normal: the scale recovers and nothing is skipped any more
+    now = run(now, 15.0f, keys, 2, 10.0f);
+    CHECK(scheduler.state().scale > 0.99f);
+    CHECK(!scheduler.state().overloaded);
+    const uint64_t skipped = schedule_of("wide").frames_skipped;
+    run(now, 2.0f, keys, 2, 10.0f);
+    CHECK(schedule_of("wide").frames_skipped == skipped);
+    CHECK(near(schedule_of("wide").achieved_fps, 30.0f, 1.0f));
+
+    scheduler.remove_camera("lane");
+    scheduler.remove_camera("wide");
+}
+
+static void test_ocr_budget() {
+    anpr::InferenceScheduler& scheduler = anpr::InferenceScheduler::instance();
+    scheduler.configure(anpr::SchedulerOptions());
+
+    anpr::CameraBudget budget;
+    budget.ocr_fps = 10.0f;
+    CHECK(scheduler.set_camera("ocr", budget));
+
+    // 4 crops per frame at 30 fps against 10 crops/s, starting with a full burst
+    size_t admitted = 0;
+    uint64_t now = 200000000000ull;
+    for (int f = 0; f < 90; f++, now += 1000000000ull / 30) admitted += scheduler.admit_ocr("ocr", 4, now);
+    CHECK(admitted >= 36 && admitted <= 42);
+    CHECK(schedule_of("ocr").ocr_admitted == admitted);
+    CHECK(schedule_of("ocr").ocr_deferred == 360 - admitted);
+    scheduler.remove_camera("ocr");
+}
+
+int main() {
+    test_allocate();
+    test_unscheduled_cameras_pass();
+    test_device_budget();
+    test_latency_controller();
+    test_ocr_budget();
+
+    if (failures) {
+        std::fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    std::printf("All scheduler tests passed\n");
+    return 0;
+}
@@ -0,0 +1,159 @@
+/**
+ * Stage stats tests
+ *
+ * Checks the log-linear bucket layout and quantiles of
+ * anpr::LatencyHistogram, the per-thread entries of anpr::StageRegistry and
+ * their rebinding by anpr::ThreadStage when a thread is renamed.
+ * No Hailo device required.
+ */
+
+#include "stage_stats.hpp"
+#include <pthread.h>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+static int failures = 0;
+
+#define CHECK(cond)                                                        \
+    do {                                                                   \
+        if (!(cond)) {                                                     \
+            std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__,    \
+                         __LINE__, #cond);                                 \
+            failures++;                                                    \
+        }                                                                  \
+    } while (0)
+
+using anpr::LatencyHistogram;
+
+static void test_buckets() {
+    // Buckets are contiguous and every value lands in the bucket covering it
+    for (int b = 0; b + 1 < LatencyHistogram::kBuckets; b++) {
+        const uint64_t lower = LatencyHistogram::bucket_lower(b);
+        const uint64_t upper = LatencyHistogram::bucket_lower(b + 1);
+        CHECK(upper > lower);
+        CHECK(LatencyHistogram::bucket_of(lower) == b);
+        CHECK(LatencyHistogram::bucket_of(upper - 1) == b);
+        // At most 12.5% relative bucket width
+        if (lower >= 8) CHECK((upper - lower) * 8 <= lower);
+    }
+    CHECK(LatencyHistogram::bucket_of(0) == 0);
+    CHECK(LatencyHistogram::bucket_of(~0ull) == LatencyHistogram::kBuckets - 1);
+    CHECK(LatencyHistogram::bucket_lower(LatencyHistogram::kBuckets - 1) > 30000000000ull);  // > 30 s
+}
+
+static void test_quantiles() {
+    LatencyHistogram histogram;
+    CHECK(histogram.quantile(0.5) == 0);
+
+    // 1..1000 us uniformly
+    for (uint64_t us = 1; us <= 1000; us++) histogram.record(us * 1000);
+    const uint64_t p50 = histogram.quantile(0.50);
+    const uint64_t p99 = histogram.quantile(0.99);
+    CHECK(p50 >= 500000 && p50 <= 500000 * 9 / 8);
+    CHECK(p99 >= 990000 && p99 <= 990000 * 9 / 8);
+    CHECK(histogram.quantile(1.0) >= 1000000);
+}
+
+static void test_registry() {
+    anpr::StageRegistry& registry = anpr::StageRegistry::instance();
+    pthread_setname_np(pthread_self(), "cam1_det:src");
+    anpr::StageStats& detection = registry.thread_stage("plate_detection", {"candidates", "detections"});
+    CHECK(&registry.thread_stage("plate_detection", {}) == &detection);
+
+    detection.record(2000);
+    detection.record(4000);
+    detection.add(0, 12);
+    detection.add(1, 2);
+    {
+        anpr::StageTimer timer(detection);
+    }
+
+    // Same stage on another thread is a separate entry
+    std::thread other([&] {
+        pthread_setname_np(pthread_self(), "cam2_det:src");
+        anpr::StageStats& stats = registry.thread_stage("plate_detection", {"candidates", "detections"});
+        CHECK(&stats != &detection);
+        stats.record(1000);
+    });
+    other.join();
+
+    const std::vector<anpr::StageStatsSnapshot> snapshots = registry.snapshots();
+    CHECK(snapshots.size() == 2);
+    const anpr::StageStatsSnapshot& s = snapshots[0];
+    CHECK(std::string(s.thread) == "cam1_det:src");
+    CHECK(std::string(s.stage) == "plate_detection");
+    CHECK(s.calls == 3);
+    CHECK(s.total_ns >= 6000);
+    CHECK(s.max_ns >= 4000);
+    CHECK(s.p50_ns >= 2000 && s.p50_ns <= s.max_ns);
+    CHECK(s.counters[0] == 12 && s.counters[1] == 2 && s.counters[2] == 0);
+    CHECK(std::string(s.counter_names[0]) == "candidates");
+    CHECK(std::string(s.counter_names[2]).empty());
+    CHECK(std::string(snapshots[1].thread) == "cam2_det:src");
+
+    std::vector<uint64_t> buckets(LatencyHistogram::kBuckets);
+    CHECK(registry.histogram(1, buckets.data()));
+    CHECK(buckets[LatencyHistogram::bucket_of(1000)] == 1);
+    CHECK(!registry.histogram(2, buckets.data()));
+}
+
+static void test_concurrent_reader() {
+    // One writer, one reader taking snapshots: counts only grow
+    anpr::StageStats stats("cam9_ocr:src", "plate_ocr", {"crops"});
+    std::thread writer([&] {
+        for (uint64_t i = 0; i < 100000; i++) {
+            stats.record(i % 5000);
+            stats.add(0);
+        }
+    });
+
+    uint64_t last_calls = 0;
+    bool monotonic = true;
+    for (int i = 0; i < 200; i++) {
+        const anpr::StageStatsSnapshot s = stats.snapshot();
+        monotonic = monotonic && s.calls >= last_calls;
+        last_calls = s.calls;
+    }
+    writer.join();
+
+    CHECK(monotonic);
+    const anpr::StageStatsSnapshot s = stats.snapshot();
+    CHECK(s.calls == 100000 && s.counters[0] == 100000);
+    CHECK(s.max_ns == 4999);
+    CHECK(s.p99_ns <= s.max_ns);
+}
+
+static void test_renamed_thread() {
+    // A pooled streaming thread reused by another camera's pipeline
+    std::string first, second;
+    std::thread worker([&] {
+        static thread_local anpr::ThreadStage stage("plate_ocr", {"crops"});
+        pthread_setname_np(pthread_self(), "cam5_ocr:src");
+        stage.get().add(0);
+        first = stage.get().thread();
+        pthread_setname_np(pthread_self(), "cam6_ocr:src");
+        stage.get().add(0);
+        second = stage.get().thread();
+    });
+    worker.join();
+
+    CHECK(first == "cam5_ocr:src");
+    CHECK(second == "cam6_ocr:src");
+}
+
+int main() {
+    test_buckets();
+    test_quantiles();
+    test_registry();
+    test_concurrent_reader();
+    test_renamed_thread();
+
+    if (failures) {
+        std::fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    std::printf("All stage stats tests passed\n");
+    return 0;
+}
@@ -0,0 +1,179 @@
+/**
+ * Tensor capture tests
+ *
+ * Checks the per-camera rate limit, frame id tagging of OCR records, the
+ * dump size limit and that a captured dump replays through
+ * anpr::TensorDumpReader. No Hailo device required.
+ */
+
+#include "tensor_capture.hpp"
+#include <unistd.h>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+static int failures = 0;
+
+#define CHECK(cond)                                                        \
+    do {                                                                   \
+        if (!(cond)) {                                                     \
+            std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__,    \
+                         __LINE__, #cond);                                 \
+            failures++;                                                    \
+        }                                                                  \
+    } while (0)
+
+static std::string temp_path() {
+    char path[] = "/tmp/test_tensor_capture_XXXXXX";
+    const int fd = mkstemp(path);
+    if (fd >= 0) close(fd);
+    std::remove(path);
+    return path;
+}
+
+static anpr::TensorRecordHeader make_header(anpr::TensorKind kind, int height, int width) {
+    anpr::TensorRecordHeader header{};
+    header.kind = static_cast<uint32_t>(kind);
+    header.dtype = static_cast<uint32_t>(anpr::TensorDType::UInt8);
+    header.height = height;
+    header.width = width;
+    header.count = 1;
+    header.payload_bytes = static_cast<uint32_t>(height * width);
+    header.quant_scale = 1.0f / 255.0f;
+    header.stream_index = -1;
+    return header;
+}
+
+static anpr::TensorCaptureStats stats_of(const std::string& key) {
+    for (const auto& s : anpr::TensorCapture::instance().stats()) {
+        if (key == s.key) return s;
+    }
+    return anpr::TensorCaptureStats{};
+}
+
+static void test_capture_and_replay() {
+    anpr::TensorCapture& capture = anpr::TensorCapture::instance();
+    const std::string path = temp_path();
+    std::vector<uint8_t> detection(5 * 16, 7);
+    std::vector<uint8_t> ocr(4 * 6, 9);
+
+    // Not capturing: nothing is written
+    CHECK(!capture.any_active());
+    anpr::TensorRecordHeader header = make_header(anpr::TensorKind::Detection, 5, 16);
+    CHECK(capture.capture_detection("cam1", header, detection.data()) == 0);
+
+    anpr::TensorCaptureOptions options;
+    options.path = path;
+    options.max_fps = 20.0f;  // one frame per 50 ms
+    options.frame_width = 1920;
+    options.frame_height = 1080;
+    CHECK(capture.start("cam1", options));
+    CHECK(capture.any_active());
+
+    // First frame is captured, an immediate second one is rate limited
+    header = make_header(anpr::TensorKind::Detection, 5, 16);
+    const uint64_t first = capture.capture_detection("cam1", header, detection.data());
+    CHECK(first == 1);
+    header = make_header(anpr::TensorKind::Detection, 5, 16);
+    CHECK(capture.capture_detection("cam1", header, detection.data()) == 0);
+
+    // Other cameras are not captured
+    header = make_header(anpr::TensorKind::Detection, 5, 16);
+    CHECK(capture.capture_detection("cam2", header, detection.data()) == 0);
+
+    // Two crops of the captured frame
+    for (int i = 0; i < 2; i++) {
+        anpr::TensorRecordHeader ocr_header = make_header(anpr::TensorKind::OCR, 4, 6);
+        CHECK(capture.capture_ocr("cam1", first, ocr_header, ocr.data()));
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(60));
+    header = make_header(anpr::TensorKind::Detection, 5, 16);
+    CHECK(capture.capture_detection("cam1", header, detection.data()) == 2);
+
+    anpr::TensorCaptureStats s = stats_of("cam1");
+    CHECK(s.active == 1);
+    CHECK(s.frames == 2);
+    CHECK(s.ocr_records == 2);
+    CHECK(s.rate_limited == 1);
+
+    CHECK(capture.stop("cam1"));
+    CHECK(!capture.stop("cam1"));
+    CHECK(!capture.any_active());
+    header = make_header(anpr::TensorKind::Detection, 5, 16);
+    CHECK(capture.capture_detection("cam1", header, detection.data()) == 0);
+    CHECK(stats_of("cam1").active == 0);
+
+    anpr::TensorDumpReader reader;
+    CHECK(reader.open(path));
+    CHECK(std::strcmp(reader.file_header().source, "cam1") == 0);
+    const auto& records = reader.records();
+    CHECK(records.size() == 4);
+    if (records.size() == 4) {
+        CHECK(records[0].kind() == anpr::TensorKind::Detection);
+        CHECK(records[0].header->frame_id == 1);
+        CHECK(records[0].header->frame_width == 1920 && records[0].header->frame_height == 1080);
+        CHECK(records[0].header->timestamp_ns > 0);
+        CHECK(records[1].kind() == anpr::TensorKind::OCR && records[1].header->frame_id == 1);
+        CHECK(records[2].kind() == anpr::TensorKind::OCR && records[2].header->frame_id == 1);
+        CHECK(records[3].header->frame_id == 2);
+        CHECK(std::memcmp(records[1].payload, ocr.data(), ocr.size()) == 0);
+    }
+
+    reader.close();
+    std::remove(path.c_str());
+}
+
+static void test_size_limit() {
+    anpr::TensorCapture& capture = anpr::TensorCapture::instance();
+    const std::string path = temp_path();
+    std::vector<uint8_t> detection(5 * 16, 1);
+
+    // Room for the file header and two records
+    anpr::TensorCaptureOptions options;
+    options.path = path;
+    options.max_fps = 0.0f;  // every frame
+    options.max_bytes = sizeof(anpr::TensorDumpFileHeader) + 2 * (sizeof(anpr::TensorRecordHeader) + 80);
+    CHECK(capture.start("cam3", options));
+
+    int captured = 0;
+    for (int i = 0; i < 5; i++) {
+        anpr::TensorRecordHeader header = make_header(anpr::TensorKind::Detection, 5, 16);
+        captured += capture.capture_detection("cam3", header, detection.data()) != 0;
+    }
+    CHECK(captured == 2);
+
+    const anpr::TensorCaptureStats s = stats_of("cam3");
+    CHECK(s.errors == 3);
+    CHECK(s.bytes == options.max_bytes);
+    CHECK(capture.stop("cam3"));
+
+    // Restarting appends to the existing dump
+    options.max_bytes = 1u << 20;
+    CHECK(capture.start("cam3", options));
+    anpr::TensorRecordHeader header = make_header(anpr::TensorKind::Detection, 5, 16);
+    CHECK(capture.capture_detection("cam3", header, detection.data()) == 3);
+    CHECK(capture.stop("cam3"));
+
+    anpr::TensorDumpReader reader;
+    CHECK(reader.open(path));
+    CHECK(reader.records().size() == 3);
+
+    reader.close();
+    std::remove(path.c_str());
+}
+
+int main() {
+    test_capture_and_replay();
+    test_size_limit();
+
+    if (failures) {
+        std::fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    std::printf("All tensor capture tests passed\n");
+    return 0;
+}
@@ -0,0 +1,150 @@
+/**
+ * Tensor dump tests
+ *
+ * Checks the round trip of anpr::TensorDumpWriter / anpr::TensorDumpReader,
+ * appending to an existing dump and that a truncated tail record is ignored.
+ * No Hailo device required.
+ */
+
+#include "tensor_dump.hpp"
+#include <unistd.h>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+static int failures = 0;
+
+#define CHECK(cond)                                                        \
+    do {                                                                   \
+        if (!(cond)) {                                                     \
+            std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__,    \
+                         __LINE__, #cond);                                 \
+            failures++;                                                    \
+        }                                                                  \
+    } while (0)
+
+static std::string temp_path() {
+    char path[] = "/tmp/test_tensor_dump_XXXXXX";
+    const int fd = mkstemp(path);
+    if (fd >= 0) close(fd);
+    std::remove(path);
+    return path;
+}
+
+static anpr::TensorRecordHeader make_header(anpr::TensorKind kind, anpr::TensorDType dtype, int height, int width,
+                                            uint32_t count, uint64_t frame_id) {
+    anpr::TensorRecordHeader header{};
+    header.kind = static_cast<uint32_t>(kind);
+    header.dtype = static_cast<uint32_t>(dtype);
+    header.height = height;
+    header.width = width;
+    header.count = count;
+    header.payload_bytes = static_cast<uint32_t>(height * width * count * anpr::dtype_size(dtype));
+    header.quant_scale = 0.5f;
+    header.quant_zero_point = 3.0f;
+    header.frame_id = frame_id;
+    header.stream_index = -1;
+    header.frame_width = 1920;
+    header.frame_height = 1080;
+    return header;
+}
+
+static void test_round_trip() {
+    const std::string path = temp_path();
+
+    std::vector<uint8_t> detection(5 * 7);
+    for (size_t i = 0; i < detection.size(); i++) detection[i] = static_cast<uint8_t>(i);
+    std::vector<uint16_t> ocr(2 * 3 * 4);
+    for (size_t i = 0; i < ocr.size(); i++) ocr[i] = static_cast<uint16_t>(1000 + i);
+
+    {
+        anpr::TensorDumpWriter writer;
+        CHECK(writer.open(path, "cam3", 42));
+        CHECK(writer.append(make_header(anpr::TensorKind::Detection, anpr::TensorDType::UInt8, 5, 7, 1, 1),
+                            detection.data()));
+        CHECK(writer.append(make_header(anpr::TensorKind::OCR, anpr::TensorDType::UInt16, 3, 4, 2, 1), ocr.data()));
+    }
+
+    // Reopening appends after the existing records
+    {
+        anpr::TensorDumpWriter writer;
+        CHECK(writer.open(path, "ignored", 0));
+        CHECK(writer.append(make_header(anpr::TensorKind::Detection, anpr::TensorDType::UInt8, 5, 7, 1, 2),
+                            detection.data()));
+    }
+
+    anpr::TensorDumpReader reader;
+    CHECK(reader.open(path));
+    CHECK(std::strcmp(reader.file_header().source, "cam3") == 0);
+    CHECK(reader.file_header().created_ns == 42);
+    CHECK(reader.records().size() == 3);
+    if (reader.records().size() == 3) {
+        const auto& det = reader.records()[0];
+        CHECK(det.kind() == anpr::TensorKind::Detection);
+        CHECK(det.dtype() == anpr::TensorDType::UInt8);
+        CHECK(det.header->height == 5 && det.header->width == 7);
+        CHECK(det.quant().scale == 0.5f && det.quant().zero_point == 3.0f);
+        CHECK(std::memcmp(det.payload, detection.data(), detection.size()) == 0);
+
+        const auto& read = reader.records()[1];
+        CHECK(read.kind() == anpr::TensorKind::OCR);
+        CHECK(read.header->count == 2);
+        CHECK(std::memcmp(read.payload, ocr.data(), ocr.size() * sizeof(uint16_t)) == 0);
+
+        // Payloads start 8-byte aligned
+        CHECK(reinterpret_cast<uintptr_t>(read.payload) % 8 == 0);
+        CHECK(reader.records()[2].header->frame_id == 2);
+    }
+
+    reader.close();
+    std::remove(path.c_str());
+}
+
+static void test_truncated_tail() {
+    const std::string path = temp_path();
+
+    std::vector<float> payload(6 * 10, 0.25f);
+    {
+        anpr::TensorDumpWriter writer;
+        CHECK(writer.open(path, "cam1", 0));
+        for (uint64_t frame = 0; frame < 3; frame++) {
+            CHECK(writer.append(make_header(anpr::TensorKind::Detection, anpr::TensorDType::Float32, 6, 10, 1, frame),
+                                payload.data()));
+        }
+    }
+
+    // Cut the last record in half, as a crash mid-write would
+    const off_t record_bytes = sizeof(anpr::TensorRecordHeader) + payload.size() * sizeof(float);
+    const off_t full = sizeof(anpr::TensorDumpFileHeader) + 3 * record_bytes;
+    CHECK(truncate(path.c_str(), full - record_bytes / 2) == 0);
+
+    anpr::TensorDumpReader reader;
+    CHECK(reader.open(path));
+    CHECK(reader.records().size() == 2);
+
+    // Not a dump
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    const char garbage[128] = "not a tensor dump";
+    std::fwrite(garbage, sizeof(garbage), 1, file);
+    std::fclose(file);
+    anpr::TensorDumpReader other;
+    CHECK(!other.open(path));
+    anpr::TensorDumpWriter writer;
+    CHECK(!writer.open(path, "cam1", 0));
+
+    reader.close();
+    std::remove(path.c_str());
+}
+
+int main() {
+    test_round_trip();
+    test_truncated_tail();
+
+    if (failures) {
+        std::fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    std::printf("All tensor dump tests passed\n");
+    return 0;
+}
@@ -0,0 +1,147 @@
+/**
+ * OCR worker pool tests
+ *
+ * Checks that anpr::WorkerPool runs every item exactly once (inline with no
+ * workers, spread over the workers otherwise), that idle participants steal
+ * from a slow slice, that concurrent callers share the pool, and that
+ * reconfiguring under load loses no items. No Hailo device required.
+ */
+
+#include "worker_pool.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+static int failures = 0;
+
+#define CHECK(cond)                                                        \
+    do {                                                                   \
+        if (!(cond)) {                                                     \
+            std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__,    \
+                         __LINE__, #cond);                                 \
+            failures++;                                                    \
+        }                                                                  \
+    } while (0)
+
+static bool each_once(std::vector<std::atomic<int>>& hits) {
+    for (auto& hit : hits) {
+        if (hit.load() != 1) return false;
+    }
+    return true;
+}
+
+static void test_inline_without_workers() {
+    anpr::WorkerPool& pool = anpr::WorkerPool::instance();
+    CHECK(pool.configure(0));
+    CHECK(pool.threads() == 0);
+
+    const std::thread::id caller = std::this_thread::get_id();
+    std::vector<std::atomic<int>> hits(10);
+    bool on_caller = true;
+    pool.parallel_for(hits.size(), [&](size_t i) {
+        hits[i]++;
+        on_caller = on_caller && std::this_thread::get_id() == caller;
+    });
+    CHECK(each_once(hits));
+    CHECK(on_caller);
+    CHECK(pool.stats().inline_jobs >= 1);
+
+    pool.parallel_for(0, [&](size_t) { CHECK(false); });
+}
+
+static void test_parallel_and_stealing() {
+    anpr::WorkerPool& pool = anpr::WorkerPool::instance();
+    CHECK(pool.configure(3));
+    CHECK(pool.threads() == 3);
+    const anpr::WorkerPoolStats before = pool.stats();
+
+    // Results land in their own index, i.e. in ROI order after the join
+    std::vector<std::atomic<int>> hits(64);
+    std::vector<size_t> squares(64);
+    pool.parallel_for(hits.size(), [&](size_t i) {
+        hits[i]++;
+        squares[i] = i * i;
+    });
+    CHECK(each_once(hits));
+    bool ordered = true;
+    for (size_t i = 0; i < squares.size(); i++) ordered = ordered && squares[i] == i * i;
+    CHECK(ordered);
+
+    // Item 0 blocks its slice's owner; the other participants take the rest of that slice
+    std::vector<std::atomic<int>> slow_hits(16);
+    pool.parallel_for(slow_hits.size(), [&](size_t i) {
+        if (i == 0) std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        slow_hits[i]++;
+    });
+    CHECK(each_once(slow_hits));
+
+    const anpr::WorkerPoolStats after = pool.stats();
+    CHECK(after.jobs == before.jobs + 2);
+    CHECK(after.items == before.items + 80);
+    CHECK(after.worker_items > before.worker_items);
+    CHECK(after.stolen > before.stolen);
+}
+
+static void test_concurrent_callers() {
+    anpr::WorkerPool& pool = anpr::WorkerPool::instance();
+    CHECK(pool.configure(2));
+
+    // Four "streaming threads" share two workers
+    std::atomic<int> wrong{0};
+    std::vector<std::thread> callers;
+    for (int t = 0; t < 4; t++) {
+        callers.emplace_back([&] {
+            for (int frame = 0; frame < 200; frame++) {
+                std::vector<std::atomic<int>> hits(1 + frame % 9);
+                pool.parallel_for(hits.size(), [&](size_t i) { hits[i]++; });
+                if (!each_once(hits)) wrong++;
+            }
+        });
+    }
+    for (auto& caller : callers) caller.join();
+    CHECK(wrong == 0);
+}
+
+static void test_reconfigure_under_load() {
+    anpr::WorkerPool& pool = anpr::WorkerPool::instance();
+    CHECK(pool.configure(2));
+
+    std::atomic<bool> done{false};
+    std::atomic<int> wrong{0};
+    std::thread caller([&] {
+        while (!done.load()) {
+            std::vector<std::atomic<int>> hits(8);
+            pool.parallel_for(hits.size(), [&](size_t i) { hits[i]++; });
+            if (!each_once(hits)) wrong++;
+        }
+    });
+    for (int i = 0; i < 20; i++) CHECK(pool.configure(i % 4));
+    done = true;
+    caller.join();
+    CHECK(wrong == 0);
+
+    // Out of range: the pool keeps its threads
+    CHECK(pool.configure(1, {0}));
+    CHECK(!pool.configure(-1));
+    CHECK(!pool.configure(anpr::WorkerPool::kMaxThreads + 1));
+    CHECK(!pool.configure(2, {-3}));
+    CHECK(pool.threads() == 1);
+    CHECK(pool.stats().pinned_cpus == 1);
+    CHECK(pool.configure(0));
+}
+
+int main() {
+    test_inline_without_workers();
+    test_parallel_and_stealing();
+    test_concurrent_callers();
+    test_reconfigure_under_load();
+
+    if (failures) {
+        std::fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    std::printf("All worker pool tests passed\n");
+    return 0;
+}
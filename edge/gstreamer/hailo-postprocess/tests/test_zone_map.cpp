@@ -0,0 +1,157 @@
+/**
+ * Zone map tests
+ *
+ * Checks the rasterized zone lookup against a direct ray cast (the rule of
+ * ZoneTracker._point_in_polygon) on random polygons and points, and the
+ * entered/exited events of anpr::ZoneCrossing. No Hailo device required.
+ */
+
+#include "zone_map.hpp"
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+static int failures = 0;
+
+#define CHECK(cond)                                                        \
+    do {                                                                   \
+        if (!(cond)) {                                                     \
+            std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__,    \
+                         __LINE__, #cond);                                 \
+            failures++;                                                    \
+        }                                                                  \
+    } while (0)
+
+/**
+ * Reference ray cast, transcribed from edge/detection/tracker.py.
+ */
+static bool reference_contains(const std::vector<float>& polygon, float x, float y) {
+    const size_t n = polygon.size() / 2;
+    bool inside = false;
+    float p1x = polygon[0], p1y = polygon[1];
+    for (size_t i = 1; i <= n; i++) {
+        const float p2x = polygon[2 * (i % n)], p2y = polygon[2 * (i % n) + 1];
+        if (y > std::min(p1y, p2y) && y <= std::max(p1y, p2y) && x <= std::max(p1x, p2x)) {
+            float x_inters = 0.0f;
+            if (p1y != p2y) x_inters = (y - p1y) * (p2x - p1x) / (p2y - p1y) + p1x;
+            if (p1x == p2x || x <= x_inters) inside = !inside;
+        }
+        p1x = p2x;
+        p1y = p2y;
+    }
+    return inside;
+}
+
+// Star-shaped random polygon around a center, so it is simple but concave
+static std::vector<float> random_polygon(std::mt19937& rng) {
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    const float cx = 0.2f + 0.6f * unit(rng), cy = 0.2f + 0.6f * unit(rng);
+    const int n = 3 + static_cast<int>(unit(rng) * 10);
+    std::vector<float> polygon;
+    for (int i = 0; i < n; i++) {
+        const float angle = 6.2831853f * i / n;
+        const float radius = 0.05f + 0.3f * unit(rng);
+        polygon.push_back(cx + radius * std::cos(angle));
+        polygon.push_back(cy + radius * std::sin(angle));
+    }
+    return polygon;
+}
+
+static void test_lookup_matches_reference() {
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<float> unit(-0.05f, 1.05f);
+
+    for (int round = 0; round < 20; round++) {
+        anpr::ZoneMap map;
+        std::vector<std::vector<float>> polygons;
+        const int num_zones = 1 + round % 6;
+        for (int z = 0; z < num_zones; z++) {
+            polygons.push_back(random_polygon(rng));
+            CHECK(map.add_zone("zone" + std::to_string(z), polygons.back().data(),
+                               static_cast<int>(polygons.back().size() / 2)));
+        }
+        map.build(160, 120);
+
+        for (int i = 0; i < 5000; i++) {
+            const float x = unit(rng), y = unit(rng);
+            uint32_t expected = 0;
+            for (int z = 0; z < num_zones; z++) {
+                if (reference_contains(polygons[z], x, y)) expected |= uint32_t(1) << z;
+            }
+            CHECK(map.lookup(x, y) == expected);
+        }
+    }
+}
+
+static void test_axis_aligned_zone() {
+    // cameras.example.yaml entry_zone, normalized to 1920x1080
+    const float entry[] = {100 / 1920.f, 100 / 1080.f, 500 / 1920.f, 100 / 1080.f,
+                           500 / 1920.f, 400 / 1080.f, 100 / 1920.f, 400 / 1080.f};
+    anpr::ZoneMap map;
+    CHECK(map.add_zone("entry_zone", entry, 4));
+    map.build(160, 120);
+
+    CHECK(map.lookup(300 / 1920.f, 250 / 1080.f) == 1u);
+    CHECK(map.lookup(50 / 1920.f, 250 / 1080.f) == 0u);
+    CHECK(map.lookup(300 / 1920.f, 500 / 1080.f) == 0u);
+
+    // Degenerate polygons are rejected
+    CHECK(!map.add_zone("line", entry, 2));
+}
+
+static void test_crossing_events() {
+    const float left[] = {0.0f, 0.0f, 0.5f, 0.0f, 0.5f, 1.0f, 0.0f, 1.0f};
+    const float band[] = {0.4f, 0.0f, 0.6f, 0.0f, 0.6f, 1.0f, 0.4f, 1.0f};
+    anpr::ZoneMap map;
+    map.add_zone("left", left, 4);
+    map.add_zone("band", band, 4);
+    map.build(64, 48);
+
+    anpr::ZoneCrossing crossing;
+    std::vector<anpr::ZoneEvent> events;
+
+    // Track 7 moves left to right across both zones
+    for (int step = 0; step <= 100; step++) {
+        crossing.update(map, 7, 0.1f + step * 0.008f, 0.5f, events);
+    }
+
+    CHECK(events.size() == 4);
+    if (events.size() == 4) {
+        CHECK(events[0].type == anpr::ZoneEventType::Entered && events[0].zone == 0);
+        CHECK(events[1].type == anpr::ZoneEventType::Entered && events[1].zone == 1);
+        CHECK(events[2].type == anpr::ZoneEventType::Exited && events[2].zone == 0);
+        CHECK(events[3].type == anpr::ZoneEventType::Exited && events[3].zone == 1);
+        for (const auto& e : events) CHECK(e.track_id == 7);
+    }
+    CHECK(crossing.zones_of(7) == 0u);
+
+    // Standing still produces no events; removed tracks start fresh
+    events.clear();
+    crossing.update(map, 8, 0.2f, 0.5f, events);
+    crossing.update(map, 8, 0.2f, 0.5f, events);
+    CHECK(events.size() == 1);
+    crossing.remove(8);
+    crossing.update(map, 8, 0.2f, 0.5f, events);
+    CHECK(events.size() == 2);
+
+    // A full table evicts the least recently updated track
+    for (uint64_t id = 100; id < 100 + anpr::ZoneCrossing::kMaxTracks; id++) {
+        crossing.update(map, id, 0.2f, 0.5f, events);
+    }
+    CHECK(crossing.zones_of(8) == 0u);
+    CHECK(crossing.zones_of(100 + anpr::ZoneCrossing::kMaxTracks - 1) == 1u);
+}
+
+int main() {
+    test_lookup_matches_reference();
+    test_axis_aligned_zone();
+    test_crossing_events();
+
+    if (failures) {
+        std::fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    std::printf("All zone map tests passed\n");
+    return 0;
+}
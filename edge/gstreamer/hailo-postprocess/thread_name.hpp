@@ -0,0 +1,74 @@
+/**
+ * Per-thread values derived from the streaming thread's name.
+ *
+ * Several plugins key process-wide state by the calling thread's name
+ * ("cam3_ocr:src"): event rings, stage stats, crop pools, evidence sources
+ * and the camera key of single-stream pipelines. GStreamer names a streaming
+ * thread after its task each time a task starts on it, but its task pool
+ * reuses threads across pipelines, so after a camera pipeline is torn down
+ * and rebuilt a thread that served cam3 may serve cam5. A value cached for
+ * the thread's whole life would then keep cam3's ring and stats.
+ *
+ * ThreadNameCache compares the name on every use (one prctl for the calling
+ * thread) and derives the value again when the name changed.
+ */
+
+#pragma once
+
+#include <pthread.h>
+
+#include <cstddef>
+#include <cstring>
+#include <string>
+
+namespace anpr {
+
+constexpr size_t kThreadNameLength = 16;  // Linux limit, terminator included
+
+/**
+ * Name of the calling thread, `fallback` if it cannot be read.
+ */
+inline void current_thread_name(char (&name)[kThreadNameLength], const char* fallback) {
+    std::strncpy(name, fallback, kThreadNameLength - 1);
+    name[kThreadNameLength - 1] = '\0';
+    if (pthread_getname_np(pthread_self(), name, kThreadNameLength) != 0) {
+        std::strncpy(name, fallback, kThreadNameLength - 1);
+    }
+}
+
+/**
+ * A value of the calling thread, re-derived when the thread is renamed.
+ * Keep one in a static thread_local at the call site.
+ */
+template <typename T>
+class ThreadNameCache {
+public:
+    /**
+     * Value for the thread's current name.
+     *
+     * @param fallback: Name used if the thread's name cannot be read
+     * @param make: Called with the name as make(const char*) on first use
+     *              and whenever the name changed since the previous call
+     */
+    template <typename Make>
+    T& get(const char* fallback, Make make) {
+        char name[kThreadNameLength];
+        current_thread_name(name, fallback);
+        if (!bound_ || std::strcmp(name, name_) != 0) {
+            value_ = make(static_cast<const char*>(name));
+            std::memcpy(name_, name, sizeof(name_));
+            bound_ = true;
+        }
+        return value_;
+    }
+
+    // Name the value was derived for, empty before the first get()
+    const char* name() const { return name_; }
+
+private:
+    char name_[kThreadNameLength] = {};
+    bool bound_ = false;
+    T value_{};
+};
+
+}  // namespace anpr
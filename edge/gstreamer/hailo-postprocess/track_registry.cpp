@@ -0,0 +1,84 @@
+/**
+ * Shared track read registry (libanpr_core.so), see track_registry.hpp.
+ */
+
+#include "track_registry.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace anpr {
+
+TrackRegistry& TrackRegistry::instance() {
+    static TrackRegistry registry;
+    return registry;
+}
+
+uint64_t TrackRegistry::new_track() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const uint64_t id = next_id_++;
+    Slot& s = slot(id);
+    s.track_id = id;
+    s.read = TrackRead();
+    return id;
+}
+
+void TrackRegistry::report_read(uint64_t track_id, const char* text, int length, float confidence,
+                                const float* char_confidences, uint64_t trace_frame) {
+    if (track_id == 0 || length <= 0) return;
+    length = std::min(length, kMaxPlateChars);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    Slot& s = slot(track_id);
+    if (s.track_id != track_id) return;  // Slot reused by a newer track
+
+    TrackRead& read = s.read;
+    const bool same = std::strlen(read.text) == static_cast<size_t>(length) &&
+                      std::memcmp(read.text, text, length) == 0;
+    if (same) {
+        read.agreeing_reads++;
+        read.confidence = std::max(read.confidence, confidence);
+    } else {
+        std::memcpy(read.text, text, length);
+        read.text[length] = '\0';
+        read.agreeing_reads = 1;
+        read.confidence = confidence;
+    }
+    read.total_reads++;
+    if (trace_frame) read.trace_frame = trace_frame;
+
+    read.consensus.add(text, char_confidences, length, confidence);
+}
+
+void TrackRegistry::mark_decided(uint64_t track_id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Slot& s = slot(track_id);
+    if (track_id != 0 && s.track_id == track_id) s.read.decided = true;
+}
+
+bool TrackRegistry::claim_evidence(uint64_t track_id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Slot& s = slot(track_id);
+    if (track_id == 0 || s.track_id != track_id || !s.read.decided || s.read.evidence_taken) return false;
+    s.read.evidence_taken = true;
+    return true;
+}
+
+bool TrackRegistry::read(uint64_t track_id, TrackRead& out) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const Slot& s = slot(track_id);
+    if (track_id == 0 || s.track_id != track_id || s.read.total_reads == 0) return false;
+    out = s.read;
+    return true;
+}
+
+void TrackRegistry::forget(uint64_t track_id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Slot& s = slot(track_id);
+    if (s.track_id == track_id) {
+        s.track_id = 0;
+        s.read = TrackRead();
+    }
+}
+
+}  // namespace anpr
@@ -0,0 +1,101 @@
+/**
+ * Process-wide plate read state per track, shared by the crop and OCR stages.
+ *
+ * The cropper assigns each plate track an id and tags its crops with it; the
+ * OCR filter reports accepted reads for that id back here, so the cropper
+ * can tell when a track already has a stable read. The registry lives in
+ * libanpr_core.so, which libplate_crop.so and libplate_ocr.so both link, so
+ * there is a single instance per process even though hailocropper and
+ * hailofilter dlopen() the plugins separately.
+ *
+ * Reads are also fused per character across the track's frames
+ * (plate_consensus.hpp); plate_tracker decides the track's plate from that
+ * consensus and marks the track decided, after which the cropper stops
+ * sending its crops to OCR.
+ *
+ * Ids are process-unique, so tracks of different pipelines never collide.
+ * Storage is a fixed table indexed by id; a slot is reused by the track
+ * kSlots ids later, long after the old track ended.
+ */
+
+#pragma once
+
+#include "plate_consensus.hpp"
+#include "plate_text.hpp"
+
+#include <cstdint>
+#include <mutex>
+
+namespace anpr {
+
+struct TrackRead {
+    char text[kMaxPlateChars + 1] = {};  // latest read
+    float confidence = 0.0f;  // best confidence among the agreeing reads
+    uint32_t agreeing_reads = 0;  // consecutive reads of the same text
+    uint32_t total_reads = 0;
+    uint64_t trace_frame = 0;  // frame_trace.hpp id of the latest read's frame, 0 if not traced
+
+    // Character-level vote over the track's lifetime
+    PlateConsensus consensus;
+    bool decided = false;  // the track's plate was emitted, no more OCR needed
+    bool evidence_taken = false;  // crop_plates took the decided track's snapshot (evidence.hpp)
+};
+
+class TrackRegistry {
+public:
+    static constexpr uint32_t kSlots = 4096;  // power of two
+
+    static TrackRegistry& instance();
+
+    uint64_t new_track();
+
+    /**
+     * Record an accepted OCR read for a track. A read that disagrees with the
+     * current text restarts the agreement count; every read adds to the
+     * track's consensus.
+     *
+     * @param char_confidences: Per-character confidences of `text`, nullptr
+     *                          to weigh all characters with `confidence`
+     * @param trace_frame: Traced frame the read comes from (frame_trace.hpp)
+     */
+    void report_read(uint64_t track_id, const char* text, int length, float confidence,
+                     const float* char_confidences = nullptr, uint64_t trace_frame = 0);
+
+    /**
+     * Mark a track's plate as emitted; the cropper skips its crops from then on.
+     */
+    void mark_decided(uint64_t track_id);
+
+    /**
+     * Claim the evidence snapshot of a decided track.
+     *
+     * @return: true once per track, for the first call after mark_decided
+     */
+    bool claim_evidence(uint64_t track_id);
+
+    /**
+     * Current read state of a track.
+     *
+     * @return: false if the track has no reads (or its slot was reused)
+     */
+    bool read(uint64_t track_id, TrackRead& out) const;
+
+    void forget(uint64_t track_id);
+
+private:
+    struct Slot {
+        uint64_t track_id = 0;
+        TrackRead read;
+    };
+
+    TrackRegistry() = default;
+
+    Slot& slot(uint64_t track_id) { return slots_[track_id & (kSlots - 1)]; }
+    const Slot& slot(uint64_t track_id) const { return slots_[track_id & (kSlots - 1)]; }
+
+    mutable std::mutex mutex_;
+    uint64_t next_id_ = 1;  // 0 means "no track"
+    Slot slots_[kSlots];
+};
+
+}  // namespace anpr
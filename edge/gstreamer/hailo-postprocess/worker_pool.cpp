@@ -0,0 +1,186 @@
+/**
+ * Shared OCR worker pool (libanpr_core.so), see worker_pool.hpp.
+ */
+
+#include "worker_pool.hpp"
+
+#include <pthread.h>
+#include <sched.h>
+
+#include <algorithm>
+#include <cstdio>
+
+namespace anpr {
+
+WorkerPool& WorkerPool::instance() {
+    static WorkerPool pool;
+    return pool;
+}
+
+WorkerPool::~WorkerPool() {
+    std::lock_guard<std::mutex> configure_lock(configure_mutex_);
+    stop_workers();
+}
+
+bool WorkerPool::configure(int threads, const std::vector<int>& cpus) {
+    if (threads < 0 || threads > kMaxThreads) return false;
+    for (const int cpu : cpus) {
+        if (cpu < 0 || cpu >= CPU_SETSIZE) return false;
+    }
+
+    std::lock_guard<std::mutex> configure_lock(configure_mutex_);
+    stop_workers();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    pinned_cpus_ = threads ? static_cast<uint32_t>(cpus.size()) : 0;
+    for (int i = 0; i < threads; i++) {
+        const int cpu = cpus.empty() ? -1 : cpus[i % cpus.size()];
+        workers_.emplace_back(&WorkerPool::worker_loop, this, generation_, cpu);
+    }
+    return true;
+}
+
+void WorkerPool::stop_workers() {
+    std::vector<std::thread> workers;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        generation_++;
+        workers.swap(workers_);
+    }
+    wake_.notify_all();
+    for (auto& worker : workers) worker.join();
+}
+
+int WorkerPool::threads() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return static_cast<int>(workers_.size());
+}
+
+WorkerPoolStats WorkerPool::stats() const {
+    WorkerPoolStats stats = {};
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats.threads = static_cast<uint32_t>(workers_.size());
+        stats.pinned_cpus = pinned_cpus_;
+    }
+    stats.jobs = jobs_.load(std::memory_order_relaxed);
+    stats.inline_jobs = inline_jobs_.load(std::memory_order_relaxed);
+    stats.items = items_.load(std::memory_order_relaxed);
+    stats.worker_items = worker_items_.load(std::memory_order_relaxed);
+    stats.stolen = stolen_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void WorkerPool::run_items(size_t n, ItemFn fn, void* context) {
+    if (n == 0) return;
+    items_.fetch_add(n, std::memory_order_relaxed);
+
+    Job job;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        job.num_slices = static_cast<int>(std::min(workers_.size() + 1, n));
+    }
+    if (job.num_slices == 1) {
+        inline_jobs_.fetch_add(1, std::memory_order_relaxed);
+        for (size_t i = 0; i < n; i++) fn(context, i);
+        return;
+    }
+    jobs_.fetch_add(1, std::memory_order_relaxed);
+
+    // Contiguous slices, the first n % num_slices one item longer
+    job.fn = fn;
+    job.context = context;
+    size_t begin = 0;
+    for (int s = 0; s < job.num_slices; s++) {
+        const size_t size = n / job.num_slices + (static_cast<size_t>(s) < n % job.num_slices);
+        job.slices[s].next.store(begin, std::memory_order_relaxed);
+        job.slices[s].end = begin + size;
+        begin += size;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queue_.push_back(&job);
+    }
+    wake_.notify_all();
+
+    run(job, false);
+
+    // Workers may still be finishing claimed items; the job lives on this stack
+    std::unique_lock<std::mutex> lock(mutex_);
+    queue_.erase(std::remove(queue_.begin(), queue_.end(), &job), queue_.end());
+    job.finished.wait(lock, [&] { return job.done.load(std::memory_order_acquire) == n && job.active == 0; });
+}
+
+size_t WorkerPool::run(Job& job, bool worker) {
+    const int slot = job.joined.fetch_add(1, std::memory_order_relaxed) % job.num_slices;
+
+    size_t count = 0;
+    size_t stolen = 0;
+    for (int k = 0; k < job.num_slices; k++) {
+        Slice& slice = job.slices[(slot + k) % job.num_slices];
+        for (size_t i = slice.next.fetch_add(1, std::memory_order_relaxed); i < slice.end;
+             i = slice.next.fetch_add(1, std::memory_order_relaxed)) {
+            job.fn(job.context, i);
+            count++;
+            stolen += k > 0;
+        }
+    }
+
+    if (worker) worker_items_.fetch_add(count, std::memory_order_relaxed);
+    stolen_.fetch_add(stolen, std::memory_order_relaxed);
+    job.done.fetch_add(count, std::memory_order_release);
+    return count;
+}
+
+void WorkerPool::worker_loop(uint64_t generation, int cpu) {
+    pthread_setname_np(pthread_self(), "anpr_ocr_pool");
+    if (cpu >= 0) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0) {
+            std::fprintf(stderr, "worker_pool: cannot pin worker to CPU %d\n", cpu);
+        }
+    }
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        wake_.wait(lock, [&] { return generation_ != generation || !queue_.empty(); });
+        if (generation_ != generation) return;
+
+        Job* job = queue_.front();
+        job->active++;
+        lock.unlock();
+        run(*job, true);
+        lock.lock();
+
+        // Every item of the job is claimed once run() returns; stop offering it
+        queue_.erase(std::remove(queue_.begin(), queue_.end(), job), queue_.end());
+        if (--job->active == 0) job->finished.notify_all();
+    }
+}
+
+}  // namespace anpr
+
+/**
+ * Size the shared OCR worker pool, e.g. before the pipelines start.
+ *
+ * @param threads: Worker count, 0 to decode on the streaming threads
+ * @param cpus: CPUs to pin the workers to (worker i on cpus[i % num_cpus]),
+ *              or nullptr
+ * @return: 1 if applied, 0 if the arguments are out of range
+ */
+extern "C" int worker_pool_configure(int threads, const int* cpus, size_t num_cpus) {
+    std::vector<int> cpu_list;
+    if (cpus) cpu_list.assign(cpus, cpus + num_cpus);
+    if (!anpr::WorkerPool::instance().configure(threads, cpu_list)) {
+        std::fprintf(stderr, "worker_pool: ignoring configuration (%d threads, %zu CPUs)\n", threads, num_cpus);
+        return 0;
+    }
+    return 1;
+}
+
+extern "C" void worker_pool_stats(anpr::WorkerPoolStats* out) {
+    *out = anpr::WorkerPool::instance().stats();
+}
@@ -0,0 +1,121 @@
+/**
+ * Process-wide worker pool for the per-crop OCR postprocess.
+ *
+ * plate_ocr's batched entry point hands the crops of a frame to the pool,
+ * which decodes and validates them in parallel and returns once all are done,
+ * so results stay in ROI order and the buffer is only pushed downstream
+ * after the join. The pool lives in libanpr_core.so and is shared by every
+ * camera pipeline of the process; its size and CPU affinity are set once
+ * through worker_pool_configure (e.g. pinned to the cores the H.264 decoders
+ * do not use).
+ *
+ * A job's items are split into one contiguous slice per participant: the
+ * calling streaming thread always takes part, so a job completes even when
+ * every worker is busy with another camera's frame, and a participant that
+ * runs out of items steals from the other slices. With no workers configured
+ * (the default) parallel_for runs the items inline.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace anpr {
+
+struct WorkerPoolStats {
+    uint32_t threads;
+    uint32_t pinned_cpus;
+    uint64_t jobs;         // parallel_for calls handed to the workers
+    uint64_t inline_jobs;  // run on the caller alone (no workers, single item)
+    uint64_t items;
+    uint64_t worker_items;  // items run by pool threads rather than the caller
+    uint64_t stolen;        // items taken from another participant's slice
+};
+
+class WorkerPool {
+public:
+    static constexpr int kMaxThreads = 32;
+
+    static WorkerPool& instance();
+
+    /**
+     * Replace the pool's threads. Jobs in flight complete on their callers.
+     *
+     * @param threads: Worker count, 0 to run every job inline
+     * @param cpus: CPUs the workers are pinned to, worker i on
+     *              cpus[i % size]; empty to leave affinity alone
+     * @return: false if threads is out of range (the pool is unchanged)
+     */
+    bool configure(int threads, const std::vector<int>& cpus = {});
+
+    /**
+     * Run fn(i) for every i in [0, n) and return when all have finished.
+     * fn must be safe to call concurrently for different i; it is called
+     * through a pointer, so capturing lambdas do not allocate.
+     */
+    template <typename Fn>
+    void parallel_for(size_t n, Fn&& fn) {
+        using Callable = std::remove_reference_t<Fn>;
+        run_items(n, [](void* context, size_t i) { (*static_cast<Callable*>(context))(i); }, &fn);
+    }
+
+    int threads() const;
+    WorkerPoolStats stats() const;
+
+    ~WorkerPool();
+
+private:
+    static constexpr int kMaxSlices = kMaxThreads + 1;
+
+    struct Slice {
+        alignas(64) std::atomic<size_t> next{0};
+        size_t end = 0;
+    };
+
+    using ItemFn = void (*)(void* context, size_t i);
+
+    struct Job {
+        ItemFn fn = nullptr;
+        void* context = nullptr;
+        int num_slices = 0;
+        Slice slices[kMaxSlices];
+        std::atomic<int> joined{0};  // participants so far, hands out their slices
+        std::atomic<size_t> done{0};
+        int active = 0;  // workers inside run(), under mutex_
+        std::condition_variable finished;
+    };
+
+    WorkerPool() = default;
+
+    void run_items(size_t n, ItemFn fn, void* context);
+
+    void worker_loop(uint64_t generation, int cpu);
+    void stop_workers();
+
+    // Run items starting with the participant's own slice; returns the number run
+    size_t run(Job& job, bool worker);
+
+    std::mutex configure_mutex_;  // serializes configure() and the destructor
+    mutable std::mutex mutex_;
+    std::condition_variable wake_;
+    std::deque<Job*> queue_;  // jobs with items left to claim
+    std::vector<std::thread> workers_;
+    uint64_t generation_ = 0;  // bumped to retire the current workers
+    uint32_t pinned_cpus_ = 0;
+
+    std::atomic<uint64_t> jobs_{0};
+    std::atomic<uint64_t> inline_jobs_{0};
+    std::atomic<uint64_t> items_{0};
+    std::atomic<uint64_t> worker_items_{0};
+    std::atomic<uint64_t> stolen_{0};
+};
+
+}  // namespace anpr
@@ -0,0 +1,322 @@
+/**
+ * Zone polygons compiled into a raster lookup, and per-track zone crossing.
+ *
+ * ZoneMap rasterizes all zone polygons once (normalized coordinates) into a
+ * grid of cells. Every cell stores
+ *  - `inside`:   zones that cover the whole cell
+ *  - `boundary`: zones with an edge through the cell
+ * so a point lookup is one table read; only in boundary cells the zones of
+ * that cell are tested exactly, against just the polygon edges that span the
+ * point's grid row (per-zone edge tables bucketed by row).
+ *
+ * ZoneCrossing keeps each track's last cell and zone set: when a track stays
+ * in a non-boundary cell nothing is evaluated at all.
+ * The point-in-polygon rule matches ZoneTracker._point_in_polygon() in
+ * edge/detection/tracker.py, so crossings agree with the Python tracker.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace anpr {
+
+class ZoneMap {
+public:
+    static constexpr int kMaxZones = 32;
+
+    /**
+     * Add a zone polygon.
+     *
+     * @param points: num_points (x, y) pairs in normalized frame coordinates
+     * @return: false if the zone table is full or the polygon is degenerate
+     */
+    bool add_zone(const std::string& name, const float* points, int num_points) {
+        if (static_cast<int>(zones_.size()) >= kMaxZones || num_points < 3) return false;
+
+        Zone zone;
+        zone.name = name;
+        for (int i = 0; i < num_points; i++) {
+            const int j = (i + 1) % num_points;
+            zone.edges.push_back(Edge{points[2 * i], points[2 * i + 1], points[2 * j], points[2 * j + 1]});
+        }
+        zones_.push_back(std::move(zone));
+        built_ = false;
+        return true;
+    }
+
+    /**
+     * Build the raster. Call after adding zones and before lookups.
+     *
+     * @param cols, rows: Grid resolution (e.g. the detection input size / 4)
+     */
+    void build(int cols, int rows) {
+        cols_ = std::max(1, cols);
+        rows_ = std::max(1, rows);
+        inside_.assign(static_cast<size_t>(cols_) * rows_, 0);
+        boundary_.assign(static_cast<size_t>(cols_) * rows_, 0);
+
+        for (size_t z = 0; z < zones_.size(); z++) {
+            build_edge_table(zones_[z]);
+            mark_boundary(zones_[z], uint32_t(1) << z);
+        }
+
+        // Cells no edge passes through are entirely inside or outside: one exact test at the center
+        for (int r = 0; r < rows_; r++) {
+            for (int c = 0; c < cols_; c++) {
+                const size_t cell = static_cast<size_t>(r) * cols_ + c;
+                const float cx = (c + 0.5f) / cols_;
+                const float cy = (r + 0.5f) / rows_;
+                for (size_t z = 0; z < zones_.size(); z++) {
+                    const uint32_t bit = uint32_t(1) << z;
+                    if (!(boundary_[cell] & bit) && contains(zones_[z], cx, cy)) inside_[cell] |= bit;
+                }
+            }
+        }
+        built_ = true;
+    }
+
+    bool built() const { return built_; }
+    int num_zones() const { return static_cast<int>(zones_.size()); }
+    const std::string& zone_name(int z) const { return zones_[z].name; }
+
+    /**
+     * Grid cell of a point, or -1 outside the frame (zones may extend past
+     * the frame edge, so those points are always tested exactly).
+     */
+    int cell_of(float x, float y) const {
+        if (!(x >= 0.0f && x < 1.0f && y >= 0.0f && y < 1.0f)) return -1;
+        const int c = std::min(static_cast<int>(x * cols_), cols_ - 1);
+        const int r = std::min(static_cast<int>(y * rows_), rows_ - 1);
+        return r * cols_ + c;
+    }
+
+    bool is_boundary(int cell) const { return cell < 0 || boundary_[cell] != 0; }
+
+    /**
+     * Zones containing a point, as a bit mask (bit z = zone z).
+     */
+    uint32_t lookup(float x, float y) const { return lookup(x, y, cell_of(x, y)); }
+
+    uint32_t lookup(float x, float y, int cell) const {
+        if (cell < 0) {
+            uint32_t mask = 0;
+            for (size_t z = 0; z < zones_.size(); z++) {
+                if (contains(zones_[z], x, y)) mask |= uint32_t(1) << z;
+            }
+            return mask;
+        }
+
+        uint32_t mask = inside_[cell];
+        uint32_t pending = boundary_[cell];
+        while (pending) {
+            const int z = __builtin_ctz(pending);
+            pending &= pending - 1;
+            if (contains_banded(zones_[z], x, y)) mask |= uint32_t(1) << z;
+        }
+        return mask;
+    }
+
+private:
+    struct Edge {
+        float x0, y0, x1, y1;
+    };
+
+    struct Zone {
+        std::string name;
+        std::vector<Edge> edges;
+        std::vector<uint32_t> band_start;  // rows_ + 1 offsets into band_edges
+        std::vector<uint16_t> band_edges;  // edge indices spanning each grid row
+    };
+
+    // Ray cast to the right, same edge rule as the Python tracker
+    static bool crosses(const Edge& e, float x, float y) {
+        if (!(y > std::min(e.y0, e.y1)) || !(y <= std::max(e.y0, e.y1)) || !(x <= std::max(e.x0, e.x1))) {
+            return false;
+        }
+        // Horizontal edges are excluded by the y test above
+        const float x_inters = (y - e.y0) * (e.x1 - e.x0) / (e.y1 - e.y0) + e.x0;
+        return e.x0 == e.x1 || x <= x_inters;
+    }
+
+    static bool contains(const Zone& zone, float x, float y) {
+        bool inside = false;
+        for (const Edge& e : zone.edges) inside ^= crosses(e, x, y);
+        return inside;
+    }
+
+    bool contains_banded(const Zone& zone, float x, float y) const {
+        const int r = std::min(std::max(static_cast<int>(y * rows_), 0), rows_ - 1);
+        bool inside = false;
+        for (uint32_t i = zone.band_start[r]; i < zone.band_start[r + 1]; i++) {
+            inside ^= crosses(zone.edges[zone.band_edges[i]], x, y);
+        }
+        return inside;
+    }
+
+    // Row span [first, last] covered by an edge's y range
+    void edge_rows(const Edge& e, int& first, int& last) const {
+        const float lo = std::min(e.y0, e.y1), hi = std::max(e.y0, e.y1);
+        first = std::min(std::max(static_cast<int>(lo * rows_), 0), rows_ - 1);
+        last = std::min(std::max(static_cast<int>(hi * rows_), 0), rows_ - 1);
+    }
+
+    void build_edge_table(Zone& zone) const {
+        zone.band_start.assign(rows_ + 1, 0);
+        for (const Edge& e : zone.edges) {
+            int first, last;
+            edge_rows(e, first, last);
+            for (int r = first; r <= last; r++) zone.band_start[r + 1]++;
+        }
+        for (int r = 0; r < rows_; r++) zone.band_start[r + 1] += zone.band_start[r];
+
+        zone.band_edges.assign(zone.band_start[rows_], 0);
+        std::vector<uint32_t> fill(zone.band_start.begin(), zone.band_start.end() - 1);
+        for (size_t i = 0; i < zone.edges.size(); i++) {
+            int first, last;
+            edge_rows(zone.edges[i], first, last);
+            for (int r = first; r <= last; r++) zone.band_edges[fill[r]++] = static_cast<uint16_t>(i);
+        }
+    }
+
+    // Does segment e intersect the closed rectangle [x0, x1] x [y0, y1]? (Liang-Barsky clip)
+    static bool segment_hits_rect(const Edge& e, float x0, float y0, float x1, float y1) {
+        float t0 = 0.0f, t1 = 1.0f;
+        const float dx = e.x1 - e.x0, dy = e.y1 - e.y0;
+        const float p[4] = {-dx, dx, -dy, dy};
+        const float q[4] = {e.x0 - x0, x1 - e.x0, e.y0 - y0, y1 - e.y0};
+        for (int i = 0; i < 4; i++) {
+            if (p[i] == 0.0f) {
+                if (q[i] < 0.0f) return false;
+                continue;
+            }
+            const float t = q[i] / p[i];
+            if (p[i] < 0.0f) {
+                t0 = std::max(t0, t);
+            } else {
+                t1 = std::min(t1, t);
+            }
+            if (t0 > t1) return false;
+        }
+        return true;
+    }
+
+    void mark_boundary(const Zone& zone, uint32_t bit) {
+        for (const Edge& e : zone.edges) {
+            int first_row, last_row;
+            edge_rows(e, first_row, last_row);
+            const float lo = std::min(e.x0, e.x1), hi = std::max(e.x0, e.x1);
+            const int first_col = std::min(std::max(static_cast<int>(lo * cols_), 0), cols_ - 1);
+            const int last_col = std::min(std::max(static_cast<int>(hi * cols_), 0), cols_ - 1);
+
+            for (int r = first_row; r <= last_row; r++) {
+                for (int c = first_col; c <= last_col; c++) {
+                    if (segment_hits_rect(e, static_cast<float>(c) / cols_, static_cast<float>(r) / rows_,
+                                          static_cast<float>(c + 1) / cols_, static_cast<float>(r + 1) / rows_)) {
+                        boundary_[static_cast<size_t>(r) * cols_ + c] |= bit;
+                    }
+                }
+            }
+        }
+    }
+
+    std::vector<Zone> zones_;
+    int cols_ = 1;
+    int rows_ = 1;
+    std::vector<uint32_t> inside_;
+    std::vector<uint32_t> boundary_;
+    bool built_ = false;
+};
+
+enum class ZoneEventType { Entered, Exited };
+
+struct ZoneEvent {
+    ZoneEventType type;
+    uint64_t track_id;
+    int zone;
+};
+
+/**
+ * Per-track zone membership over a ZoneMap, fixed-size track table. When the
+ * table is full the least recently updated track is dropped, so tracks that
+ * end without remove() (e.g. never confirmed) do not leak entries.
+ */
+class ZoneCrossing {
+public:
+    static constexpr int kMaxTracks = 64;
+
+    /**
+     * Update a track's position; appends entered/exited events.
+     */
+    void update(const ZoneMap& map, uint64_t track_id, float x, float y, std::vector<ZoneEvent>& events) {
+        if (!map.built() || track_id == 0) return;
+
+        const int cell = map.cell_of(x, y);
+        int t = find(track_id);
+        if (t < 0) {
+            t = num_tracks_ < kMaxTracks ? num_tracks_++ : least_recent();
+            tracks_[t] = Entry{track_id, -1, 0, 0};  // -1: outside cell, always evaluated
+        }
+
+        Entry& entry = tracks_[t];
+        entry.last_update = ++clock_;
+        if (cell == entry.cell && !map.is_boundary(cell)) return;  // Same uniform cell: same zones
+        entry.cell = cell;
+
+        const uint32_t mask = map.lookup(x, y, cell);
+        uint32_t changed = mask ^ entry.zones;
+        while (changed) {
+            const int z = __builtin_ctz(changed);
+            changed &= changed - 1;
+            const bool entered = (mask >> z) & 1u;
+            events.push_back(ZoneEvent{entered ? ZoneEventType::Entered : ZoneEventType::Exited, track_id, z});
+        }
+        entry.zones = mask;
+    }
+
+    /**
+     * Forget a track (no events, like ZoneTracker.cleanup_object()).
+     */
+    void remove(uint64_t track_id) {
+        const int t = find(track_id);
+        if (t >= 0) tracks_[t] = tracks_[--num_tracks_];
+    }
+
+    uint32_t zones_of(uint64_t track_id) const {
+        const int t = find(track_id);
+        return t >= 0 ? tracks_[t].zones : 0;
+    }
+
+private:
+    struct Entry {
+        uint64_t track_id;
+        int cell;
+        uint32_t zones;
+        uint64_t last_update;
+    };
+
+    int least_recent() const {
+        int oldest = 0;
+        for (int t = 1; t < num_tracks_; t++) {
+            if (tracks_[t].last_update < tracks_[oldest].last_update) oldest = t;
+        }
+        return oldest;
+    }
+
+    int find(uint64_t track_id) const {
+        for (int t = 0; t < num_tracks_; t++) {
+            if (tracks_[t].track_id == track_id) return t;
+        }
+        return -1;
+    }
+
+    Entry tracks_[kMaxTracks];
+    int num_tracks_ = 0;
+    uint64_t clock_ = 0;
+};
+
+}  // namespace anpr
@@ -6,11 +6,67 @@ and Hailo AI accelerator integration for license plate detection and OCR.
 import gi
 gi.require_version('Gst', '1.0')
 from gi.repository import Gst, GLib
+import json
 import logging
-from typing import Callable, Optional
+import os
+import tempfile
+import time
+from dataclasses import dataclass, field
+from typing import Any, Callable, Dict, List, Optional
+
+from .crop_pool import read_crop_pool_stats
+from .event_ring import ZONE_EVENTS, EventDrain, read_event_ring_stats
+from .evidence import EvidenceDrain, read_evidence_stats
+from .stage_stats import read_stage_stats
+from .frame_gate import FrameGate, read_frame_gate_stats
+from .frame_trace import FrameTraceProbes, frame_latency, read_frame_trace_stats
+from .scheduler import read_scheduler_stats, remove_camera_budget, set_camera_budget
+from .postprocess_params import load_postprocess_params, merge_params, postprocess_params_version
+from .tensor_capture import read_tensor_capture_stats, start_tensor_capture, stop_tensor_capture
+from .worker_pool import read_worker_pool_stats
 
 logger = logging.getLogger(__name__)
 
+# Plate regions compiled into libplate_ocr.so (plate_region.hpp), one
+# plate_ocr_<region> and plate_ocr_frame_<region> entry point each
+OCR_REGIONS = ("eu", "lt", "us")
+
+# Elements of the zero-copy path: the V4L2 stateful decoder and the V4L2
+# memory-to-memory converter (the ISP/bcm2835-codec scaler on a Pi)
+ZERO_COPY_ELEMENTS = ("v4l2h264dec", "v4l2convert")
+
+
+def zero_copy_supported() -> bool:
+    """True if the V4L2 decoder and hardware converter elements are available"""
+    return all(Gst.ElementFactory.find(name) is not None for name in ZERO_COPY_ELEMENTS)
+
+
+def normalize_zones(zones: List[Dict[str, Any]], frame_width: int, frame_height: int,
+                    label: str = "") -> List[Dict[str, Any]]:
+    """
+    Convert zone polygons from camera pixels to normalized frame coordinates.
+
+    Args:
+        zones: Zones as {name, polygon: [[x, y], ...]} in camera pixels
+        frame_width: Camera frame width the polygons refer to
+        frame_height: Camera frame height the polygons refer to
+        label: Log prefix
+
+    Returns:
+        Zones in the plate_tracker config format
+    """
+    normalized = []
+    for zone in zones:
+        polygon = [
+            [x / frame_width, y / frame_height]
+            for x, y in zone.get("polygon", [])
+        ]
+        if len(polygon) < 3:
+            logger.warning(f"{label}: Skipping zone '{zone.get('name')}' with < 3 points")
+            continue
+        normalized.append({"name": zone.get("name", f"zone{len(normalized)}"), "polygon": polygon})
+    return normalized
+
 
 class ANPRPipeline:
     """
@@ -19,6 +75,19 @@ class ANPRPipeline:
     Pipeline flow:
     RTSP source → H.264 decode (hardware) → scale → format convert →
     Hailo detection → crop plates → Hailo OCR → results sink
+
+    With zero_copy the decoded frames stay in DMA-BUF: the V4L2 hardware
+    converter scales and converts them and hailonet and crop_plates read the
+    mapped buffers, with no CPU scaling or copies.
+
+    With dual_resolution only a tee branch is scaled down for detection;
+    hailomuxer attaches the detections to the decoded frame of the other
+    branch (the same buffer, referenced), so plates are cropped at the
+    camera's native resolution.
+
+    Results do not leave through the buffers: the OCR filter and the tracker
+    publish plate events into native rings (event_ring.py), drained here on
+    a separate thread that calls result_callback.
     """
 
     def __init__(
@@ -30,7 +99,23 @@ class ANPRPipeline:
         target_width: int = 640,
         target_height: int = 480,
         detection_threshold: float = 0.5,
-        result_callback: Optional[Callable] = None
+        result_callback: Optional[Callable] = None,
+        ocr_region: str = "eu",
+        native_tracker: bool = True,
+        zones: Optional[List[Dict[str, Any]]] = None,
+        frame_width: int = 1920,
+        frame_height: int = 1080,
+        adaptive_fps: bool = False,
+        idle_fps: float = 2.0,
+        idle_after_frames: int = 30,
+        roi_detection: bool = False,
+        roi_margin: float = 0.1,
+        postprocess: Optional[Dict[str, Any]] = None,
+        zero_copy: bool = False,
+        dual_resolution: bool = False,
+        evidence_callback: Optional[Callable] = None,
+        schedule: Optional[Dict[str, float]] = None,
+        latency_tracing: bool = False
     ):
         """
         Initialize ANPR pipeline.
@@ -43,8 +128,54 @@ class ANPRPipeline:
             target_width: Target frame width for inference
             target_height: Target frame height for inference
             detection_threshold: Detection confidence threshold
-            result_callback: Callback function for results
+            result_callback: Called as result_callback(camera_id, metadata)
+                for every plate event (plate_decided with the native tracker,
+                otherwise every accepted OCR read), from the event drain
+                thread
+            ocr_region: Plate region decoder in libplate_ocr.so (see OCR_REGIONS)
+            native_tracker: Track plates in libplate_tracker.so and emit
+                track-level events instead of per-frame detections
+            zones: Zones ({name, polygon: [[x, y], ...]} in camera pixels)
+                evaluated by the native tracker on track centers
+            frame_width: Camera frame width the zone polygons refer to
+            frame_height: Camera frame height the zone polygons refer to
+            adaptive_fps: Gate frames in front of the detection network:
+                full rate with motion or recent detections, idle_fps otherwise
+            idle_fps: Inference rate of an idle camera
+            idle_after_frames: Inferred frames without detections before a
+                camera goes idle
+            roi_detection: Infer only the zones' bounding boxes, tiled into
+                the detection input from the full-resolution frame
+            roi_margin: Margin added around each zone's bounding box, as a
+                share of its size
+            postprocess: Postprocess parameter sections ({"detection": {...},
+                "ocr": {...}, "crop": {...}}, see postprocess_params.py) over
+                the plugin defaults; detection_threshold applies unless set
+                here. Changeable at runtime with update_postprocess_params()
+            zero_copy: Keep decoded frames in DMA-BUF through the V4L2
+                hardware converter into hailonet; falls back to the CPU
+                scale/convert chain when the converter is missing or the
+                zero-copy pipeline fails to negotiate
+            dual_resolution: Detect on a downscaled tee branch and crop the
+                plates for OCR from the full-resolution decoded frame
+                (ignored with roi_detection, which crops there already)
+            evidence_callback: Called as evidence_callback(camera_id,
+                evidence) with the JPEG snapshots of each decided track
+                (see evidence.py), from the evidence drain thread; needs the
+                native tracker and the "evidence" postprocess section enabled
+            schedule: Register the camera with the process-wide inference
+                scheduler (scheduler.py): {"priority", "fps", "min_fps",
+                "ocr_fps"}, missing keys at their defaults. Its frames are
+                skipped at the frame gate and its OCR crops deferred when
+                the shared device is oversubscribed
+            latency_tracing: Trace every frame from its RTSP capture
+                timestamp through the postprocess stages (frame_trace.py);
+                plate events then carry "capture_timestamp" and per-stage
+                "latency_ms"
         """
+        if ocr_region not in OCR_REGIONS:
+            raise ValueError(f"Unknown OCR region '{ocr_region}', expected one of {OCR_REGIONS}")
+
         self.camera_id = camera_id
         self.rtsp_url = rtsp_url
         self.detection_model_path = detection_model_path
@@ -53,6 +184,37 @@ class ANPRPipeline:
         self.target_height = target_height
         self.detection_threshold = detection_threshold
         self.result_callback = result_callback
+        self.ocr_region = ocr_region
+        self.native_tracker = native_tracker
+        self.zones = zones or []
+        self.frame_width = frame_width
+        self.frame_height = frame_height
+        self.adaptive_fps = adaptive_fps
+        self.idle_fps = idle_fps
+        self.idle_after_frames = idle_after_frames
+        self.frame_gates: List[FrameGate] = []
+        self.schedule = dict(schedule) if schedule is not None else None
+        self.scheduled_keys: List[str] = []
+        self.latency_tracing = latency_tracing
+        self.trace_probes: Optional[FrameTraceProbes] = None
+        self.roi_detection = roi_detection
+        self.roi_margin = roi_margin
+        self.postprocess = merge_params({}, postprocess)
+        self.zero_copy = zero_copy
+        self.zero_copy_active = False  # chosen when the pipeline starts
+        self.dual_resolution = dual_resolution
+        self.dual_resolution_active = False  # chosen when the pipeline is built
+        # plate_tracker also evaluates the zones, so zone crossings need the native tracker
+        self.result_events = ("plate_decided",) + ZONE_EVENTS if native_tracker else ("read",)
+        self.zone_names: Dict[int, List[str]] = {}  # per stream index, -1: streams without their own zones
+        self.event_drain: Optional[EventDrain] = None
+        self.evidence_callback = evidence_callback
+        self.evidence_drain: Optional[EvidenceDrain] = None
+
+        # Element name prefix; the cropper's crop pool is reported under it
+        # (thread names are limited to 15 characters)
+        self.stream_name = f"cam{camera_id}"
+        self.label = f"Camera {camera_id}"
 
         # Initialize GStreamer
         Gst.init(None)
@@ -68,70 +230,487 @@ class ANPRPipeline:
         Returns:
             GStreamer pipeline string
         """
+        tracker = ""
+        if self.native_tracker:
+            tracker = (
+                "hailofilter function-name=plate_tracker so-path=./libplate_tracker.so "
+                f"config-path={self.write_tracker_config()} qos=false !"
+            )
+
+        rois = self.lane_rois() if self.roi_detection else []
+        if self.roi_detection and not rois:
+            logger.warning(f"{self.label}: ROI detection enabled without zones, detecting on the full frame")
+
+        self.dual_resolution_active = self.dual_resolution and not rois
+        if rois:
+            detection = self.lane_detection_chain(rois)
+        elif self.dual_resolution_active:
+            detection = self.dual_resolution_chain()
+        else:
+            detection = f"""
+                {self.source_chain(self.rtsp_url)}
+                {self.gate_element(self.stream_name)}
+                {self.trace_element(self.stream_name)}
+                hailonet hef-path={self.detection_model_path} !
+                queue name={self.stream_name}_det !
+                {self.detection_filter()}
+            """
+
         pipeline = f"""
-            rtspsrc location={self.rtsp_url} latency=200 !
+            {detection}
+            {tracker}
+            {self.ocr_chain()}
+            fakesink
+        """
+        return " ".join(pipeline.split())
+
+    def detection_filter(self) -> str:
+        """plate_detection element, loading the postprocess config when it starts"""
+        return (
+            "hailofilter function-name=plate_detection so-path=./libplate_detection.so "
+            f"config-path={self.postprocess_config_path()} qos=false !"
+        )
+
+    def ocr_chain(self, batch_size: int = 1) -> str:
+        """
+        Plate crops through the OCR network and back onto their frame, where
+        the frame-level plate_ocr filter reads all of the frame's crops at once
+        (on the OCR worker pool when it is configured)
+        """
+        name = self.stream_name
+        batch = f" batch-size={batch_size}" if batch_size > 1 else ""
+        return f"""
+            hailocropper name={name}_crop function-name=crop_plates so-path=./libplate_crop.so
+            hailoaggregator name={name}_join
+            {name}_crop. ! queue ! {name}_join.sink_0
+            {name}_crop. ! queue !
+                hailonet hef-path={self.ocr_model_path}{batch} !
+                queue name={name}_ocr !
+                {name}_join.sink_1
+            {name}_join. ! queue name={name}_read !
+            {self.ocr_filter()}
+        """
+
+    def ocr_filter(self) -> str:
+        """Frame-level plate_ocr element of the configured region, loading the postprocess config"""
+        return (
+            f"hailofilter function-name=plate_ocr_frame_{self.ocr_region} so-path=./libplate_ocr.so "
+            f"config-path={self.postprocess_config_path()} qos=false !"
+        )
+
+    def decoder(self) -> str:
+        """Hardware H.264 decoder, exporting DMA-BUF buffers on the zero-copy path"""
+        return "v4l2h264dec capture-io-mode=dmabuf" if self.zero_copy_active else "v4l2h264dec"
+
+    def decode_chain(self, rtsp_url: str) -> str:
+        """RTSP source and hardware decode, ending in the decoded frames"""
+        return f"""
+            rtspsrc location={rtsp_url} latency=200 !
             rtph264depay !
             h264parse !
-            v4l2h264dec !
+            {self.decoder()} !
+        """
+
+    def scale_chain(self) -> str:
+        """
+        Scaling and conversion to the inference size.
+
+        On the zero-copy path the V4L2 converter imports the decoder's
+        DMA-BUFs and exports RGB at the inference size, again as DMA-BUF.
+        """
+        if self.zero_copy_active:
+            return f"""
+                v4l2convert output-io-mode=dmabuf-import capture-io-mode=dmabuf !
+                video/x-raw,format=RGB,width={self.target_width},height={self.target_height} !
+            """
+        return f"""
             videoscale !
             video/x-raw,width={self.target_width},height={self.target_height} !
             videoconvert !
-            hailonet hef-path={self.detection_model_path} !
-            queue !
-            hailofilter function-name=plate_detection so-path=./libplate_detection.so qos=false !
-            hailocropper function-name=crop_plates so-path=./libplate_crop.so !
-            hailonet hef-path={self.ocr_model_path} !
-            queue !
-            hailofilter function-name=plate_ocr so-path=./libplate_ocr.so qos=false !
-            identity name=result_sink !
-            fakesink
         """
-        return " ".join(pipeline.split())
+
+    def source_chain(self, rtsp_url: str) -> str:
+        """
+        RTSP source, hardware decode and scaling to the inference size.
+
+        Returns:
+            Pipeline fragment ending in a raw video output
+        """
+        return self.decode_chain(rtsp_url) + self.scale_chain()
+
+    def dual_resolution_chain(self) -> str:
+        """
+        Dual-resolution detection: the decoded frame is teed, one branch is
+        scaled to the inference size and runs detection, and hailomuxer
+        attaches those (normalized) detections to the untouched decoded
+        frame of the other branch, which continues downstream. Both branches
+        reference the same buffer; nothing is copied at full resolution.
+
+        The full-resolution queue only has to cover the detection latency;
+        it is kept short so the frames it holds do not starve the decoder's
+        buffer pool.
+
+        Returns:
+            Pipeline fragment from the source to the full-resolution frame
+            carrying the detections
+        """
+        tee = f"{self.stream_name}_tee"
+        muxer = f"{self.stream_name}_mux"
+        return f"""
+            {self.decode_chain(self.rtsp_url)}
+            video/x-raw,format=NV12 !
+            {self.gate_element(self.stream_name)}
+            {self.trace_element(self.stream_name)}
+            tee name={tee}
+            hailomuxer name={muxer}
+            {tee}. ! queue name={self.stream_name}_full max-size-buffers=4 ! {muxer}.sink_0
+            {tee}. ! queue name={self.stream_name}_scale max-size-buffers=2 !
+                {self.scale_chain()}
+                hailonet hef-path={self.detection_model_path} !
+                queue name={self.stream_name}_det !
+                {self.detection_filter()}
+                {muxer}.sink_1
+            {muxer}. ! queue name={self.stream_name}_merged !
+        """
+
+    def lane_rois(self) -> List[List[float]]:
+        """
+        Detection ROIs: the zones' bounding boxes plus roi_margin.
+
+        Returns:
+            [x, y, width, height] per zone, normalized to the frame
+        """
+        rois = []
+        for zone in normalize_zones(self.zones, self.frame_width, self.frame_height, self.label):
+            xs = [x for x, _ in zone["polygon"]]
+            ys = [y for _, y in zone["polygon"]]
+            margin_x = (max(xs) - min(xs)) * self.roi_margin
+            margin_y = (max(ys) - min(ys)) * self.roi_margin
+            x0, y0 = max(0.0, min(xs) - margin_x), max(0.0, min(ys) - margin_y)
+            x1, y1 = min(1.0, max(xs) + margin_x), min(1.0, max(ys) + margin_y)
+            if x1 > x0 and y1 > y0:
+                rois.append([x0, y0, x1 - x0, y1 - y0])
+        return rois
+
+    def lane_detection_chain(self, rois: List[List[float]]) -> str:
+        """
+        ROI-restricted detection: the lane cropper renders the ROIs as tiles
+        of the detection input from the full-resolution frame (crop_lanes),
+        plate_detection maps the boxes back to the frame and lane_merge moves
+        them onto the full-resolution frame that continues downstream.
+
+        Returns:
+            Pipeline fragment from the source to the merged detections
+        """
+        path = os.path.join(tempfile.gettempdir(), f"anpr_{self.stream_name}_lanes.json")
+        with open(path, "w") as f:
+            json.dump({
+                "frame_size": [self.frame_width, self.frame_height],
+                "input_size": [self.target_width, self.target_height],
+                "rois": rois,
+            }, f)
+
+        cropper = f"{self.stream_name}_lane_cropper"
+        aggregator = f"{self.stream_name}_lane_agg"
+        return f"""
+            rtspsrc location={self.rtsp_url} latency=200 !
+            rtph264depay !
+            h264parse !
+            {self.decoder()} !
+            video/x-raw,format=NV12 !
+            {self.gate_element(self.stream_name)}
+            {self.trace_element(self.stream_name)}
+            queue name={self.stream_name}_lanes !
+            hailofilter function-name=lane_layout so-path=./liblane_tiles.so config-path={path} qos=false !
+            hailocropper name={cropper} function-name=crop_lanes so-path=./libplate_crop.so internal-offset=true
+            hailoaggregator name={aggregator}
+            {cropper}. ! queue ! {aggregator}.sink_0
+            {cropper}. ! queue !
+                hailonet hef-path={self.detection_model_path} !
+                queue name={self.stream_name}_det !
+                {self.detection_filter()}
+                {aggregator}.sink_1
+            {aggregator}. ! queue name={self.stream_name}_merged !
+            hailofilter function-name=lane_merge so-path=./liblane_tiles.so qos=false !
+        """
+
+    def gate_element(self, prefix: str) -> str:
+        """Element the frame gate probe attaches to (empty without adaptive_fps or a schedule)"""
+        return f"identity name={prefix}_gate !" if self.adaptive_fps or self.scheduled() else ""
+
+    def trace_element(self, prefix: str) -> str:
+        """Element whose pad probe opens the frame traces (empty without latency_tracing)"""
+        return f"identity name={prefix}_trace !" if self.latency_tracing else ""
+
+    def camera_schedules(self) -> List[tuple]:
+        """(gate element prefix, SceneActivity key, schedule or None) of every camera"""
+        return [(prefix, key, self.schedule) for prefix, key in self.gate_keys()]
+
+    def scheduled(self) -> bool:
+        return any(schedule is not None for _, _, schedule in self.camera_schedules())
+
+    def gate_keys(self) -> List[tuple]:
+        """(gate element prefix, SceneActivity key) of every camera"""
+        # plate_detection runs on the {stream_name}_det queue thread and
+        # reports under the stream name
+        return [(self.stream_name, self.stream_name)]
+
+    def attach_gates(self):
+        """Install a frame gate on every camera's gate element and register its schedule"""
+        if not self.adaptive_fps and not self.scheduled():
+            return
+        # Without adaptive_fps the gate only applies the schedule: it never goes idle
+        idle_after_frames = self.idle_after_frames if self.adaptive_fps else 2**32 - 1
+        for prefix, activity_key, schedule in self.camera_schedules():
+            if schedule is not None:
+                if set_camera_budget(activity_key, **schedule):
+                    self.scheduled_keys.append(activity_key)
+                else:
+                    logger.warning(f"{self.label}: Inference schedule of {prefix} rejected: {schedule}")
+            element = self.pipeline.get_by_name(f"{prefix}_gate")
+            gate = FrameGate(f"{prefix}_gate", activity_key, self.idle_fps, idle_after_frames)
+            if element and gate.attach(element):
+                self.frame_gates.append(gate)
+            else:
+                gate.close()
+                logger.warning(f"{self.label}: Frame gate not installed for {prefix}, inferring every frame")
+
+    def attach_tracing(self):
+        """Install the latency tracing probes behind every camera's gate and on the detection queue"""
+        if not self.latency_tracing:
+            return
+        self.trace_probes = FrameTraceProbes()
+        sources = [(f"{prefix}_trace", key) for prefix, key in self.gate_keys()]
+        if not self.trace_probes.attach(self.pipeline, sources, f"{self.stream_name}_det"):
+            logger.warning(f"{self.label}: Latency tracing probes not installed, events carry no latency")
+
+    def close_tracing(self):
+        if self.trace_probes:
+            self.trace_probes.close()
+            self.trace_probes = None
+
+    def close_gates(self):
+        for gate in self.frame_gates:
+            gate.close()
+        self.frame_gates = []
+        for key in self.scheduled_keys:
+            remove_camera_budget(key)
+        self.scheduled_keys = []
+
+    def capture_sources(self) -> List[tuple]:
+        """(camera id, tensor capture key, frame width, frame height) of every camera"""
+        # Same key as the camera's SceneActivity entry
+        return [(self.camera_id, self.stream_name, self.frame_width, self.frame_height)]
+
+    def start_tensor_capture(self, camera_id: int, path: str, max_fps: float = 1.0,
+                             max_bytes: int = 256 << 20) -> bool:
+        """
+        Capture raw detection/OCR output tensors of one camera into a tensor
+        dump (see tensor_capture.py), e.g. for bench_postprocess.
+
+        Args:
+            camera_id: Camera of this pipeline
+            path: Tensor dump to append to
+            max_fps: Captured frames per second
+            max_bytes: Stop writing once the dump reaches this size
+
+        Returns:
+            True if the capture runs
+        """
+        for source_camera, key, width, height in self.capture_sources():
+            if source_camera == camera_id:
+                started = start_tensor_capture(key, path, max_fps, max_bytes, width, height)
+                if started:
+                    logger.info(f"{self.label}: Capturing tensors of camera {camera_id} to {path}")
+                else:
+                    logger.error(f"{self.label}: Cannot capture tensors to {path}")
+                return started
+        return False
+
+    def stop_tensor_capture(self, camera_id: Optional[int] = None):
+        """Stop capturing one camera, or every camera of the pipeline"""
+        for source_camera, key, _, _ in self.capture_sources():
+            if camera_id is None or source_camera == camera_id:
+                stop_tensor_capture(key)
+
+    def tracker_config(self) -> Dict[str, Any]:
+        """plate_tracker config: the camera's zones, normalized to the frame"""
+        return {"zones": normalize_zones(self.zones, self.frame_width, self.frame_height, self.label)}
+
+    def write_tracker_config(self) -> str:
+        """
+        Write the plate_tracker config file.
+
+        Returns:
+            Path of the JSON config file
+        """
+        path = os.path.join(tempfile.gettempdir(), f"anpr_{self.stream_name}_tracker.json")
+        config = self.tracker_config()
+        with open(path, "w") as f:
+            json.dump(config, f)
+
+        # Zone events carry the zone's index in the list its stream was given
+        self.zone_names = {-1: [zone["name"] for zone in config.get("zones", [])]}
+        for stream, section in config.get("streams", {}).items():
+            self.zone_names[int(stream.rsplit("_", 1)[1])] = [zone["name"] for zone in section["zones"]]
+        return path
+
+    def camera_postprocess(self, postprocess: Dict[str, Any]) -> Dict[str, Any]:
+        """
+        Postprocess sections of one camera, with the pipeline's detection
+        threshold and, on the zero-copy path, staged crops from DMA-BUF frames
+        """
+        return merge_params({
+            "detection": {"confidence_threshold": self.detection_threshold},
+            "crop": {"dmabuf": self.zero_copy_active},
+        }, postprocess)
+
+    def postprocess_config(self) -> Dict[str, Any]:
+        """Postprocess parameters per camera key (postprocess_params.hpp)"""
+        # plate_detection, crop_plates and plate_ocr report under the stream name
+        return {"cameras": {self.stream_name: self.camera_postprocess(self.postprocess)}}
+
+    def postprocess_config_path(self) -> str:
+        return os.path.join(tempfile.gettempdir(), f"anpr_{self.stream_name}_postprocess.json")
+
+    def write_postprocess_config(self) -> str:
+        """
+        Write the postprocess config file.
+
+        Returns:
+            Path of the JSON config file
+        """
+        path = self.postprocess_config_path()
+        with open(path, "w") as f:
+            json.dump(self.postprocess_config(), f)
+        return path
+
+    def set_camera_postprocess(self, camera_id: int, postprocess: Dict[str, Any]) -> bool:
+        """Replace the stored postprocess sections of a camera of this pipeline"""
+        if camera_id != self.camera_id:
+            return False
+        self.postprocess = merge_params({}, postprocess)
+        return True
+
+    def update_postprocess_params(self, camera_id: int, postprocess: Dict[str, Any]) -> bool:
+        """
+        Change a camera's postprocess parameters while the pipeline runs.
+
+        The config file is rewritten and reloaded into the plugins' shared
+        parameter store; frames from then on use the new values.
+
+        Args:
+            camera_id: Camera of this pipeline
+            postprocess: Parameter sections replacing the camera's current ones
+
+        Returns:
+            True if the plugins picked up the parameters
+        """
+        if not self.set_camera_postprocess(camera_id, postprocess):
+            return False
+        path = self.write_postprocess_config()
+        if not self.pipeline:
+            return True  # loaded by the plugins when the pipeline starts
+        if not load_postprocess_params(path):
+            logger.error(f"{self.label}: Postprocess parameters of camera {camera_id} rejected")
+            return False
+        logger.info(f"{self.label}: Postprocess parameters of camera {camera_id} updated")
+        return True
 
     def on_message(self, bus, message):
         """Handle GStreamer bus messages"""
         t = message.type
 
         if t == Gst.MessageType.EOS:
-            logger.info(f"Camera {self.camera_id}: End-of-stream")
+            logger.info(f"{self.label}: End-of-stream")
             self.stop()
         elif t == Gst.MessageType.ERROR:
             err, debug = message.parse_error()
-            logger.error(f"Camera {self.camera_id}: Error: {err}, {debug}")
+            if self.zero_copy_active and self.is_zero_copy_error(message, err):
+                if self.fall_back_to_cpu(str(err)):
+                    return True
+            logger.error(f"{self.label}: Error: {err}, {debug}")
             self.stop()
         elif t == Gst.MessageType.WARNING:
             warn, debug = message.parse_warning()
-            logger.warning(f"Camera {self.camera_id}: Warning: {warn}, {debug}")
+            logger.warning(f"{self.label}: Warning: {warn}, {debug}")
 
         return True
 
-    def on_result(self, element, buf):
+    def stream_source(self, stream_index: int) -> tuple:
+        """(camera id, frame width, frame height) of an event's stream"""
+        return self.camera_id, self.frame_width, self.frame_height
+
+    def on_events(self, events: List[Dict[str, Any]]):
         """
-        Callback for plate detection results.
+        Hand a batch of drained plate events to result_callback.
 
-        This is called when a plate is detected and OCR'd.
+        Runs on the event drain thread; bounding boxes are converted from
+        normalized to camera pixels and zone events get their zone's name as
+        "zone". With latency_tracing, events of traced frames get
+        "capture_timestamp" and "latency_ms" (frame_latency()).
         """
-        if self.result_callback:
-            # Extract metadata from buffer
-            # This will be populated by the Hailo post-processing
-            meta = buf.get_meta("HailoDetectionMeta")
-            if meta:
-                self.result_callback(self.camera_id, meta)
+        drained_ns = time.monotonic_ns()
+        for event in events:
+            if event["event"] not in self.result_events:
+                continue
+            trace_frame, published_ns = event.pop("trace_frame"), event.pop("published_ns")
+            if self.latency_tracing:
+                event.update(frame_latency(trace_frame, published_ns, drained_ns) or {})
+            stream_index = event.pop("stream_index")
+            zone_index = event.pop("zone_index")
+            if event["event"] in ZONE_EVENTS:
+                names = self.zone_names.get(stream_index, self.zone_names.get(-1, []))
+                event["zone"] = names[zone_index] if 0 <= zone_index < len(names) else f"zone{zone_index}"
+            camera_id, width, height = self.stream_source(stream_index)
+            x, y, w, h = event["bbox"]
+            event["bbox"] = {
+                "x": int(x * width), "y": int(y * height),
+                "width": int(w * width), "height": int(h * height),
+            }
+            self.result_callback(camera_id, event)
 
-    def start(self):
-        """Start the GStreamer pipeline"""
+    def on_evidence(self, evidence: Dict[str, Any]):
+        """Hand a track's evidence snapshot to evidence_callback (evidence drain thread)"""
+        camera_id, _, _ = self.stream_source(evidence.pop("stream_index"))
+        self.evidence_callback(camera_id, evidence)
+
+    def connect_results(self):
+        """Start draining this pipeline's plate event rings and evidence snapshots"""
+        if self.result_callback and self.event_drain is None:
+            self.event_drain = EventDrain(f"{self.stream_name}_", self.on_events)
+            if not self.event_drain.start():
+                logger.warning(f"{self.label}: Plate events unavailable, no results will be reported")
+                self.event_drain = None
+        if self.evidence_callback and self.native_tracker and self.evidence_drain is None:
+            self.evidence_drain = EvidenceDrain(f"{self.stream_name}_", self.on_evidence)
+            if not self.evidence_drain.start():
+                logger.warning(f"{self.label}: Evidence snapshots unavailable")
+                self.evidence_drain = None
+
+    def disconnect_results(self):
+        """Stop the drains after delivering what is left in the rings"""
+        if self.event_drain:
+            self.event_drain.stop()
+            self.event_drain = None
+        if self.evidence_drain:
+            self.evidence_drain.stop()
+            self.evidence_drain = None
+
+    def launch(self) -> bool:
+        """Build the pipeline for the current mode and set it to PLAYING"""
         try:
-            # Create pipeline
+            # Create pipeline; the plugins load the postprocess config at init
+            self.write_postprocess_config()
             pipeline_str = self.build_pipeline()
-            logger.info(f"Camera {self.camera_id}: Creating pipeline")
+            logger.info(f"{self.label}: Creating pipeline{' (zero-copy)' if self.zero_copy_active else ''}")
             logger.debug(f"Pipeline: {pipeline_str}")
 
             self.pipeline = Gst.parse_launch(pipeline_str)
 
-            # Get result sink element and connect callback
-            result_sink = self.pipeline.get_by_name("result_sink")
-            if result_sink:
-                result_sink.connect("handoff", self.on_result)
+            self.connect_results()
+            self.attach_gates()
+            self.attach_tracing()
 
             # Setup bus
             self.bus = self.pipeline.get_bus()
@@ -141,34 +720,82 @@ class ANPRPipeline:
             # Start pipeline
             ret = self.pipeline.set_state(Gst.State.PLAYING)
             if ret == Gst.StateChangeReturn.FAILURE:
-                logger.error(f"Camera {self.camera_id}: Failed to start pipeline")
+                logger.error(f"{self.label}: Failed to start pipeline")
                 return False
+            return True
 
-            logger.info(f"Camera {self.camera_id}: Pipeline started")
+        except Exception as e:
+            logger.error(f"{self.label}: Failed to start: {e}")
+            return False
 
-            # Create main loop
-            self.loop = GLib.MainLoop()
+    def teardown(self):
+        """Drop the GStreamer pipeline, keeping the event drain and captures"""
+        if self.pipeline:
+            self.pipeline.set_state(Gst.State.NULL)
+            if self.bus:
+                self.bus.remove_signal_watch()
+            self.close_gates()
+            self.close_tracing()
+            self.pipeline = None
+            self.bus = None
 
+    @staticmethod
+    def is_zero_copy_error(message, err) -> bool:
+        """Caps negotiation failure or an error of a zero-copy V4L2 element"""
+        if err.matches(Gst.StreamError.quark(), Gst.StreamError.NOT_NEGOTIATED):
             return True
+        factory = message.src.get_factory() if isinstance(message.src, Gst.Element) else None
+        return factory is not None and factory.get_name() in ZERO_COPY_ELEMENTS
 
-        except Exception as e:
-            logger.error(f"Camera {self.camera_id}: Failed to start: {e}")
+    def fall_back_to_cpu(self, reason: str) -> bool:
+        """
+        Rebuild the pipeline with CPU scaling after the zero-copy path failed.
+
+        Returns:
+            True if the CPU pipeline is playing
+        """
+        logger.warning(f"{self.label}: Zero-copy path failed ({reason}), falling back to CPU scaling")
+        self.teardown()
+        self.zero_copy_active = False
+        return self.launch()
+
+    def start(self):
+        """Start the GStreamer pipeline"""
+        self.zero_copy_active = self.zero_copy and zero_copy_supported()
+        if self.zero_copy and not self.zero_copy_active:
+            logger.warning(f"{self.label}: No V4L2 hardware converter, using CPU scaling")
+
+        started = self.launch()
+        if not started and self.zero_copy_active:
+            started = self.fall_back_to_cpu("pipeline did not start")
+        if not started:
             return False
 
+        logger.info(f"{self.label}: Pipeline started")
+
+        # Create main loop
+        self.loop = GLib.MainLoop()
+
+        return True
+
     def run(self):
         """Run the pipeline (blocking)"""
         if self.loop:
             try:
                 self.loop.run()
             except KeyboardInterrupt:
-                logger.info(f"Camera {self.camera_id}: Interrupted by user")
+                logger.info(f"{self.label}: Interrupted by user")
                 self.stop()
 
     def stop(self):
         """Stop the pipeline"""
         if self.pipeline:
-            logger.info(f"Camera {self.camera_id}: Stopping pipeline")
+            logger.info(f"{self.label}: Stopping pipeline")
             self.pipeline.set_state(Gst.State.NULL)
+            self.close_gates()
+            self.close_tracing()
+            self.stop_tensor_capture()
+            self.disconnect_results()
 
         if self.loop:
             self.loop.quit()
@@ -183,5 +810,248 @@ class ANPRPipeline:
         return {
             "camera_id": self.camera_id,
             "state": self.pipeline.get_state(0)[1].value_nick,
+            "crop_pool": read_crop_pool_stats(prefix=f"{self.stream_name}_"),
+            # Plate events dropped because the drain thread fell behind
+            "event_ring": read_event_ring_stats(prefix=f"{self.stream_name}_"),
+            # Native per-stage latency (p50/p90/p99) and counters
+            "stages": read_stage_stats(prefix=f"{self.stream_name}_"),
+            # Actual inference rate per camera (adaptive_fps)
+            "frame_gate": [
+                gate
+                for prefix, _ in self.gate_keys()
+                for gate in read_frame_gate_stats(prefix=f"{prefix}_gate")
+            ],
+            # Tensor dumps being written (start_tensor_capture)
+            "tensor_capture": read_tensor_capture_stats(keys=[key for _, key, _, _ in self.capture_sources()]),
+            # DMA-BUF path in use (zero_copy and the hardware converter negotiated)
+            "zero_copy": self.zero_copy_active,
+            # Plates cropped from the full-resolution frame
+            "dual_resolution": self.dual_resolution_active,
+            # Bumped by every postprocess parameter reload (process-wide)
+            "postprocess_params_version": postprocess_params_version(),
+            # Shared OCR worker pool (process-wide, configure_worker_pool)
+            "ocr_pool": read_worker_pool_stats(),
+            # JPEG snapshots of decided tracks (process-wide)
+            "evidence": read_evidence_stats(),
+            # Frame traces opened and found by plate_detection (latency_tracing, process-wide)
+            "frame_trace": read_frame_trace_stats() if self.latency_tracing else {},
+            # Device budget and this pipeline's cameras: granted/achieved fps, queue latency
+            "scheduler": read_scheduler_stats(keys=self.scheduled_keys) if self.scheduled_keys else {},
             # Add more stats as needed
         }
+
+
+@dataclass
+class StreamSource:
+    """One camera of a multi-stream pipeline"""
+    camera_id: int
+    rtsp_url: str
+    zones: List[Dict[str, Any]] = field(default_factory=list)
+    frame_width: int = 1920
+    frame_height: int = 1080
+    postprocess: Dict[str, Any] = field(default_factory=dict)  # over the pipeline's sections
+    schedule: Optional[Dict[str, float]] = None  # over the pipeline's schedule
+
+
+class MultiStreamANPRPipeline(ANPRPipeline):
+    """
+    One GStreamer pipeline serving several cameras with shared networks.
+
+    Pipeline flow:
+    N × (RTSP source → H.264 decode → scale → format convert) →
+    hailoroundrobin → Hailo detection (batched) → tracker → crop plates →
+    Hailo OCR (batched) → hailostreamrouter → N × results sink
+
+    A single detection and a single OCR network group avoid switching
+    network groups per camera on the device. hailoroundrobin tags every
+    frame with its stream id (sink_<i>); the postprocess plugins keep their
+    per-stream state under it and hailostreamrouter sends each frame back
+    out on src_<i>. Plate events carry the stream index, which maps them
+    back to their camera. The native tracker always runs in this mode (see
+    plate_crop.cpp).
+    """
+
+    def __init__(
+        self,
+        sources: List[StreamSource],
+        detection_model_path: str,
+        ocr_model_path: str,
+        target_width: int = 640,
+        target_height: int = 480,
+        detection_threshold: float = 0.5,
+        result_callback: Optional[Callable] = None,
+        ocr_region: str = "eu",
+        ocr_batch_size: int = 8,
+        adaptive_fps: bool = False,
+        idle_fps: float = 2.0,
+        idle_after_frames: int = 30,
+        postprocess: Optional[Dict[str, Any]] = None,
+        zero_copy: bool = False,
+        evidence_callback: Optional[Callable] = None,
+        schedule: Optional[Dict[str, float]] = None,
+        latency_tracing: bool = False
+    ):
+        """
+        Initialize multi-stream ANPR pipeline.
+
+        Args:
+            sources: Cameras to serve; stream i is sources[i]
+            detection_model_path: Path to Hailo detection model (.hef)
+            ocr_model_path: Path to Hailo OCR model (.hef)
+            target_width: Target frame width for inference
+            target_height: Target frame height for inference
+            detection_threshold: Detection confidence threshold
+            result_callback: Callback function for results, called with the
+                camera id of the frame's source
+            ocr_region: Plate region decoder in libplate_ocr.so (see OCR_REGIONS)
+            ocr_batch_size: OCR hailonet batch size (crops of all cameras)
+            adaptive_fps: Gate each camera's frames before the funnel (see
+                ANPRPipeline)
+            idle_fps: Inference rate of an idle camera
+            idle_after_frames: Inferred frames without detections before a
+                camera goes idle
+            postprocess: Postprocess parameter sections of all cameras (see
+                ANPRPipeline); StreamSource.postprocess overrides them per
+                camera
+            zero_copy: DMA-BUF path for every camera's decode and scaling
+                (see ANPRPipeline)
+            evidence_callback: Called with the camera id of the snapshot's
+                source (see ANPRPipeline)
+            schedule: Inference schedule of every camera (see ANPRPipeline);
+                StreamSource.schedule replaces it per camera
+            latency_tracing: Trace every camera's frames (see ANPRPipeline)
+        """
+        if not sources:
+            raise ValueError("Multi-stream pipeline needs at least one source")
+
+        super().__init__(
+            camera_id=sources[0].camera_id,
+            rtsp_url=sources[0].rtsp_url,
+            detection_model_path=detection_model_path,
+            ocr_model_path=ocr_model_path,
+            target_width=target_width,
+            target_height=target_height,
+            detection_threshold=detection_threshold,
+            result_callback=result_callback,
+            ocr_region=ocr_region,
+            native_tracker=True,
+            adaptive_fps=adaptive_fps,
+            idle_fps=idle_fps,
+            idle_after_frames=idle_after_frames,
+            postprocess=postprocess,
+            zero_copy=zero_copy,
+            evidence_callback=evidence_callback,
+            schedule=schedule,
+            latency_tracing=latency_tracing
+        )
+        self.sources = list(sources)
+        self.ocr_batch_size = ocr_batch_size
+        self.stream_name = "multi"
+        self.label = f"Cameras {[s.camera_id for s in self.sources]}"
+
+    @staticmethod
+    def stream_id(index: int) -> str:
+        """Stream id hailoroundrobin assigns to source `index`"""
+        return f"sink_{index}"
+
+    def build_pipeline(self) -> str:
+        """
+        Build the GStreamer pipeline string.
+
+        Returns:
+            GStreamer pipeline string
+        """
+        routes = " ".join(
+            f'src_{i}::input-streams="<{self.stream_id(i)}>"'
+            for i in range(len(self.sources))
+        )
+
+        pipeline = f"""
+            hailoroundrobin name=funnel mode=1 !
+            queue name={self.stream_name}_in !
+            hailonet hef-path={self.detection_model_path} batch-size={len(self.sources)} !
+            queue name={self.stream_name}_det !
+            {self.detection_filter()}
+            hailofilter function-name=plate_tracker so-path=./libplate_tracker.so
+                config-path={self.write_tracker_config()} qos=false !
+            {self.ocr_chain(self.ocr_batch_size)}
+            hailostreamrouter name=router {routes}
+        """
+
+        # The gate sits behind the leaky queue: every frame it admits reaches
+        # the funnel, so the scheduler's queue latency (admission to
+        # plate_detection) is not skewed by frames the queue drops
+        for i, source in enumerate(self.sources):
+            pipeline += f"""
+                {self.source_chain(source.rtsp_url)}
+                queue name=cam{source.camera_id}_src leaky=downstream max-size-buffers=4 !
+                {self.gate_element(f"cam{source.camera_id}")}
+                {self.trace_element(f"cam{source.camera_id}")}
+                funnel.{self.stream_id(i)}
+                router.src_{i} !
+                fakesink
+            """
+        return " ".join(pipeline.split())
+
+    def gate_keys(self) -> List[tuple]:
+        """(gate element prefix, SceneActivity key) of every camera"""
+        # Detections of the shared network are reported per stream id
+        return [(f"cam{source.camera_id}", self.stream_id(i)) for i, source in enumerate(self.sources)]
+
+    def camera_schedules(self) -> List[tuple]:
+        """(gate element prefix, SceneActivity key, schedule or None) of every camera"""
+        return [
+            (f"cam{source.camera_id}", self.stream_id(i),
+             source.schedule if source.schedule is not None else self.schedule)
+            for i, source in enumerate(self.sources)
+        ]
+
+    def capture_sources(self) -> List[tuple]:
+        """(camera id, tensor capture key, frame width, frame height) of every camera"""
+        return [
+            (source.camera_id, self.stream_id(i), source.frame_width, source.frame_height)
+            for i, source in enumerate(self.sources)
+        ]
+
+    def tracker_config(self) -> Dict[str, Any]:
+        """plate_tracker config: zones per stream id"""
+        return {
+            "streams": {
+                self.stream_id(i): {
+                    "zones": normalize_zones(
+                        source.zones, source.frame_width, source.frame_height,
+                        f"Camera {source.camera_id}"
+                    )
+                }
+                for i, source in enumerate(self.sources)
+            }
+        }
+
+    def postprocess_config(self) -> Dict[str, Any]:
+        """Postprocess parameters per stream id"""
+        # ROIs without a stream id fall back to the stream name (the thread prefix)
+        cameras = {self.stream_name: self.camera_postprocess(self.postprocess)}
+        for i, source in enumerate(self.sources):
+            cameras[self.stream_id(i)] = self.camera_postprocess(merge_params(self.postprocess, source.postprocess))
+        return {"cameras": cameras}
+
+    def set_camera_postprocess(self, camera_id: int, postprocess: Dict[str, Any]) -> bool:
+        for source in self.sources:
+            if source.camera_id == camera_id:
+                source.postprocess = merge_params({}, postprocess)
+                return True
+        return False
+
+    def stream_source(self, stream_index: int) -> tuple:
+        """Events carry the index of their hailoroundrobin stream"""
+        if 0 <= stream_index < len(self.sources):
+            source = self.sources[stream_index]
+            return source.camera_id, source.frame_width, source.frame_height
+        return super().stream_source(stream_index)
+
+    def get_stats(self) -> dict:
+        """Get pipeline statistics"""
+        stats = super().get_stats()
+        if stats:
+            stats["camera_ids"] = [s.camera_id for s in self.sources]
+        return stats
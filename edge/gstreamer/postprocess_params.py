@@ -0,0 +1,89 @@
+"""
+Runtime postprocess parameters (libanpr_core.so).
+
+plate_detection and plate_ocr load their config-path into a shared,
+per-camera parameter store when the pipeline starts
+(postprocess_params.hpp). Reloading a rewritten config swaps the parameter
+block while the streams run: thresholds, decoding options, plate lengths and
+the crop size change from the next frame on, without a pipeline rebuild.
+"""
+
+import copy
+import ctypes
+import logging
+from typing import Any, Dict, Optional
+
+from .event_ring import CORE_LIBRARY
+
+logger = logging.getLogger(__name__)
+
+# Config sections and their keys (see postprocess_params.hpp)
+SECTIONS = {
+    "detection": ("confidence_threshold", "nms_threshold", "fast", "top_k", "max_plates",
+                  "min_width", "min_height", "min_aspect", "max_aspect"),
+    "ocr": ("min_confidence", "beam_search", "beam_width", "min_length", "max_length"),
+    "crop": ("width", "height", "dmabuf"),
+    "evidence": ("enabled", "quality", "plate_width", "frame_width", "margin"),
+}
+
+_library: Optional[ctypes.CDLL] = None
+
+
+def _load_library(path: str) -> Optional[ctypes.CDLL]:
+    global _library
+    if _library is None:
+        try:
+            _library = ctypes.CDLL(path)
+            _library.postprocess_params_load.restype = ctypes.c_int
+            _library.postprocess_params_load.argtypes = [ctypes.c_char_p]
+            _library.postprocess_params_version.restype = ctypes.c_uint64
+        except (OSError, AttributeError) as e:
+            logger.warning(f"Postprocess parameter reload unavailable: {e}")
+            return None
+    return _library
+
+
+def merge_params(base: Dict[str, Any], override: Optional[Dict[str, Any]]) -> Dict[str, Any]:
+    """
+    Merge two sets of config sections, override winning per key.
+
+    Unknown sections and keys are dropped with a warning, so a typo from the
+    backend does not get the whole config rejected by the plugins.
+    """
+    merged = copy.deepcopy(base)
+    for section, values in (override or {}).items():
+        if section not in SECTIONS or not isinstance(values, dict):
+            logger.warning(f"Ignoring unknown postprocess section '{section}'")
+            continue
+        for key, value in values.items():
+            if key not in SECTIONS[section]:
+                logger.warning(f"Ignoring unknown postprocess parameter '{section}.{key}'")
+                continue
+            merged.setdefault(section, {})[key] = value
+    return merged
+
+
+def load_postprocess_params(path: str, library_path: str = CORE_LIBRARY) -> bool:
+    """
+    Publish a postprocess config to the running pipelines.
+
+    Args:
+        path: JSON config written by the pipeline
+        library_path: Path of libanpr_core.so
+
+    Returns:
+        True if published; a rejected config leaves the previous parameters
+        in effect (the reason is logged by the library)
+    """
+    library = _load_library(library_path)
+    if library is None:
+        return False
+    return bool(library.postprocess_params_load(path.encode()))
+
+
+def postprocess_params_version(library_path: str = CORE_LIBRARY) -> int:
+    """Version of the published parameters, 0 if the library is not loaded"""
+    library = _load_library(library_path)
+    if library is None:
+        return 0
+    return library.postprocess_params_version()
@@ -0,0 +1,187 @@
+"""
+Process-wide inference scheduler of the postprocess plugins (libanpr_core.so).
+
+All camera pipelines of the process share one Hailo device. The scheduler
+(scheduler.hpp) gives each camera a priority and budgets: an inference frame
+rate enforced by the frame gate in front of the detection network, and an
+OCR crop rate enforced by crop_plates. When the device budget or the queue
+latency target is exceeded, it throttles the lower priorities first. It
+reports each camera's achieved throughput and queue latency.
+
+The device options are set once per process (configure_scheduler). Each
+pipeline registers its cameras under their SceneActivity keys when it
+starts and removes them when it stops.
+"""
+
+import ctypes
+import logging
+from typing import Dict, List, Optional
+
+from .event_ring import CORE_LIBRARY
+
+logger = logging.getLogger(__name__)
+
+
+class CameraSchedule(ctypes.Structure):
+    """Mirror of anpr::CameraSchedule (scheduler.hpp)"""
+    _fields_ = [
+        ("key", ctypes.c_char * 32),
+        ("priority", ctypes.c_int32),
+        ("budget_fps", ctypes.c_float),
+        ("offered_fps", ctypes.c_float),
+        ("granted_fps", ctypes.c_float),
+        ("achieved_fps", ctypes.c_float),
+        ("queue_latency_ms", ctypes.c_float),
+        ("queue_latency_max_ms", ctypes.c_float),
+        ("ocr_share", ctypes.c_float),
+        ("throttled", ctypes.c_uint32),
+        ("frames_offered", ctypes.c_uint64),
+        ("frames_admitted", ctypes.c_uint64),
+        ("frames_skipped", ctypes.c_uint64),
+        ("frames_inferred", ctypes.c_uint64),
+        ("ocr_admitted", ctypes.c_uint64),
+        ("ocr_deferred", ctypes.c_uint64),
+    ]
+
+    def to_dict(self) -> Dict:
+        stats = {}
+        for name, _ in self._fields_:
+            value = getattr(self, name)
+            if name == "key":
+                value = value.decode(errors="replace")
+            elif name == "throttled":
+                value = bool(value)
+            elif isinstance(value, float):
+                value = round(value, 2)
+            stats[name] = value
+        return stats
+
+
+class SchedulerState(ctypes.Structure):
+    """Mirror of anpr::SchedulerState (scheduler.hpp)"""
+    _fields_ = [
+        ("device_fps", ctypes.c_float),
+        ("target_latency_ms", ctypes.c_float),
+        ("capacity_fps", ctypes.c_float),
+        ("scale", ctypes.c_float),
+        ("cameras", ctypes.c_uint32),
+        ("overloaded", ctypes.c_uint32),
+        ("rounds", ctypes.c_uint64),
+    ]
+
+    def to_dict(self) -> Dict:
+        return {
+            "device_fps": round(self.device_fps, 2),
+            "target_latency_ms": round(self.target_latency_ms, 2),
+            "capacity_fps": round(self.capacity_fps, 2),
+            "scale": round(self.scale, 3),
+            "cameras": self.cameras,
+            "overloaded": bool(self.overloaded),
+            "rounds": self.rounds,
+        }
+
+
+_library: Optional[ctypes.CDLL] = None
+
+
+def _load_library(path: str) -> Optional[ctypes.CDLL]:
+    global _library
+    if _library is None:
+        try:
+            _library = ctypes.CDLL(path)
+            _library.scheduler_configure.restype = None
+            _library.scheduler_configure.argtypes = [ctypes.c_float, ctypes.c_float]
+            _library.scheduler_set_camera.restype = ctypes.c_int
+            _library.scheduler_set_camera.argtypes = [
+                ctypes.c_char_p, ctypes.c_int, ctypes.c_float, ctypes.c_float, ctypes.c_float
+            ]
+            _library.scheduler_remove_camera.argtypes = [ctypes.c_char_p]
+            _library.scheduler_count.restype = ctypes.c_size_t
+            _library.scheduler_stats.restype = ctypes.c_size_t
+            _library.scheduler_stats.argtypes = [ctypes.POINTER(CameraSchedule), ctypes.c_size_t]
+            _library.scheduler_state.restype = None
+            _library.scheduler_state.argtypes = [ctypes.POINTER(SchedulerState)]
+        except (OSError, AttributeError) as e:
+            logger.warning(f"Inference scheduler unavailable: {e}")
+            return None
+    return _library
+
+
+def configure_scheduler(device_fps: float = 0.0, target_latency_ms: float = 150.0,
+                        library_path: str = CORE_LIBRARY) -> bool:
+    """
+    Set the shared device budget.
+
+    Args:
+        device_fps: Detection frames per second the device sustains for all
+            cameras together, 0 to rely on the latency target alone
+        target_latency_ms: Queue latency (frame gate to plate_detection)
+            above which lower priorities are throttled
+        library_path: Path of libanpr_core.so
+
+    Returns:
+        True if applied
+    """
+    library = _load_library(library_path)
+    if library is None:
+        return False
+    library.scheduler_configure(device_fps, target_latency_ms)
+    return True
+
+
+def set_camera_budget(key: str, priority: int = 0, fps: float = 0.0, min_fps: float = 1.0,
+                      ocr_fps: float = 0.0, library_path: str = CORE_LIBRARY) -> bool:
+    """
+    Schedule a camera.
+
+    Args:
+        key: The camera's SceneActivity key (stream name or stream id)
+        priority: Higher priorities are served first (e.g. entry gates over
+            overview cameras)
+        fps: Inference budget, 0 for whatever the camera offers
+        min_fps: Rate the camera keeps under overload
+        ocr_fps: OCR crops per second, 0 for unlimited
+        library_path: Path of libanpr_core.so
+
+    Returns:
+        True if set
+    """
+    library = _load_library(library_path)
+    if library is None:
+        return False
+    return bool(library.scheduler_set_camera(key.encode(), priority, fps, min_fps, ocr_fps))
+
+
+def remove_camera_budget(key: str, library_path: str = CORE_LIBRARY):
+    """Stop scheduling a camera"""
+    library = _load_library(library_path)
+    if library is not None:
+        library.scheduler_remove_camera(key.encode())
+
+
+def read_scheduler_stats(keys: Optional[List[str]] = None, library_path: str = CORE_LIBRARY) -> Dict:
+    """
+    Read the device state and the per-camera schedules.
+
+    Args:
+        keys: Only return these cameras (all if None)
+        library_path: Path of libanpr_core.so
+
+    Returns:
+        {"device": {...}, "cameras": [...]}, empty if the library is not loaded
+    """
+    library = _load_library(library_path)
+    if library is None:
+        return {}
+
+    state = SchedulerState()
+    library.scheduler_state(ctypes.byref(state))
+    cameras = []
+    count = library.scheduler_count()
+    if count:
+        buffer = (CameraSchedule * count)()
+        written = library.scheduler_stats(buffer, count)
+        cameras = [buffer[i].to_dict() for i in range(written)]
+    if keys is not None:
+        cameras = [c for c in cameras if c["key"] in keys]
+    return {"device": state.to_dict(), "cameras": cameras}
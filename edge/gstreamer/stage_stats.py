@@ -0,0 +1,126 @@
+"""
+Per-stage latency and counters of the postprocess plugins (libanpr_core.so).
+
+Every plugin entry point records its latency into a histogram and a few
+counters per streaming thread (stage_stats.hpp), e.g. "cam3_det:src" /
+"plate_detection" with the candidates over the threshold and the NMS
+survivors. Values are cumulative since the process started.
+"""
+
+import ctypes
+import logging
+from typing import Dict, List, Optional
+
+from .event_ring import CORE_LIBRARY
+
+logger = logging.getLogger(__name__)
+
+MAX_COUNTERS = 4  # anpr::StageStatsSnapshot::kMaxCounters
+
+
+class StageStatsSnapshot(ctypes.Structure):
+    """Mirror of anpr::StageStatsSnapshot (stage_stats.hpp)"""
+    _fields_ = [
+        ("thread", ctypes.c_char * 16),
+        ("stage", ctypes.c_char * 16),
+        ("calls", ctypes.c_uint64),
+        ("total_ns", ctypes.c_uint64),
+        ("max_ns", ctypes.c_uint64),
+        ("p50_ns", ctypes.c_uint64),
+        ("p90_ns", ctypes.c_uint64),
+        ("p99_ns", ctypes.c_uint64),
+        ("counters", ctypes.c_uint64 * MAX_COUNTERS),
+        ("counter_names", (ctypes.c_char * 24) * MAX_COUNTERS),
+    ]
+
+    def to_dict(self) -> Dict:
+        counters = {}
+        for i in range(MAX_COUNTERS):
+            name = self.counter_names[i].value.decode(errors="replace")
+            if name:
+                counters[name] = self.counters[i]
+        return {
+            "thread": self.thread.decode(errors="replace"),
+            "stage": self.stage.decode(errors="replace"),
+            "calls": self.calls,
+            "mean_us": round(self.total_ns / self.calls / 1e3, 1) if self.calls else 0.0,
+            "p50_us": round(self.p50_ns / 1e3, 1),
+            "p90_us": round(self.p90_ns / 1e3, 1),
+            "p99_us": round(self.p99_ns / 1e3, 1),
+            "max_us": round(self.max_ns / 1e3, 1),
+            "counters": counters,
+        }
+
+
+_library: Optional[ctypes.CDLL] = None
+
+
+def _load_library(path: str) -> Optional[ctypes.CDLL]:
+    global _library
+    if _library is None:
+        try:
+            _library = ctypes.CDLL(path)
+            _library.stage_stats_count.restype = ctypes.c_size_t
+            _library.stage_stats.restype = ctypes.c_size_t
+            _library.stage_stats.argtypes = [ctypes.POINTER(StageStatsSnapshot), ctypes.c_size_t]
+            _library.stage_stats_histogram.restype = ctypes.c_int
+            _library.stage_stats_histogram.argtypes = [ctypes.c_size_t, ctypes.POINTER(ctypes.c_uint64)]
+            _library.stage_stats_num_buckets.restype = ctypes.c_int
+            _library.stage_stats_bucket_lower_ns.restype = ctypes.c_uint64
+            _library.stage_stats_bucket_lower_ns.argtypes = [ctypes.c_int]
+        except (OSError, AttributeError) as e:
+            logger.debug(f"Stage stats unavailable: {e}")
+            return None
+    return _library
+
+
+def _histogram(library: ctypes.CDLL, index: int) -> List[List[float]]:
+    """Cumulative [upper bound in us, count] pairs of the non-empty buckets"""
+    num_buckets = library.stage_stats_num_buckets()
+    counts = (ctypes.c_uint64 * num_buckets)()
+    if not library.stage_stats_histogram(index, counts):
+        return []
+
+    buckets = []
+    cumulative = 0
+    for b in range(num_buckets):
+        if counts[b]:
+            cumulative += counts[b]
+            upper_ns = library.stage_stats_bucket_lower_ns(b + 1) if b + 1 < num_buckets else float("inf")
+            buckets.append([upper_ns / 1e3, cumulative])
+    return buckets
+
+
+def read_stage_stats(prefix: str = "", histograms: bool = False,
+                     library_path: str = CORE_LIBRARY) -> List[Dict]:
+    """
+    Read latency and counters of every plugin stage.
+
+    Args:
+        prefix: Only return stages whose thread name starts with this prefix
+        histograms: Include each stage's cumulative latency buckets under
+            "histogram" (e.g. for a Prometheus histogram)
+        library_path: Path of libanpr_core.so
+
+    Returns:
+        List of per-stage stat dicts (empty if the library is not loaded)
+    """
+    library = _load_library(library_path)
+    if library is None:
+        return []
+
+    count = library.stage_stats_count()
+    if count == 0:
+        return []
+
+    buffer = (StageStatsSnapshot * count)()
+    written = library.stage_stats(buffer, count)
+    stages = []
+    for i in range(written):
+        stage = buffer[i].to_dict()
+        if not stage["thread"].startswith(prefix):
+            continue
+        if histograms:
+            stage["histogram"] = _histogram(library, i)
+        stages.append(stage)
+    return stages
@@ -0,0 +1,129 @@
+"""
+Per-camera capture of raw output tensors (libanpr_core.so).
+
+While capture is on for a camera, plate_detection appends the detection
+output of at most max_fps frames per second to the camera's tensor dump,
+and plate_ocr appends the OCR output of those frames' crops
+(tensor_capture.hpp). The dumps replay in bench_postprocess, so production
+hot spots can be reproduced without taking video off the edge box.
+"""
+
+import ctypes
+import logging
+from typing import Dict, Iterable, List, Optional
+
+from .event_ring import CORE_LIBRARY
+
+logger = logging.getLogger(__name__)
+
+
+class TensorCaptureStats(ctypes.Structure):
+    """Mirror of anpr::TensorCaptureStats (tensor_capture.hpp)"""
+    _fields_ = [
+        ("key", ctypes.c_char * 32),
+        ("active", ctypes.c_uint32),
+        ("max_fps", ctypes.c_float),
+        ("frames", ctypes.c_uint64),
+        ("ocr_records", ctypes.c_uint64),
+        ("rate_limited", ctypes.c_uint64),
+        ("bytes", ctypes.c_uint64),
+        ("errors", ctypes.c_uint64),
+    ]
+
+    def to_dict(self) -> Dict:
+        return {
+            "key": self.key.decode(errors="replace"),
+            "active": bool(self.active),
+            "max_fps": round(self.max_fps, 2),
+            "frames": self.frames,
+            "ocr_records": self.ocr_records,
+            "rate_limited": self.rate_limited,
+            "bytes": self.bytes,
+            "errors": self.errors,
+        }
+
+
+_library: Optional[ctypes.CDLL] = None
+
+
+def _load_library(path: str) -> Optional[ctypes.CDLL]:
+    global _library
+    if _library is None:
+        try:
+            _library = ctypes.CDLL(path)
+            _library.tensor_capture_start.restype = ctypes.c_int
+            _library.tensor_capture_start.argtypes = [
+                ctypes.c_char_p, ctypes.c_char_p, ctypes.c_float, ctypes.c_uint64,
+                ctypes.c_int, ctypes.c_int
+            ]
+            _library.tensor_capture_stop.restype = ctypes.c_int
+            _library.tensor_capture_stop.argtypes = [ctypes.c_char_p]
+            _library.tensor_capture_count.restype = ctypes.c_size_t
+            _library.tensor_capture_stats.restype = ctypes.c_size_t
+            _library.tensor_capture_stats.argtypes = [ctypes.POINTER(TensorCaptureStats), ctypes.c_size_t]
+        except (OSError, AttributeError) as e:
+            logger.warning(f"Tensor capture unavailable: {e}")
+            return None
+    return _library
+
+
+def start_tensor_capture(key: str, path: str, max_fps: float = 1.0, max_bytes: int = 256 << 20,
+                         frame_width: int = 0, frame_height: int = 0,
+                         library_path: str = CORE_LIBRARY) -> bool:
+    """
+    Start (or reconfigure) capturing one camera's output tensors.
+
+    Args:
+        key: Camera key plate_detection reports under: the stream id in
+            multi-stream pipelines, otherwise the element prefix
+        path: Tensor dump to append to
+        max_fps: Captured frames per second (<= 0: every frame)
+        max_bytes: Stop writing once the dump reaches this size
+        frame_width: Camera frame size stored with the records
+        frame_height: Camera frame size stored with the records
+
+    Returns:
+        True if the capture runs
+    """
+    library = _load_library(library_path)
+    if library is None:
+        return False
+    return bool(library.tensor_capture_start(key.encode(), path.encode(), max_fps, max_bytes,
+                                             frame_width, frame_height))
+
+
+def stop_tensor_capture(key: str, library_path: str = CORE_LIBRARY) -> bool:
+    """Stop capturing a camera; returns False if it was not capturing"""
+    library = _load_library(library_path)
+    if library is None:
+        return False
+    return bool(library.tensor_capture_stop(key.encode()))
+
+
+def read_tensor_capture_stats(keys: Optional[Iterable[str]] = None,
+                              library_path: str = CORE_LIBRARY) -> List[Dict]:
+    """
+    Read counters of every camera that captured since the process started.
+
+    Args:
+        keys: Only return these camera keys
+        library_path: Path of libanpr_core.so
+
+    Returns:
+        List of per-camera stat dicts (empty if the library is not loaded)
+    """
+    library = _load_library(library_path)
+    if library is None:
+        return []
+
+    count = library.tensor_capture_count()
+    if count == 0:
+        return []
+
+    buffer = (TensorCaptureStats * count)()
+    written = library.tensor_capture_stats(buffer, count)
+    captures = [buffer[i].to_dict() for i in range(written)]
+    if keys is not None:
+        wanted = set(keys)
+        captures = [c for c in captures if c["key"] in wanted]
+    return captures
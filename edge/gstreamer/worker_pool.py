@@ -0,0 +1,84 @@
+"""
+Shared OCR worker pool of the postprocess plugins (libanpr_core.so).
+
+plate_ocr's frame entry points (plate_ocr_frame_<region>) decode and validate
+the crops of a frame in parallel on this pool and join before the frame moves on
+(worker_pool.hpp). There is one pool per process, shared by every camera
+pipeline; it is off (0 threads) until configured.
+"""
+
+import ctypes
+import logging
+from typing import Dict, Optional, Sequence
+
+from .event_ring import CORE_LIBRARY
+
+logger = logging.getLogger(__name__)
+
+
+class WorkerPoolStats(ctypes.Structure):
+    """Mirror of anpr::WorkerPoolStats (worker_pool.hpp)"""
+    _fields_ = [
+        ("threads", ctypes.c_uint32),
+        ("pinned_cpus", ctypes.c_uint32),
+        ("jobs", ctypes.c_uint64),
+        ("inline_jobs", ctypes.c_uint64),
+        ("items", ctypes.c_uint64),
+        ("worker_items", ctypes.c_uint64),
+        ("stolen", ctypes.c_uint64),
+    ]
+
+    def to_dict(self) -> Dict:
+        return {name: getattr(self, name) for name, _ in self._fields_}
+
+
+_library: Optional[ctypes.CDLL] = None
+
+
+def _load_library(path: str) -> Optional[ctypes.CDLL]:
+    global _library
+    if _library is None:
+        try:
+            _library = ctypes.CDLL(path)
+            _library.worker_pool_configure.restype = ctypes.c_int
+            _library.worker_pool_configure.argtypes = [
+                ctypes.c_int, ctypes.POINTER(ctypes.c_int), ctypes.c_size_t
+            ]
+            _library.worker_pool_stats.restype = None
+            _library.worker_pool_stats.argtypes = [ctypes.POINTER(WorkerPoolStats)]
+        except (OSError, AttributeError) as e:
+            logger.warning(f"OCR worker pool unavailable: {e}")
+            return None
+    return _library
+
+
+def configure_worker_pool(threads: int, cpus: Sequence[int] = (),
+                          library_path: str = CORE_LIBRARY) -> bool:
+    """
+    Size the process-wide OCR worker pool.
+
+    Args:
+        threads: Worker threads, 0 to decode on the streaming threads
+        cpus: CPUs to pin the workers to (worker i on cpus[i % len(cpus)]),
+            e.g. the cores the H.264 decoders do not run on; empty to leave
+            affinity to the scheduler
+        library_path: Path of libanpr_core.so
+
+    Returns:
+        True if applied
+    """
+    library = _load_library(library_path)
+    if library is None:
+        return False
+    cpu_array = (ctypes.c_int * len(cpus))(*cpus)
+    return bool(library.worker_pool_configure(threads, cpu_array, len(cpus)))
+
+
+def read_worker_pool_stats(library_path: str = CORE_LIBRARY) -> Dict:
+    """Pool size and cumulative item counts, empty if the library is not loaded"""
+    library = _load_library(library_path)
+    if library is None:
+        return {}
+    stats = WorkerPoolStats()
+    library.worker_pool_stats(ctypes.byref(stats))
+    return stats.to_dict()
@@ -59,10 +59,15 @@ class EdgeWorker:
 
         # Event dispatcher
         logger.info("Initializing event exporters...")
-        self.dispatcher = EventDispatcher(
-            configs=config.exporters,
-            queue_path=config.exporters[0].queue_path if config.exporters else None,
-        )
+        queue_args = {}
+        if config.exporters:
+            queue_config = config.exporters[0]
+            queue_args = {
+                "queue_path": queue_config.queue_path,
+                "queue_segment_bytes": queue_config.queue_segment_mb << 20,
+                "queue_max_bytes": queue_config.queue_max_mb << 20,
+            }
+        self.dispatcher = EventDispatcher(configs=config.exporters, **queue_args)
 
         # Pipeline manager
         logger.info("Initializing pipeline manager...")
@@ -71,6 +76,13 @@ class EdgeWorker:
             hardware_config=config.hardware,
         )
 
+        # Backend camera ids, events of unmapped cameras are rejected by the backend
+        self.backend_camera_ids = {camera.id: camera.backend_id for camera in config.cameras}
+        if any(exporter.enabled and exporter.type == "rest" for exporter in config.exporters):
+            for camera_id, backend_id in self.backend_camera_ids.items():
+                if backend_id is None:
+                    logger.warning(f"Camera {camera_id} has no backend_id, the backend will reject its events")
+
         # Add cameras
         for camera_config in config.cameras:
             if camera_config.enabled:
@@ -283,6 +295,7 @@ class EdgeWorker:
             metadata={
                 "vehicle_confidence": vehicle_detection.confidence if vehicle_detection else None,
                 "plate_confidence": plate_detection.confidence,
+                "backend_camera_id": self.backend_camera_ids.get(camera_id),
             },
         )
 
@@ -0,0 +1,131 @@
+"""
+Retry Log Tests
+Append, batch replay, crash recovery and compaction of the segmented retry log
+"""
+
+import pytest
+from edge.exporters.retry_log import RetryLog, SEGMENT_HEADER_BYTES
+
+
+def payload(index: int, size: int = 100) -> bytes:
+    return (f"event-{index:06d}-".encode() * size)[:size]
+
+
+@pytest.fixture
+def log_path(tmp_path):
+    return tmp_path / "queue"
+
+
+def open_log(path, **kwargs) -> RetryLog:
+    kwargs.setdefault("segment_bytes", 8192)
+    kwargs.setdefault("compact_interval", 3600.0)
+    return RetryLog(str(path), **kwargs)
+
+
+class TestRetryLog:
+    """Test RetryLog"""
+
+    def test_fifo_batches(self, log_path):
+        """Records come back in order, one batch at a time, until committed"""
+        log = open_log(log_path)
+        assert log.append([payload(i) for i in range(10)]) == 10
+        assert log.pending() == 10
+
+        batch, position = log.read_batch(4)
+        assert batch == [payload(i) for i in range(4)]
+
+        # Not committed: the same batch again
+        assert log.read_batch(4)[0] == batch
+        log.commit(position)
+        assert log.pending() == 6
+
+        batch, position = log.read_batch(100)
+        assert batch == [payload(i) for i in range(4, 10)]
+        log.commit(position)
+        assert log.pending() == 0
+        assert log.read_batch(4)[0] == []
+        log.close()
+
+    def test_spans_segments(self, log_path):
+        """Appends roll over to new segments, replay crosses them"""
+        log = open_log(log_path)
+        log.append([payload(i) for i in range(200)])
+        assert log.stats()["segments"] > 2
+
+        replayed = []
+        while True:
+            batch, position = log.read_batch(32)
+            if not batch:
+                break
+            replayed.extend(batch)
+            log.commit(position)
+        assert replayed == [payload(i) for i in range(200)]
+        log.close()
+
+    def test_reopen_resumes_at_cursor(self, log_path):
+        """The committed position survives a restart"""
+        log = open_log(log_path)
+        log.append([payload(i) for i in range(100)])
+        log.commit(log.read_batch(30)[1])
+        log.close()
+
+        log = open_log(log_path)
+        assert log.pending() == 70
+        assert log.read_batch(1)[0] == [payload(30)]
+        log.append([payload(100)])
+        assert log.pending() == 71
+        log.close()
+
+    def test_torn_tail_is_dropped(self, log_path):
+        """A record cut short by a crash ends the segment on recovery"""
+        log = open_log(log_path)
+        log.append([payload(i) for i in range(3)])
+        active = log._segments[-1]
+        end = active.end
+        log.close()
+
+        # Corrupt the last record's payload as a torn write would
+        with open(active.path, "r+b") as f:
+            f.seek(end - 8)
+            f.write(b"\xff" * 8)
+
+        log = open_log(log_path)
+        assert log.pending() == 2
+        assert log.read_batch(10)[0] == [payload(0), payload(1)]
+        log.close()
+
+    def test_compaction_deletes_consumed_segments(self, log_path):
+        """Segments behind the cursor are removed, the rest stay"""
+        log = open_log(log_path)
+        log.append([payload(i) for i in range(200)])
+        segments = len(list(log_path.glob("segment-*.log")))
+
+        log.commit(log.read_batch(150)[1])
+        log.compact()
+        remaining = len(list(log_path.glob("segment-*.log")))
+        assert remaining < segments
+        assert log.stats()["compactions"] == 1
+        assert log.read_batch(1)[0] == [payload(150)]
+        log.close()
+
+    def test_disk_budget_drops_oldest(self, log_path):
+        """Past max_bytes the oldest segments go, counted as dropped"""
+        log = open_log(log_path, max_bytes=4 * 8192)
+        log.append([payload(i) for i in range(400)])
+
+        stats = log.stats()
+        assert stats["disk_bytes"] <= 4 * 8192
+        assert stats["dropped"] > 0
+        assert stats["pending"] == 400 - stats["dropped"]
+
+        first = log.read_batch(1)[0][0]
+        assert first == payload(stats["dropped"])
+        log.close()
+
+    def test_oversized_record_is_skipped(self, log_path):
+        """A record larger than a segment is refused rather than corrupting the log"""
+        log = open_log(log_path)
+        assert log.append([payload(0, 8192), payload(1)]) == 1
+        assert log.read_batch(10)[0] == [payload(1)]
+        assert log._segments[-1].end > SEGMENT_HEADER_BYTES
+        log.close()
@@ -0,0 +1,142 @@
+"""
+Wire Format Tests
+Round trips of the binary event batch encoding, and the REST exporter's
+handling of events the bulk ingest endpoint rejects
+"""
+
+import pytest
+from edge.config import ExporterConfig
+from edge.exporters.dispatcher import DetectionEvent, RESTExporter
+from edge.exporters import wire
+
+
+def make_event(index: int, **overrides) -> DetectionEvent:
+    fields = dict(
+        event_id=f"evt-{index}",
+        worker_id="edge-001",
+        camera_id="3",
+        camera_name="Gate",
+        timestamp="2026-10-14T08:00:00.250000+00:00",
+        plate_text="AB123CD",
+        confidence=0.9,
+        vehicle_bbox=(10.0, 20.0, 400.0, 300.0),
+        plate_bbox=(110.0, 220.0, 210.0, 250.0),
+        image_path=f"/var/lib/anpr/images/{index}.jpg",
+        metadata={"track_id": index, "ocr_confidence": 0.8},
+    )
+    fields.update(overrides)
+    return DetectionEvent(**fields)
+
+
+class TestWireFormat:
+    """Test encode_batch / decode_batch"""
+
+    @pytest.mark.parametrize("compress", [False, True])
+    def test_round_trip(self, compress):
+        """Every field survives a round trip, compressed or not"""
+        events = [make_event(i).to_dict() for i in range(40)]
+        decoded = wire.decode_batch(wire.encode_batch(events, compress=compress))
+
+        assert len(decoded) == len(events)
+        for original, event in zip(events, decoded):
+            assert event == original
+
+    def test_optional_fields(self):
+        """Missing boxes, image path and metadata come back as None"""
+        event = make_event(0, vehicle_bbox=None, plate_bbox=None, image_path=None, metadata=None)
+        decoded = wire.decode_batch(wire.encode_batch([event.to_dict()]))[0]
+
+        assert decoded["vehicle_bbox"] is None
+        assert decoded["plate_bbox"] is None
+        assert decoded["image_path"] is None
+        assert decoded["metadata"] is None
+
+    def test_naive_timestamp_is_utc(self):
+        """Timestamps without an offset are taken as UTC"""
+        event = make_event(0, timestamp="2026-10-14T08:00:00")
+        decoded = wire.decode_batch(wire.encode_batch([event.to_dict()]))[0]
+
+        assert decoded["timestamp"] == "2026-10-14T08:00:00+00:00"
+
+    def test_compression(self):
+        """Large batches are compressed, tiny ones are not"""
+        events = [make_event(i).to_dict() for i in range(40)]
+        plain = wire.encode_batch(events, compress=False)
+        compressed = wire.encode_batch(events, compress=True)
+
+        assert len(compressed) < len(plain) // 2
+        assert wire.encode_batch([], compress=True)[5] & wire.FLAG_ZLIB == 0
+
+    @pytest.mark.parametrize("data", [b"", b"JSON", b"XXXX\x01\x00\x00\x00\x00\x00"])
+    def test_rejects_foreign_data(self, data):
+        """Short or foreign bodies are rejected"""
+        with pytest.raises(wire.WireFormatError):
+            wire.decode_batch(data)
+
+    def test_rejects_truncated_batch(self):
+        """A batch cut short is rejected rather than decoded partially"""
+        data = wire.encode_batch([make_event(i).to_dict() for i in range(3)], compress=False)
+
+        with pytest.raises(wire.WireFormatError):
+            wire.decode_batch(data[:-7])
+
+
+class FakeResponse:
+    def __init__(self, status_code, body=None):
+        self.status_code = status_code
+        self.body = body
+        self.text = str(body)
+
+    def json(self):
+        if self.body is None:
+            raise ValueError("No JSON body")
+        return self.body
+
+
+class TestBulkRejections:
+    """Test RESTExporter with 207 Multi-Status answers"""
+
+    def make_exporter(self, monkeypatch, response):
+        exporter = RESTExporter(ExporterConfig(
+            type="rest",
+            endpoint="http://backend.local:8000/api/plate-events/ingest",
+            retry_enabled=False,
+        ))
+        posted = []
+        monkeypatch.setattr(exporter.session, "post", lambda url, **request: posted.append(url) or response)
+        return exporter, posted
+
+    def test_default_batch_endpoint(self, monkeypatch):
+        """The example endpoint gives the backend's bulk route"""
+        exporter, posted = self.make_exporter(monkeypatch, FakeResponse(202))
+
+        assert exporter.export(make_event(0))
+        assert posted == ["http://backend.local:8000/api/plate-events/ingest/bulk"]
+
+    def test_rejected_events_are_kept(self, monkeypatch):
+        """Events listed in a 207 answer are handed back once, the rest count as delivered"""
+        body = {"received": 3, "inserted": 1, "rejected": 2, "rejected_events": [
+            {"index": 2, "event_id": "evt-2", "reason": "unknown camera 3"},
+            {"index": 0, "event_id": "evt-0", "reason": "unknown camera 3"},
+        ]}
+        exporter, _ = self.make_exporter(monkeypatch, FakeResponse(207, body))
+        events = [make_event(i) for i in range(3)]
+
+        assert exporter.export_batch(events)
+        assert [event.event_id for event in exporter.take_rejected()] == ["evt-0", "evt-2"]
+        assert exporter.take_rejected() == []
+
+    def test_unreadable_rejections_keep_the_batch(self, monkeypatch):
+        """A 207 without a readable rejection list keeps every event"""
+        exporter, _ = self.make_exporter(monkeypatch, FakeResponse(207))
+        events = [make_event(i) for i in range(2)]
+
+        assert exporter.export_batch(events)
+        assert exporter.take_rejected() == events
+
+    def test_accepted_batch_has_no_rejections(self, monkeypatch):
+        """A fully accepted batch leaves nothing rejected"""
+        exporter, _ = self.make_exporter(monkeypatch, FakeResponse(202, {"rejected": 0}))
+
+        assert exporter.export_batch([make_event(0), make_event(1)])
+        assert exporter.take_rejected() == []
@@ -4,7 +4,7 @@ Data models for edge worker.
 
 from pydantic import BaseModel, Field
 from datetime import datetime
-from typing import Optional, Dict, Any
+from typing import Optional, Dict, Any, List
 
 
 class BoundingBox(BaseModel):
@@ -43,6 +43,16 @@ class CameraConfig(BaseModel):
     fps: int = 15
     resolution_width: int = 1920
     resolution_height: int = 1080
+    zones: List[Dict[str, Any]] = Field(default_factory=list)
+    # Postprocess parameter sections over the worker's (see gstreamer/postprocess_params.py),
+    # applied to the running pipeline when they change
+    postprocess: Dict[str, Any] = Field(default_factory=dict)
+    # Inference scheduler (WorkerConfig.scheduler): higher priorities keep their
+    # rate when the Hailo device is oversubscribed; 0 budgets are unlimited
+    priority: int = 0
+    inference_fps: float = 0.0
+    min_inference_fps: float = 1.0
+    ocr_fps: float = 0.0
 
 
 class WorkerConfig(BaseModel):
@@ -53,6 +63,29 @@ class WorkerConfig(BaseModel):
     target_width: int = Field(default=640)
     target_height: int = Field(default=480)
     detection_threshold: float = Field(default=0.5)
+    postprocess_params: Dict[str, Any] = Field(default_factory=dict)  # site-wide postprocess sections
+    ocr_region: str = Field(default="eu")
+    native_tracker: bool = Field(default=True)
+    multi_stream: bool = Field(default=False)  # all cameras share one detection/OCR hailonet
+    ocr_batch_size: int = Field(default=8)
+    zero_copy: bool = Field(default=False)  # DMA-BUF decode/scale into hailonet, CPU fallback
+    dual_resolution: bool = Field(default=False)  # detect downscaled, crop plates at native resolution
+    ocr_workers: int = Field(default=0)  # shared OCR decode threads, 0: on the streaming threads
+    ocr_worker_cpus: List[int] = Field(default_factory=list)  # CPUs to pin them to, away from the decoders
+    latency_tracing: bool = Field(default=False)  # capture timestamp and stage latencies on every event
+    latency_trace_file: str = Field(default="")  # Chrome trace of sampled events, empty: none
+    latency_trace_sample: int = Field(default=10)  # every n-th traced event goes to the trace file
+    scheduler: bool = Field(default=False)  # per-camera priorities and budgets on the shared device
+    hailo_fps: float = Field(default=0.0)  # detection frames/s of the device, 0: latency target only
+    scheduler_target_latency_ms: float = Field(default=150.0)
+    adaptive_fps: bool = Field(default=False)  # idle cameras infer at idle_fps
+    idle_fps: float = Field(default=2.0)
+    idle_after_frames: int = Field(default=30)
+    roi_detection: bool = Field(default=False)  # detect only inside the camera's zones
+    tensor_capture_cameras: List[int] = Field(default_factory=list)  # cameras whose output tensors are recorded
+    tensor_capture_dir: str = Field(default="/tmp/tensor_dumps")
+    tensor_capture_fps: float = Field(default=1.0)
+    tensor_capture_max_mb: int = Field(default=256)  # per camera dump
     save_plate_images: bool = Field(default=False)
     plate_images_dir: str = Field(default="/tmp/plates")
     max_cameras: int = Field(default=4)
@@ -7,20 +7,30 @@ import asyncio
 import logging
 import signal
 import sys
+import time
 from datetime import datetime
 from pathlib import Path
-from typing import Dict, Optional
+from typing import Dict, List, Optional, Tuple
 import threading
 
 # Add parent directory to path for imports
 sys.path.insert(0, str(Path(__file__).parent.parent))
 
-from gstreamer.pipeline import ANPRPipeline
+from gstreamer.event_ring import ZONE_EVENTS
+from gstreamer.frame_trace import ChromeTraceWriter
+from gstreamer.pipeline import ANPRPipeline, MultiStreamANPRPipeline, StreamSource
+from gstreamer.postprocess_params import merge_params
+from gstreamer.scheduler import configure_scheduler
+from gstreamer.worker_pool import configure_worker_pool
 from worker.backend_client import BackendClient
 from worker.models import PlateEvent, CameraConfig, WorkerConfig, BoundingBox
 
 logger = logging.getLogger(__name__)
 
+# With save_plate_images, how long a decided plate's event waits for its
+# evidence snapshot (and a snapshot for its event) before going out alone
+EVIDENCE_WAIT_SECONDS = 2.0
+
 
 class EdgeWorkerService:
     """
@@ -45,9 +55,20 @@ class EdgeWorkerService:
         self.backend_client = BackendClient(config.backend_url)
         self.pipelines: Dict[int, ANPRPipeline] = {}
         self.pipeline_threads: Dict[int, threading.Thread] = {}
+        self.shared_pipeline: Optional[MultiStreamANPRPipeline] = None
+        self.shared_pipeline_thread: Optional[threading.Thread] = None
         self.running = False
         self.event_queue = asyncio.Queue()
 
+        # Decided plates waiting for their evidence snapshot and snapshots
+        # waiting for their event, by (camera id, track id), with deadlines
+        self._evidence_lock = threading.Lock()
+        self._held_events: Dict[Tuple[int, int], Tuple[PlateEvent, float]] = {}
+        self._held_evidence: Dict[Tuple[int, int], Tuple[Dict[str, str], float]] = {}
+
+        # Sampled event latency traces (latency_tracing with latency_trace_file)
+        self.trace_writer: Optional[ChromeTraceWriter] = None
+
         # Setup logging
         logging.basicConfig(
             level=getattr(logging, config.log_level),
@@ -69,9 +90,18 @@ class EdgeWorkerService:
 
         Args:
             camera_id: Camera ID
-            metadata: Detection metadata from Hailo
+            metadata: Plate event from the pipeline's event drain (see
+                ANPRPipeline.on_events); called from the drain thread
         """
         try:
+            # Zone crossings of a track are not plate events
+            if metadata.get('event') in ZONE_EVENTS:
+                logger.debug(
+                    f"Track {metadata.get('track_id')} {metadata['event']} {metadata.get('zone')} "
+                    f"(camera {camera_id}, plate '{metadata.get('plate_text', '')}')"
+                )
+                return
+
             # Extract plate information from Hailo metadata
             # This structure depends on the post-processing plugin output
             plate_text = metadata.get('plate_text', '')
@@ -79,8 +109,10 @@ class EdgeWorkerService:
             ocr_conf = metadata.get('ocr_confidence', 0.0)
             bbox_data = metadata.get('bbox', {})
 
-            # Calculate overall confidence (average of detection and OCR)
-            confidence = (detection_conf + ocr_conf) / 2.0
+            # Overall confidence: average of the detection and OCR confidences
+            # the event carries (a record without a detection leaves it at 0)
+            present = [c for c in (detection_conf, ocr_conf) if c]
+            confidence = sum(present) / len(present) if present else 0.0
 
             # Create bounding box
             bbox = None
@@ -100,15 +132,23 @@ class EdgeWorkerService:
                 detection_confidence=detection_conf,
                 ocr_confidence=ocr_conf,
                 bbox=bbox,
-                timestamp=datetime.utcnow(),
+                timestamp=(datetime.utcfromtimestamp(metadata['timestamp'])
+                           if 'timestamp' in metadata else datetime.utcnow()),
                 metadata=metadata
             )
 
-            # Add to queue for async processing
-            asyncio.run_coroutine_threadsafe(
-                self.event_queue.put(event),
-                self.loop
-            )
+            # Add to queue for async processing, once it has its snapshot
+            track_id = metadata.get('track_id')
+            if self.config.save_plate_images and metadata.get('event') == 'plate_decided' and track_id:
+                with self._evidence_lock:
+                    held = self._held_evidence.pop((camera_id, track_id), None)
+                    if held is None:
+                        self._held_events[(camera_id, track_id)] = (event, time.monotonic() + EVIDENCE_WAIT_SECONDS)
+                        event = None
+                if held is not None:
+                    self._attach_evidence(event, held[0])
+            if event is not None:
+                self._enqueue_event(event)
 
             logger.debug(
                 f"Plate detected: {plate_text} "
@@ -118,24 +158,143 @@ class EdgeWorkerService:
         except Exception as e:
             logger.error(f"Error processing plate detection: {e}")
 
+    def _enqueue_event(self, event: PlateEvent):
+        """Queue an event for the event processor (from any thread)"""
+        asyncio.run_coroutine_threadsafe(
+            self.event_queue.put(event),
+            self.loop
+        )
+
+    @staticmethod
+    def _attach_evidence(event: PlateEvent, paths: Dict[str, str]):
+        """Point an event at its saved snapshot files"""
+        event.image_path = paths['plate_image']
+        event.metadata = {**(event.metadata or {}), **paths}
+
+    def _save_evidence(self, camera_id: int, evidence: dict) -> Dict[str, str]:
+        """
+        Write a track's JPEG snapshots to plate_images_dir.
+
+        Returns:
+            plate_image / frame_image paths
+        """
+        directory = Path(self.config.plate_images_dir) / f"camera_{camera_id}"
+        directory.mkdir(parents=True, exist_ok=True)
+        stem = f"{int(evidence['timestamp'] * 1000)}_{evidence['track_id']}"
+        paths = {}
+        for kind in ('plate', 'frame'):
+            path = directory / f"{stem}_{kind}.jpg"
+            path.write_bytes(evidence[f'{kind}_jpeg'])
+            paths[f'{kind}_image'] = str(path)
+        return paths
+
+    def _on_evidence(self, camera_id: int, evidence: dict):
+        """
+        Callback for a decided track's evidence snapshot (JPEG plate crop and
+        context frame), from the pipeline's evidence drain thread.
+
+        Args:
+            camera_id: Camera ID
+            evidence: Snapshot from the pipeline (see ANPRPipeline.on_evidence)
+        """
+        try:
+            paths = self._save_evidence(camera_id, evidence)
+        except OSError as e:
+            logger.error(f"Error saving plate images: {e}")
+            return
+
+        key = (camera_id, evidence['track_id'])
+        with self._evidence_lock:
+            held = self._held_events.pop(key, None)
+            if held is None:
+                self._held_evidence[key] = (paths, time.monotonic() + EVIDENCE_WAIT_SECONDS)
+                return
+        event, _ = held
+        self._attach_evidence(event, paths)
+        self._enqueue_event(event)
+
+    def _release_expired_evidence(self) -> List[PlateEvent]:
+        """Take the events whose snapshot did not arrive in time, drop stale snapshots"""
+        now = time.monotonic()
+        with self._evidence_lock:
+            expired = [key for key, (_, deadline) in self._held_events.items() if deadline <= now]
+            events = [self._held_events.pop(key)[0] for key in expired]
+            for key in [key for key, (_, deadline) in self._held_evidence.items() if deadline <= now]:
+                del self._held_evidence[key]
+        return events
+
     async def _event_processor(self):
         """Process plate events from queue and send to backend"""
         while self.running:
             try:
-                # Get event from queue with timeout
+                # Events whose snapshot never came go out without images
+                for event in self._release_expired_evidence():
+                    await self.event_queue.put(event)
+
+                # Get event from queue with timeout (shorter while events are held)
                 event = await asyncio.wait_for(
                     self.event_queue.get(),
-                    timeout=1.0
+                    timeout=0.5 if self._held_events else 1.0
                 )
 
                 # Send to backend
                 await self.backend_client.ingest_plate_event(event)
+                self._trace_event(event)
 
             except asyncio.TimeoutError:
                 continue
             except Exception as e:
                 logger.error(f"Error in event processor: {e}")
 
+    def _trace_event(self, event: PlateEvent):
+        """Add a sent event's latency, up to now, to the trace file if it is sampled"""
+        metadata = event.metadata or {}
+        if self.trace_writer is None or "latency_ms" not in metadata:
+            return
+        latency = dict(metadata["latency_ms"])
+        latency["exported"] = round((time.time() - metadata["capture_timestamp"]) * 1e3, 3)
+        self.trace_writer.write(event.camera_id, event.plate_text, metadata["capture_timestamp"], latency)
+
+    def _start_tensor_capture(self, pipeline: ANPRPipeline, camera_ids: List[int]):
+        """
+        Record raw output tensors of the configured cameras (for the offline
+        benchmark), one dump per camera in tensor_capture_dir.
+
+        Args:
+            pipeline: Running pipeline serving the cameras
+            camera_ids: Cameras of the pipeline
+        """
+        for camera_id in camera_ids:
+            if camera_id not in self.config.tensor_capture_cameras:
+                continue
+            Path(self.config.tensor_capture_dir).mkdir(parents=True, exist_ok=True)
+            pipeline.start_tensor_capture(
+                camera_id,
+                str(Path(self.config.tensor_capture_dir) / f"camera_{camera_id}.dump"),
+                max_fps=self.config.tensor_capture_fps,
+                max_bytes=self.config.tensor_capture_max_mb << 20
+            )
+
+    def _worker_postprocess(self) -> dict:
+        """Postprocess sections of the worker; save_plate_images turns on evidence snapshots"""
+        defaults = {"evidence": {"enabled": True}} if self.config.save_plate_images else {}
+        return merge_params(defaults, self.config.postprocess_params)
+
+    def _camera_postprocess(self, camera: CameraConfig) -> dict:
+        """Postprocess sections of a camera: the worker's, overridden by the backend's"""
+        return merge_params(self._worker_postprocess(), camera.postprocess)
+
+    def _camera_schedule(self, camera: CameraConfig) -> Optional[dict]:
+        """Inference schedule of a camera, None without the scheduler"""
+        if not self.config.scheduler:
+            return None
+        return {
+            "priority": camera.priority,
+            "fps": camera.inference_fps,
+            "min_fps": camera.min_inference_fps,
+            "ocr_fps": camera.ocr_fps,
+        }
+
     def _start_pipeline(self, camera: CameraConfig):
         """
         Start GStreamer pipeline for a camera.
@@ -155,12 +314,28 @@ class EdgeWorkerService:
                 target_width=self.config.target_width,
                 target_height=self.config.target_height,
                 detection_threshold=self.config.detection_threshold,
-                result_callback=self._on_plate_detected
+                result_callback=self._on_plate_detected,
+                ocr_region=self.config.ocr_region,
+                native_tracker=self.config.native_tracker,
+                zones=camera.zones,
+                frame_width=camera.resolution_width,
+                frame_height=camera.resolution_height,
+                adaptive_fps=self.config.adaptive_fps,
+                idle_fps=self.config.idle_fps,
+                idle_after_frames=self.config.idle_after_frames,
+                roi_detection=self.config.roi_detection,
+                postprocess=self._camera_postprocess(camera),
+                zero_copy=self.config.zero_copy,
+                dual_resolution=self.config.dual_resolution,
+                evidence_callback=self._on_evidence if self.config.save_plate_images else None,
+                schedule=self._camera_schedule(camera),
+                latency_tracing=self.config.latency_tracing
             )
 
             # Start pipeline
             if pipeline.start():
                 self.pipelines[camera.id] = pipeline
+                self._start_tensor_capture(pipeline, [camera.id])
 
                 # Run pipeline in separate thread
                 thread = threading.Thread(
@@ -195,6 +370,89 @@ class EdgeWorkerService:
 
             del self.pipelines[camera_id]
 
+    def _start_shared_pipeline(self, cameras: List[CameraConfig]):
+        """
+        Start one multi-stream pipeline for all cameras.
+
+        Args:
+            cameras: Camera configurations, in stream order
+        """
+        try:
+            logger.info(f"Starting shared pipeline for cameras {[c.id for c in cameras]}")
+
+            pipeline = MultiStreamANPRPipeline(
+                sources=[
+                    StreamSource(
+                        camera_id=camera.id,
+                        rtsp_url=camera.rtsp_url,
+                        zones=camera.zones,
+                        frame_width=camera.resolution_width,
+                        frame_height=camera.resolution_height,
+                        postprocess=merge_params({}, camera.postprocess),
+                        schedule=self._camera_schedule(camera)
+                    )
+                    for camera in cameras
+                ],
+                detection_model_path=self.config.detection_model_path,
+                ocr_model_path=self.config.ocr_model_path,
+                target_width=self.config.target_width,
+                target_height=self.config.target_height,
+                detection_threshold=self.config.detection_threshold,
+                result_callback=self._on_plate_detected,
+                ocr_region=self.config.ocr_region,
+                ocr_batch_size=self.config.ocr_batch_size,
+                adaptive_fps=self.config.adaptive_fps,
+                idle_fps=self.config.idle_fps,
+                idle_after_frames=self.config.idle_after_frames,
+                postprocess=self._worker_postprocess(),
+                zero_copy=self.config.zero_copy,
+                evidence_callback=self._on_evidence if self.config.save_plate_images else None,
+                latency_tracing=self.config.latency_tracing
+            )
+
+            if pipeline.start():
+                self.shared_pipeline = pipeline
+                self._start_tensor_capture(pipeline, [camera.id for camera in cameras])
+                self.shared_pipeline_thread = threading.Thread(target=pipeline.run, daemon=True)
+                self.shared_pipeline_thread.start()
+                logger.info("Shared pipeline started")
+            else:
+                logger.error("Failed to start shared pipeline")
+
+        except Exception as e:
+            logger.error(f"Error starting shared pipeline: {e}")
+
+    def _stop_shared_pipeline(self):
+        """Stop the multi-stream pipeline"""
+        if self.shared_pipeline:
+            logger.info("Stopping shared pipeline")
+            self.shared_pipeline.stop()
+
+            if self.shared_pipeline_thread:
+                self.shared_pipeline_thread.join(timeout=5.0)
+                self.shared_pipeline_thread = None
+
+            self.shared_pipeline = None
+
+    def _sync_shared_pipeline(self, cameras: List[CameraConfig]):
+        """
+        Rebuild the multi-stream pipeline when the camera set changes.
+
+        Args:
+            cameras: Enabled cameras from the backend
+        """
+        cameras = cameras[:self.config.max_cameras]
+        current_ids = [s.camera_id for s in self.shared_pipeline.sources] if self.shared_pipeline else []
+        if current_ids == [c.id for c in cameras]:
+            for camera, source in zip(cameras, self.shared_pipeline.sources):
+                if merge_params({}, camera.postprocess) != source.postprocess:
+                    self.shared_pipeline.update_postprocess_params(camera.id, camera.postprocess)
+            return
+
+        self._stop_shared_pipeline()
+        if cameras:
+            self._start_shared_pipeline(cameras)
+
     async def _sync_cameras(self):
         """Synchronize camera configurations with backend"""
         try:
@@ -202,6 +460,10 @@ class EdgeWorkerService:
             cameras = await self.backend_client.get_cameras()
             logger.info(f"Fetched {len(cameras)} enabled cameras from backend")
 
+            if self.config.multi_stream:
+                self._sync_shared_pipeline(cameras)
+                return
+
             # Get current camera IDs
             current_ids = set(self.pipelines.keys())
             new_ids = {cam.id for cam in cameras}
@@ -219,6 +481,13 @@ class EdgeWorkerService:
             for camera in cameras_to_add:
                 self._start_pipeline(camera)
 
+            # Parameter changes of running cameras apply without a restart
+            for camera in cameras:
+                pipeline = self.pipelines.get(camera.id) if camera.id in current_ids else None
+                postprocess = self._camera_postprocess(camera)
+                if pipeline and pipeline.postprocess != postprocess:
+                    pipeline.update_postprocess_params(camera.id, postprocess)
+
         except Exception as e:
             logger.error(f"Error syncing cameras: {e}")
 
@@ -237,6 +506,24 @@ class EdgeWorkerService:
             logger.warning("Waiting for backend to be available...")
             await asyncio.sleep(5)
 
+        # One OCR worker pool for every pipeline of the process
+        if self.config.ocr_workers:
+            if configure_worker_pool(self.config.ocr_workers, self.config.ocr_worker_cpus):
+                logger.info(f"OCR worker pool: {self.config.ocr_workers} threads "
+                            f"on CPUs {self.config.ocr_worker_cpus or 'any'}")
+
+        # Chrome trace of sampled events (chrome://tracing, Perfetto)
+        if self.config.latency_tracing and self.config.latency_trace_file:
+            self.trace_writer = ChromeTraceWriter(self.config.latency_trace_file, self.config.latency_trace_sample)
+            logger.info(f"Latency traces of every {self.trace_writer.sample_every}th event "
+                        f"to {self.config.latency_trace_file}")
+
+        # One inference scheduler for every camera on the device
+        if self.config.scheduler:
+            if configure_scheduler(self.config.hailo_fps, self.config.scheduler_target_latency_ms):
+                logger.info(f"Inference scheduler: {self.config.hailo_fps or 'unknown'} fps, "
+                            f"{self.config.scheduler_target_latency_ms} ms target latency")
+
         # Start event processor
         event_processor_task = asyncio.create_task(self._event_processor())
 
@@ -259,12 +546,15 @@ class EdgeWorkerService:
             # Stop all pipelines
             for camera_id in list(self.pipelines.keys()):
                 self._stop_pipeline(camera_id)
+            self._stop_shared_pipeline()
 
             # Cancel event processor
             event_processor_task.cancel()
 
             # Close backend client
             await self.backend_client.close()
+            if self.trace_writer:
+                self.trace_writer.close()
 
             logger.info("Edge worker service stopped")
 